@@ -29,6 +29,18 @@ CoreBackend::~CoreBackend()
 {
 }
 
+bool CoreBackend::attachDevice(Device& d)
+{
+    Q_UNUSED(d)
+
+    return true;
+}
+
+void CoreBackend::detachDevice(Device& d)
+{
+    Q_UNUSED(d)
+}
+
 void CoreBackend::emitProgress(int i)
 {
     Q_EMIT progress(i);
@@ -153,6 +153,21 @@ public:
       */
     virtual bool closeDevice(std::unique_ptr<CoreBackendDevice> coreDevice) = 0;
 
+    /**
+      * Make the partitions of a device available to external tools.
+      * Called before an Operation that runs tools on partition device nodes, the
+      * default implementation does nothing.
+      * @param d the Device the Operation works on
+      * @return true if the partitions' device nodes can be used
+      */
+    virtual bool attachDevice(Device& d);
+
+    /**
+      * Undo attachDevice() once the Operation is done.
+      * @param d the Device the Operation worked on
+      */
+    virtual void detachDevice(Device& d);
+
     /**
       * Emit progress.
       * @param i the progress in percent (from 0 to 100)
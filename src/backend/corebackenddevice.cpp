@@ -6,9 +6,62 @@
 */
 
 #include "backend/corebackenddevice.h"
+#include "backend/corebackendpartitiontable.h"
+
+#include "core/partition.h"
+#include "core/partitiontable.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
 
 CoreBackendDevice::CoreBackendDevice(const QString& deviceNode) :
     m_DeviceNode(deviceNode),
     m_Exclusive(false)
 {
 }
+
+static bool createPartitions(Report& report, CoreBackendPartitionTable& backendPartitionTable, PartitionNode& parent, bool isGpt)
+{
+    for (auto &p : parent.children()) {
+        if (p->roles().has(PartitionRole::Unallocated))
+            continue;
+
+        const QString partitionPath = backendPartitionTable.createPartition(report, *p);
+        if (partitionPath.isEmpty()) {
+            report.line() << xi18nc("@info/plain", "Failed to add partition <filename>%1</filename> to device <filename>%2</filename>.", p->deviceNode(), p->devicePath());
+            return false;
+        }
+
+        p->setPartitionPath(partitionPath);
+        p->setState(Partition::State::None);
+
+        if (!p->roles().has(PartitionRole::Extended)) {
+            if (!backendPartitionTable.setPartitionSystemType(report, *p))
+                return false;
+            if (isGpt && (!backendPartitionTable.setPartitionLabel(report, *p, p->label()) ||
+                          !backendPartitionTable.setPartitionAttributes(report, *p, p->attributes())))
+                return false;
+        }
+
+        if (!createPartitions(report, backendPartitionTable, *p, isGpt))
+            return false;
+    }
+
+    return true;
+}
+
+bool CoreBackendDevice::createPartitionTableLayout(Report& report, PartitionTable& ptable)
+{
+    if (!createPartitionTable(report, ptable))
+        return false;
+
+    std::unique_ptr<CoreBackendPartitionTable> backendPartitionTable = openPartitionTable();
+    if (!backendPartitionTable)
+        return false;
+
+    const bool rval = createPartitions(report, *backendPartitionTable, ptable, ptable.type() == PartitionTable::TableType::gpt);
+    backendPartitionTable->commit();
+
+    return rval;
+}
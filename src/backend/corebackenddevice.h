@@ -85,6 +85,18 @@ public:
       */
     virtual bool createPartitionTable(Report& report, const PartitionTable& ptable) = 0;
 
+    /**
+      * Create a new partition table on this device together with all of its partitions.
+      * The partitions are created in the order of the table, their labels, types and
+      * attributes are set and the changes are committed to the OS only once at the end.
+      * On success the partition paths are updated and the partitions are no longer new.
+      * Backends that can write a complete layout in one go should override this.
+      * @param report the Report to write information to
+      * @param ptable the PartitionTable with all partitions to create on this backend device
+      * @return true if successful
+      */
+    virtual bool createPartitionTableLayout(Report& report, PartitionTable& ptable);
+
 protected:
     void setExclusive(bool b) {
         m_Exclusive = b;
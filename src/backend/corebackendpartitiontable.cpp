@@ -5,3 +5,81 @@
 */
 
 #include "backend/corebackendpartitiontable.h"
+
+#include <QHash>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QString>
+
+/** @return the lock guarding the partition table of the given device node */
+static std::shared_ptr<QReadWriteLock> partitionTableLock(const QString& deviceNode)
+{
+    static QMutex locksMutex;
+    static QHash<QString, std::shared_ptr<QReadWriteLock>> locks;
+
+    QMutexLocker locker(&locksMutex);
+    auto &lock = locks[deviceNode];
+    if (!lock)
+        lock = std::make_shared<QReadWriteLock>(QReadWriteLock::Recursive);
+
+    return lock;
+}
+
+/** @return how often the calling thread holds each lock for working on partition contents */
+static QHash<const QReadWriteLock*, qint32>& contentLocks()
+{
+    thread_local QHash<const QReadWriteLock*, qint32> locks;
+    return locks;
+}
+
+/** Creates a CoreBackendPartitionTable that is not guarded against concurrent changes. */
+CoreBackendPartitionTable::CoreBackendPartitionTable()
+{
+}
+
+/** Creates a CoreBackendPartitionTable and waits until no other thread has the partition
+    table of the device open or works on the contents of its partitions.
+    @param deviceNode the device node of the device this partition table is on
+*/
+CoreBackendPartitionTable::CoreBackendPartitionTable(const QString& deviceNode) :
+    m_Lock(partitionTableLock(deviceNode))
+{
+    // Give up our own content locks for now, two threads each holding one and waiting for the
+    // other to give up its lock would wait forever
+    m_ReleasedContentLocks = contentLocks().take(m_Lock.get());
+    for (qint32 i = 0; i < m_ReleasedContentLocks; i++)
+        m_Lock->unlock();
+
+    m_Lock->lockForWrite();
+}
+
+CoreBackendPartitionTable::~CoreBackendPartitionTable()
+{
+    if (!m_Lock)
+        return;
+
+    m_Lock->unlock();
+
+    for (qint32 i = 0; i < m_ReleasedContentLocks; i++)
+        m_Lock->lockForRead();
+    if (m_ReleasedContentLocks > 0)
+        contentLocks().insert(m_Lock.get(), m_ReleasedContentLocks);
+}
+
+/** Waits until no other thread has the partition table of the device open.
+    @param deviceNode the device node of the device whose partitions are worked on
+*/
+CoreBackendPartitionTable::ContentLocker::ContentLocker(const QString& deviceNode) :
+    m_Lock(partitionTableLock(deviceNode))
+{
+    m_Lock->lockForRead();
+    ++contentLocks()[m_Lock.get()];
+}
+
+CoreBackendPartitionTable::ContentLocker::~ContentLocker()
+{
+    if (--contentLocks()[m_Lock.get()] <= 0)
+        contentLocks().remove(m_Lock.get());
+
+    m_Lock->unlock();
+}
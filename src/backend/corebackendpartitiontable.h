@@ -16,18 +16,47 @@
 
 #include <QtGlobal>
 
+#include <memory>
+
 class CoreBackendPartition;
 class Report;
 class Partition;
+class QReadWriteLock;
 
 /**
   * Interface class to represent a partition table in the backend.
+  *
+  * Jobs may run concurrently on different partitions of the same device. A partition table
+  * opened for a device node keeps all other threads from opening the partition table of that
+  * device until it is destroyed, so changes to the partition table are never interleaved.
+  * It also waits until no other thread holds a ContentLocker for the device, so the kernel does
+  * not re-read the partition table while tools work on the device's partitions.
+  *
   * @author Volker Lanz <vl@fidra.de>
   */
 class CoreBackendPartitionTable
 {
+protected:
+    CoreBackendPartitionTable();
+    explicit CoreBackendPartitionTable(const QString& deviceNode);
+
 public:
-    virtual ~CoreBackendPartitionTable() {}
+    virtual ~CoreBackendPartitionTable();
+
+    /** Keeps the partition table of a device from being changed by other threads while the
+        calling thread works on the contents of its partitions. The calling thread may still
+        open the partition table itself. */
+    class ContentLocker
+    {
+        Q_DISABLE_COPY(ContentLocker)
+
+    public:
+        explicit ContentLocker(const QString& deviceNode);
+        ~ContentLocker();
+
+    private:
+        std::shared_ptr<QReadWriteLock> m_Lock;
+    };
 
 public:
     /**
@@ -153,6 +182,10 @@ public:
       * @return true on success
       */
     virtual bool setFlag(Report& report, const Partition& partition, PartitionTable::Flag flag, bool state) = 0;
+
+private:
+    std::shared_ptr<QReadWriteLock> m_Lock;
+    qint32 m_ReleasedContentLocks = 0;
 };
 
 #endif
@@ -0,0 +1,45 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/backupimage.h"
+
+#include <QFile>
+#include <QtEndian>
+
+/** Reads the header of a backup image.
+    @param filename name of the image file
+*/
+BackupImage::BackupImage(const QString& filename) :
+    m_Format(Format::Raw),
+    m_Length(0),
+    m_FileSystemType(FileSystem::Type::Unknown)
+{
+    QFile file(filename);
+    if (!file.open(QIODevice::ReadOnly))
+        return;
+
+    m_Length = file.size();
+
+    const QByteArray header = file.read(64);
+    if (header.size() < 32)
+        return;
+
+    const uchar* data = reinterpret_cast<const uchar*>(header.constData());
+
+    if (header.startsWith(QByteArray("\0ntfsclone-image", 16))) {
+        // Packed header: magic, two version bytes, 32 bit cluster size, 64 bit device size
+        m_Format = Format::NtfsClone;
+        m_Length = qFromLittleEndian<qint64>(data + 22);
+        m_FileSystemType = FileSystem::Type::Ntfs;
+    } else if (header.startsWith("QFI\xfb")) {
+        // The virtual disk size follows magic, version, backing file offset and size, cluster bits
+        m_Format = Format::Qcow2;
+        m_Length = qFromBigEndian<qint64>(data + 24);
+        // ext3 and ext4 share the tools of ext2
+        m_FileSystemType = FileSystem::Type::Ext2;
+    } else if (header.startsWith("XFSB"))
+        m_FileSystemType = FileSystem::Type::Xfs;
+}
@@ -0,0 +1,52 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_BACKUPIMAGE_H
+#define KPMCORE_BACKUPIMAGE_H
+
+#include "fs/filesystem.h"
+
+#include <QString>
+#include <QtGlobal>
+
+/** Describes a file system backup image.
+
+    Backups are either raw copies of the file system, possibly sparse, or images in the
+    native format of a file system's tools that only contain the used blocks. The format is
+    recognized by the header of the image, so restoring picks the tool that wrote it.
+
+    @author KPMcore contributors
+*/
+class BackupImage
+{
+public:
+    enum class Format {
+        Raw,        /**< plain copy of the file system, as written by core copying or xfs_copy */
+        NtfsClone,  /**< ntfsclone special image */
+        Qcow2       /**< QCOW2 image as written by e2image */
+    };
+
+public:
+    explicit BackupImage(const QString& filename);
+
+public:
+    Format format() const {
+        return m_Format;    /**< @return the format of the image */
+    }
+    qint64 length() const {
+        return m_Length;    /**< @return the length of the file system in the image in bytes */
+    }
+    FileSystem::Type fileSystemType() const {
+        return m_FileSystemType;    /**< @return the file system whose tools restore the image, Unknown for a plain copy */
+    }
+
+private:
+    Format m_Format;
+    qint64 m_Length;
+    FileSystem::Type m_FileSystemType;
+};
+
+#endif
@@ -14,13 +14,18 @@
 #include "core/operationstack.h"
 #include "core/device.h"
 #include "core/diskdevice.h"
+#include "core/volumemanagerdevice.h"
 
+#include "fs/btrfs.h"
+#include "fs/filesystem.h"
 #include "fs/lvm2_pv.h"
 
 #include "util/externalcommand.h"
 
 #include <QRegularExpression>
 
+#include <algorithm>
+
 /** Constructs a DeviceScanner
     @param ostack the OperationStack where the devices will be created
 */
@@ -53,11 +58,73 @@ void DeviceScanner::scan()
 
     clear();
 
+    // Every file system probes the same few superblocks several times, read them only once
+    ExternalCommand::setReadCacheEnabled(true);
+
     const QList<Device*> deviceList = CoreBackendManager::self()->backend()->scanDevices(ScanFlag::includeLoopback);
 
+    ExternalCommand::setReadCacheEnabled(false);
+
     for (const auto &d : deviceList)
         operationStack().addDevice(d);
 
     operationStack().sortDevices();
+
+    // btrfs can span several Devices, including Logical Volumes
+    FS::btrfs::scanMembers(operationStack().previewDevices());
+
+    // so can ext3, ext4 and XFS with an external journal or log
+    FileSystem::scanExternalJournals(operationStack().previewDevices());
 }
 
+/** Scans only the given Devices and all volume manager Devices.
+
+    Unlike scan() this does not probe every disk on the computer, which is a lot faster
+    when the caller already knows which disks it is interested in. Devices that cannot be
+    found are skipped. RAID arrays and LVM volume groups are always scanned, they may be
+    built from the given Devices.
+
+    @param deviceNodes the device nodes to scan
+*/
+void DeviceScanner::scan(const QStringList& deviceNodes)
+{
+    Q_EMIT progress(QString(), 0);
+
+    clear();
+
+    ExternalCommand::setReadCacheEnabled(true);
+
+    QList<Device*> deviceList;
+    for (const auto &deviceNode : deviceNodes) {
+        Device* d = CoreBackendManager::self()->backend()->scanDevice(deviceNode);
+        if (d)
+            deviceList.append(d);
+    }
+
+    QList<Device*> volumeManagerDevices = deviceList;
+    VolumeManagerDevice::scanDevices(volumeManagerDevices);
+
+    ExternalCommand::setReadCacheEnabled(false);
+
+    // RAID arrays that were asked for are found again by the volume manager scan
+    for (const auto &d : std::as_const(volumeManagerDevices)) {
+        if (deviceList.contains(d))
+            continue;
+
+        if (std::any_of(deviceList.begin(), deviceList.end(), [d] (const Device* other) { return other->deviceNode() == d->deviceNode(); }))
+            delete d;
+        else
+            deviceList.append(d);
+    }
+
+    for (const auto &d : std::as_const(deviceList))
+        operationStack().addDevice(d);
+
+    operationStack().sortDevices();
+
+    // btrfs can span several Devices, including Logical Volumes
+    FS::btrfs::scanMembers(operationStack().previewDevices());
+
+    // so can ext3, ext4 and XFS with an external journal or log
+    FileSystem::scanExternalJournals(operationStack().previewDevices());
+}
@@ -12,6 +12,7 @@
 
 #include "util/libpartitionmanagerexport.h"
 
+#include <QStringList>
 #include <QThread>
 
 class OperationStack;
@@ -32,6 +33,7 @@ public:
 public:
     void clear(); /**< clear Devices and the OperationStack */
     void scan(); /**< do the actual scanning; blocks if called directly */
+    void scan(const QStringList& deviceNodes);
     void setupConnections();
 
 Q_SIGNALS:
@@ -21,6 +21,7 @@
 #include "util/globallog.h"
 #include "util/report.h"
 
+#include <numeric>
 #include <utility>
 
 #include <QRegularExpression>
@@ -43,6 +44,10 @@ public:
     mutable QStringList m_LVPathList;
     QVector <const Partition*> m_PVs;
     mutable std::unique_ptr<QHash<QString, qint64>> m_LVSizeMap;
+    QHash<QString, LvmDevice::LVLayout> m_LVLayouts;
+    QHash<QString, LvmDevice::LVCacheStatus> m_LVCacheStatus;
+    QHash<QString, LvmDevice::LVThinStatus> m_ThinStatus;
+    QHash<QString, qint64> m_PVPreviewAllocated;
 };
 
 /** Constructs a representation of LVM device with initialized LV as Partitions
@@ -65,6 +70,7 @@ LvmDevice::LvmDevice(const QString& vgName, const QString& iconName)
     d_ptr->m_allocPE = d_ptr->m_totalPE - d_ptr->m_freePE;
     d_ptr->m_UUID    = getUUID(vgName);
     d_ptr->m_LVPathList = getLVs(vgName);
+    d_ptr->m_ThinStatus = readThinStatus(vgName);
     d_ptr->m_LVSizeMap  = std::make_unique<QHash<QString, qint64>>();
 
     initPartitions();
@@ -209,6 +215,11 @@ void LvmDevice::scanSystemLVM(QList<Device*>& devices)
     LVM::pvList::list().clear();
     LVM::pvList::list().append(FS::lvm2_pv::getPVs(devices));
 
+    // One dmsetup call for the cache statistics of all Logical Volumes
+    const QHash<QString, LVCacheStatus> cacheStatus = lvmList.isEmpty() ? QHash<QString, LVCacheStatus>() : readCacheStatus();
+    for (const auto &d : std::as_const(lvmList))
+        d->setCacheStatus(cacheStatus);
+
     // Look for LVM physical volumes in LVM VGs
     for (const auto &d : lvmList) {
         devices.append(d);
@@ -379,20 +390,84 @@ bool LvmDevice::removeLV(Report& report, LvmDevice& d, Partition& p)
 
 bool LvmDevice::createLV(Report& report, LvmDevice& d, Partition& p, const QString& lvName)
 {
-    ExternalCommand cmd(report, QStringLiteral("lvm"),
-            { QStringLiteral("lvcreate"),
-              QStringLiteral("--yes"),
-              QStringLiteral("--extents"),
-              QString::number(p.length()),
-              QStringLiteral("--name"),
-              lvName,
-              d.name()});
+    const LVLayout layout = d.lvLayout(p.partitionPath());
+
+    // lvcreate itself checks linear allocations, the scanned model might not know all PVs
+    if (layout.type != LVLayout::Type::Linear && !d.canAllocate(layout, p.length())) {
+        report.line() << xi18nc("@info:progress", "Volume group <filename>%1</filename> does not have enough free extents on %2 physical volumes for logical volume <filename>%3</filename>.", d.name(), layout.devices(), lvName);
+        return false;
+    }
+
+    QStringList args = { QStringLiteral("lvcreate"),
+                         QStringLiteral("--yes"),
+                         QStringLiteral("--extents"),
+                         QString::number(p.length()) };
+
+    switch (layout.type) {
+    case LVLayout::Type::Linear:
+        break;
+    case LVLayout::Type::Striped:
+        args << QStringLiteral("--type") << QStringLiteral("striped") << QStringLiteral("--stripes") << QString::number(layout.stripes);
+        break;
+    case LVLayout::Type::Raid0:
+        args << QStringLiteral("--type") << QStringLiteral("raid0") << QStringLiteral("--stripes") << QString::number(layout.stripes);
+        break;
+    case LVLayout::Type::Raid1:
+        args << QStringLiteral("--type") << QStringLiteral("raid1") << QStringLiteral("--mirrors") << QString::number(layout.mirrors);
+        break;
+    case LVLayout::Type::Raid10:
+        args << QStringLiteral("--type") << QStringLiteral("raid10") << QStringLiteral("--stripes") << QString::number(layout.stripes)
+             << QStringLiteral("--mirrors") << QString::number(layout.mirrors);
+        break;
+    case LVLayout::Type::Raid5:
+        args << QStringLiteral("--type") << QStringLiteral("raid5") << QStringLiteral("--stripes") << QString::number(layout.stripes);
+        break;
+    }
+
+    if (layout.stripeSize > 0 && layout.type != LVLayout::Type::Linear && layout.type != LVLayout::Type::Raid1)
+        args << QStringLiteral("--stripesize") << QString::number(layout.stripeSize) + QStringLiteral("k");
+
+    if (layout.regionSize > 0 && layout.hasMetadata())
+        args << QStringLiteral("--regionsize") << QString::number(layout.regionSize) + QStringLiteral("k");
+
+    args << QStringLiteral("--name") << lvName << d.name();
+
+    ExternalCommand cmd(report, QStringLiteral("lvm"), args);
 
     return (cmd.run(-1) && cmd.exitCode() == 0);
 }
 
+/** Creates a copy-on-write snapshot of a Logical Volume.
+ *
+ *  @param report the report to write information to
+ *  @param p the Logical Volume to snapshot
+ *  @param name the name of the snapshot
+ *  @param extents size of the snapshot in extents, 0 for the size of the origin
+ *  @return true on success
+ */
 bool LvmDevice::createLVSnapshot(Report& report, Partition& p, const QString& name, const qint64 extents)
 {
+    return createLVSnapshot(report, p, name, SnapshotType::CopyOnWrite, extents);
+}
+
+/** Creates a snapshot of a Logical Volume.
+ *
+ *  Snapshots of thin volumes share the pool of their origin, which is much cheaper for writes
+ *  to the origin than a classic copy-on-write snapshot. Whether a Logical Volume is thin is
+ *  known from the scan, see thinStatus().
+ *
+ *  @param report the report to write information to
+ *  @param p the Logical Volume to snapshot
+ *  @param name the name of the snapshot
+ *  @param type the kind of snapshot to create
+ *  @param extents size of a copy-on-write snapshot in extents, 0 for the size of the origin
+ *  @return true on success
+ */
+bool LvmDevice::createLVSnapshot(Report& report, const Partition& p, const QString& name, SnapshotType type, const qint64 extents)
+{
+    if (type == SnapshotType::Thin)
+        return createThinSnapshot(report, p, name);
+
     QString numExtents = (extents > 0) ? QString::number(extents) :
         QString::number(p.length());
     ExternalCommand cmd(report, QStringLiteral("lvm"),
@@ -407,6 +482,134 @@ bool LvmDevice::createLVSnapshot(Report& report, Partition& p, const QString& na
     return (cmd.run(-1) && cmd.exitCode() == 0);
 }
 
+/** Creates a thin pool.
+ *
+ *  @param report the report to write information to
+ *  @param d the Volume Group to create the pool in
+ *  @param name the name of the new thin pool
+ *  @param extents size of the pool data in extents
+ *  @param metadataSize size of the pool metadata in MiB, 0 lets LVM choose it from the pool size
+ *  @param chunkSize chunk size in KiB, 0 for the LVM default. Larger chunks are faster to provision,
+ *         smaller chunks make snapshots share more space
+ *  @return true on success
+ */
+bool LvmDevice::createThinPool(Report& report, LvmDevice& d, const QString& name, qint64 extents, qint64 metadataSize, qint64 chunkSize)
+{
+    QStringList args = { QStringLiteral("lvcreate"),
+                         QStringLiteral("--yes"),
+                         QStringLiteral("--type"),
+                         QStringLiteral("thin-pool"),
+                         QStringLiteral("--extents"),
+                         QString::number(extents) };
+
+    if (metadataSize > 0)
+        args << QStringLiteral("--poolmetadatasize") << QString::number(metadataSize) + QStringLiteral("m");
+    if (chunkSize > 0)
+        args << QStringLiteral("--chunksize") << QString::number(chunkSize) + QStringLiteral("k");
+
+    args << QStringLiteral("--name") << name << d.name();
+
+    ExternalCommand cmd(report, QStringLiteral("lvm"), args);
+
+    return (cmd.run(-1) && cmd.exitCode() == 0);
+}
+
+/** Creates a thin Logical Volume.
+ *
+ *  @param report the report to write information to
+ *  @param d the Volume Group of the thin pool
+ *  @param pool the name of the thin pool
+ *  @param name the name of the new Logical Volume
+ *  @param size virtual size of the new Logical Volume in bytes
+ *  @return true on success
+ */
+bool LvmDevice::createThinLV(Report& report, LvmDevice& d, const QString& pool, const QString& name, qint64 size)
+{
+    ExternalCommand cmd(report, QStringLiteral("lvm"),
+            { QStringLiteral("lvcreate"),
+              QStringLiteral("--yes"),
+              QStringLiteral("--type"),
+              QStringLiteral("thin"),
+              QStringLiteral("--virtualsize"),
+              QString::number(size) + QStringLiteral("b"),
+              QStringLiteral("--thinpool"),
+              pool,
+              QStringLiteral("--name"),
+              name,
+              d.name() });
+
+    return (cmd.run(-1) && cmd.exitCode() == 0);
+}
+
+/** Creates a thin snapshot of a thin Logical Volume.
+ *
+ *  The snapshot lives in the pool of its origin and does not need space of its own.
+ *  Unlike LVM's default for thin snapshots it is activated like any other Logical Volume.
+ *
+ *  @param report the report to write information to
+ *  @param origin the thin Logical Volume to snapshot
+ *  @param name the name of the snapshot
+ *  @return true on success
+ */
+bool LvmDevice::createThinSnapshot(Report& report, const Partition& origin, const QString& name)
+{
+    ExternalCommand cmd(report, QStringLiteral("lvm"),
+            { QStringLiteral("lvcreate"),
+              QStringLiteral("--yes"),
+              QStringLiteral("--snapshot"),
+              QStringLiteral("--setactivationskip"),
+              QStringLiteral("n"),
+              QStringLiteral("--name"),
+              name,
+              origin.partitionPath() });
+
+    return (cmd.run(-1) && cmd.exitCode() == 0);
+}
+
+/** Reads the thin provisioning state of all Logical Volumes in a Volume Group.
+ *
+ *  @param vgName Volume Group name
+ *  @return thin pools and thin Logical Volumes by Logical Volume path
+ */
+QHash<QString, LvmDevice::LVThinStatus> LvmDevice::readThinStatus(const QString& vgName)
+{
+    QHash<QString, LVThinStatus> result;
+
+    ExternalCommand cmd(QStringLiteral("lvm"),
+            { QStringLiteral("lvs"),
+              QStringLiteral("--foreign"),
+              QStringLiteral("--readonly"),
+              QStringLiteral("--noheadings"),
+              QStringLiteral("--separator"),
+              QStringLiteral("|"),
+              QStringLiteral("--options"),
+              QStringLiteral("lv_name,segtype,pool_lv,data_percent,metadata_percent"),
+              vgName }, QProcess::ProcessChannelMode::SeparateChannels);
+
+    if (!cmd.run(-1) || cmd.exitCode() != 0)
+        return result;
+
+    const QStringList lines = cmd.output().split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    for (const auto &line : lines) {
+        const QStringList fields = line.split(QLatin1Char('|'));
+        if (fields.size() < 5)
+            continue;
+
+        const QString segmentType = fields[1].trimmed();
+        if (segmentType != QStringLiteral("thin-pool") && segmentType != QStringLiteral("thin"))
+            continue;
+
+        LVThinStatus status;
+        status.isPool = segmentType == QStringLiteral("thin-pool");
+        status.pool = fields[2].trimmed();
+        status.dataPercent = fields[3].trimmed().toDouble();
+        status.metadataPercent = fields[4].trimmed().toDouble();
+        result.insert(QStringLiteral("/dev/") + vgName + QLatin1Char('/') + fields[0].trimmed(), status);
+    }
+
+    return result;
+}
+
 bool LvmDevice::resizeLV(Report& report, Partition& p)
 {
     ExternalCommand cmd(report, QStringLiteral("lvm"),
@@ -500,6 +703,143 @@ bool LvmDevice::deactivateLV(Report& report, const Partition& p)
     return deactivate.run(-1) && deactivate.exitCode() == 0;
 }
 
+/** Attaches a fast-tier cache to a Logical Volume.
+ *
+ *  Creates a cache pool (dm-cache) or a cache volume (dm-writecache) on the given Physical Volume
+ *  and converts the Logical Volume to use it.
+ *
+ *  @param report the report to write information to
+ *  @param d the Volume Group of the Logical Volume
+ *  @param p the Logical Volume to cache
+ *  @param fastPV the Physical Volume the cache is created on
+ *  @param cache type, mode and size of the cache
+ *  @return true on success
+ */
+bool LvmDevice::attachCache(Report& report, LvmDevice& d, const Partition& p, const Partition& fastPV, const LVCache& cache)
+{
+    const QString pvPath = fastPV.roles().has(PartitionRole::Luks) ? static_cast<const FS::luks*>(&fastPV.fileSystem())->mapperName() : fastPV.partitionPath();
+    const QString lvName = p.partitionPath().section(QLatin1Char('/'), -1);
+    const bool writeCache = cache.type == LVCache::Type::WriteCache;
+    const QString cacheName = lvName + (writeCache ? QStringLiteral("_wcache") : QStringLiteral("_cpool"));
+
+    QStringList createArgs = { QStringLiteral("lvcreate"), QStringLiteral("--yes") };
+    if (!writeCache)
+        createArgs << QStringLiteral("--type") << QStringLiteral("cache-pool");
+    createArgs << QStringLiteral("--extents") << QString::number(cache.extents);
+    if (!writeCache && cache.chunkSize > 0)
+        createArgs << QStringLiteral("--chunksize") << QString::number(cache.chunkSize) + QStringLiteral("k");
+    createArgs << QStringLiteral("--name") << cacheName << d.name() << pvPath;
+
+    ExternalCommand createCmd(report, QStringLiteral("lvm"), createArgs);
+    if (!createCmd.run(-1) || createCmd.exitCode() != 0)
+        return false;
+
+    QStringList convertArgs = { QStringLiteral("lvconvert"), QStringLiteral("--yes") };
+    if (writeCache)
+        convertArgs << QStringLiteral("--type") << QStringLiteral("writecache") << QStringLiteral("--cachevol") << cacheName;
+    else
+        convertArgs << QStringLiteral("--type") << QStringLiteral("cache") << QStringLiteral("--cachepool") << cacheName
+                    << QStringLiteral("--cachemode") << (cache.mode == LVCache::Mode::WriteBack ? QStringLiteral("writeback") : QStringLiteral("writethrough"));
+    convertArgs << d.name() + QStringLiteral("/") + lvName;
+
+    ExternalCommand convertCmd(report, QStringLiteral("lvm"), convertArgs);
+    if (convertCmd.run(-1) && convertCmd.exitCode() == 0)
+        return true;
+
+    // Do not leave an unused cache volume behind
+    ExternalCommand removeCmd(report, QStringLiteral("lvm"),
+            { QStringLiteral("lvremove"),
+              QStringLiteral("--yes"),
+              d.name() + QStringLiteral("/") + cacheName });
+    removeCmd.run(-1);
+
+    return false;
+}
+
+/** Detaches the cache from a Logical Volume.
+ *
+ *  lvconvert writes all dirty blocks back to the origin before the cache is removed,
+ *  so this can take a while for a large write-back cache.
+ *
+ *  @param report the report to write information to
+ *  @param d the Volume Group of the Logical Volume
+ *  @param p the cached Logical Volume
+ *  @return true on success
+ */
+bool LvmDevice::detachCache(Report& report, const LvmDevice& d, const Partition& p)
+{
+    ExternalCommand cmd(report, QStringLiteral("lvm"),
+            { QStringLiteral("lvconvert"),
+              QStringLiteral("--yes"),
+              QStringLiteral("--uncache"),
+              d.name() + QStringLiteral("/") + p.partitionPath().section(QLatin1Char('/'), -1) });
+
+    return cmd.run(-1) && cmd.exitCode() == 0;
+}
+
+/** @return the device mapper name of the Logical Volume at lvPath */
+QString LvmDevice::deviceMapperName(const QString& lvPath)
+{
+    // device mapper names of LVs are VG-LV with dashes in either name doubled
+    QString vgName = lvPath.section(QLatin1Char('/'), -2, -2);
+    QString lvName = lvPath.section(QLatin1Char('/'), -1);
+    return vgName.replace(QLatin1Char('-'), QStringLiteral("--")) + QLatin1Char('-') + lvName.replace(QLatin1Char('-'), QStringLiteral("--"));
+}
+
+/** Reads cache statistics of all cached Logical Volumes from the device mapper.
+ *
+ *  @return the cache statistics by device mapper name, see deviceMapperName()
+ */
+QHash<QString, LvmDevice::LVCacheStatus> LvmDevice::readCacheStatus()
+{
+    QHash<QString, LVCacheStatus> result;
+
+    ExternalCommand cmd(QStringLiteral("dmsetup"), { QStringLiteral("status") });
+    if (!cmd.run(-1) || cmd.exitCode() != 0)
+        return result;
+
+    const QStringList lines = cmd.output().split(QLatin1Char('\n'), Qt::SkipEmptyParts);
+    for (const auto &line : lines) {
+        // <name>: <start> <length> <target> <target status>
+        const QString dmName = line.section(QStringLiteral(": "), 0, 0);
+        const QStringList fields = line.section(QStringLiteral(": "), 1).split(QLatin1Char(' '), Qt::SkipEmptyParts);
+        auto field = [&fields] (int i) { return i < fields.size() ? fields[i].toLongLong() : 0; };
+
+        LVCacheStatus status;
+
+        if (fields.size() > 13 && fields[2] == QStringLiteral("cache")) {
+            // <start> <length> cache <metadata block size> <used>/<total metadata blocks> <cache block size>
+            // <used>/<total cache blocks> <read hits> <read misses> <write hits> <write misses> <demotions> <promotions> <dirty> ...
+            status.attached = true;
+            status.type = LVCache::Type::Cache;
+            status.usedBlocks = fields[6].section(QLatin1Char('/'), 0, 0).toLongLong();
+            status.totalBlocks = fields[6].section(QLatin1Char('/'), 1, 1).toLongLong();
+            status.readHits = field(7);
+            status.readMisses = field(8);
+            status.writeHits = field(9);
+            status.writeMisses = field(10);
+            status.dirtyBlocks = field(13);
+        } else if (fields.size() > 6 && fields[2] == QStringLiteral("writecache")) {
+            // <start> <length> writecache <error> <blocks> <free blocks> <blocks under writeback>
+            // [<read blocks> <read hits> <write blocks> <write hits uncommitted> <write hits committed> ...]
+            status.attached = true;
+            status.type = LVCache::Type::WriteCache;
+            status.totalBlocks = field(4);
+            status.usedBlocks = field(4) - field(5);
+            // dm-writecache does not tell dirty blocks from clean ones, dirtyBlocks stays unknown
+            status.readHits = field(8);
+            status.readMisses = field(7) - field(8);
+            status.writeHits = field(10) + field(11);
+            status.writeMisses = field(9) - status.writeHits;
+        }
+
+        if (status.attached)
+            result.insert(dmName, status);
+    }
+
+    return result;
+}
+
 bool LvmDevice::activateVG(Report& report, const LvmDevice& d)
 {
     ExternalCommand deactivate(report, QStringLiteral("lvm"),
@@ -544,6 +884,33 @@ void LvmDevice::setFreePE(qint64 freePE) const
     d_ptr->m_allocPE = d_ptr->m_totalPE - freePE;
 }
 
+/** @return the free extents of the Physical Volume pv as scanned, less those taken in the preview,
+ *          0 if pv is no Physical Volume */
+qint64 LvmDevice::pvFreePE(const Partition& pv) const
+{
+    const FileSystem* fs = &pv.fileSystem();
+    if (pv.roles().has(PartitionRole::Luks))
+        fs = static_cast<const FS::luks*>(fs)->innerFS();
+
+    const FS::lvm2_pv* lvm2PVFs = dynamic_cast<const FS::lvm2_pv*>(fs);
+    if (!lvm2PVFs)
+        return 0;
+
+    return lvm2PVFs->freePE() - d_ptr->m_PVPreviewAllocated.value(pv.partitionPath());
+}
+
+/** Takes extents on one Physical Volume in the preview.
+ *
+ *  For Operations that allocate on a given Physical Volume, so later Operations do not count on these extents.
+ *
+ *  @param pv the Physical Volume
+ *  @param extents the number of extents to take, negative to give them back
+ */
+void LvmDevice::allocatePVExtents(const Partition& pv, qint64 extents)
+{
+    d_ptr->m_PVPreviewAllocated[pv.partitionPath()] += extents;
+}
+
 QString LvmDevice::UUID() const
 {
     return d_ptr->m_UUID;
@@ -563,3 +930,112 @@ std::unique_ptr<QHash<QString, qint64>>& LvmDevice::LVSizeMap() const
 {
     return d_ptr->m_LVSizeMap;
 }
+
+/** @return the segment layout used when the Logical Volume at lvPath is created, linear by default */
+LvmDevice::LVLayout LvmDevice::lvLayout(const QString& lvPath) const
+{
+    return d_ptr->m_LVLayouts.value(lvPath);
+}
+
+/** Sets the segment layout for a Logical Volume that is about to be created.
+ *
+ *  @param lvPath the path of the new Logical Volume
+ *  @param layout segment type and geometry passed to lvcreate
+ */
+void LvmDevice::setLVLayout(const QString& lvPath, const LVLayout& layout)
+{
+    d_ptr->m_LVLayouts.insert(lvPath, layout);
+}
+
+/** Checks if a Logical Volume with the given layout fits into this Volume Group.
+ *
+ *  Uses the free extents of each Physical Volume as scanned, so Logical Volumes already
+ *  added to the preview are not counted twice. Only extents taken on a given Physical
+ *  Volume, see allocatePVExtents(), are deducted. Striped and RAID Logical Volumes need their
+ *  share of extents on distinct Physical Volumes.
+ *  Images of RAID levels with metadata need one extra extent for it.
+ *
+ *  @param layout segment type and geometry of the Logical Volume
+ *  @param extents size of the Logical Volume in extents
+ *  @return true if there are enough Physical Volumes with enough free extents
+ */
+bool LvmDevice::canAllocate(const LVLayout& layout, qint64 extents) const
+{
+    QVector<qint64> freeExtents;
+    for (const auto &p : physicalVolumes())
+        freeExtents.append(pvFreePE(*p));
+
+    if (layout.type == LVLayout::Type::Linear)
+        return extents <= std::accumulate(freeExtents.cbegin(), freeExtents.cend(), qint64(0));
+
+    const qint32 devices = layout.devices();
+    if (layout.stripes < 1 || layout.mirrors < 1 || devices > freeExtents.size())
+        return false;
+
+    const qint32 dataStripes = layout.type == LVLayout::Type::Raid1 ? 1 : layout.stripes;
+    const qint64 perDevice = (extents + dataStripes - 1) / dataStripes + (layout.hasMetadata() ? 1 : 0);
+
+    // every stripe or image has to go on a different physical volume
+    qint32 usable = 0;
+    for (const auto &free : std::as_const(freeExtents))
+        if (free >= perDevice)
+            usable++;
+
+    return usable >= devices;
+}
+
+/** Keeps the cache statistics of the Logical Volumes of this Volume Group.
+ *
+ *  @param status cache statistics of all Logical Volumes by device mapper name, see readCacheStatus()
+ */
+void LvmDevice::setCacheStatus(const QHash<QString, LVCacheStatus>& status)
+{
+    d_ptr->m_LVCacheStatus.clear();
+    for (const auto &lvPath : partitionNodes())
+        if (status.contains(deviceMapperName(lvPath)))
+            d_ptr->m_LVCacheStatus.insert(lvPath, status.value(deviceMapperName(lvPath)));
+}
+
+/** @return the cache statistics of the Logical Volume at lvPath as of the last scan */
+LvmDevice::LVCacheStatus LvmDevice::cacheStatus(const QString& lvPath) const
+{
+    return d_ptr->m_LVCacheStatus.value(lvPath);
+}
+
+/** @return the thin provisioning state of the Logical Volume at lvPath as of the last scan and the preview */
+LvmDevice::LVThinStatus LvmDevice::thinStatus(const QString& lvPath) const
+{
+    return d_ptr->m_ThinStatus.value(lvPath);
+}
+
+/** Sets the thin provisioning state of a Logical Volume that is about to be created.
+ *
+ *  @param lvPath the path of the new Logical Volume
+ *  @param status pool state of the new Logical Volume, a default LVThinStatus for none
+ */
+void LvmDevice::setThinStatus(const QString& lvPath, const LVThinStatus& status)
+{
+    d_ptr->m_ThinStatus.insert(lvPath, status);
+}
+
+/** @return the names of the thin pools in this Volume Group */
+QStringList LvmDevice::thinPools() const
+{
+    QStringList result;
+    for (auto it = d_ptr->m_ThinStatus.cbegin(); it != d_ptr->m_ThinStatus.cend(); ++it)
+        if (it.value().isPool)
+            result.append(it.key().section(QLatin1Char('/'), -1));
+
+    return result;
+}
+
+/** @return true if this Volume Group has a Logical Volume named lvName, including those in the preview */
+bool LvmDevice::containsLV(const QString& lvName) const
+{
+    const QString lvPath = deviceNode() + QLatin1Char('/') + lvName;
+    for (const auto &p : partitionTable()->children())
+        if (p->partitionPath() == lvPath)
+            return true;
+
+    return false;
+}
@@ -38,6 +38,102 @@ class LIBKPMCORE_EXPORT LvmDevice : public VolumeManagerDevice
 
     friend class VolumeManagerDevice;
 
+public:
+    /** Segment type and geometry of a Logical Volume. */
+    struct LVLayout
+    {
+        enum class Type {
+            Linear,
+            Striped,
+            Raid0,
+            Raid1,
+            Raid10,
+            Raid5
+        };
+
+        Type type = Type::Linear;
+        qint32 stripes = 1;     /**< number of data stripes for striped, raid0, raid10 and raid5 */
+        qint64 stripeSize = 0;  /**< stripe size in KiB, 0 for the LVM default */
+        qint32 mirrors = 1;     /**< number of additional copies for raid1 and raid10 */
+        qint64 regionSize = 0;  /**< RAID region size in KiB, 0 for the LVM default */
+
+        /** @return the number of physical volumes the Logical Volume is spread over */
+        qint32 devices() const {
+            switch (type) {
+            case Type::Linear:
+                return 1;
+            case Type::Striped:
+            case Type::Raid0:
+                return stripes;
+            case Type::Raid1:
+                return mirrors + 1;
+            case Type::Raid10:
+                return stripes * (mirrors + 1);
+            case Type::Raid5:
+                return stripes + 1;
+            }
+            return 1;
+        }
+
+        /** @return true if the Logical Volume is a RAID Logical Volume */
+        bool isRaid() const {
+            return type != Type::Linear && type != Type::Striped;
+        }
+
+        /** @return true if each image carries a RAID metadata subvolume, raid0 has none */
+        bool hasMetadata() const {
+            return isRaid() && type != Type::Raid0;
+        }
+    };
+
+    /** Fast-tier cache for a Logical Volume, kept on a chosen Physical Volume. */
+    struct LVCache
+    {
+        enum class Type {
+            Cache,      /**< dm-cache with a cache pool */
+            WriteCache  /**< dm-writecache with a cache volume */
+        };
+
+        enum class Mode {
+            WriteThrough,
+            WriteBack
+        };
+
+        Type type = Type::Cache;
+        Mode mode = Mode::WriteThrough; /**< only used by dm-cache, dm-writecache always writes back */
+        qint64 extents = 0;             /**< size of the cache in extents */
+        qint64 chunkSize = 0;           /**< dm-cache chunk size in KiB, 0 for the LVM default */
+    };
+
+    /** Statistics of a cache attached to a Logical Volume, as reported by the device mapper. */
+    struct LVCacheStatus
+    {
+        bool attached = false;
+        LVCache::Type type = LVCache::Type::Cache;
+        qint64 usedBlocks = 0;
+        qint64 totalBlocks = 0;
+        qint64 readHits = 0;
+        qint64 readMisses = 0;
+        qint64 writeHits = 0;
+        qint64 writeMisses = 0;
+        qint64 dirtyBlocks = -1;        /**< blocks not written back yet, -1 if the cache does not report them */
+    };
+
+    /** Kind of snapshot to create of a Logical Volume. */
+    enum class SnapshotType {
+        CopyOnWrite,    /**< classic snapshot with its own extents for the changed blocks */
+        Thin            /**< snapshot in the thin pool of a thin Logical Volume, needs no extents of its own */
+    };
+
+    /** Thin provisioning state of a Logical Volume. */
+    struct LVThinStatus
+    {
+        bool isPool = false;
+        QString pool;               /**< pool of a thin Logical Volume, empty for other Logical Volumes */
+        double dataPercent = 0;     /**< used data space of a thin pool or thin Logical Volume in percent */
+        double metadataPercent = 0; /**< used metadata space of a thin pool in percent */
+    };
+
 public:
     explicit LvmDevice(const QString& name, const QString& iconName = QString());
     ~LvmDevice() override;
@@ -65,8 +161,17 @@ public:
     static bool removeLV(Report& report, LvmDevice& d, Partition& p);
     static bool createLV(Report& report, LvmDevice& d, Partition& p, const QString& lvName);
     static bool createLVSnapshot(Report& report, Partition& p, const QString& name, const qint64 extents = 0);
+    static bool createLVSnapshot(Report& report, const Partition& p, const QString& name, SnapshotType type, const qint64 extents = 0);
+    static bool createThinPool(Report& report, LvmDevice& d, const QString& name, qint64 extents, qint64 metadataSize = 0, qint64 chunkSize = 0);
+    static bool createThinLV(Report& report, LvmDevice& d, const QString& pool, const QString& name, qint64 size);
+    static bool createThinSnapshot(Report& report, const Partition& origin, const QString& name);
+    static QHash<QString, LVThinStatus> readThinStatus(const QString& vgName);
     static bool resizeLV(Report& report, Partition& p);
     static bool deactivateLV(Report& report, const Partition& p);
+    static bool attachCache(Report& report, LvmDevice& d, const Partition& p, const Partition& fastPV, const LVCache& cache);
+    static bool detachCache(Report& report, const LvmDevice& d, const Partition& p);
+    static QHash<QString, LVCacheStatus> readCacheStatus();
+    static QString deviceMapperName(const QString& lvPath);
     static bool activateLV(const QString& deviceNode);
 
     static bool removePV(Report& report, LvmDevice& d, const QString& pvPath);
@@ -82,6 +187,7 @@ protected:
     void initPartitions() override;
     const QList<Partition*> scanPartitions(PartitionTable* pTable) const;
     Partition* scanPartition(const QString& lvPath, PartitionTable* pTable) const;
+    void setCacheStatus(const QHash<QString, LVCacheStatus>& status);
     qint64 mappedSector(const QString& lvPath, qint64 sector) const override;
 
 public:
@@ -90,10 +196,21 @@ public:
     qint64 allocatedPE() const;
     qint64 freePE() const;
     void setFreePE(qint64 freePE) const;
+    qint64 pvFreePE(const Partition& pv) const;
+    void allocatePVExtents(const Partition& pv, qint64 extents);
     QString UUID() const;
     QVector <const Partition*>& physicalVolumes();
     const QVector <const Partition*>& physicalVolumes() const;
 
+    LVLayout lvLayout(const QString& lvPath) const;
+    void setLVLayout(const QString& lvPath, const LVLayout& layout);
+    bool canAllocate(const LVLayout& layout, qint64 extents) const;
+    LVCacheStatus cacheStatus(const QString& lvPath) const;
+    LVThinStatus thinStatus(const QString& lvPath) const;
+    void setThinStatus(const QString& lvPath, const LVThinStatus& status);
+    QStringList thinPools() const;
+    bool containsLV(const QString& lvName) const;
+
 protected:
     std::unique_ptr<QHash<QString, qint64>>& LVSizeMap() const;
 
@@ -0,0 +1,204 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/mounttree.h"
+#include "core/partition.h"
+
+#include "util/report.h"
+
+#include <QDir>
+#include <QMutex>
+#include <QThread>
+#include <QWaitCondition>
+
+#include <KLocalizedString>
+
+#include <functional>
+#include <memory>
+#include <utility>
+#include <vector>
+
+/** @return true if mount point child lies below mount point parent */
+static bool isBelow(const QString& child, const QString& parent)
+{
+    if (parent == QStringLiteral("/"))
+        return child != parent && child.startsWith(parent);
+
+    return child.startsWith(parent + QLatin1Char('/'));
+}
+
+/** Creates a MountTree.
+    @param partitions the Partitions to mount or unmount, with their mount points set
+*/
+MountTree::MountTree(const QList<Partition*>& partitions) :
+    m_Partitions(partitions),
+    m_MaxParallel(8)
+{
+    QList<QString> mountPoints;
+    for (const auto &p : partitions)
+        mountPoints.append(QDir::cleanPath(p->mountPoint()));
+
+    // the parent is the Partition with the longest mount point above this one
+    for (int i = 0; i < partitions.size(); i++) {
+        qint32 parent = -1;
+        for (int j = 0; j < partitions.size(); j++) {
+            if (mountPoints[i].isEmpty() || mountPoints[j].isEmpty() || !isBelow(mountPoints[i], mountPoints[j]))
+                continue;
+            if (parent == -1 || mountPoints[j].length() > mountPoints[parent].length())
+                parent = j;
+        }
+        m_Parents.append(parent);
+        m_Duplicates.append(mountPoints[i].isEmpty() ? -1 : mountPoints.indexOf(mountPoints[i]));
+        if (m_Duplicates.last() == i)
+            m_Duplicates.last() = -1;
+    }
+}
+
+/** Mounts all Partitions, each one after the one it is mounted in.
+    @param report the Report to write information to
+    @return true if all Partitions were mounted
+*/
+bool MountTree::mount(Report& report)
+{
+    return run(report, true);
+}
+
+/** Unmounts all Partitions, each one after all those mounted in it.
+    @param report the Report to write information to
+    @return true if all Partitions were unmounted
+*/
+bool MountTree::unmount(Report& report)
+{
+    return run(report, false);
+}
+
+namespace
+{
+struct MountTask
+{
+    enum class State { Waiting, Running, Done, Failed };
+
+    State state = State::Waiting;
+    qint32 blockers = 0;
+    std::unique_ptr<QThread> thread;
+    Report report{nullptr};
+};
+}
+
+bool MountTree::run(Report& report, bool mounting)
+{
+    // Mounting waits for the parent, unmounting for all children
+    std::vector<MountTask> tasks(m_Partitions.size());
+    QList<QList<qint32>> dependents;
+    for (int i = 0; i < m_Partitions.size(); i++)
+        dependents.append({});
+
+    for (int i = 0; i < m_Partitions.size(); i++) {
+        const qint32 parent = m_Parents[i];
+        if (parent == -1)
+            continue;
+
+        if (mounting) {
+            tasks[i].blockers++;
+            dependents[parent].append(i);
+        } else {
+            tasks[parent].blockers++;
+            dependents[i].append(parent);
+        }
+    }
+
+    QMutex mutex;
+    QWaitCondition condition;
+    qint32 running = 0;
+    qint32 remaining = m_Partitions.size();
+    bool rval = true;
+
+    // a failed Partition takes everything depending on it down with it
+    std::function<void(qint32)> skipDependents = [&] (qint32 i) {
+        for (const auto &d : std::as_const(dependents[i])) {
+            if (tasks[d].state != MountTask::State::Waiting)
+                continue;
+
+            tasks[d].state = MountTask::State::Failed;
+            remaining--;
+            report.line() << (mounting ? xi18nc("@info:status", "Skipped mounting <filename>%1</filename> because <filename>%2</filename> could not be mounted.", m_Partitions[d]->deviceNode(), m_Partitions[i]->deviceNode())
+                                       : xi18nc("@info:status", "Skipped unmounting <filename>%1</filename> because <filename>%2</filename> could not be unmounted.", m_Partitions[d]->deviceNode(), m_Partitions[i]->deviceNode()));
+            skipDependents(d);
+        }
+    };
+
+    // two Partitions on the same mount point would hide each other
+    for (int i = 0; i < m_Partitions.size(); i++) {
+        if (m_Duplicates[i] == -1)
+            continue;
+
+        tasks[i].state = MountTask::State::Failed;
+        remaining--;
+        rval = false;
+        report.line() << xi18nc("@info:status", "<filename>%1</filename> and <filename>%2</filename> have the same mount point <filename>%3</filename>.", m_Partitions[m_Duplicates[i]]->deviceNode(), m_Partitions[i]->deviceNode(), m_Partitions[i]->mountPoint());
+        skipDependents(i);
+    }
+
+    while (remaining > 0) {
+        // start everything that is ready
+        for (int i = 0; i < m_Partitions.size() && running < m_MaxParallel; i++) {
+            MountTask& task = tasks[i];
+            if (task.state != MountTask::State::Waiting || task.blockers > 0)
+                continue;
+
+            Partition* p = m_Partitions[i];
+            task.state = MountTask::State::Running;
+            running++;
+
+            task.thread.reset(QThread::create([&task, p, mounting, &mutex, &condition] {
+                bool success;
+                if (mounting)
+                    success = p->isMounted() || p->mount(task.report);
+                else
+                    success = !p->isMounted() || p->unmount(task.report);
+
+                QMutexLocker locker(&mutex);
+                task.state = success ? MountTask::State::Done : MountTask::State::Failed;
+                condition.wakeAll();
+            }));
+            task.thread->start();
+        }
+
+        // wait for at least one to finish
+        QList<qint32> finished;
+        QMutexLocker locker(&mutex);
+        while (finished.isEmpty()) {
+            for (int i = 0; i < m_Partitions.size(); i++)
+                if (tasks[i].thread && tasks[i].state != MountTask::State::Running)
+                    finished.append(i);
+            if (finished.isEmpty())
+                condition.wait(&mutex);
+        }
+        locker.unlock();
+
+        for (const auto &i : std::as_const(finished)) {
+            MountTask& task = tasks[i];
+            task.thread->wait();
+            task.thread.reset();
+            running--;
+            remaining--;
+
+            report.takeChildren(task.report);
+
+            if (task.state == MountTask::State::Done) {
+                for (const auto &d : std::as_const(dependents[i]))
+                    tasks[d].blockers--;
+            } else {
+                rval = false;
+                report.line() << (mounting ? xi18nc("@info:status", "Mounting <filename>%1</filename> on <filename>%2</filename> failed.", m_Partitions[i]->deviceNode(), m_Partitions[i]->mountPoint())
+                                           : xi18nc("@info:status", "Unmounting <filename>%1</filename> failed.", m_Partitions[i]->deviceNode()));
+                skipDependents(i);
+            }
+        }
+    }
+
+    return rval;
+}
@@ -0,0 +1,64 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_MOUNTTREE_H
+#define KPMCORE_MOUNTTREE_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include <QList>
+#include <QtGlobal>
+
+class Partition;
+class Report;
+
+/** Mounts or unmounts many Partitions at once.
+
+    The Partitions are arranged in a tree by their mount points: a Partition whose mount point
+    lies below the mount point of another one is its child. Mounting goes parent first,
+    unmounting child first, and Partitions in independent subtrees are handled concurrently.
+    If a Partition fails, the Partitions depending on it are skipped. Everything, including
+    the failures, is reported in a single Report.
+
+    Partitions with the same mount point as an earlier one are errors and are neither mounted
+    nor unmounted.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT MountTree
+{
+public:
+    explicit MountTree(const QList<Partition*>& partitions);
+
+public:
+    bool mount(Report& report);
+    bool unmount(Report& report);
+
+    qint32 maxParallel() const {
+        return m_MaxParallel;    /**< @return the maximum number of Partitions handled at the same time */
+    }
+    void setMaxParallel(qint32 n) {
+        m_MaxParallel = n;    /**< @param n the maximum number of Partitions handled at the same time */
+    }
+
+    qint32 parent(qint32 index) const {
+        return m_Parents[index];    /**< @return the index of the Partition the given one is mounted in, -1 if none */
+    }
+    qint32 duplicate(qint32 index) const {
+        return m_Duplicates[index];    /**< @return the index of an earlier Partition with the same mount point, -1 if none */
+    }
+
+private:
+    bool run(Report& report, bool mounting);
+
+private:
+    QList<Partition*> m_Partitions;
+    QList<qint32> m_Parents;
+    QList<qint32> m_Duplicates;
+    qint32 m_MaxParallel;
+};
+
+#endif
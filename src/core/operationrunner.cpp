@@ -7,13 +7,101 @@
 */
 
 #include "core/operationrunner.h"
+
+#include "backend/corebackend.h"
+#include "backend/corebackendmanager.h"
+#include "backend/corebackendpartitiontable.h"
+
+#include "core/device.h"
 #include "core/operationstack.h"
+#include "core/partition.h"
+#include "core/planjournal.h"
+#include "jobs/createpartitionjob.h"
 #include "ops/operation.h"
 #include "util/report.h"
 
 #include <QDBusInterface>
 #include <QDBusReply>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
 #include <QMutex>
+#include <QStringList>
+#include <QWaitCondition>
+
+#include <KLocalizedString>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace
+{
+/** An Operation running in a thread of its own */
+struct ConcurrentOperation
+{
+    qint32 index = 0;
+    Operation* op = nullptr;
+    QList<Device*> attached;
+    std::unique_ptr<QThread> thread;
+    Report report{nullptr};
+    bool partitionCreated = false;
+    bool finished = false;
+    bool status = false;
+};
+}
+
+/** @return the paths of the devices an Operation works on concurrently with others, sorted */
+static QStringList devicePaths(const Operation* op)
+{
+    QStringList paths;
+    for (const auto &p : op->concurrentPartitions())
+        paths.append(p->devicePath());
+
+    paths.sort();
+    paths.removeDuplicates();
+
+    return paths;
+}
+
+/** @return true if the device node is a rotational device, which is assumed if unknown */
+static bool isRotational(const QString& deviceNode)
+{
+    const QString name = QFileInfo(QFileInfo(deviceNode).canonicalFilePath()).fileName();
+
+    QFile file(QStringLiteral("/sys/class/block/%1/queue/rotational").arg(name));
+    if (name.isEmpty() || !file.open(QIODevice::ReadOnly))
+        return true;
+
+    return file.readAll().trimmed() != "0";
+}
+
+/** Checks if two Operations may run at the same time.
+    @param a the Partitions the first Operation works on
+    @param b the Partitions the second Operation works on
+    @param rotational cache of which devices are rotational, by device path, filled in as needed
+    @return true if the Partitions overlap or share a rotational device
+*/
+bool OperationRunner::conflicts(const QList<const Partition*>& a, const QList<const Partition*>& b, QHash<QString, bool>& rotational)
+{
+    for (const auto &p : a) {
+        for (const auto &q : b) {
+            if (p->devicePath() != q->devicePath())
+                continue;
+
+            if (p->firstSector() <= q->lastSector() && q->firstSector() <= p->lastSector())
+                return true;
+
+            // seeking between partitions would make both slower than running them one after the other
+            if (!rotational.contains(p->devicePath()))
+                rotational.insert(p->devicePath(), isRotational(p->devicePath()));
+            if (rotational.value(p->devicePath()))
+                return true;
+        }
+    }
+
+    return false;
+}
 
 /** Constructs an OperationRunner.
     @param ostack the OperationStack to act on
@@ -22,12 +110,18 @@ OperationRunner::OperationRunner(QObject* parent, OperationStack& ostack) :
     QThread(parent),
     m_OperationStack(ostack),
     m_Report(nullptr),
+    m_Journal(nullptr),
     m_SuspendMutex(),
     m_Cancelling(false)
 {
 }
 
-/** Runs the operations in the OperationStack. */
+/** Runs the operations in the OperationStack.
+
+    The Operations are expected to be undone, each one is previewed again after it has run.
+    With a PlanJournal set, the plan is written to it before the first Operation starts and
+    it is updated whenever one starts or finishes.
+*/
 void OperationRunner::run()
 {
     Q_ASSERT(m_Report);
@@ -48,6 +142,101 @@ void OperationRunner::run()
     if (automounter)
         kdedInterface.call( QStringLiteral("unloadModule"), automounterService );
 
+    // Without a journal an interruption could not be resumed, better not start at all
+    if (m_Journal && !m_Journal->begin(operationStack())) {
+        report().line() << xi18nc("@info:status", "Could not write the plan journal <filename>%1</filename>.", m_Journal->path());
+        status = false;
+    }
+
+    auto journal = [this] (qint32 index, PlanJournal::Status s) {
+        if (m_Journal && !m_Journal->setStatus(index, s))
+            report().line() << xi18nc("@info:status", "<warning>Could not update the plan journal <filename>%1</filename>.</warning>", m_Journal->path());
+    };
+
+    // The backend may have to make the device nodes of partitions available while an Operation
+    // runs tools on them, e.g. attach an image file to a loop device
+    auto attachDevices = [this] (Operation* op) {
+        QList<Device*> attached;
+        const auto &jobs = op->jobs();
+        if (std::none_of(jobs.begin(), jobs.end(), [] (Job* job) { return job->needsPartitionNodes(); }))
+            return attached;
+
+        for (const auto &d : operationStack().previewDevices()) {
+            if (!op->targets(*d))
+                continue;
+
+            if (CoreBackendManager::self()->backend()->attachDevice(*d))
+                attached.append(d);
+            else
+                report().line() << xi18nc("@info:status", "<warning>Could not make the partitions of <filename>%1</filename> available.</warning>", d->deviceNode());
+        }
+
+        return attached;
+    };
+
+    auto detachDevices = [] (const QList<Device*>& attached) {
+        for (const auto &d : attached)
+            CoreBackendManager::self()->backend()->detachDevice(*d);
+    };
+
+    // Operations that only work on the contents of partitions run concurrently with others as
+    // long as their partitions do not overlap and are not on the same rotational device. Changes
+    // to a partition table are still serialized by CoreBackendPartitionTable, which also waits
+    // for the other Operations on the device to finish their work on the partitions' contents.
+    std::vector<std::unique_ptr<ConcurrentOperation>> running;
+    std::vector<std::unique_ptr<ConcurrentOperation>> unpreviewed;
+    QHash<QString, bool> rotational;
+    QMutex mutex;
+    QWaitCondition condition;
+
+    // waits for at least one concurrent Operation to finish and collects all finished ones
+    auto collectFinished = [&] {
+        QMutexLocker locker(&mutex);
+        while (std::none_of(running.begin(), running.end(), [] (const auto &c) { return c->finished; }))
+            condition.wait(&mutex);
+        locker.unlock();
+
+        for (auto it = running.begin(); it != running.end();) {
+            ConcurrentOperation& c = **it;
+            if (!c.finished) {
+                ++it;
+                continue;
+            }
+
+            c.thread->wait();
+            detachDevices(c.attached);
+            report().takeChildren(c.report);
+            status = status && c.status;
+            journal(c.index - 1, c.status ? PlanJournal::Status::Done : PlanJournal::Status::Failed);
+
+            unpreviewed.push_back(std::move(*it));
+            it = running.erase(it);
+        }
+
+        // Previewing changes the partition table of a device in the model, which Operations still
+        // running on that device work with. The preview waits until they are done, and previews
+        // of Operations on the same device are done in stack order.
+        std::sort(unpreviewed.begin(), unpreviewed.end(), [] (const auto &a, const auto &b) { return a->index < b->index; });
+
+        for (auto it = unpreviewed.begin(); it != unpreviewed.end();) {
+            ConcurrentOperation& c = **it;
+            const QStringList paths = devicePaths(c.op);
+            if (std::any_of(running.begin(), running.end(), [&paths] (const auto &r) {
+                    const QStringList runningPaths = devicePaths(r->op);
+                    return std::any_of(runningPaths.begin(), runningPaths.end(), [&paths] (const QString& path) { return paths.contains(path); }); })) {
+                ++it;
+                continue;
+            }
+
+            c.op->preview();
+
+            disconnect(c.op, &Operation::progress, this, &OperationRunner::progressSub);
+
+            Q_EMIT opFinished(c.index, c.op);
+            it = unpreviewed.erase(it);
+        }
+    };
+
     for (int i = 0; i < numOperations(); i++) {
         suspendMutex().lock();
         suspendMutex().unlock();
@@ -57,23 +246,91 @@ void OperationRunner::run()
         }
 
         Operation* op = operationStack().operations()[i];
+        const QList<const Partition*> partitions = op->concurrentPartitions();
+
+        while (!running.empty() && (partitions.isEmpty() || std::any_of(running.begin(), running.end(), [&] (const auto &c) {
+                   return conflicts(partitions, c->op->concurrentPartitions(), rotational); })))
+            collectFinished();
+
+        if (!status || isCancelling()) {
+            break;
+        }
+
         op->setStatus(Operation::StatusRunning);
+        journal(i, PlanJournal::Status::Running);
 
         Q_EMIT opStarted(i + 1, op);
 
         connect(op, &Operation::progress, this, &OperationRunner::progressSub);
 
-        status = op->execute(report());
-        op->preview();
+        if (partitions.isEmpty()) {
+            const QList<Device*> attached = attachDevices(op);
+            status = op->execute(report());
+            detachDevices(attached);
+            op->preview();
+            journal(i, status ? PlanJournal::Status::Done : PlanJournal::Status::Failed);
+
+            disconnect(op, &Operation::progress, this, &OperationRunner::progressSub);
+
+            Q_EMIT opFinished(i + 1, op);
+            continue;
+        }
+
+        auto concurrent = std::make_unique<ConcurrentOperation>();
+        ConcurrentOperation* c = concurrent.get();
+        c->index = i + 1;
+        c->op = op;
+        c->attached = attachDevices(op);
+
+        // Partitions get their numbers in the order they are created, so the next Operation
+        // only starts once this one has created its partition
+        const auto &jobs = op->jobs();
+        const auto createJob = std::find_if(jobs.begin(), jobs.end(), [] (Job* job) { return dynamic_cast<CreatePartitionJob*>(job) != nullptr; });
+        c->partitionCreated = createJob == jobs.end();
+        if (!c->partitionCreated)
+            connect(*createJob, &Job::finished, this, [c, &mutex, &condition] {
+                QMutexLocker locker(&mutex);
+                c->partitionCreated = true;
+                condition.wakeAll();
+            }, Qt::DirectConnection);
+
+        c->thread.reset(QThread::create([c, &mutex, &condition] {
+            bool rval;
+            {
+                std::vector<std::unique_ptr<CoreBackendPartitionTable::ContentLocker>> locks;
+                for (const auto &path : devicePaths(c->op))
+                    locks.push_back(std::make_unique<CoreBackendPartitionTable::ContentLocker>(path));
 
-        disconnect(op, &Operation::progress, this, &OperationRunner::progressSub);
+                rval = c->op->execute(c->report);
+            }
 
-        Q_EMIT opFinished(i + 1, op);
+            QMutexLocker locker(&mutex);
+            c->status = rval;
+            c->finished = true;
+            condition.wakeAll();
+        }));
+        running.push_back(std::move(concurrent));
+        c->thread->start();
+
+        QMutexLocker locker(&mutex);
+        while (!c->partitionCreated && !c->finished)
+            condition.wait(&mutex);
+        locker.unlock();
+
+        if (createJob != jobs.end())
+            disconnect(*createJob, &Job::finished, this, nullptr);
     }
 
+    while (!running.empty())
+        collectFinished();
+
     if (automounter)
         kdedInterface.call( QStringLiteral("loadModule"), automounterService );
 
+    // A cancelled or failed run keeps its journal, it can be resumed later
+    if (m_Journal && status && !isCancelling())
+        m_Journal->finish();
+
     if (!status)
         Q_EMIT error();
     else if (isCancelling())
@@ -11,18 +11,30 @@
 
 #include "util/libpartitionmanagerexport.h"
 
+#include <QHash>
+#include <QList>
 #include <QThread>
 #include <QMutex>
 #include <QtGlobal>
 
 class Operation;
 class OperationStack;
+class Partition;
+class PlanJournal;
 class Report;
 
 /** Thread to run the Operations in the OperationStack.
 
     Runs the OperationStack when the user applies operations.
 
+    Operations returning Partitions from Operation::concurrentPartitions() may run at the same
+    time as others. opStarted() and opFinished() are then emitted for several Operations in
+    between each other and in the order the Operations start and finish, not in stack order.
+    An Operation is previewed again and opFinished() emitted only once no other Operation on
+    the same Device is running, because previewing changes the Device's PartitionTable.
+    progressSub() is emitted for all running Operations alike, use Operation::progress() to
+    follow a single one.
+
     @author Volker Lanz <vl@fidra.de>
 */
 class LIBKPMCORE_EXPORT OperationRunner : public QThread
@@ -48,9 +60,14 @@ public:
         return m_SuspendMutex;    /**< @return the QMutex used for syncing */
     }
     QString description(qint32 op) const;
+
+    static bool conflicts(const QList<const Partition*>& a, const QList<const Partition*>& b, QHash<QString, bool>& rotational);
     void setReport(Report* report) {
         m_Report = report;    /**< @param report the Report to use while running */
     }
+    void setJournal(PlanJournal* journal) {
+        m_Journal = journal;    /**< @param journal the PlanJournal to record progress in, nullptr for none */
+    }
 
 Q_SIGNALS:
     void progressSub(int);
@@ -78,6 +95,7 @@ protected:
 private:
     OperationStack& m_OperationStack;
     Report* m_Report;
+    PlanJournal* m_Journal;
     mutable QMutex m_SuspendMutex;
     mutable volatile bool m_Cancelling;
 };
@@ -165,7 +165,8 @@ bool OperationStack::mergeNewOperation(Operation*& currentOp, Operation*& pushed
     }
 
     // -- 5 --
-    if (pushedCreateFileSystemOp && &newOp->newPartition() == &pushedCreateFileSystemOp->partition()) {
+    // the NewOperation cannot put the journal on another partition, so keep the CreateFileSystemOperation then
+    if (pushedCreateFileSystemOp && &newOp->newPartition() == &pushedCreateFileSystemOp->partition() && pushedCreateFileSystemOp->journal() == nullptr) {
         Log() << xi18nc("@info:status", "Changing file system for a new partition: No new operation required.");
 
         FileSystem* oldFs = &newOp->newPartition().fileSystem();
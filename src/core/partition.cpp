@@ -284,6 +284,10 @@ bool Partition::canMount() const
         return false;
     }
 
+    // the external journal or log of another file system is never mounted on its own
+    if (!fileSystem().journalOwner().isEmpty())
+        return false;
+
     if (fileSystem().canMount(deviceNode(), mountPoint())) {
         return true;
     }
@@ -294,7 +298,7 @@ bool Partition::canMount() const
 /** @return true if this Partition can be unmounted */
 bool Partition::canUnmount() const
 {
-    return !roles().has(PartitionRole::Extended) && isMounted() && fileSystem().canUnmount(deviceNode());
+    return !roles().has(PartitionRole::Extended) && isMounted() && fileSystem().journalOwner().isEmpty() && fileSystem().canUnmount(deviceNode());
 }
 
 void Partition::setMounted(bool b) {
@@ -457,6 +457,15 @@ qint64 PartitionTable::defaultLastUsable(const Device& d, TableType t)
     return d.totalLogical() - 1;
 }
 
+/** @param deviceNode the device node of a disk, e.g. /dev/sda or /dev/nvme0n1
+    @param number the number of a partition on it
+    @return the device node of the partition, following the kernel's naming, e.g. /dev/sda1 or /dev/nvme0n1p1
+*/
+QString PartitionTable::partitionPath(const QString& deviceNode, qint32 number)
+{
+    return deviceNode + (deviceNode.back().isDigit() ? QStringLiteral("p") : QString()) + QString::number(number);
+}
+
 static struct {
     const QLatin1String name; /**< name of partition table type */
     quint32 maxPrimaries; /**< max numbers of primary partitions supported */
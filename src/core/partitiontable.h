@@ -187,6 +187,7 @@ public:
 
     static qint64 defaultFirstUsable(const Device& d, TableType t);
     static qint64 defaultLastUsable(const Device& d, TableType t);
+    static QString partitionPath(const QString& deviceNode, qint32 number);
 
     static PartitionTable::TableType nameToTableType(const QString& n);
     static QString tableTypeToName(TableType l);
@@ -0,0 +1,454 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "core/planjournal.h"
+#include "core/device.h"
+#include "core/operationstack.h"
+#include "core/partition.h"
+#include "core/partitiontable.h"
+
+#include "ops/operation.h"
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSaveFile>
+#include <QSet>
+#include <QStandardPaths>
+
+#include <KLocalizedString>
+
+#include <algorithm>
+
+static const QStringList journalLanguages = { QStringLiteral("en_US") };
+
+static QString statusName(PlanJournal::Status status)
+{
+    switch (status) {
+    case PlanJournal::Status::Running:
+        return QStringLiteral("running");
+    case PlanJournal::Status::Done:
+        return QStringLiteral("done");
+    case PlanJournal::Status::Failed:
+        return QStringLiteral("failed");
+    case PlanJournal::Status::Pending:
+        break;
+    }
+
+    return QStringLiteral("pending");
+}
+
+static PlanJournal::Status statusForName(const QString& name)
+{
+    if (name == QStringLiteral("running"))
+        return PlanJournal::Status::Running;
+    if (name == QStringLiteral("done"))
+        return PlanJournal::Status::Done;
+    if (name == QStringLiteral("failed"))
+        return PlanJournal::Status::Failed;
+
+    return PlanJournal::Status::Pending;
+}
+
+static QJsonArray targetsToJson(const QList<PlanJournal::Target>& targets)
+{
+    QJsonArray result;
+
+    for (const auto &t : targets) {
+        QJsonObject target = {
+            { QStringLiteral("device"), t.device },
+            { QStringLiteral("first"), t.firstSector },
+            { QStringLiteral("last"), t.lastSector },
+            { QStringLiteral("fs"), FileSystem::nameForType(t.type, journalLanguages) } };
+        if (!t.uuid.isEmpty())
+            target.insert(QStringLiteral("uuid"), t.uuid);
+        result.append(target);
+    }
+
+    return result;
+}
+
+static QList<PlanJournal::Target> targetsFromJson(const QJsonArray& array)
+{
+    QList<PlanJournal::Target> result;
+
+    for (const auto &value : array) {
+        const QJsonObject target = value.toObject();
+
+        PlanJournal::Target t;
+        t.device = target.value(QStringLiteral("device")).toString();
+        t.firstSector = target.value(QStringLiteral("first")).toVariant().toLongLong();
+        t.lastSector = target.value(QStringLiteral("last")).toVariant().toLongLong();
+        t.type = FileSystem::typeForName(target.value(QStringLiteral("fs")).toString(), journalLanguages);
+        t.uuid = target.value(QStringLiteral("uuid")).toString();
+        result.append(t);
+    }
+
+    return result;
+}
+
+/** @return true if both identify the same Partition or Device, whatever is on it */
+static bool sameLocation(const PlanJournal::Target& a, const PlanJournal::Target& b)
+{
+    return a.device == b.device && a.firstSector == b.firstSector && a.lastSector == b.lastSector;
+}
+
+/** @return true if both describe the same Partition with the same FileSystem on it */
+static bool sameTarget(const PlanJournal::Target& a, const PlanJournal::Target& b)
+{
+    return sameLocation(a, b) && a.type == b.type && a.uuid == b.uuid;
+}
+
+/** @return the targets in @p targets that are not in @p other, compared with @p equal */
+static QList<PlanJournal::Target> subtract(const QList<PlanJournal::Target>& targets, const QList<PlanJournal::Target>& other,
+                                           bool (*equal)(const PlanJournal::Target&, const PlanJournal::Target&) = sameLocation)
+{
+    QList<PlanJournal::Target> result;
+
+    for (const auto &t : targets)
+        if (std::none_of(other.begin(), other.end(), [&t, equal] (const PlanJournal::Target& o) { return equal(t, o); }))
+            result.append(t);
+
+    return result;
+}
+
+/** @return the devices the Entry touches */
+static QSet<QString> entryDevices(const PlanJournal::Entry& e)
+{
+    QSet<QString> result;
+
+    for (const auto &device : e.devices)
+        result.insert(device);
+
+    return result;
+}
+
+static const Partition* findPartition(const PartitionNode* parent, qint64 firstSector, qint64 lastSector)
+{
+    if (parent == nullptr)
+        return nullptr;
+
+    for (const auto &p : parent->children()) {
+        if (p->firstSector() == firstSector && p->lastSector() == lastSector && !p->roles().has(PartitionRole::Unallocated))
+            return p;
+
+        if (const Partition* child = findPartition(p, firstSector, lastSector))
+            return child;
+    }
+
+    return nullptr;
+}
+
+static const Device* findDevice(const QList<Device*>& devices, const QString& deviceNode)
+{
+    for (const auto &d : devices)
+        if (d->deviceNode() == deviceNode)
+            return d;
+
+    return nullptr;
+}
+
+static void snapshotNode(const Device& d, const PartitionNode* parent, QList<PlanJournal::Target>& result)
+{
+    if (parent == nullptr)
+        return;
+
+    for (const auto &p : parent->children()) {
+        if (!p->roles().has(PartitionRole::Unallocated)) {
+            PlanJournal::Target t;
+            t.device = d.deviceNode();
+            t.firstSector = p->firstSector();
+            t.lastSector = p->lastSector();
+            t.type = p->fileSystem().type();
+            t.uuid = p->fileSystem().uuid();
+            result.append(t);
+        }
+
+        snapshotNode(d, p, result);
+    }
+}
+
+/** @return all Partitions on the Devices */
+static QList<PlanJournal::Target> snapshot(const QList<Device*>& devices)
+{
+    QList<PlanJournal::Target> result;
+
+    for (const auto &d : devices)
+        snapshotNode(*d, d->partitionTable(), result);
+
+    return result;
+}
+
+/** Creates a PlanJournal.
+    @param path the file to keep the journal in
+*/
+PlanJournal::PlanJournal(const QString& path) :
+    m_Path(path)
+{
+}
+
+/** @return the journal file used if none is given */
+QString PlanJournal::defaultPath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QStringLiteral("/plan-journal.json");
+}
+
+/** Reads the journal left by an earlier run.
+    @return true if there is a journal
+*/
+bool PlanJournal::load()
+{
+    m_Entries.clear();
+    m_Errors.clear();
+
+    QFile file(path());
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    const QJsonObject journal = QJsonDocument::fromJson(file.readAll()).object();
+    if (journal.value(QStringLiteral("version")).toInt() != 1)
+        return false;
+
+    m_PlanId = journal.value(QStringLiteral("plan")).toString();
+
+    for (const auto &value : journal.value(QStringLiteral("operations")).toArray()) {
+        const QJsonObject op = value.toObject();
+
+        Entry e;
+        e.description = op.value(QStringLiteral("description")).toString();
+        e.status = statusForName(op.value(QStringLiteral("status")).toString());
+        e.before = targetsFromJson(op.value(QStringLiteral("before")).toArray());
+        e.after = targetsFromJson(op.value(QStringLiteral("after")).toArray());
+        for (const auto &device : op.value(QStringLiteral("devices")).toArray())
+            e.devices.append(device.toString());
+        m_Entries.append(e);
+    }
+
+    return true;
+}
+
+/** Records the Operations about to be run and writes the journal.
+
+    The Operations must not be previewed, like when they are handed to the OperationRunner.
+    Each one is previewed in turn and the Partitions before and after are compared to find
+    out what it removes and what it creates. All Operations are undone again afterwards.
+
+    @param ostack the OperationStack about to be run
+    @return true if the journal was written
+*/
+bool PlanJournal::begin(OperationStack& ostack)
+{
+    m_Entries.clear();
+    m_Errors.clear();
+
+    const auto &ops = ostack.operations();
+
+    QList<Target> current = snapshot(ostack.previewDevices());
+
+    for (const auto &op : ops) {
+        Entry e;
+        e.description = op->description();
+
+        op->preview();
+        const QList<Target> next = snapshot(ostack.previewDevices());
+
+        // A new partition only shows up in after, a deleted one only in before and a
+        // resized or formatted one in both
+        e.before = subtract(current, next, sameTarget);
+        e.after = subtract(next, current, sameTarget);
+
+        for (const auto &d : ostack.previewDevices())
+            if (op->targets(*d))
+                e.devices.append(d->deviceNode());
+        for (const auto &t : e.before + e.after)
+            if (!e.devices.contains(t.device))
+                e.devices.append(t.device);
+
+        m_Entries.append(e);
+        current = next;
+    }
+
+    for (auto it = ops.rbegin(); it != ops.rend(); ++it)
+        (*it)->undo();
+
+    return write();
+}
+
+/** Updates the status of an Operation and writes the journal.
+    @param index the index of the Operation in the OperationStack
+    @param status the new status
+    @return true if the journal was written
+*/
+bool PlanJournal::setStatus(qint32 index, Status status)
+{
+    Q_ASSERT(index >= 0 && index < m_Entries.size());
+
+    m_Entries[index].status = status;
+    return write();
+}
+
+/** Removes the journal after all Operations have succeeded.
+    @return true if there is no journal left
+*/
+bool PlanJournal::finish()
+{
+    m_Entries.clear();
+
+    return !QFile::exists(path()) || QFile::remove(path());
+}
+
+/** Checks a loaded journal against freshly scanned Devices.
+
+    Operations that were running are marked done or pending depending on what was found.
+    Only the last done Operation and the first remaining one on each device can be verified,
+    the others are covered by them.
+
+    @param devices the scanned Devices
+    @return true if the Devices are in a state the remaining Operations can be run from
+*/
+bool PlanJournal::validate(const QList<Device*>& devices)
+{
+    m_Errors.clear();
+
+    auto devicesFound = [&] (const Entry& e) {
+        return std::all_of(e.devices.begin(), e.devices.end(), [&] (const QString& node) { return findDevice(devices, node) != nullptr; });
+    };
+
+    // done means everything is as it should be afterwards and what it replaced is gone, untouched the other way round
+    auto isDone = [&] (const Entry& e) {
+        return devicesFound(e) && matches(e.after, devices) && !present(subtract(e.before, e.after), devices);
+    };
+    auto isUntouched = [&] (const Entry& e) {
+        return devicesFound(e) && matches(e.before, devices) && !present(subtract(e.after, e.before), devices);
+    };
+
+    for (auto &e : m_Entries) {
+        if (e.status != Status::Running && e.status != Status::Failed)
+            continue;
+
+        // Operations that leave their targets looking the same, like checks, are simply run again
+        if (isUntouched(e))
+            e.status = Status::Pending;
+        else if (isDone(e))
+            e.status = Status::Done;
+        else
+            m_Errors.append(xi18nc("@info:status", "Operation \"%1\" was interrupted and left its targets in an unknown state.", e.description));
+    }
+
+    QSet<QString> later;
+    for (auto it = m_Entries.crbegin(); it != m_Entries.crend(); ++it) {
+        if (it->status != Status::Done)
+            continue;
+
+        const QSet<QString> touched = entryDevices(*it);
+        if (!touched.intersects(later) && !isDone(*it))
+            m_Errors.append(xi18nc("@info:status", "Operation \"%1\" was completed, but its result cannot be found.", it->description));
+        later.unite(touched);
+    }
+
+    QSet<QString> earlier;
+    for (const auto &e : std::as_const(m_Entries)) {
+        if (e.status == Status::Done)
+            continue;
+
+        const QSet<QString> touched = entryDevices(e);
+        if (!touched.intersects(earlier) && !isUntouched(e))
+            m_Errors.append(xi18nc("@info:status", "The targets of operation \"%1\" have changed since it was planned.", e.description));
+        earlier.unite(touched);
+    }
+
+    return m_Errors.isEmpty();
+}
+
+/** @return the indices of the Operations that are done */
+QList<qint32> PlanJournal::completed() const
+{
+    QList<qint32> result;
+
+    for (qint32 i = 0; i < m_Entries.size(); i++)
+        if (m_Entries[i].status == Status::Done)
+            result.append(i);
+
+    return result;
+}
+
+/** @return the indices of the Operations that still have to be run */
+QList<qint32> PlanJournal::remaining() const
+{
+    QList<qint32> result;
+
+    for (qint32 i = 0; i < m_Entries.size(); i++)
+        if (m_Entries[i].status != Status::Done)
+            result.append(i);
+
+    return result;
+}
+
+bool PlanJournal::write() const
+{
+    QJsonArray operations;
+    for (const auto &e : m_Entries)
+        operations.append(QJsonObject{
+            { QStringLiteral("description"), e.description },
+            { QStringLiteral("status"), statusName(e.status) },
+            { QStringLiteral("before"), targetsToJson(e.before) },
+            { QStringLiteral("after"), targetsToJson(e.after) },
+            { QStringLiteral("devices"), QJsonArray::fromStringList(e.devices) } });
+
+    const QJsonObject journal = {
+        { QStringLiteral("version"), 1 },
+        { QStringLiteral("plan"), planId() },
+        { QStringLiteral("updated"), QDateTime::currentDateTimeUtc().toString(Qt::ISODate) },
+        { QStringLiteral("operations"), operations } };
+
+    QDir().mkpath(QFileInfo(path()).absolutePath());
+
+    // QSaveFile syncs and renames, a crash leaves either the old or the new journal behind
+    QSaveFile file(path());
+    if (!file.open(QIODevice::WriteOnly))
+        return false;
+
+    file.write(QJsonDocument(journal).toJson(QJsonDocument::Compact));
+    return file.commit();
+}
+
+/** @return true if all targets are found in the Devices as recorded */
+bool PlanJournal::matches(const QList<Target>& targets, const QList<Device*>& devices) const
+{
+    for (const auto &t : targets) {
+        const Device* d = findDevice(devices, t.device);
+        if (d == nullptr)
+            return false;
+
+        const Partition* p = findPartition(d->partitionTable(), t.firstSector, t.lastSector);
+        if (p == nullptr)
+            return false;
+
+        const FileSystem& fs = p->fileSystem();
+        if (t.type != FileSystem::Type::Unknown && t.type != FileSystem::Type::Unformatted && fs.type() != t.type)
+            return false;
+        if (!t.uuid.isEmpty() && !fs.uuid().isEmpty() && fs.uuid() != t.uuid)
+            return false;
+    }
+
+    return true;
+}
+
+/** @return true if any of the targets is found in the Devices, whatever is on it now */
+bool PlanJournal::present(const QList<Target>& targets, const QList<Device*>& devices) const
+{
+    for (const auto &t : targets) {
+        const Device* d = findDevice(devices, t.device);
+        if (d != nullptr && findPartition(d->partitionTable(), t.firstSector, t.lastSector) != nullptr)
+            return true;
+    }
+
+    return false;
+}
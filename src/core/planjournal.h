@@ -0,0 +1,109 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_PLANJOURNAL_H
+#define KPMCORE_PLANJOURNAL_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "fs/filesystem.h"
+
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QtGlobal>
+
+class Device;
+class OperationStack;
+
+/** A file recording the progress of an OperationRunner.
+
+    Before the first Operation runs, the journal records every Operation with the Partitions it
+    removes and the ones it creates, identified by device, sectors, file system type and UUID.
+    A resized or formatted Partition counts as both, a new one is only created and a deleted
+    one only removed. While running, the status of each Operation is updated. The journal is
+    written atomically after every change and removed once all Operations have succeeded.
+
+    If the run is interrupted, a later process loads the journal and validates it against a
+    fresh scan. An Operation that was running is considered done if what it creates is there
+    and what it removes is gone, and remaining if it is the other way round. Anything else, or
+    done Operations whose targets cannot be found, makes the journal invalid. The remaining
+    Operations can then be planned again and run.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT PlanJournal
+{
+public:
+    enum class Status {
+        Pending,
+        Running,
+        Done,
+        Failed
+    };
+
+    /** A Partition removed or created by an Operation */
+    struct Target {
+        QString device;
+        qint64 firstSector = 0;
+        qint64 lastSector = 0;
+        FileSystem::Type type = FileSystem::Type::Unknown;
+        QString uuid;
+    };
+
+    /** An Operation in the journal */
+    struct Entry {
+        QString description;
+        Status status = Status::Pending;
+        QList<Target> before;
+        QList<Target> after;
+        QStringList devices;
+    };
+
+public:
+    explicit PlanJournal(const QString& path = defaultPath());
+
+public:
+    bool load();
+    bool begin(OperationStack& ostack);
+    bool setStatus(qint32 index, Status status);
+    bool finish();
+    bool validate(const QList<Device*>& devices);
+
+    QList<qint32> completed() const;
+    QList<qint32> remaining() const;
+
+    const QString& path() const {
+        return m_Path;    /**< @return the path of the journal file */
+    }
+    const QString& planId() const {
+        return m_PlanId;    /**< @return the client's identification of the plan, may be empty */
+    }
+    void setPlanId(const QString& id) {
+        m_PlanId = id;    /**< @param id identifies the plan, so a later run can tell if the journal belongs to it */
+    }
+    const QList<Entry>& entries() const {
+        return m_Entries;    /**< @return the Operations in the journal */
+    }
+    const QStringList& errors() const {
+        return m_Errors;    /**< @return why validation failed */
+    }
+
+    static QString defaultPath();
+
+private:
+    bool write() const;
+    bool matches(const QList<Target>& targets, const QList<Device*>& devices) const;
+    bool present(const QList<Target>& targets, const QList<Device*>& devices) const;
+
+private:
+    QString m_Path;
+    QString m_PlanId;
+    QList<Entry> m_Entries;
+    QStringList m_Errors;
+};
+
+#endif
@@ -13,11 +13,13 @@
 #include "fs/filesystem.h"
 #include "fs/filesystemfactory.h"
 #include "util/externalcommand.h"
+#include "util/report.h"
 
 #include <utility>
 
 #include <KLocalizedString>
 #include <QFile>
+#include <QFileInfo>
 #include <QRegularExpression>
 
 #define d_ptr std::static_pointer_cast<SoftwareRAIDPrivate>(d)
@@ -31,8 +33,10 @@ public:
     qint64 m_arraySize;
     QString m_UUID;
     QStringList m_devicePathList;
+    QStringList m_activeDevicePathList;
     QStringList m_partitionPathList;
     SoftwareRAID::Status m_status;
+    SoftwareRAID::SyncStatus m_syncStatus;
 };
 
 SoftwareRAID::SoftwareRAID(const QString& name, SoftwareRAID::Status status, const QString& iconName)
@@ -50,7 +54,9 @@ SoftwareRAID::SoftwareRAID(const QString& name, SoftwareRAID::Status status, con
     d_ptr->m_arraySize = getArraySize(deviceNode());
     d_ptr->m_UUID = getUUID(deviceNode());
     d_ptr->m_devicePathList = getDevicePathList(deviceNode());
+    d_ptr->m_activeDevicePathList = getActiveDevicePathList(deviceNode());
     d_ptr->m_status = status;
+    d_ptr->m_syncStatus = readSyncStatus(deviceNode());
 
     initPartitions();
 }
@@ -71,18 +77,112 @@ qint64 SoftwareRAID::partitionSize(QString &partitionPath) const
     return 0;
 }
 
+/** Adds devices to the array and reshapes it to use them.
+ *
+ *  The reshape runs in the background, its progress is available from syncStatus() after
+ *  the next scan.
+ *
+ *  @param report the report to write information to
+ *  @param devices the devices to add
+ *  @return true if the reshape was started
+ */
 bool SoftwareRAID::growArray(Report &report, const QStringList &devices)
 {
-    Q_UNUSED(report)
-    Q_UNUSED(devices)
-    return false;
+    if (devices.isEmpty())
+        return true;
+
+    ExternalCommand addCmd(report, QStringLiteral("mdadm"),
+                           QStringList{ QStringLiteral("--manage"), deviceNode(), QStringLiteral("--add") } + devices);
+
+    if (!addCmd.run(-1) || addCmd.exitCode() != 0) {
+        report.line() << xi18nc("@info:progress", "Could not add devices to RAID array <filename>%1</filename>.", deviceNode());
+        return false;
+    }
+
+    d_ptr->m_devicePathList += devices;
+
+    // Spares do not count, the new devices become active members next to the active ones
+    const QString raidDevices = QStringLiteral("--raid-devices=") + QString::number(activeDevicePathList().size() + devices.size());
+    ExternalCommand growCmd(report, QStringLiteral("mdadm"), { QStringLiteral("--grow"), deviceNode(), raidDevices });
+
+    if (!growCmd.run(-1) || growCmd.exitCode() != 0) {
+        report.line() << xi18nc("@info:progress", "Could not reshape RAID array <filename>%1</filename>.", deviceNode());
+        return false;
+    }
+
+    d_ptr->m_activeDevicePathList += devices;
+
+    return true;
+}
+
+/** Can devices be removed from the array?
+ *
+ *  Only mirrors can lose members. Other levels would need the file system and the array
+ *  size reduced first, which is not supported.
+ *
+ *  @param devices the devices to remove
+ *  @return true if the array is a RAID 1, all devices are members and at least one active member is left
+ */
+bool SoftwareRAID::canShrinkArray(const QStringList& devices) const
+{
+    if (raidLevel() != 1)
+        return false;
+
+    qint32 remaining = activeDevicePathList().size();
+    for (const auto &path : devices) {
+        if (!deviceNodes().contains(path))
+            return false;
+        if (activeDevicePathList().contains(path))
+            remaining--;
+    }
+
+    return remaining > 0;
 }
 
+/** Removes devices from a mirrored array.
+ *
+ *  @param report the report to write information to
+ *  @param devices the devices to remove, see canShrinkArray()
+ *  @return true on success
+ */
 bool SoftwareRAID::shrinkArray(Report &report, const QStringList &devices)
 {
-    Q_UNUSED(report)
-    Q_UNUSED(devices)
-    return false;
+    if (devices.isEmpty())
+        return true;
+
+    if (!canShrinkArray(devices)) {
+        report.line() << xi18nc("@info:progress", "Removing devices from RAID %1 array <filename>%2</filename> is not supported.", raidLevel(), deviceNode());
+        return false;
+    }
+
+    const qint32 activeBefore = activeDevicePathList().size();
+
+    for (const QString& path : devices) {
+        ExternalCommand cmd(report, QStringLiteral("mdadm"),
+                            { QStringLiteral("--manage"), deviceNode(), QStringLiteral("--fail"), path, QStringLiteral("--remove"), path });
+
+        if (!cmd.run(-1) || cmd.exitCode() != 0) {
+            report.line() << xi18nc("@info:progress", "Could not remove <filename>%1</filename> from RAID array <filename>%2</filename>.", path, deviceNode());
+            return false;
+        }
+
+        d_ptr->m_devicePathList.removeAll(path);
+        d_ptr->m_activeDevicePathList.removeAll(path);
+    }
+
+    // Removing spares leaves the number of active members as it is
+    if (activeDevicePathList().size() == activeBefore)
+        return true;
+
+    const QString raidDevices = QStringLiteral("--raid-devices=") + QString::number(activeDevicePathList().size());
+    ExternalCommand growCmd(report, QStringLiteral("mdadm"), { QStringLiteral("--grow"), deviceNode(), raidDevices });
+
+    if (!growCmd.run(-1) || growCmd.exitCode() != 0) {
+        report.line() << xi18nc("@info:progress", "Could not reshape RAID array <filename>%1</filename>.", deviceNode());
+        return false;
+    }
+
+    return true;
 }
 
 QString SoftwareRAID::prettyName() const
@@ -95,6 +195,8 @@ QString SoftwareRAID::prettyName() const
         raidInfo = xi18nc("@item:inlistbox [RAID level - Recovering]", " [RAID %1 - Recovering]", raidLevel());
     else if (status() == SoftwareRAID::Status::Resync)
         raidInfo = xi18nc("@item:inlistbox [RAID level - Resyncing]", " [RAID %1 - Resyncing]", raidLevel());
+    else if (status() == SoftwareRAID::Status::Reshape)
+        raidInfo = xi18nc("@item:inlistbox [RAID level - Reshaping]", " [RAID %1 - Reshaping]", raidLevel());
     else
         raidInfo = QStringLiteral(" [RAID]");
 
@@ -145,6 +247,12 @@ QStringList SoftwareRAID::devicePathList() const
     return d_ptr->m_devicePathList;
 }
 
+/** @return the members that hold a slot of the array, without spares and faulty devices */
+QStringList SoftwareRAID::activeDevicePathList() const
+{
+    return d_ptr->m_activeDevicePathList;
+}
+
 SoftwareRAID::Status SoftwareRAID::status() const
 {
     return d_ptr->m_status;
@@ -155,6 +263,12 @@ void SoftwareRAID::setStatus(SoftwareRAID::Status status)
     d_ptr->m_status = status;
 }
 
+/** @return the resync state of the array as of the last scan */
+const SoftwareRAID::SyncStatus& SoftwareRAID::syncStatus() const
+{
+    return d_ptr->m_syncStatus;
+}
+
 void SoftwareRAID::scanSoftwareRAID(QList<Device*>& devices)
 {
     QStringList availableInConf;
@@ -219,6 +333,9 @@ void SoftwareRAID::scanSoftwareRAID(QList<Device*>& devices)
                     else if (reMirrorStatusMatch.captured(2) == QStringLiteral("recovery"))
                         d->setStatus(SoftwareRAID::Status::Recovery);
                 }
+
+                if (d->syncStatus().action == QStringLiteral("reshape"))
+                    d->setStatus(SoftwareRAID::Status::Reshape);
             }
         }
     }
@@ -361,6 +478,28 @@ QStringList SoftwareRAID::getDevicePathList(const QString &path)
     return result;
 }
 
+/** Reads the members that hold a slot of the array from mdadm --detail.
+ *
+ *  Members are listed as "Number Major Minor RaidDevice State Device". Spares and faulty
+ *  devices have no RaidDevice, a member that is being rebuilt already has one.
+ */
+QStringList SoftwareRAID::getActiveDevicePathList(const QString &path)
+{
+    QStringList result;
+
+    QString detail = getDetail(path);
+
+    if (!detail.isEmpty()) {
+        QRegularExpression re(QStringLiteral("^\\s*\\d+\\s+\\d+\\s+\\d+\\s+\\d+\\s+.*\\s(\\/dev\\/\\S+)\\s*$"), QRegularExpression::MultilineOption);
+        QRegularExpressionMatchIterator i = re.globalMatch(detail);
+
+        while (i.hasNext())
+            result << i.next().captured(1);
+    }
+
+    return result;
+}
+
 bool SoftwareRAID::isRaidPath(const QString &path)
 {
     return !getDetail(path).isEmpty();
@@ -372,22 +511,201 @@ bool SoftwareRAID::createSoftwareRAID(Report &report,
                                       const qint32 raidLevel,
                                       const qint32 chunkSize)
 {
-    Q_UNUSED(report)
-    Q_UNUSED(name)
-    Q_UNUSED(devicePathList)
-    Q_UNUSED(raidLevel)
-    Q_UNUSED(chunkSize)
-    return false;
+    return createSoftwareRAID(report, name, devicePathList, raidLevel, chunkSize, ArrayOptions());
+}
+
+/** Creates and starts a new array.
+ *
+ *  @param report the report to write information to
+ *  @param name the name of the array, e.g. md0
+ *  @param devicePathList the member devices
+ *  @param raidLevel the RAID level
+ *  @param chunkSize the chunk size in KiB, 0 for the mdadm default
+ *  @param options layout, bitmap, resync and write hole protection settings
+ *  @return true if the array was created
+ */
+bool SoftwareRAID::createSoftwareRAID(Report &report,
+                                      const QString &name,
+                                      const QStringList devicePathList,
+                                      const qint32 raidLevel,
+                                      const qint32 chunkSize,
+                                      const ArrayOptions& options)
+{
+    const QString deviceNode = QStringLiteral("/dev/") + name;
+    const bool parity = raidLevel >= 4 && raidLevel <= 6;
+
+    QStringList args = { QStringLiteral("--create"),
+                         deviceNode,
+                         QStringLiteral("--run"),
+                         QStringLiteral("--level=") + QString::number(raidLevel),
+                         QStringLiteral("--raid-devices=") + QString::number(devicePathList.size()) };
+
+    if (chunkSize > 0 && raidLevel != 1)
+        args << QStringLiteral("--chunk=") + QString::number(chunkSize) + QStringLiteral("K");
+
+    if (!options.layout.isEmpty())
+        args << QStringLiteral("--layout=") + options.layout;
+
+    // A journal or PPL replaces the bitmap, RAID 0 has no redundancy to protect
+    if (parity && options.consistency == ArrayOptions::Consistency::Journal) {
+        if (options.journalDevice.isEmpty()) {
+            report.line() << xi18nc("@info:progress", "A write journal needs a journal device.");
+            return false;
+        }
+        args << QStringLiteral("--write-journal") << options.journalDevice;
+    } else if (raidLevel == 5 && options.consistency == ArrayOptions::Consistency::Ppl)
+        args << QStringLiteral("--consistency-policy=ppl");
+    else if (raidLevel > 0) {
+        args << (options.bitmap ? QStringLiteral("--bitmap=internal") : QStringLiteral("--bitmap=none"));
+        if (options.bitmap && options.bitmapChunk > 0)
+            args << QStringLiteral("--bitmap-chunk=") + QString::number(options.bitmapChunk) + QStringLiteral("K");
+    }
+
+    if (options.assumeClean && raidLevel > 0)
+        args << QStringLiteral("--assume-clean");
+
+    args << devicePathList;
+
+    ExternalCommand cmd(report, QStringLiteral("mdadm"), args);
+    if (!cmd.run(-1) || cmd.exitCode() != 0)
+        return false;
+
+    if (parity && options.stripeCacheSize > 0)
+        setStripeCacheSize(report, deviceNode, options.stripeCacheSize);
+
+    return true;
 }
 
+/** Stops an array and erases the RAID superblocks of its members.
+ *
+ *  @param report the report to write information to
+ *  @param raidDevice the array to delete
+ *  @return true if the array was stopped and all superblocks were erased
+ */
 bool SoftwareRAID::deleteSoftwareRAID(Report &report,
                                       SoftwareRAID &raidDevice)
 {
-    Q_UNUSED(report)
-    Q_UNUSED(raidDevice)
+    const QStringList members = raidDevice.devicePathList();
+
+    ExternalCommand stopCmd(report, QStringLiteral("mdadm"),
+                            { QStringLiteral("--manage"), QStringLiteral("--stop"), raidDevice.deviceNode() });
+
+    if (!stopCmd.run(-1) || stopCmd.exitCode() != 0)
+        return false;
+
+    for (const QString& member : members) {
+        ExternalCommand zeroCmd(report, QStringLiteral("mdadm"),
+                                { QStringLiteral("--misc"), QStringLiteral("--zero-superblock"), member });
+
+        if (!zeroCmd.run(-1) || zeroCmd.exitCode() != 0)
+            return false;
+    }
+
+    return true;
+}
+
+/** Sets the size of the stripe cache of a RAID 4/5/6 array.
+ *
+ *  A larger cache lets the array collect full stripes before computing parity, which speeds up
+ *  writes a lot. It costs pages * 4 KiB of memory for each member device.
+ *
+ *  @param report the report to write information to
+ *  @param deviceNode the array
+ *  @param pages the number of cache entries
+ *  @return true on success
+ */
+bool SoftwareRAID::setStripeCacheSize(Report& report, const QString& deviceNode, qint32 pages)
+{
+    if (writeSysfs(report, deviceNode, QStringLiteral("stripe_cache_size"), QByteArray::number(pages)))
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Could not set the stripe cache size of <filename>%1</filename>.", deviceNode);
     return false;
 }
 
+/** Reads the resync state of an array from sysfs.
+ *
+ *  @param deviceNode the array
+ *  @return the state, action is empty if the array is not running
+ */
+SoftwareRAID::SyncStatus SoftwareRAID::readSyncStatus(const QString& deviceNode)
+{
+    SyncStatus result;
+
+    auto read = [&deviceNode] (const QString& attribute) {
+        QFile file(sysfsPath(deviceNode, attribute));
+        return file.open(QIODevice::ReadOnly) ? QString::fromLatin1(file.readAll()).trimmed() : QString();
+    };
+
+    result.action = read(QStringLiteral("sync_action"));
+
+    // "none" when idle, "<done> / <total>" in sectors otherwise
+    const QString completed = read(QStringLiteral("sync_completed"));
+    if (completed.contains(QLatin1Char('/'))) {
+        result.completed = completed.section(QLatin1Char('/'), 0, 0).trimmed().toLongLong();
+        result.total = completed.section(QLatin1Char('/'), 1, 1).trimmed().toLongLong();
+    }
+
+    result.speed = read(QStringLiteral("sync_speed")).toLongLong();
+
+    // limits are followed by "(system)" or "(local)"
+    result.speedMin = read(QStringLiteral("sync_speed_min")).section(QLatin1Char(' '), 0, 0).toLongLong();
+    result.speedMax = read(QStringLiteral("sync_speed_max")).section(QLatin1Char(' '), 0, 0).toLongLong();
+
+    return result;
+}
+
+/** Pauses resync, recovery or reshape of an array.
+ *
+ *  The array keeps its checkpoint and no new action is started until resumeSync() is called.
+ *
+ *  @param report the report to write information to
+ *  @param deviceNode the array
+ *  @return true on success
+ */
+bool SoftwareRAID::pauseSync(Report& report, const QString& deviceNode)
+{
+    return writeSysfs(report, deviceNode, QStringLiteral("sync_action"), "frozen");
+}
+
+/** Resumes a paused resync, recovery or reshape from its checkpoint.
+ *
+ *  @param report the report to write information to
+ *  @param deviceNode the array
+ *  @return true on success
+ */
+bool SoftwareRAID::resumeSync(Report& report, const QString& deviceNode)
+{
+    // leaving the frozen state makes md restart whatever action the array still needs
+    return writeSysfs(report, deviceNode, QStringLiteral("sync_action"), "idle");
+}
+
+/** Throttles resync, recovery and reshape of a single array.
+ *
+ *  Unlike /proc/sys/dev/raid/speed_limit_* this only affects the given array.
+ *
+ *  @param report the report to write information to
+ *  @param deviceNode the array
+ *  @param speedMin guaranteed speed in KiB/s even if there is other I/O, 0 for the system default
+ *  @param speedMax maximum speed in KiB/s, 0 for the system default
+ *  @return true on success
+ */
+bool SoftwareRAID::setSyncSpeedLimits(Report& report, const QString& deviceNode, qint64 speedMin, qint64 speedMax)
+{
+    const QByteArray system("system");
+
+    return writeSysfs(report, deviceNode, QStringLiteral("sync_speed_min"), speedMin > 0 ? QByteArray::number(speedMin) : system) &&
+           writeSysfs(report, deviceNode, QStringLiteral("sync_speed_max"), speedMax > 0 ? QByteArray::number(speedMax) : system);
+}
+
+/** Assembles an array.
+ *
+ *  md does not keep the stripe cache size of RAID 4/5/6 arrays when they stop, so assembled
+ *  arrays get the same stripe cache as new ones, see ArrayOptions::stripeCacheSize.
+ *
+ *  @param deviceNode the array
+ *  @return true if the array was assembled
+ */
 bool SoftwareRAID::assembleSoftwareRAID(const QString& deviceNode)
 {
     if (!isRaidPath(deviceNode))
@@ -396,7 +714,17 @@ bool SoftwareRAID::assembleSoftwareRAID(const QString& deviceNode)
     ExternalCommand cmd(QStringLiteral("mdadm"),
                         { QStringLiteral("--assemble"), QStringLiteral("--scan"), deviceNode });
 
-    return cmd.run(-1) && cmd.exitCode() == 0;
+    if (!cmd.run(-1) || cmd.exitCode() != 0)
+        return false;
+
+    const qint32 raidLevel = getRaidLevel(deviceNode);
+    const qint32 stripeCacheSize = ArrayOptions().stripeCacheSize;
+    if (raidLevel >= 4 && raidLevel <= 6 && stripeCacheSize > 0) {
+        Report report(nullptr);
+        setStripeCacheSize(report, deviceNode, stripeCacheSize);
+    }
+
+    return true;
 }
 
 bool SoftwareRAID::stopSoftwareRAID(const QString& deviceNode)
@@ -477,3 +805,18 @@ QString SoftwareRAID::getRAIDConfiguration(const QString &configurationPath)
 
     return result;
 }
+
+QString SoftwareRAID::sysfsPath(const QString& deviceNode, const QString& attribute)
+{
+    // named arrays like /dev/md/data are links to /dev/mdNNN
+    const QString kernelName = QFileInfo(deviceNode).canonicalFilePath().section(QLatin1Char('/'), -1);
+
+    return QStringLiteral("/sys/block/%1/md/%2").arg(kernelName, attribute);
+}
+
+bool SoftwareRAID::writeSysfs(Report& report, const QString& deviceNode, const QString& attribute, const QByteArray& value)
+{
+    ExternalCommand cmd;
+
+    return cmd.writeData(report, value, sysfsPath(deviceNode, attribute), 0);
+}
@@ -23,6 +23,36 @@ public:
         Inactive,
         Resync,
         Recovery,
+        Reshape,
+    };
+
+    /** Resync, recovery and reshape state of an array as exposed in sysfs. */
+    struct SyncStatus
+    {
+        QString action;         /**< sync_action: idle, frozen, resync, recover, reshape, check or repair */
+        qint64 completed = 0;   /**< sectors done of the running action */
+        qint64 total = 0;       /**< sectors of the running action, 0 if nothing is running */
+        qint64 speed = 0;       /**< current speed in KiB/s */
+        qint64 speedMin = 0;    /**< guaranteed minimum speed in KiB/s */
+        qint64 speedMax = 0;    /**< maximum speed in KiB/s */
+    };
+
+    /** Performance relevant parameters of a new array. */
+    struct ArrayOptions
+    {
+        enum class Consistency {
+            Bitmap,     /**< write-intent bitmap, or no protection if bitmap is false */
+            Journal,    /**< RAID 4/5/6 write journal on a separate device */
+            Ppl         /**< RAID 5 partial parity log */
+        };
+
+        QString layout;                 /**< mdadm layout, e.g. left-symmetric or f2, empty for the default */
+        bool bitmap = true;             /**< keep an internal write-intent bitmap for fast resync after a crash */
+        qint64 bitmapChunk = 0;         /**< bitmap chunk in KiB, 0 for the mdadm default */
+        bool assumeClean = false;       /**< skip the initial resync, only safe on devices that read zeroes after a discard */
+        Consistency consistency = Consistency::Bitmap;
+        QString journalDevice;          /**< device for Consistency::Journal */
+        qint32 stripeCacheSize = 4096;  /**< RAID 4/5/6 stripe cache in pages per device, 0 keeps the kernel default */
     };
 
     explicit SoftwareRAID(const QString& name,
@@ -36,6 +66,7 @@ public:
     virtual bool growArray(Report& report, const QStringList& devices);
 
     virtual bool shrinkArray(Report& report, const QStringList& devices);
+    bool canShrinkArray(const QStringList& devices) const;
 
     virtual QString prettyName() const override;
 
@@ -47,7 +78,9 @@ public:
     qint64 arraySize() const;
     QString uuid() const;
     QStringList devicePathList() const;
+    QStringList activeDevicePathList() const;
     SoftwareRAID::Status status() const;
+    const SyncStatus& syncStatus() const;
 
     void setStatus(SoftwareRAID::Status status);
 
@@ -58,6 +91,7 @@ public:
     static qint64 getArraySize(const QString& path);
     static QString getUUID(const QString& path);
     static QStringList getDevicePathList(const QString& path);
+    static QStringList getActiveDevicePathList(const QString& path);
 
     static bool isRaidPath(const QString& path);
 
@@ -67,6 +101,20 @@ public:
                                    const qint32 raidLevel,
                                    const qint32 chunkSize);
 
+    static bool createSoftwareRAID(Report& report,
+                                   const QString& name,
+                                   const QStringList devicePathList,
+                                   const qint32 raidLevel,
+                                   const qint32 chunkSize,
+                                   const ArrayOptions& options);
+
+    static bool setStripeCacheSize(Report& report, const QString& deviceNode, qint32 pages);
+
+    static SyncStatus readSyncStatus(const QString& deviceNode);
+    static bool pauseSync(Report& report, const QString& deviceNode);
+    static bool resumeSync(Report& report, const QString& deviceNode);
+    static bool setSyncSpeedLimits(Report& report, const QString& deviceNode, qint64 speedMin, qint64 speedMax);
+
     static bool deleteSoftwareRAID(Report& report,
                                    SoftwareRAID& raidDevice);
 
@@ -89,6 +137,9 @@ private:
     static QString getDetail(const QString& path);
 
     static QString getRAIDConfiguration(const QString& configurationPath);
+
+    static QString sysfsPath(const QString& deviceNode, const QString& attribute);
+    static bool writeSysfs(Report& report, const QString& deviceNode, const QString& attribute, const QByteArray& value);
 };
 
 #endif // SOFTWARERAID_H
@@ -10,6 +10,10 @@
 
 #include "fs/btrfs.h"
 
+#include "core/device.h"
+#include "core/partition.h"
+#include "core/partitiontable.h"
+
 #include "util/externalcommand.h"
 #include "util/capacity.h"
 #include "util/report.h"
@@ -34,6 +38,7 @@ FileSystem::CommandSupportType btrfs::m_Backup = FileSystem::cmdSupportNone;
 FileSystem::CommandSupportType btrfs::m_SetLabel = FileSystem::cmdSupportNone;
 FileSystem::CommandSupportType btrfs::m_UpdateUUID = FileSystem::cmdSupportNone;
 FileSystem::CommandSupportType btrfs::m_GetUUID = FileSystem::cmdSupportNone;
+FileSystem::CommandSupportType btrfs::m_Convert = FileSystem::cmdSupportNone;
 
 btrfs::btrfs(qint64 firstsector, qint64 lastsector, qint64 sectorsused, const QString& label, const QVariantMap& features) :
     FileSystem(firstsector, lastsector, sectorsused, label, features, FileSystem::Type::Btrfs)
@@ -50,6 +55,7 @@ void btrfs::init()
 
     m_SetLabel = m_Check;
     m_UpdateUUID = findExternal(QStringLiteral("btrfstune")) ? cmdSupportFileSystem : cmdSupportNone;
+    m_Convert = findExternal(QStringLiteral("btrfs-convert")) ? cmdSupportFileSystem : cmdSupportNone;
 
     m_Copy = (m_Check != cmdSupportNone) ? cmdSupportCore : cmdSupportNone;
     m_Move = (m_Check != cmdSupportNone) ? cmdSupportCore : cmdSupportNone;
@@ -135,6 +141,20 @@ bool btrfs::check(Report& report, const QString& deviceNode) const
 }
 
 bool btrfs::create(Report& report, const QString& deviceNode)
+{
+    return createMultiDevice(report, { deviceNode });
+}
+
+/** Creates one btrfs file system spanning several devices.
+
+    Data and metadata are spread over the devices according to dataProfile() and metadataProfile().
+
+    @param report the report to write information to
+    @param deviceNodes the devices to create the file system on
+    @param label the label of the new file system
+    @return true on success
+*/
+bool btrfs::createMultiDevice(Report& report, const QStringList& deviceNodes, const QString& label)
 {
     QStringList args = QStringList();
 
@@ -153,7 +173,15 @@ bool btrfs::create(Report& report, const QString& deviceNode)
         }
         args << QStringLiteral("--features") << feature_list.join(QStringLiteral(","));
     }
-    args << QStringLiteral("--force") << deviceNode;
+
+    if (!dataProfile().isEmpty())
+        args << QStringLiteral("--data") << dataProfile();
+    if (!metadataProfile().isEmpty())
+        args << QStringLiteral("--metadata") << metadataProfile();
+    if (!label.isEmpty())
+        args << QStringLiteral("--label") << label;
+
+    args << QStringLiteral("--force") << deviceNodes;
 
     ExternalCommand cmd(report, QStringLiteral("mkfs.btrfs"), args);
     return cmd.run(-1) && cmd.exitCode() == 0;
@@ -221,4 +249,237 @@ bool btrfs::updateUUID(Report& report, const QString& deviceNode) const
     ExternalCommand cmd(report, QStringLiteral("btrfstune"), { QStringLiteral("-f"), QStringLiteral("-u"), deviceNode });
     return cmd.run(-1) && cmd.exitCode() == 0;
 }
+
+/** @return the block group profiles mkfs.btrfs and balance accept */
+const QStringList& btrfs::profiles()
+{
+    static const QStringList p = {
+        QStringLiteral("single"),
+        QStringLiteral("dup"),
+        QStringLiteral("raid0"),
+        QStringLiteral("raid1"),
+        QStringLiteral("raid1c3"),
+        QStringLiteral("raid1c4"),
+        QStringLiteral("raid10"),
+        QStringLiteral("raid5"),
+        QStringLiteral("raid6"),
+    };
+
+    return p;
+}
+
+/** @param profile a block group profile
+    @return the number of devices the profile needs at least, -1 if the profile is unknown
+*/
+qint32 btrfs::minDevices(const QString& profile)
+{
+    static const QMap<QString, qint32> m = {
+        { QStringLiteral("single"), 1 },
+        { QStringLiteral("dup"), 1 },
+        { QStringLiteral("raid0"), 2 },
+        { QStringLiteral("raid1"), 2 },
+        { QStringLiteral("raid1c3"), 3 },
+        { QStringLiteral("raid1c4"), 4 },
+        { QStringLiteral("raid10"), 4 },
+        { QStringLiteral("raid5"), 2 },
+        { QStringLiteral("raid6"), 3 },
+    };
+
+    return profile.isEmpty() ? 1 : m.value(profile, -1);
+}
+
+/** Adds devices to a btrfs file system.
+
+    Existing data stays where it is until the file system is balanced.
+
+    @param report the report to write information to
+    @param deviceNode a device of the file system
+    @param mountPoint where the file system is mounted, empty to mount it temporarily
+    @param deviceNodes the devices to add
+    @return true on success
+*/
+bool btrfs::addDevices(Report& report, const QString& deviceNode, const QString& mountPoint, const QStringList& deviceNodes)
+{
+    return runMounted(report, deviceNode, mountPoint, [&report, &deviceNodes] (const QString& path) {
+        ExternalCommand cmd(report, QStringLiteral("btrfs"),
+                            QStringList{ QStringLiteral("device"), QStringLiteral("add"), QStringLiteral("--force") } + deviceNodes + QStringList{ path });
+        return cmd.run(-1) && cmd.exitCode() == 0;
+    });
+}
+
+/** Removes devices from a btrfs file system.
+
+    The data on the devices is moved to the remaining ones first, which can take a long time.
+
+    @param report the report to write information to
+    @param deviceNode a device of the file system that stays
+    @param mountPoint where the file system is mounted, empty to mount it temporarily
+    @param deviceNodes the devices to remove
+    @return true on success
+*/
+bool btrfs::removeDevices(Report& report, const QString& deviceNode, const QString& mountPoint, const QStringList& deviceNodes)
+{
+    return runMounted(report, deviceNode, mountPoint, [&report, &deviceNodes] (const QString& path) {
+        ExternalCommand cmd(report, QStringLiteral("btrfs"),
+                            QStringList{ QStringLiteral("device"), QStringLiteral("remove") } + deviceNodes + QStringList{ path });
+        return cmd.run(-1) && cmd.exitCode() == 0;
+    });
+}
+
+/** Rebalances a btrfs file system over all its devices, optionally converting the profiles.
+
+    @param report the report to write information to
+    @param deviceNode a device of the file system
+    @param mountPoint where the file system is mounted, empty to mount it temporarily
+    @param dataProfile the new data profile, empty to keep the current one
+    @param metadataProfile the new metadata profile, empty to keep the current one
+    @return true on success
+*/
+bool btrfs::balance(Report& report, const QString& deviceNode, const QString& mountPoint, const QString& dataProfile, const QString& metadataProfile)
+{
+    return runMounted(report, deviceNode, mountPoint, [&] (const QString& path) {
+        QStringList args = { QStringLiteral("balance"), QStringLiteral("start"), QStringLiteral("--full-balance") };
+
+        if (!dataProfile.isEmpty())
+            args << QStringLiteral("-dconvert=") + dataProfile;
+        if (!metadataProfile.isEmpty())
+            args << QStringLiteral("-mconvert=") + metadataProfile;
+
+        args << path;
+
+        ExternalCommand cmd(report, QStringLiteral("btrfs"), args);
+        return cmd.run(-1) && cmd.exitCode() == 0;
+    });
+}
+
+bool btrfs::runMounted(Report& report, const QString& deviceNode, const QString& mountPoint, const std::function<bool(const QString&)>& command)
+{
+    if (!mountPoint.isEmpty())
+        return command(mountPoint);
+
+    QTemporaryDir tempDir;
+    if (!tempDir.isValid()) {
+        report.line() << xi18nc("@info:progress", "Could not create temp dir to mount Btrfs file system on <filename>%1</filename>.", deviceNode);
+        return false;
+    }
+
+    ExternalCommand mountCmd(report, QStringLiteral("mount"),
+                             { QStringLiteral("--verbose"),  QStringLiteral("--types"), QStringLiteral("btrfs"), deviceNode, tempDir.path() });
+
+    if (!mountCmd.run(-1) || mountCmd.exitCode() != 0) {
+        report.line() << xi18nc("@info:progress", "Could not mount Btrfs file system on <filename>%1</filename>.", deviceNode);
+        return false;
+    }
+
+    const bool rval = command(tempDir.path());
+
+    ExternalCommand unmountCmd(report, QStringLiteral("umount"), { tempDir.path() });
+
+    if (!unmountCmd.run(-1) || unmountCmd.exitCode() != 0)
+        report.line() << xi18nc("@info:progress", "<warning>Could not unmount Btrfs file system on <filename>%1</filename>.</warning>", deviceNode);
+
+    return rval;
+}
+
+/** Groups the btrfs Partitions on the given Devices by file system UUID.
+
+    All devices of a multi-device btrfs share the UUID. Every btrfs FileSystem found gets the
+    device nodes of all devices of its file system, so members() works without another scan.
+    Nothing is kept outside the Devices, the grouping goes away with them.
+
+    @param devices the scanned Devices
+*/
+void btrfs::scanMembers(const QList<Device*>& devices)
+{
+    QMap<QString, QVector<Partition*>> groups;
+
+    for (const auto &d : devices)
+        scanMembersInNode(d->partitionTable(), groups);
+
+    for (const auto &members : std::as_const(groups)) {
+        QStringList deviceNodes;
+        for (const auto &p : members)
+            deviceNodes.append(p->deviceNode());
+
+        for (const auto &p : members)
+            static_cast<btrfs&>(p->fileSystem()).setMembers(deviceNodes);
+    }
+}
+
+void btrfs::scanMembersInNode(PartitionNode* parent, QMap<QString, QVector<Partition*>>& groups)
+{
+    if (parent == nullptr)
+        return;
+
+    for (const auto &p : parent->children()) {
+        if (p->children().size() > 0)
+            scanMembersInNode(p, groups);
+
+        if (p->fileSystem().type() == FileSystem::Type::Btrfs && !p->fileSystem().uuid().isEmpty())
+            groups[p->fileSystem().uuid()].append(p);
+    }
+}
+
+/** Can btrfs-convert turn a FileSystem of the given type into btrfs?
+    @param type the FileSystem::Type in question
+    @return true for the ext file systems
+*/
+bool btrfs::canConvertFrom(FileSystem::Type type)
+{
+    return type == FileSystem::Type::Ext2 || type == FileSystem::Type::Ext3 || type == FileSystem::Type::Ext4;
+}
+
+/** Estimates the free space btrfs-convert needs.
+
+    The data stays where it is and the original file system is kept as an image referencing
+    the same blocks, so only the new metadata and the system chunks need room.
+
+    @param usedBytes the bytes in use on the file system to convert
+    @return the free space needed in bytes
+*/
+qint64 btrfs::convertSpaceNeeded(qint64 usedBytes)
+{
+    return 256 * Capacity::unitFactor(Capacity::Unit::Byte, Capacity::Unit::MiB) + usedBytes / 10;
+}
+
+/** Converts an ext file system to btrfs in place.
+
+    Only metadata is written. The original file system is kept in the ext2_saved subvolume
+    until it is deleted, so the conversion can be undone with rollback(). If btrfs-convert
+    fails the original file system is left untouched. Label and UUID are kept, so fstab
+    entries still match.
+
+    @param report the report to write information to
+    @param deviceNode the device node of the unmounted file system
+    @param progress called with the percentage done
+    @return true on success
+*/
+bool btrfs::convert(Report& report, const QString& deviceNode, const std::function<void(int)>& progress)
+{
+    report.line() << xi18nc("@info:progress", "Converting the file system on <filename>%1</filename> to Btrfs.", deviceNode);
+
+    const QStringList args = { QStringLiteral("--copy-label"), QStringLiteral("--uuid"), QStringLiteral("copy"), QStringLiteral("--progress"), deviceNode };
+
+    ExternalCommand cmd(report, QStringLiteral("btrfs-convert"), args);
+    if (progress)
+        QObject::connect(&cmd, &ExternalCommand::progress, &cmd, progress);
+
+    return cmd.runWithProgress() && cmd.exitCode() == 0;
+}
+
+/** Restores the file system a btrfs file system was converted from.
+
+    This only works as long as the ext2_saved subvolume has not been deleted.
+
+    @param report the report to write information to
+    @param deviceNode the device node of the unmounted file system
+    @return true on success
+*/
+bool btrfs::rollback(Report& report, const QString& deviceNode)
+{
+    report.line() << xi18nc("@info:progress", "Restoring the original file system on <filename>%1</filename>.", deviceNode);
+
+    ExternalCommand cmd(report, QStringLiteral("btrfs-convert"), { QStringLiteral("--rollback"), deviceNode });
+    return cmd.run(-1) && cmd.exitCode() == 0;
+}
 }
@@ -15,8 +15,16 @@
 
 #include "fs/filesystem.h"
 
+#include <QMap>
+#include <QStringList>
+#include <QVector>
 #include <QtGlobal>
 
+#include <functional>
+
+class Device;
+class Partition;
+class PartitionNode;
 class Report;
 
 class QString;
@@ -43,6 +51,29 @@ public:
     bool writeLabelOnline(Report& report, const QString& deviceNode, const QString& mountPoint, const QString& newLabel) override;
     bool updateUUID(Report& report, const QString& deviceNode) const override;
 
+    bool createMultiDevice(Report& report, const QStringList& deviceNodes, const QString& label = QString());
+
+    const QString& dataProfile() const {
+        return m_DataProfile;    /**< @return the data block group profile used on creation, empty for the mkfs.btrfs default */
+    }
+    void setDataProfile(const QString& profile) {
+        m_DataProfile = profile;
+    }
+
+    const QString& metadataProfile() const {
+        return m_MetadataProfile;    /**< @return the metadata block group profile used on creation, empty for the mkfs.btrfs default */
+    }
+    void setMetadataProfile(const QString& profile) {
+        m_MetadataProfile = profile;
+    }
+
+    const QStringList& members() const {
+        return m_Members;    /**< @return the device nodes of this file system found by the last scan, including its own */
+    }
+    void setMembers(const QStringList& deviceNodes) {
+        m_Members = deviceNodes;
+    }
+
     CommandSupportType supportGetUsed() const override {
         return m_GetUsed;
     }
@@ -98,6 +129,24 @@ public:
     SupportTool supportToolName() const override;
     bool supportToolFound() const override;
 
+    static const QStringList& profiles();
+    static qint32 minDevices(const QString& profile);
+
+    static bool addDevices(Report& report, const QString& deviceNode, const QString& mountPoint, const QStringList& deviceNodes);
+    static bool removeDevices(Report& report, const QString& deviceNode, const QString& mountPoint, const QStringList& deviceNodes);
+    static bool balance(Report& report, const QString& deviceNode, const QString& mountPoint, const QString& dataProfile, const QString& metadataProfile);
+
+    static void scanMembers(const QList<Device*>& devices);
+
+    static bool canConvertFrom(FileSystem::Type type);
+    static qint64 convertSpaceNeeded(qint64 usedBytes);
+    static bool convert(Report& report, const QString& deviceNode, const std::function<void(int)>& progress = {});
+    static bool rollback(Report& report, const QString& deviceNode);
+
+private:
+    static bool runMounted(Report& report, const QString& deviceNode, const QString& mountPoint, const std::function<bool(const QString&)>& command);
+    static void scanMembersInNode(PartitionNode* parent, QMap<QString, QVector<Partition*>>& groups);
+
 public:
     static CommandSupportType m_GetUsed;
     static CommandSupportType m_GetLabel;
@@ -111,6 +160,12 @@ public:
     static CommandSupportType m_SetLabel;
     static CommandSupportType m_UpdateUUID;
     static CommandSupportType m_GetUUID;
+    static CommandSupportType m_Convert;
+
+private:
+    QString m_DataProfile;
+    QString m_MetadataProfile;
+    QStringList m_Members;
 };
 }
 
@@ -11,10 +11,18 @@
 
 #include "util/externalcommand.h"
 #include "util/capacity.h"
+#include "util/report.h"
 
+#include <QFileInfo>
+#include <QUuid>
+#include <QtEndian>
 #include <QRegularExpression>
 #include <QString>
 
+#include <KLocalizedString>
+
+#include <algorithm>
+
 namespace FS
 {
 FileSystem::CommandSupportType ext2::m_GetUsed = FileSystem::cmdSupportNone;
@@ -47,7 +55,8 @@ void ext2::init()
     m_Shrink = (m_Grow != cmdSupportNone && m_GetUsed) != cmdSupportNone ? cmdSupportFileSystem : cmdSupportNone;
     m_Copy = (m_Check != cmdSupportNone) ? cmdSupportCore : cmdSupportNone;
     m_Move = (m_Check != cmdSupportNone) ? cmdSupportCore : cmdSupportNone;
-    m_Backup = cmdSupportCore;
+    // QCOW2 images written by e2image only contain the used blocks
+    m_Backup = findExternal(QStringLiteral("e2image")) ? cmdSupportFileSystem : cmdSupportCore;
     m_GetUUID = cmdSupportCore;
 
     if (m_Create == cmdSupportFileSystem) {
@@ -82,6 +91,53 @@ void ext2::init()
     }
 }
 
+/** Reads the primary superblock, served from the helper's read cache while scanning.
+    @return the superblock, empty if it could not be read or has no ext2 magic
+*/
+static QByteArray readSuperblock(const QString& deviceNode)
+{
+    const QByteArray superblock = ExternalCommand().readData(deviceNode, 1024, 1024);
+
+    if (superblock.size() != 1024 || qFromLittleEndian<quint16>(superblock.constData() + 0x38) != 0xEF53)
+        return {};
+
+    return superblock;
+}
+
+void ext2::scan(const QString& deviceNode)
+{
+    const QByteArray superblock = readSuperblock(deviceNode);
+    QString journalUuid;
+
+    if (!superblock.isEmpty()) {
+        // Only file systems with an external journal have a journal UUID, the kernel and e2fsck look it up by that
+        const QByteArray uuid = superblock.mid(0xD0, 16);
+        if (uuid != QByteArray(16, '\0'))
+            journalUuid = QUuid::fromRfc4122(uuid).toString(QUuid::WithoutBraces);
+    } else {
+        if (m_GetUsed == cmdSupportNone)
+            return;
+
+        ExternalCommand cmd(QStringLiteral("dumpe2fs"), { QStringLiteral("-h"), deviceNode });
+
+        if (!cmd.run())
+            return;
+
+        QRegularExpression re(QStringLiteral("Journal UUID:\\s+([0-9a-fA-F-]{36})"));
+        QRegularExpressionMatch reJournalUUID = re.match(cmd.output());
+
+        if (reJournalUUID.hasMatch())
+            journalUuid = reJournalUUID.captured(1);
+    }
+
+    if (!journalUuid.isEmpty()) {
+        const QFileInfo link(QStringLiteral("/dev/disk/by-uuid/") + journalUuid.toLower());
+
+        setExternalJournal(link.exists() ? link.canonicalFilePath() : QString());
+        setHasExternalJournal(true);
+    }
+}
+
 bool ext2::supportToolFound() const
 {
     return
@@ -116,6 +172,23 @@ int ext2::maxLabelLength() const
 
 qint64 ext2::readUsedCapacity(const QString& deviceNode) const
 {
+    const QByteArray superblock = readSuperblock(deviceNode);
+
+    if (!superblock.isEmpty()) {
+        const char* sb = superblock.constData();
+        qint64 blockCount = qFromLittleEndian<quint32>(sb + 0x04);
+        qint64 freeBlocks = qFromLittleEndian<quint32>(sb + 0x0C);
+        const qint64 blockSize = 1024LL << qFromLittleEndian<quint32>(sb + 0x18);
+
+        // 64bit feature: the counts have high halves
+        if (qFromLittleEndian<quint32>(sb + 0x60) & 0x80) {
+            blockCount |= static_cast<qint64>(qFromLittleEndian<quint32>(sb + 0x150)) << 32;
+            freeBlocks |= static_cast<qint64>(qFromLittleEndian<quint32>(sb + 0x158)) << 32;
+        }
+
+        return (blockCount - freeBlocks) * blockSize;
+    }
+
     ExternalCommand cmd(QStringLiteral("dumpe2fs"), { QStringLiteral("-h"), deviceNode });
 
     if (cmd.run()) {
@@ -149,10 +222,36 @@ qint64 ext2::readUsedCapacity(const QString& deviceNode) const
 
 bool ext2::check(Report& report, const QString& deviceNode) const
 {
-    ExternalCommand cmd(report, QStringLiteral("e2fsck"), { QStringLiteral("-f"), QStringLiteral("-y"), QStringLiteral("-v"), deviceNode });
+    QStringList args = { QStringLiteral("-f"), QStringLiteral("-y"), QStringLiteral("-v") };
+
+    if (!externalJournal().isEmpty())
+        args << QStringLiteral("-j") << externalJournal();
+
+    args << deviceNode;
+
+    ExternalCommand cmd(report, QStringLiteral("e2fsck"), args);
     return cmd.run(-1) && (cmd.exitCode() == 0 || cmd.exitCode() == 1 || cmd.exitCode() == 2 || cmd.exitCode() == 256);
 }
 
+bool ext2::backup(Report& report, const Device& sourceDevice, const QString& deviceNode, const QString& filename) const
+{
+    Q_UNUSED(sourceDevice)
+
+    ExternalCommand cmd(report, QStringLiteral("e2image"), { QStringLiteral("-Qa"), deviceNode, filename });
+
+    return cmd.run(-1) && cmd.exitCode() == 0;
+}
+
+bool ext2::restore(Report& report, const Device& targetDevice, const QString& deviceNode, const QString& filename) const
+{
+    Q_UNUSED(targetDevice)
+
+    // -r converts the QCOW2 image back to a raw file system, written straight to the partition
+    ExternalCommand cmd(report, QStringLiteral("e2image"), { QStringLiteral("-r"), filename, deviceNode });
+
+    return cmd.run(-1) && cmd.exitCode() == 0;
+}
+
 bool ext2::create(Report& report, const QString& deviceNode)
 {
     QStringList args = QStringList();
@@ -203,4 +302,45 @@ bool ext2::updateUUID(Report& report, const QString& deviceNode) const
     ExternalCommand cmd(report, QStringLiteral("tune2fs"), { QStringLiteral("-U"), QStringLiteral("random"), deviceNode });
     return cmd.run(-1) && cmd.exitCode() == 0;
 }
+
+/** Formats the external journal device and adds the options to use it to the mkfs arguments.
+
+    Does nothing if the journal is inside the file system.
+
+    The journal must use the same block size as the file system, so both get it passed
+    explicitly instead of leaving it to mke2fs, which picks it from the device size.
+
+    @param report the report to write information to
+    @param mkfsCommand the mkfs command of the file system, the journal is created with the same one
+    @param args the mkfs arguments
+    @return true on success
+*/
+bool ext2::prepareExternalJournal(Report& report, const QString& mkfsCommand, QStringList& args) const
+{
+    if (externalJournal().isEmpty())
+        return true;
+
+    // Like mke2fs, use small blocks for small file systems, but never smaller than a sector
+    // of the file system or the journal device
+    qint64 size = length() * sectorSize() < 512 * Capacity::unitFactor(Capacity::Unit::Byte, Capacity::Unit::MiB) ? 1024 : 4096;
+    size = std::max(size, sectorSize());
+
+    ExternalCommand sectorSizeCmd(QStringLiteral("blockdev"), { QStringLiteral("--getss"), externalJournal() });
+    if (sectorSizeCmd.run(-1) && sectorSizeCmd.exitCode() == 0)
+        size = std::max(size, sectorSizeCmd.output().trimmed().toLongLong());
+
+    const QString blockSize = QString::number(size);
+
+    ExternalCommand cmd(report, mkfsCommand,
+                        { QStringLiteral("-qF"), QStringLiteral("-O"), QStringLiteral("journal_dev"), QStringLiteral("-b"), blockSize, externalJournal() });
+
+    if (!cmd.run(-1) || cmd.exitCode() != 0) {
+        report.line() << xi18nc("@info:progress", "Could not create external journal on <filename>%1</filename>.", externalJournal());
+        return false;
+    }
+
+    args << QStringLiteral("-b") << blockSize << QStringLiteral("-J") << QStringLiteral("device=") + externalJournal();
+
+    return true;
+}
 }
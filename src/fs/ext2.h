@@ -34,10 +34,13 @@ public:
 
 public:
     void init() override;
+    void scan(const QString& deviceNode) override;
 
     qint64 readUsedCapacity(const QString& deviceNode) const override;
     bool check(Report& report, const QString& deviceNode) const override;
     bool create(Report& report, const QString& deviceNode) override;
+    bool backup(Report& report, const Device& sourceDevice, const QString& deviceNode, const QString& filename) const override;
+    bool restore(Report& report, const Device& targetDevice, const QString& deviceNode, const QString& filename) const override;
     bool resize(Report& report, const QString& deviceNode, qint64 length) const override;
     bool writeLabel(Report& report, const QString& deviceNode, const QString& newLabel) override;
     bool writeLabelOnline(Report& report, const QString& deviceNode, const QString& mountPoint, const QString& newLabel) override;
@@ -104,6 +107,9 @@ public:
     static CommandSupportType m_SetLabel;
     static CommandSupportType m_UpdateUUID;
     static CommandSupportType m_GetUUID;
+
+protected:
+    bool prepareExternalJournal(Report& report, const QString& mkfsCommand, QStringList& args) const;
 };
 }
 
@@ -45,6 +45,10 @@ bool ext3::create(Report& report, const QString& deviceNode)
         }
         args << QStringLiteral("-O") << feature_list.join(QStringLiteral(","));
     }
+
+    if (!prepareExternalJournal(report, QStringLiteral("mkfs.ext3"), args))
+        return false;
+
     args << QStringLiteral("-qF") << deviceNode;
 
     ExternalCommand cmd(report, QStringLiteral("mkfs.ext3"), args);
@@ -13,7 +13,10 @@
 */
 
 #include "fs/filesystem.h"
+#include "core/device.h"
 #include "core/fstab.h"
+#include "core/partition.h"
+#include "core/partitiontable.h"
 
 #include "fs/lvm2_pv.h"
 
@@ -29,9 +32,12 @@
 #include <QColor>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
 #include <QStandardPaths>
 #include <QStorageInfo>
 
+#include <utility>
+
 const std::vector<QColor> FileSystem::defaultColorCode =
 {
 {
@@ -82,6 +88,9 @@ struct FileSystemPrivate {
     QString m_UUID;
     QStringList m_AvailableFeatures;
     QVariantMap m_Features;
+    bool m_HasExternalJournal = false;
+    QString m_ExternalJournal;
+    QString m_JournalOwner;
 };
 
 /** Creates a new FileSystem object
@@ -177,6 +186,55 @@ bool FileSystem::detectMountStatus(FileSystem* fs, const QString& partitionPath)
     return mounted;
 }
 
+static void collectPartitions(PartitionNode* parent, QList<Partition*>& partitions)
+{
+    if (parent == nullptr)
+        return;
+
+    for (const auto &p : parent->children()) {
+        partitions.append(p);
+        collectPartitions(p, partitions);
+    }
+}
+
+/** Marks the Partitions holding the external journal or log of another FileSystem as in use.
+
+    Like LVM physical volumes, such a Partition is shown as mounted and its mount point is the
+    device node of the FileSystem it belongs to, so it cannot be deleted, formatted or unmounted.
+
+    @param devices the Devices to look for external journals on
+*/
+void FileSystem::scanExternalJournals(const QList<Device*>& devices)
+{
+    QList<Partition*> partitions;
+    for (const auto &d : devices)
+        collectPartitions(d->partitionTable(), partitions);
+
+    // External journals are recorded by their canonical path, Logical Volumes are usually not
+    const auto canonicalPath = [] (const Partition* p) {
+        const QString path = QFileInfo(p->deviceNode()).canonicalFilePath();
+        return path.isEmpty() ? p->deviceNode() : path;
+    };
+
+    QHash<QString, const Partition*> owners;
+    for (const auto &p : std::as_const(partitions))
+        if (!p->fileSystem().externalJournal().isEmpty())
+            owners.insert(p->fileSystem().externalJournal(), p);
+
+    if (owners.isEmpty())
+        return;
+
+    for (const auto &p : std::as_const(partitions)) {
+        const Partition* owner = owners.value(canonicalPath(p));
+        if (owner == nullptr || owner == p)
+            continue;
+
+        p->fileSystem().setJournalOwner(owner->deviceNode());
+        p->setMountPoint(owner->deviceNode());
+        p->setMounted(true);
+    }
+}
+
 /** Reads the label for this FileSystem
     @param deviceNode the device node for the Partition the FileSystem is on
     @return the FileSystem label or an empty string in case of error
@@ -333,6 +391,23 @@ bool FileSystem::backup(Report& report, const Device& sourceDevice, const QStrin
     return false;
 }
 
+/** Restores a FileSystem from a backup written by backup()
+    @param report Report to write status information to
+    @param targetDevice Device the FileSystem is restored to
+    @param deviceNode device node of the target Partition
+    @param filename name of the file to restore from
+    @return true on success
+*/
+bool FileSystem::restore(Report& report, const Device& targetDevice, const QString& deviceNode, const QString& filename) const
+{
+    Q_UNUSED(report)
+    Q_UNUSED(targetDevice)
+    Q_UNUSED(deviceNode)
+    Q_UNUSED(filename)
+
+    return false;
+}
+
 /** Removes a FileSystem
     @param report Report to write status information to
     @param deviceNode the device node for the Partition the FileSystem is on
@@ -686,3 +761,34 @@ void FileSystem::setUUID(const QString& s)
 {
     d->m_UUID = s;
 }
+
+bool FileSystem::hasExternalJournal() const
+{
+    return d->m_HasExternalJournal;
+}
+
+const QString& FileSystem::externalJournal() const
+{
+    return d->m_ExternalJournal;
+}
+
+void FileSystem::setHasExternalJournal(bool b)
+{
+    d->m_HasExternalJournal = b;
+}
+
+void FileSystem::setExternalJournal(const QString& deviceNode)
+{
+    d->m_ExternalJournal = deviceNode;
+    d->m_HasExternalJournal = !deviceNode.isEmpty();
+}
+
+const QString& FileSystem::journalOwner() const
+{
+    return d->m_JournalOwner;
+}
+
+void FileSystem::setJournalOwner(const QString& deviceNode)
+{
+    d->m_JournalOwner = deviceNode;
+}
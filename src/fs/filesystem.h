@@ -130,6 +130,7 @@ public:
     virtual bool writeLabelOnline(Report& report, const QString& deviceNode, const QString& mountPoint, const QString& newLabel);
     virtual bool copy(Report& report, const QString& targetDeviceNode, const QString& sourceDeviceNode) const;
     virtual bool backup(Report& report, const Device& sourceDevice, const QString& deviceNode, const QString& filename) const;
+    virtual bool restore(Report& report, const Device& targetDevice, const QString& deviceNode, const QString& filename) const;
     virtual bool remove(Report& report, const QString& deviceNode) const;
     virtual bool check(Report& report, const QString& deviceNode) const;
     virtual bool updateUUID(Report& report, const QString& deviceNode) const;
@@ -225,6 +226,7 @@ public:
     static FileSystem::Type detectFileSystem(const QString& partitionPath);
     static QString detectMountPoint(FileSystem* fs, const QString& partitionPath);
     static bool detectMountStatus(FileSystem* fs, const QString& partitionPath);
+    static void scanExternalJournals(const QList<Device*>& devices);
 
     /**< @return true if this FileSystem can be mounted */
     virtual bool canMount(const QString& deviceNode, const QString& mountPoint) const;
@@ -299,6 +301,24 @@ public:
     /**< @param s the new UUID */
     void setUUID(const QString& s);
 
+    /**< @return true if the journal or log is on another device */
+    bool hasExternalJournal() const;
+
+    /**< @return the device node of the external journal or log, empty if it is not external or could not be found */
+    const QString& externalJournal() const;
+
+    /**< @param b true if the journal or log is on another device */
+    void setHasExternalJournal(bool b);
+
+    /**< @param deviceNode the device node of the external journal or log, empty to keep it inside the FileSystem */
+    void setExternalJournal(const QString& deviceNode);
+
+    /**< @return the device node of the FileSystem this one holds the external journal or log for, empty if none */
+    const QString& journalOwner() const;
+
+    /**< @param deviceNode the device node of the FileSystem this one holds the external journal or log for */
+    void setJournalOwner(const QString& deviceNode);
+
 protected:
     static bool findExternal(const QString& cmdName, const QStringList& args = QStringList(), int exptectedCode = 1);
     void addAvailableFeature(const QString& name);
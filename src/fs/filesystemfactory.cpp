@@ -167,7 +167,23 @@ FileSystem* FileSystemFactory::create(FileSystem::Type t, qint64 firstsector, qi
 */
 FileSystem* FileSystemFactory::create(const FileSystem& other)
 {
-    return create(other.type(), other.firstSector(), other.lastSector(), other.sectorSize(), other.sectorsUsed(), other.label(), other.features(), other.uuid());
+    FileSystem* fs = create(other.type(), other.firstSector(), other.lastSector(), other.sectorSize(), other.sectorsUsed(), other.label(), other.features(), other.uuid());
+
+    if (fs != nullptr) {
+        fs->setExternalJournal(other.externalJournal());
+        fs->setHasExternalJournal(other.hasExternalJournal());
+
+        if (other.type() == FileSystem::Type::Btrfs) {
+            const FS::btrfs& otherBtrfs = static_cast<const FS::btrfs&>(other);
+            FS::btrfs* btrfsFs = static_cast<FS::btrfs*>(fs);
+
+            btrfsFs->setDataProfile(otherBtrfs.dataProfile());
+            btrfsFs->setMetadataProfile(otherBtrfs.metadataProfile());
+            btrfsFs->setMembers(otherBtrfs.members());
+        }
+    }
+
+    return fs;
 }
 
 /** @return the map of FileSystems */
@@ -21,10 +21,14 @@
 #include "util/helpers.h"
 #include "util/report.h"
 
+#include <algorithm>
 #include <cmath>
+#include <memory>
+#include <vector>
 
 #include <QDebug>
 #include <QDialog>
+#include <QFile>
 #include <QJsonArray>
 #include <QJsonObject>
 #include <QJsonDocument>
@@ -32,12 +36,27 @@
 #include <QPointer>
 #include <QStorageInfo>
 #include <QString>
+#include <QThread>
 #include <QUuid>
 #include <QWidget>
 
 #include <KLocalizedString>
 #include <KPasswordDialog>
 
+/** @return MemAvailable from /proc/meminfo in KiB, as cryptsetup reports PBKDF memory in KiB */
+static qint64 availableMemory()
+{
+    QFile meminfo(QStringLiteral("/proc/meminfo"));
+    if (meminfo.open(QIODevice::ReadOnly)) {
+        QRegularExpressionMatch rem = QRegularExpression(QStringLiteral("MemAvailable:\\s+(\\d+) kB")).match(QString::fromLatin1(meminfo.readAll()));
+        if (rem.hasMatch())
+            return rem.captured(1).toLongLong();
+    }
+
+    // Assume 4 GiB, enough for a few default LUKS2 keyslots
+    return 4 * 1024 * 1024;
+}
+
 namespace FS
 {
 FileSystem::CommandSupportType luks::m_GetUsed = FileSystem::cmdSupportNone;
@@ -264,6 +283,12 @@ bool luks::cryptOpen(QWidget* parent, const QString& deviceNode)
                     openCmd.start(-1) && openCmd.exitCode() == 0) )
         return false;
 
+    return finishCryptOpen(deviceNode, passphrase);
+}
+
+/** Picks up the inner FileSystem after cryptsetup opened the device. */
+bool luks::finishCryptOpen(const QString& deviceNode, const QString& passphrase)
+{
     if (m_innerFs) {
         delete m_innerFs;
         m_innerFs = nullptr;
@@ -288,6 +313,118 @@ bool luks::cryptOpen(QWidget* parent, const QString& deviceNode)
     return true;
 }
 
+/** Unlocks many LUKS devices with the same passphrase or key file without asking.
+
+    The memory hard key derivation of LUKS2 takes about a second per device, so the devices
+    are unlocked in parallel. Each device is charged with the memory and threads of its most
+    expensive keyslot, as cryptsetup might have to try them all. The most expensive devices go
+    first and as many run together as fit into half the available memory and the CPU cores.
+
+    @param partitions the Partitions to unlock, Partitions that are unlocked already are skipped
+    @param passphrase the passphrase, ignored if a key file is given
+    @param keyFile path to a key file, empty to use the passphrase
+    @return the result for every Partition, in the same order
+*/
+QList<luks::UnlockResult> luks::cryptOpenAll(const QList<Partition*>& partitions, const QString& passphrase, const QString& keyFile)
+{
+    struct Pending {
+        int index;
+        luks* fs;
+        qint64 memory;
+        qint32 threads;
+    };
+
+    QList<UnlockResult> results;
+    QList<Pending> pending;
+
+    for (const auto &p : partitions) {
+        UnlockResult result;
+        result.deviceNode = p->deviceNode();
+
+        luks* fs = dynamic_cast<luks*>(&p->fileSystem());
+        if (fs == nullptr)
+            result.message = xi18nc("@info:status", "<filename>%1</filename> is not a LUKS device.", p->deviceNode());
+        else if (fs->isCryptOpen())
+            result.success = true;
+        else
+            pending.append({ static_cast<int>(results.size()), fs, 0, 1 });
+
+        results.append(result);
+    }
+
+    // Read the key derivation parameters of all keyslots
+    std::vector<std::unique_ptr<ExternalCommand>> dumpCmds;
+    QList<ExternalCommand*> dumps;
+    for (const auto &p : std::as_const(pending)) {
+        dumpCmds.push_back(std::make_unique<ExternalCommand>(QStringLiteral("cryptsetup"), QStringList{ QStringLiteral("luksDump"), results[p.index].deviceNode }));
+        dumps.append(dumpCmds.back().get());
+    }
+    ExternalCommand::runParallel(dumps, QThread::idealThreadCount());
+
+    const QRegularExpression memoryRe(QStringLiteral("Memory:\\s+(\\d+)"));
+    const QRegularExpression threadsRe(QStringLiteral("Threads:\\s+(\\d+)"));
+    for (int i = 0; i < pending.size(); ++i) {
+        QRegularExpressionMatchIterator it = memoryRe.globalMatch(dumps[i]->output());
+        while (it.hasNext())
+            pending[i].memory = std::max(pending[i].memory, it.next().captured(1).toLongLong());
+
+        it = threadsRe.globalMatch(dumps[i]->output());
+        while (it.hasNext())
+            pending[i].threads = std::max(pending[i].threads, it.next().captured(1).toInt());
+    }
+
+    std::stable_sort(pending.begin(), pending.end(), [] (const Pending& a, const Pending& b) { return a.memory > b.memory; });
+
+    const qint64 memoryBudget = availableMemory() / 2;
+    const qint32 cores = QThread::idealThreadCount();
+
+    while (!pending.isEmpty()) {
+        // Always run at least one device, even if it alone exceeds the budget
+        QList<Pending> batch;
+        qint64 memory = 0;
+        qint32 threads = 0;
+        for (auto it = pending.begin(); it != pending.end();) {
+            if (!batch.isEmpty() && (memory + it->memory > memoryBudget || threads + it->threads > cores)) {
+                ++it;
+                continue;
+            }
+
+            memory += it->memory;
+            threads += it->threads;
+            batch.append(*it);
+            it = pending.erase(it);
+        }
+
+        std::vector<std::unique_ptr<ExternalCommand>> openCmds;
+        QList<ExternalCommand*> opens;
+        for (const auto &p : std::as_const(batch)) {
+            const QString& deviceNode = results[p.index].deviceNode;
+            QStringList args = { QStringLiteral("open"), QStringLiteral("--tries"), QStringLiteral("1") };
+            if (!keyFile.isEmpty())
+                args << QStringLiteral("--key-file") << keyFile;
+            args << deviceNode << p.fs->suggestedMapperName(deviceNode);
+
+            openCmds.push_back(std::make_unique<ExternalCommand>(QStringLiteral("cryptsetup"), args));
+            if (keyFile.isEmpty())
+                openCmds.back()->write(passphrase.toLocal8Bit() + '\n');
+            opens.append(openCmds.back().get());
+        }
+
+        ExternalCommand::runParallel(opens, opens.size());
+
+        for (int i = 0; i < batch.size(); ++i) {
+            UnlockResult& result = results[batch[i].index];
+
+            if (opens[i]->exitCode() == 0 && batch[i].fs->finishCryptOpen(result.deviceNode, keyFile.isEmpty() ? passphrase : QString()))
+                result.success = true;
+            else
+                result.message = opens[i]->output().trimmed();
+        }
+    }
+
+    return results;
+}
+
 bool luks::cryptClose(const QString& deviceNode)
 {
     if (!m_isCryptOpen)
@@ -19,6 +19,7 @@
 
 #include <QtGlobal>
 
+class Partition;
 class Report;
 
 class QString;
@@ -41,6 +42,14 @@ public:
         keyring
     };
 
+    /** Result of unlocking one device with cryptOpenAll() */
+    struct UnlockResult
+    {
+        QString deviceNode;
+        bool success = false;
+        QString message;    /**< cryptsetup output if unlocking failed */
+    };
+
 public:
     void init() override;
     void scan(const QString& deviceNode) override;
@@ -154,6 +163,8 @@ public:
     bool cryptOpen(QWidget* parent, const QString& deviceNode);
     bool cryptClose(const QString& deviceNode);
 
+    static QList<UnlockResult> cryptOpenAll(const QList<Partition*>& partitions, const QString& passphrase, const QString& keyFile = QString());
+
     void loadInnerFileSystem(const QString& mapperNode);
     void createInnerFileSystem(Type type);
 
@@ -185,6 +196,7 @@ public:
 protected:
     virtual QString readOuterUUID(const QString& deviceNode) const;
     void setPayloadSize();
+    bool finishCryptOpen(const QString& deviceNode, const QString& passphrase);
 
 public:
     static CommandSupportType m_GetUsed;
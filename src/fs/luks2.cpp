@@ -11,7 +11,12 @@
 #include "util/externalcommand.h"
 #include "util/report.h"
 
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
 #include <QRegularExpression>
+#include <QSysInfo>
+#include <QVersionNumber>
 
 #include <KLocalizedString>
 
@@ -39,24 +44,39 @@ bool luks2::create(Report& report, const QString& deviceNode)
     Q_ASSERT(m_innerFs);
     Q_ASSERT(!m_passphrase.isEmpty());
 
-    ExternalCommand createCmd(report, QStringLiteral("cryptsetup"),
-                              { QStringLiteral("-s"),
-                                QStringLiteral("512"),
-                                QStringLiteral("--batch-mode"),
-                                QStringLiteral("--force-password"),
-                                QStringLiteral("--type"), QStringLiteral("luks2"),
-                                QStringLiteral("luksFormat"),
-                                deviceNode });
+    PerformanceProfile profile = usePerformanceProfile() ? performanceProfile(deviceNode) : PerformanceProfile();
+
+    // cryptsetup refuses encryption sectors that do not divide the partition, newer versions
+    // would also pick 4096 bytes on their own, so ask for 512 byte sectors explicitly
+    if (profile.sectorSize > 0 && (length() * sectorSize()) % profile.sectorSize != 0)
+        profile.sectorSize = 512;
+
+    QStringList createArgs = { QStringLiteral("--batch-mode"),
+                               QStringLiteral("--force-password"),
+                               QStringLiteral("--type"), QStringLiteral("luks2") };
+
+    if (!profile.cipher.isEmpty())
+        createArgs << QStringLiteral("--cipher") << profile.cipher;
+    createArgs << QStringLiteral("-s") << QString::number(profile.keySize > 0 ? profile.keySize : 512);
+    if (profile.sectorSize > 0)
+        createArgs << QStringLiteral("--sector-size") << QString::number(profile.sectorSize);
+    createArgs << QStringLiteral("luksFormat") << deviceNode;
+
+    ExternalCommand createCmd(report, QStringLiteral("cryptsetup"), createArgs);
     if (!( createCmd.write(m_passphrase.toLocal8Bit() + '\n') &&
                 createCmd.start(-1) && createCmd.exitCode() == 0))
     {
         return false;
     }
 
-    ExternalCommand openCmd(report, QStringLiteral("cryptsetup"),
-                              { QStringLiteral("open"),
-                                deviceNode,
-                                suggestedMapperName(deviceNode) });
+    QStringList openArgs = { QStringLiteral("open") };
+
+    // --persistent stores the flags in the LUKS2 header, so they are used for every later unlock too
+    if (profile.noWorkqueue)
+        openArgs << QStringLiteral("--perf-no_read_workqueue") << QStringLiteral("--perf-no_write_workqueue") << QStringLiteral("--persistent");
+    openArgs << deviceNode << suggestedMapperName(deviceNode);
+
+    ExternalCommand openCmd(report, QStringLiteral("cryptsetup"), openArgs);
 
     if (!( openCmd.write(m_passphrase.toLocal8Bit() + '\n') && openCmd.start(-1)))
         return false;
@@ -135,4 +155,246 @@ luks::KeyLocation luks2::keyLocation()
     return m_KeyLocation;
 }
 
+/** Picks dm-crypt settings for a device.
+
+    The encryption sector size follows the physical block size, so 4K drives do not do
+    read-modify-write cycles for every 512 byte crypto sector. On non-rotational devices the
+    kcryptd workqueues only add latency, they are bypassed if the kernel supports it.
+
+    @param deviceNode the device to encrypt
+    @return the profile
+*/
+luks2::PerformanceProfile luks2::performanceProfile(const QString& deviceNode)
+{
+    PerformanceProfile profile = fastestCipher();
+
+    const qint32 physicalBlockSize = readQueueAttribute(deviceNode, QStringLiteral("physical_block_size")).toInt();
+    if (physicalBlockSize >= 4096)
+        profile.sectorSize = 4096;
+
+    profile.noWorkqueue = readQueueAttribute(deviceNode, QStringLiteral("rotational")) == QStringLiteral("0") && supportsPerformanceFlags();
+
+    return profile;
+}
+
+/** Runs cryptsetup benchmark for AES-XTS and Adiantum once and keeps the faster one.
+
+    AES-XTS wins by far on CPUs with AES instructions, Adiantum on the ones without.
+*/
+const luks2::PerformanceProfile& luks2::fastestCipher()
+{
+    static const PerformanceProfile fastest = [] {
+        const QList<PerformanceProfile> candidates = {
+            { QStringLiteral("aes-xts-plain64"), 512, 0, false },
+            { QStringLiteral("xchacha12,aes-adiantum-plain64"), 256, 0, false },
+        };
+        const QRegularExpression re(QStringLiteral("([\\d.]+) MiB/s\\s+([\\d.]+) MiB/s"));
+
+        PerformanceProfile best = candidates.first();
+        double bestSpeed = 0;
+
+        for (const auto &candidate : candidates) {
+            ExternalCommand cmd(QStringLiteral("cryptsetup"),
+                                { QStringLiteral("benchmark"), QStringLiteral("--cipher"), candidate.cipher, QStringLiteral("--key-size"), QString::number(candidate.keySize) });
+
+            if (!cmd.run(-1) || cmd.exitCode() != 0)
+                continue;
+
+            QRegularExpressionMatch rem = re.match(cmd.output());
+            if (!rem.hasMatch())
+                continue;
+
+            // Reads and writes both matter, take the slower direction
+            const double speed = qMin(rem.captured(1).toDouble(), rem.captured(2).toDouble());
+            if (speed > bestSpeed) {
+                best = candidate;
+                bestSpeed = speed;
+            }
+        }
+
+        return best;
+    }();
+
+    return fastest;
+}
+
+bool luks2::supportsPerformanceFlags()
+{
+    // Needs cryptsetup 2.3.4 and Linux 5.9
+    static const bool supported = [] {
+        if (QVersionNumber::fromString(QSysInfo::kernelVersion()) < QVersionNumber(5, 9))
+            return false;
+
+        ExternalCommand cmd(QStringLiteral("cryptsetup"), { QStringLiteral("--version") });
+        if (!cmd.run(-1) || cmd.exitCode() != 0)
+            return false;
+
+        QRegularExpressionMatch rem = QRegularExpression(QStringLiteral("(\\d+\\.\\d+\\.\\d+)")).match(cmd.output());
+        return rem.hasMatch() && QVersionNumber::fromString(rem.captured(1)) >= QVersionNumber(2, 3, 4);
+    }();
+
+    return supported;
+}
+
+QString luks2::readQueueAttribute(const QString& deviceNode, const QString& attribute)
+{
+    const QString name = QFileInfo(deviceNode).canonicalFilePath().section(QLatin1Char('/'), -1);
+    const QString sysfsPath = QFileInfo(QStringLiteral("/sys/class/block/") + name).canonicalFilePath();
+
+    // Partitions share the queue of their disk
+    QFile file(sysfsPath + QStringLiteral("/queue/") + attribute);
+    if (!file.exists())
+        file.setFileName(sysfsPath + QStringLiteral("/../queue/") + attribute);
+
+    if (!file.open(QIODevice::ReadOnly))
+        return QString();
+
+    return QString::fromLatin1(file.readAll()).trimmed();
+}
+
+/** Encrypts a device in place.
+
+    The data is moved towards the end of the device to make room for the header, the last
+    reencryptHeaderSize bytes of it are lost. Whatever lives there, usually a file system,
+    has to be shrunk beforehand. The device must not be in use.
+
+    @param report the report to write information to
+    @param deviceNode the device to encrypt
+    @param passphrase the passphrase of the new LUKS2 header
+    @param options cipher and resilience settings
+    @param progress called with the percentage done
+    @return true on success
+*/
+bool luks2::encrypt(Report& report, const QString& deviceNode, const QString& passphrase, const ReencryptOptions& options, const std::function<void(int)>& progress)
+{
+    // The header already says what is left to do
+    if (options.resume)
+        return reencrypt(report, deviceNode, passphrase, options, progress);
+
+    QStringList args = { QStringLiteral("--encrypt"),
+                         QStringLiteral("--type"), QStringLiteral("luks2"),
+                         QStringLiteral("--reduce-device-size"), QStringLiteral("%1M").arg(reencryptHeaderSize / 1024 / 1024) };
+
+    ReencryptOptions tuned = options;
+    if (tuned.cipher.isEmpty()) {
+        const PerformanceProfile profile = performanceProfile(deviceNode);
+        tuned.cipher = profile.cipher;
+        tuned.keySize = profile.keySize;
+    }
+
+    report.line() << xi18nc("@info:progress", "Encrypting <filename>%1</filename> in place.", deviceNode);
+    return runReencrypt(report, deviceNode, args, passphrase, tuned, progress);
+}
+
+/** Re-encrypts a LUKS2 device with a new volume key and, optionally, a new cipher.
+
+    If the device is unlocked this happens online, the file system on it stays mounted.
+
+    @param report the report to write information to
+    @param deviceNode the LUKS2 device
+    @param passphrase a passphrase of the device
+    @param options new cipher and resilience settings
+    @param progress called with the percentage done
+    @return true on success
+*/
+bool luks2::reencrypt(Report& report, const QString& deviceNode, const QString& passphrase, const ReencryptOptions& options, const std::function<void(int)>& progress)
+{
+    report.line() << xi18nc("@info:progress", "Re-encrypting <filename>%1</filename>.", deviceNode);
+    return runReencrypt(report, deviceNode, {}, passphrase, options, progress);
+}
+
+/** Decrypts a LUKS2 device in place.
+
+    The header is moved to decryptHeaderPath() first, which is needed to resume an interrupted
+    decryption, and the data is shifted back to the start of the device. The header directory
+    is created by the helper and only root can access it, the header is removed once the
+    device is decrypted. Needs cryptsetup 2.6.
+
+    @param report the report to write information to
+    @param deviceNode the LUKS2 device
+    @param uuid the UUID of the device, names the header file
+    @param passphrase a passphrase of the device
+    @param options resilience settings and the header directory, the cipher is ignored
+    @param progress called with the percentage done
+    @return true on success
+*/
+bool luks2::decrypt(Report& report, const QString& deviceNode, const QString& uuid, const QString& passphrase, const ReencryptOptions& options, const std::function<void(int)>& progress)
+{
+    if (uuid.isEmpty()) {
+        report.line() << xi18nc("@info:progress", "The UUID of <filename>%1</filename> is unknown.", deviceNode);
+        return false;
+    }
+
+    ReencryptOptions plain = options;
+    plain.cipher.clear();
+    plain.keySize = 0;
+
+    const QString directory = options.headerDirectory.isEmpty() ? defaultHeaderDirectory() : options.headerDirectory;
+    const QString header = decryptHeaderPath(uuid, directory);
+
+    ExternalCommand cmd;
+    if (!cmd.createStateDirectory(directory)) {
+        report.line() << xi18nc("@info:progress", "Could not create the private directory <filename>%1</filename> for the header.", directory);
+        return false;
+    }
+
+    report.line() << xi18nc("@info:progress", "Decrypting <filename>%1</filename> in place, the header is kept in <filename>%2</filename>.", deviceNode, header);
+
+    QStringList args = { QStringLiteral("--header"), header };
+    if (!options.resume)
+        args.prepend(QStringLiteral("--decrypt"));
+
+    if (!runReencrypt(report, deviceNode, args, passphrase, plain, progress))
+        return false;
+
+    // The header is only needed to resume, it still holds the volume key
+    if (!cmd.removeStateFile(header))
+        report.line() << xi18nc("@info:progress", "Could not remove the header <filename>%1</filename>.", header);
+
+    return true;
+}
+
+/** @param uuid the UUID of the LUKS2 device
+    @param directory the directory for the header, empty for defaultHeaderDirectory()
+    @return where decrypt() moves the header of the device to */
+QString luks2::decryptHeaderPath(const QString& uuid, const QString& directory)
+{
+    return QDir(directory.isEmpty() ? defaultHeaderDirectory() : directory).filePath(QStringLiteral("kpmcore-decrypt-%1.luks2").arg(uuid));
+}
+
+/** @return the directory decrypt() keeps headers in unless told otherwise, it persists across
+    reboots so an interrupted decryption can be resumed */
+QString luks2::defaultHeaderDirectory()
+{
+    return QStringLiteral("/var/lib/kpmcore");
+}
+
+bool luks2::runReencrypt(Report& report, const QString& deviceNode, QStringList args, const QString& passphrase, const ReencryptOptions& options, const std::function<void(int)>& progress)
+{
+    args.prepend(QStringLiteral("reencrypt"));
+    args << QStringLiteral("--batch-mode") << QStringLiteral("--progress-json");
+
+    if (!options.cipher.isEmpty() && !options.resume)
+        args << QStringLiteral("--cipher") << options.cipher;
+    if (options.keySize > 0 && !options.resume)
+        args << QStringLiteral("--key-size") << QString::number(options.keySize);
+    if (!options.resilience.isEmpty())
+        args << QStringLiteral("--resilience") << options.resilience;
+    if (options.hotzoneSize > 0)
+        args << QStringLiteral("--hotzone-size") << QString::number(options.hotzoneSize);
+    if (options.resume)
+        args << QStringLiteral("--resume-only");
+    args << deviceNode;
+
+    ExternalCommand cmd(report, QStringLiteral("cryptsetup"), args);
+    if (progress)
+        QObject::connect(&cmd, &ExternalCommand::progress, &cmd, progress);
+
+    if (cmd.write(passphrase.toLocal8Bit() + '\n') && cmd.runWithProgress() && cmd.exitCode() == 0)
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Re-encryption of <filename>%1</filename> stopped, it can be resumed later.", deviceNode);
+    return false;
+}
+
 }
@@ -15,6 +15,8 @@
 
 #include <QtGlobal>
 
+#include <functional>
+
 class QString;
 
 namespace FS
@@ -24,6 +26,37 @@ namespace FS
 */
 class LIBKPMCORE_EXPORT luks2 : public luks
 {
+public:
+    /** dm-crypt settings tuned to the device and CPU */
+    struct PerformanceProfile
+    {
+        QString cipher;             /**< cipher specification for cryptsetup, empty for the default */
+        qint32 keySize = 0;         /**< key size in bits, 0 for the default */
+        qint32 sectorSize = 0;      /**< encryption sector size in bytes, 0 for the default */
+        bool noWorkqueue = false;   /**< bypass the kcryptd read and write workqueues */
+    };
+
+    /** What to do to a device in place */
+    enum class ReencryptMode {
+        Encrypt,
+        Reencrypt,
+        Decrypt
+    };
+
+    /** Settings for in-place encryption, re-encryption and decryption */
+    struct ReencryptOptions
+    {
+        QString cipher;             /**< new cipher specification, empty to keep the current or use the default */
+        qint32 keySize = 0;         /**< new key size in bits, 0 for the default */
+        QString resilience;         /**< checksum, journal, datashift or none, empty for the default */
+        qint64 hotzoneSize = 0;     /**< bytes re-encrypted between two metadata updates, 0 for the default */
+        bool resume = false;        /**< only resume an interrupted run */
+        QString headerDirectory;    /**< where decrypt() keeps the header, empty for defaultHeaderDirectory() */
+    };
+
+    /** Space freed at the end of the data for the header when encrypting in place */
+    static constexpr qint64 reencryptHeaderSize = 32 * 1024 * 1024;
+
 public:
     luks2(qint64 firstsector, qint64 lastsector, qint64 sectorsused, const QString& label, const QVariantMap& features = {});
     ~luks2() override;
@@ -34,6 +67,30 @@ public:
     FileSystem::Type type() const override;
 
     luks::KeyLocation keyLocation();
+
+    bool usePerformanceProfile() const {
+        return m_UsePerformanceProfile;    /**< @return true if create() tunes cipher, sector size and queueing to the device */
+    }
+    void setUsePerformanceProfile(bool use) {
+        m_UsePerformanceProfile = use;
+    }
+
+    static PerformanceProfile performanceProfile(const QString& deviceNode);
+
+    static bool encrypt(Report& report, const QString& deviceNode, const QString& passphrase, const ReencryptOptions& options, const std::function<void(int)>& progress = {});
+    static bool reencrypt(Report& report, const QString& deviceNode, const QString& passphrase, const ReencryptOptions& options, const std::function<void(int)>& progress = {});
+    static bool decrypt(Report& report, const QString& deviceNode, const QString& uuid, const QString& passphrase, const ReencryptOptions& options, const std::function<void(int)>& progress = {});
+    static QString decryptHeaderPath(const QString& uuid, const QString& directory = QString());
+    static QString defaultHeaderDirectory();
+
+private:
+    static bool runReencrypt(Report& report, const QString& deviceNode, QStringList args, const QString& passphrase, const ReencryptOptions& options, const std::function<void(int)>& progress);
+    static const PerformanceProfile& fastestCipher();
+    static bool supportsPerformanceFlags();
+    static QString readQueueAttribute(const QString& deviceNode, const QString& attribute);
+
+private:
+    bool m_UsePerformanceProfile = true;
 };
 }
 
@@ -52,7 +52,8 @@ void ntfs::init()
     m_SetLabel = findExternal(QStringLiteral("ntfslabel")) ? cmdSupportFileSystem : cmdSupportNone;
     m_Create = findExternal(QStringLiteral("mkfs.ntfs")) ? cmdSupportFileSystem : cmdSupportNone;
     m_Copy = findExternal(QStringLiteral("ntfsclone")) ? cmdSupportFileSystem : cmdSupportNone;
-    m_Backup = cmdSupportCore;
+    // ntfsclone images only contain the used clusters
+    m_Backup = m_Copy == cmdSupportFileSystem ? cmdSupportFileSystem : cmdSupportCore;
     m_UpdateUUID = cmdSupportCore;
     m_Move = (m_Check != cmdSupportNone) ? cmdSupportCore : cmdSupportNone;
     m_GetUUID = cmdSupportCore;
@@ -143,6 +144,24 @@ bool ntfs::copy(Report& report, const QString& targetDeviceNode, const QString&
     return cmd.run(-1) && cmd.exitCode() == 0;
 }
 
+bool ntfs::backup(Report& report, const Device& sourceDevice, const QString& deviceNode, const QString& filename) const
+{
+    Q_UNUSED(sourceDevice)
+
+    ExternalCommand cmd(report, QStringLiteral("ntfsclone"), { QStringLiteral("--save-image"), QStringLiteral("--overwrite"), filename, deviceNode });
+
+    return cmd.run(-1) && cmd.exitCode() == 0;
+}
+
+bool ntfs::restore(Report& report, const Device& targetDevice, const QString& deviceNode, const QString& filename) const
+{
+    Q_UNUSED(targetDevice)
+
+    ExternalCommand cmd(report, QStringLiteral("ntfsclone"), { QStringLiteral("--restore-image"), QStringLiteral("--overwrite"), deviceNode, filename });
+
+    return cmd.run(-1) && cmd.exitCode() == 0;
+}
+
 bool ntfs::resize(Report& report, const QString& deviceNode, qint64 length) const
 {
     QStringList args = { QStringLiteral("--no-progress-bar"), QStringLiteral("--force"), deviceNode, QStringLiteral("--size"), QString::number(length) };
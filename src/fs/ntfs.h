@@ -38,6 +38,8 @@ public:
     bool check(Report& report, const QString& deviceNode) const override;
     bool create(Report& report, const QString& deviceNode) override;
     bool copy(Report& report, const QString& targetDeviceNode, const QString& sourceDeviceNode) const override;
+    bool backup(Report& report, const Device& sourceDevice, const QString& deviceNode, const QString& filename) const override;
+    bool restore(Report& report, const Device& targetDevice, const QString& deviceNode, const QString& filename) const override;
     bool resize(Report& report, const QString& deviceNode, qint64 length) const override;
     bool writeLabel(Report& report, const QString& deviceNode, const QString& newLabel) override;
     bool updateUUID(Report& report, const QString& deviceNode) const override;
@@ -14,10 +14,14 @@
 #include "util/capacity.h"
 #include "util/report.h"
 
+#include <QFile>
+#include <QFileInfo>
 #include <QRegularExpression>
 #include <QString>
 #include <QStringList>
 #include <QTemporaryDir>
+#include <QTextStream>
+#include <QtEndian>
 
 #include <KLocalizedString>
 
@@ -48,7 +52,8 @@ void xfs::init()
     m_Grow = (findExternal(QStringLiteral("xfs_growfs"), { QStringLiteral("-V") }) && m_Check != cmdSupportNone) ? cmdSupportFileSystem : cmdSupportNone;
     m_Copy = findExternal(QStringLiteral("xfs_copy")) ? cmdSupportFileSystem : cmdSupportNone;
     m_Move = (m_Check != cmdSupportNone) ? cmdSupportCore : cmdSupportNone;
-    m_Backup = cmdSupportCore;
+    // xfs_copy writes sparse files that only contain the used blocks
+    m_Backup = m_Copy == cmdSupportFileSystem ? cmdSupportFileSystem : cmdSupportCore;
 }
 
 bool xfs::supportToolFound() const
@@ -88,8 +93,75 @@ int xfs::maxLabelLength() const
     return 12;
 }
 
+/** Reads the primary superblock, served from the helper's read cache while scanning.
+    @return the superblock, empty if it could not be read or has no XFS magic
+*/
+static QByteArray readSuperblock(const QString& deviceNode)
+{
+    const QByteArray superblock = ExternalCommand().readData(deviceNode, 0, 512);
+
+    if (superblock.size() != 512 || !superblock.startsWith("XFSB"))
+        return {};
+
+    return superblock;
+}
+
+void xfs::scan(const QString& deviceNode)
+{
+    const QByteArray superblock = readSuperblock(deviceNode);
+
+    // An internal log starts at a block inside the file system
+    if (!superblock.isEmpty()) {
+        if (qFromBigEndian<quint64>(superblock.constData() + 48) != 0)
+            return;
+    } else {
+        if (m_GetUsed == cmdSupportNone)
+            return;
+
+        ExternalCommand cmd(QStringLiteral("xfs_db"), { QStringLiteral("-r"), QStringLiteral("-c"), QStringLiteral("sb 0"), QStringLiteral("-c"), QStringLiteral("print logstart"), deviceNode });
+
+        if (!cmd.run(-1) || cmd.exitCode() != 0 || !cmd.output().contains(QStringLiteral("logstart = 0")))
+            return;
+    }
+
+    setHasExternalJournal(true);
+
+    // The superblock does not say where an external log is, only the mount options do
+    QFile mounts(QStringLiteral("/proc/self/mounts"));
+    if (!mounts.open(QIODevice::ReadOnly))
+        return;
+
+    const QString canonicalNode = QFileInfo(deviceNode).canonicalFilePath();
+    const QRegularExpression re(QStringLiteral("(?:^|,)logdev=([^,]+)"));
+
+    QTextStream in(&mounts);
+    while (!in.atEnd()) {
+        const QStringList fields = in.readLine().split(QLatin1Char(' '));
+
+        if (fields.size() < 4 || QFileInfo(fields[0]).canonicalFilePath() != canonicalNode)
+            continue;
+
+        QRegularExpressionMatch reLogDev = re.match(fields[3]);
+        if (reLogDev.hasMatch()) {
+            setExternalJournal(QFileInfo(reLogDev.captured(1)).canonicalFilePath());
+            return;
+        }
+    }
+}
+
 qint64 xfs::readUsedCapacity(const QString& deviceNode) const
 {
+    const QByteArray superblock = readSuperblock(deviceNode);
+
+    if (!superblock.isEmpty()) {
+        const char* sb = superblock.constData();
+        const qint64 blockSize = qFromBigEndian<quint32>(sb + 4);
+        const qint64 dBlocks = qFromBigEndian<quint64>(sb + 8);
+        const qint64 fdBlocks = qFromBigEndian<quint64>(sb + 144);
+
+        return (dBlocks - fdBlocks) * blockSize;
+    }
+
     ExternalCommand cmd(QStringLiteral("xfs_db"), { QStringLiteral("-c"), QStringLiteral("sb 0"), QStringLiteral("-c"), QStringLiteral("print"), deviceNode });
 
     if (cmd.run(-1) && cmd.exitCode() == 0) {
@@ -129,18 +201,44 @@ bool xfs::writeLabel(Report& report, const QString& deviceNode, const QString& n
 
 bool xfs::check(Report& report, const QString& deviceNode) const
 {
-    ExternalCommand cmd(report, QStringLiteral("xfs_repair"), { QStringLiteral("-v"), deviceNode });
+    QStringList args = { QStringLiteral("-v") };
+
+    if (hasExternalJournal()) {
+        if (externalJournal().isEmpty()) {
+            report.line() << xi18nc("@info:progress", "Checking XFS file system on partition <filename>%1</filename> failed: The external log device is unknown.", deviceNode);
+            return false;
+        }
+
+        args << QStringLiteral("-l") << externalJournal();
+    }
+
+    args << deviceNode;
+
+    ExternalCommand cmd(report, QStringLiteral("xfs_repair"), args);
     return cmd.run(-1) && cmd.exitCode() == 0;
 }
 
 bool xfs::create(Report& report, const QString& deviceNode)
 {
-    ExternalCommand cmd(report, QStringLiteral("mkfs.xfs"), { QStringLiteral("-f"), deviceNode });
+    QStringList args = { QStringLiteral("-f") };
+
+    // mkfs.xfs sizes the log itself, at most it takes the whole log device
+    if (!externalJournal().isEmpty())
+        args << QStringLiteral("-l") << QStringLiteral("logdev=") + externalJournal();
+
+    args << deviceNode;
+
+    ExternalCommand cmd(report, QStringLiteral("mkfs.xfs"), args);
     return cmd.run(-1) && cmd.exitCode() == 0;
 }
 
 bool xfs::copy(Report& report, const QString& targetDeviceNode, const QString& sourceDeviceNode) const
 {
+    if (hasExternalJournal()) {
+        report.line() << xi18nc("@info:progress", "Copying XFS file systems with an external log is not supported.");
+        return false;
+    }
+
     ExternalCommand cmd(report, QStringLiteral("xfs_copy"), { sourceDeviceNode, targetDeviceNode });
 
     // xfs_copy behaves a little strangely. It apparently kills itself at the end of main, causing QProcess
@@ -152,6 +250,30 @@ bool xfs::copy(Report& report, const QString& targetDeviceNode, const QString& s
     return cmd.exitCode() == 0;
 }
 
+bool xfs::backup(Report& report, const Device& sourceDevice, const QString& deviceNode, const QString& filename) const
+{
+    Q_UNUSED(sourceDevice)
+
+    if (hasExternalJournal()) {
+        report.line() << xi18nc("@info:progress", "Backing up XFS file systems with an external log is not supported.");
+        return false;
+    }
+
+    // -d keeps the UUID, so the restored file system is a true clone. See copy() for the exit status.
+    ExternalCommand cmd(report, QStringLiteral("xfs_copy"), { QStringLiteral("-d"), deviceNode, filename });
+    cmd.run(-1);
+    return cmd.exitCode() == 0;
+}
+
+bool xfs::restore(Report& report, const Device& targetDevice, const QString& deviceNode, const QString& filename) const
+{
+    Q_UNUSED(targetDevice)
+
+    ExternalCommand cmd(report, QStringLiteral("xfs_copy"), { QStringLiteral("-d"), filename, deviceNode });
+    cmd.run(-1);
+    return cmd.exitCode() == 0;
+}
+
 bool xfs::resize(Report& report, const QString& deviceNode, qint64) const
 {
     QTemporaryDir tempDir;
@@ -162,7 +284,12 @@ bool xfs::resize(Report& report, const QString& deviceNode, qint64) const
 
     bool rval = false;
 
-    ExternalCommand mountCmd(report, QStringLiteral("mount"), { QStringLiteral("--verbose"), QStringLiteral("--types"), QStringLiteral("xfs"), deviceNode, tempDir.path() });
+    QStringList mountArgs = { QStringLiteral("--verbose"), QStringLiteral("--types"), QStringLiteral("xfs") };
+    if (!externalJournal().isEmpty())
+        mountArgs << QStringLiteral("--options") << QStringLiteral("logdev=") + externalJournal();
+    mountArgs << deviceNode << tempDir.path();
+
+    ExternalCommand mountCmd(report, QStringLiteral("mount"), mountArgs);
 
     if (mountCmd.run(-1)) {
         ExternalCommand resizeCmd(report, QStringLiteral("xfs_growfs"), { tempDir.path() });
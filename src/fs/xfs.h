@@ -33,11 +33,14 @@ public:
 
 public:
     void init() override;
+    void scan(const QString& deviceNode) override;
 
     qint64 readUsedCapacity(const QString& deviceNode) const override;
     bool check(Report& report, const QString& deviceNode) const override;
     bool create(Report& report, const QString& deviceNode) override;
     bool copy(Report& report, const QString&, const QString&) const override;
+    bool backup(Report& report, const Device& sourceDevice, const QString& deviceNode, const QString& filename) const override;
+    bool restore(Report& report, const Device& targetDevice, const QString& deviceNode, const QString& filename) const override;
     bool resize(Report& report, const QString& deviceNode, qint64 length) const override;
     bool resizeOnline(Report& report, const QString& deviceNode, const QString& mountPoint, qint64 length) const override;
     bool writeLabel(Report& report, const QString& deviceNode, const QString& newLabel) override;
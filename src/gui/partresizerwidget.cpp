@@ -26,6 +26,7 @@
 #include <QMouseEvent>
 #include <QPaintEvent>
 #include <QResizeEvent>
+#include <QScreen>
 #include <QStyleOptionToolBar>
 #include <QStyleOptionFrame>
 #include <QStyleOptionButton>
@@ -53,10 +54,16 @@ PartResizerWidget::PartResizerWidget(QWidget* parent) :
     m_RightHandle(this),
     m_DraggedWidget(nullptr),
     m_Hotspot(0),
+    m_DragX(0),
+    m_DragTimer(this),
     m_MoveAllowed(true),
     m_ReadOnly(false),
     m_Align(true)
 {
+    // Aligning and updating the dialog on every mouse move is too slow on huge devices, moves
+    // are only applied once per frame
+    m_DragTimer.setSingleShot(true);
+    connect(&m_DragTimer, &QTimer::timeout, this, &PartResizerWidget::applyDrag);
 }
 
 /** Intializes the PartResizerWidget
@@ -280,7 +287,18 @@ bool PartResizerWidget::movePartition(qint64 newFirstSector)
 
 void PartResizerWidget::mouseMoveEvent(QMouseEvent* event)
 {
-    int x = event->pos().x() - m_Hotspot;
+    m_DragX = event->pos().x() - m_Hotspot;
+
+    if (!m_DragTimer.isActive()) {
+        const qreal refreshRate = screen() ? screen()->refreshRate() : 60;
+        m_DragTimer.start(static_cast<int>(1000 / std::max(refreshRate, 1.0)));
+    }
+}
+
+/** Applies the last mouse position of a drag. */
+void PartResizerWidget::applyDrag()
+{
+    const int x = m_DragX;
 
     if (draggedWidget() == &leftHandle()) {
         const qint64 newFirstSector = static_cast<qint64>(std::max(minimumFirstSector() + x * sectorsPerPixel(), 0.0L));
@@ -296,8 +314,13 @@ void PartResizerWidget::mouseMoveEvent(QMouseEvent* event)
 
 void PartResizerWidget::mouseReleaseEvent(QMouseEvent* event)
 {
-    if (event->button() == Qt::LeftButton)
+    if (event->button() == Qt::LeftButton) {
+        if (m_DragTimer.isActive()) {
+            m_DragTimer.stop();
+            applyDrag();
+        }
         m_DraggedWidget = nullptr;
+    }
 }
 
 bool PartResizerWidget::updateFirstSector(qint64 newFirstSector)
@@ -16,6 +16,7 @@
 
 #include <QWidget>
 #include <QLabel>
+#include <QTimer>
 
 class PartWidget;
 class Device;
@@ -180,6 +181,8 @@ protected:
 
     bool checkConstraints(qint64 first, qint64 last) const;
 
+    void applyDrag();
+
 private:
     Device* m_Device;
     Partition* m_Partition;
@@ -197,6 +200,8 @@ private:
 
     QWidget* m_DraggedWidget;
     int m_Hotspot;
+    int m_DragX;
+    QTimer m_DragTimer;
 
     bool m_MoveAllowed;
     bool m_ReadOnly;
@@ -14,6 +14,8 @@
 #include "fs/filesystem.h"
 #include "util/capacity.h"
 
+#include <KLocalizedString>
+
 #include <QApplication>
 #include <QFontDatabase>
 #include <QPainter>
@@ -26,7 +28,8 @@
 PartWidget::PartWidget(QWidget* parent, Partition* p) :
     PartWidgetBase(parent),
     m_Partition(nullptr),
-    m_Active(false)
+    m_Active(false),
+    m_AggregatedCount(1)
 {
     setFont(QFontDatabase::systemFont(QFontDatabase::SmallestReadableFont));
     init(p);
@@ -37,10 +40,7 @@ void PartWidget::init(Partition* p)
 {
     m_Partition = p;
 
-    if (partition())
-        setToolTip(partition()->deviceNode() + QStringLiteral("\n") + partition()->fileSystem().name() + QStringLiteral(" ") + QString(Capacity::formatByteSize(partition()->capacity())));
-    else
-        setToolTip(QString());
+    setToolTip(toolTipText());
 
     updateChildren();
 }
@@ -57,13 +57,52 @@ void PartWidget::updateChildren()
 
         for (const auto &child : partition()->children()) {
             QWidget* w = new PartWidget(this, child);
-            w->setVisible(true);
+            w->setVisible(aggregatedCount() <= 1);
         }
 
-        positionChildren(this, partition()->children(), childWidgets());
+        if (aggregatedCount() <= 1)
+            positionChildren(this, partition()->children(), childWidgets());
     }
 }
 
+/** Sets how many partitions this widget shows.
+
+    Partitions too small to be shown on their own are merged with their neighbours. The widget
+    of the first one of them shows all of them and the widgets of the others are hidden. The
+    widgets of the children of merged partitions are hidden as well.
+
+    @param count the number of consecutive partitions to show, 0 to hide this widget
+*/
+void PartWidget::setAggregatedCount(qint32 count)
+{
+    if (count == m_AggregatedCount)
+        return;
+
+    const bool wasHidden = m_AggregatedCount == 0;
+    const bool wasAggregated = m_AggregatedCount > 1;
+    m_AggregatedCount = count;
+
+    if (count == 0)
+        setVisible(false);
+    else if (wasHidden)
+        setVisible(true);
+
+    if ((count > 1) != wasAggregated) {
+        // children were not positioned while this widget was merged
+        if (count <= 1 && partition())
+            positionChildren(this, partition()->children(), childWidgets());
+
+        for (const auto &w : childWidgets())
+            w->setVisible(count <= 1 && w->aggregatedCount() > 0);
+    }
+
+    // an empty tool tip was set on purpose, e.g. by PartResizerWidget
+    if (!toolTip().isEmpty())
+        setToolTip(toolTipText());
+
+    update();
+}
+
 void PartWidget::setFileSystemColorCode(const std::vector<QColor>& colorCode)
 {
     m_fileSystemColorCode = colorCode;
@@ -72,7 +111,7 @@ void PartWidget::setFileSystemColorCode(const std::vector<QColor>& colorCode)
 
 void PartWidget::resizeEvent(QResizeEvent*)
 {
-    if (partition())
+    if (partition() && aggregatedCount() <= 1)
         positionChildren(this, partition()->children(), childWidgets());
 }
 
@@ -81,6 +120,18 @@ QColor PartWidget::activeColor(const QColor& col) const
     return isActive() ? col.darker(190) : col;
 }
 
+/** @return the tool tip for the partitions this widget shows, empty if it shows none */
+QString PartWidget::toolTipText() const
+{
+    if (partition() == nullptr)
+        return QString();
+
+    if (aggregatedCount() > 1)
+        return xi18ncp("@info:tooltip", "%1 partition starting with <filename>%2</filename>", "%1 partitions starting with <filename>%2</filename>", aggregatedCount(), partition()->deviceNode());
+
+    return partition()->deviceNode() + QStringLiteral("\n") + partition()->fileSystem().name() + QStringLiteral(" ") + QString(Capacity::formatByteSize(partition()->capacity()));
+}
+
 void PartWidget::paintEvent(QPaintEvent*)
 {
     if (partition() == nullptr)
@@ -96,6 +147,17 @@ void PartWidget::paintEvent(QPaintEvent*)
     QPainter painter(this);
     painter.setRenderHints(QPainter::Antialiasing);
 
+    // many small partitions, too narrow to show any details
+    if (aggregatedCount() > 1) {
+        drawGradient(&painter, activeColor(palette().color(QPalette::Mid)), QRect(0, 0, width(), height()), isActive());
+
+        const QString text = i18ncp("@info:status", "%1\npartition", "%1\npartitions", aggregatedCount());
+        const QRect textRect(0, 0, width() - 1, height() - 1);
+        if (painter.boundingRect(textRect, Qt::AlignCenter, text).x() > PartWidgetBase::borderWidth())
+            painter.drawText(textRect, Qt::AlignCenter, text);
+        return;
+    }
+
     const QColor base = activeColor(m_fileSystemColorCode[ static_cast<int>(partition()->fileSystem().type()) ]);
     if (partition()->roles().has(PartitionRole::Extended)) {
         drawGradient(&painter, base, QRect(0, 0, width(), height()));
@@ -45,6 +45,11 @@ public:
     }
     void updateChildren();
 
+    void setAggregatedCount(qint32 count);
+    qint32 aggregatedCount() const {
+        return m_AggregatedCount;    /**< @return the number of partitions this widget shows, 0 if it is hidden in another widget */
+    }
+
     Partition* partition() {
         return m_Partition;    /**< @return the widget's Partition */
     }
@@ -60,12 +65,14 @@ protected:
     void resizeEvent(QResizeEvent* event) override;
 
     QColor activeColor(const QColor& col) const;
+    QString toolTipText() const;
 
     void drawGradient(QPainter* painter, const QColor& color, const QRect& rect, bool active = false) const;
 
 private:
     Partition* m_Partition;
     bool m_Active;
+    qint32 m_AggregatedCount;
     std::vector<QColor> m_fileSystemColorCode;
 };
 
@@ -12,6 +12,7 @@
 
 #include "core/partition.h"
 
+#include <algorithm>
 #include <cmath>
 
 const qint32 PartWidgetBase::m_Spacing = 2;
@@ -86,51 +87,120 @@ bool levelChildrenWidths(QList<qint32>& childrenWidth, const QList<qint32>& minC
     return true;
 }
 
+/** Groups partitions that are too small to be shown on their own.
+
+    Devices with hundreds of partitions or logical volumes cannot show every one of them at
+    its minimum width. Runs of partitions narrower than the minimum width are merged into one
+    entry then and if there are still too many entries, the narrowest ones are merged with their
+    neighbours until all of them fit.
+
+    @return the number of consecutive partitions making up each entry
+*/
+QList<qint32> PartWidgetBase::groupPartitions(const PartitionNode::Partitions& partitions, qint64 totalLength, qint32 availableWidth) const
+{
+    const qint32 maxEntries = std::max(1, (availableWidth + spacing()) / (minWidth() + spacing()));
+
+    QList<qint32> groups;
+    if (partitions.size() <= maxEntries) {
+        for (int i = 0; i < partitions.size(); i++)
+            groups.append(1);
+        return groups;
+    }
+
+    QList<qint64> lengths;
+    bool previousSmall = false;
+    for (const auto &p : partitions) {
+        const bool small = p->length() * availableWidth / totalLength < minWidth();
+        if (small && previousSmall) {
+            groups.last()++;
+            lengths.last() += p->length();
+        } else {
+            groups.append(1);
+            lengths.append(p->length());
+        }
+        previousSmall = small;
+    }
+
+    while (groups.size() > maxEntries) {
+        const int i = std::min_element(lengths.begin(), lengths.end()) - lengths.begin();
+        int first = i;
+        if (i == groups.size() - 1 || (i > 0 && lengths[i - 1] < lengths[i + 1]))
+            first = i - 1;
+
+        groups[first] += groups[first + 1];
+        lengths[first] += lengths[first + 1];
+        groups.removeAt(first + 1);
+        lengths.removeAt(first + 1);
+    }
+
+    return groups;
+}
+
 void PartWidgetBase::positionChildren(const QWidget* destWidget, const PartitionNode::Partitions& partitions, QList<PartWidget*> widgets) const
 {
     if (partitions.size() == 0)
         return;
 
-    QList<qint32> childrenWidth;
-    QList<qint32> minChildrenWidth;
-    const qint32 destWidgetWidth = destWidget->width() - 2 * borderWidth() - (partitions.size() - 1) * spacing();
+    const qint32 availableWidth = destWidget->width() - 2 * borderWidth();
 
-    if (destWidgetWidth < 0)
+    if (availableWidth < 0)
         return;
 
+    QList<qint64> key { availableWidth };
     qint64 totalLength = 0;
-    for (const auto &p : partitions)
+    for (const auto &p : partitions) {
         totalLength += p->length();
+        key << p->length() << p->children().size();
+    }
 
     if (totalLength < 1)
         return;
 
-    // calculate unleveled width for each child and store it
-    for (const auto &p : partitions) {
-        childrenWidth.append(static_cast<qint32>(p->length() * destWidgetWidth / totalLength));
-
-        // Calculate the minimum width for the widget. This is easy for primary and logical partitions: they
-        // just have a fixed min width (configured in m_MinWidth). But for extended partitions things
-        // are not quite as simple. We need to calc the sum of the min widths for each child, taking
-        // spacing and borders into account, and add our own min width.
-        qint32 min = (minWidth() + 2 * borderWidth() + spacing()) * p->children().size() - spacing() + 2 * borderWidth();
-
-        // if it's too small, this partition is a primary or logical so just use the configured value
-        if (min < minWidth())
-            min = minWidth();
-        minChildrenWidth.append(min);
+    // Leveling the widths is expensive for many partitions, only do it if something changed
+    if (key != m_LayoutKey) {
+        m_LayoutKey = key;
+        m_LayoutGroups = groupPartitions(partitions, totalLength, availableWidth);
+        m_LayoutWidths.clear();
+        m_LayoutMinWidths.clear();
+
+        const qint32 destWidgetWidth = availableWidth - (m_LayoutGroups.size() - 1) * spacing();
+
+        // calculate unleveled width for each child and store it
+        for (int g = 0, i = 0; g < m_LayoutGroups.size(); i += m_LayoutGroups[g], g++) {
+            qint64 length = 0;
+            for (int j = i; j < i + m_LayoutGroups[g]; j++)
+                length += partitions[j]->length();
+            m_LayoutWidths.append(static_cast<qint32>(length * std::max(destWidgetWidth, 0) / totalLength));
+
+            // Calculate the minimum width for the widget. This is easy for primary and logical partitions: they
+            // just have a fixed min width (configured in m_MinWidth). But for extended partitions things
+            // are not quite as simple. We need to calc the sum of the min widths for each child, taking
+            // spacing and borders into account, and add our own min width.
+            qint32 min = (minWidth() + 2 * borderWidth() + spacing()) * partitions[i]->children().size() - spacing() + 2 * borderWidth();
+
+            // if it's too small, this partition is a primary or logical so just use the configured value;
+            // merged partitions are only shown as one block and do not need room for children either
+            if (min < minWidth() || m_LayoutGroups[g] > 1)
+                min = minWidth();
+            m_LayoutMinWidths.append(min);
+        }
+
+        // now go level the widths as long as required
+        while (levelChildrenWidths(m_LayoutWidths, m_LayoutMinWidths, destWidgetWidth))
+            ;
     }
 
-    // now go level the widths as long as required
-    while (levelChildrenWidths(childrenWidth, minChildrenWidth, destWidgetWidth))
-        ;
+    // move the children to their positions and resize them, merged partitions are shown by the
+    // widget of the first partition of their group
+    for (int g = 0, i = 0, x = borderWidth(); g < m_LayoutGroups.size() && i < widgets.size(); i += m_LayoutGroups[g], g++) {
+        for (int j = i + 1; j < i + m_LayoutGroups[g] && j < widgets.size(); j++)
+            widgets[j]->setAggregatedCount(0);
 
-    // move the children to their positions and resize them
-    for (int i = 0, x = borderWidth(); i < widgets.size(); i++) {
-        widgets[i]->setMinimumWidth(minChildrenWidth[i]);
+        widgets[i]->setAggregatedCount(m_LayoutGroups[g]);
+        widgets[i]->setMinimumWidth(m_LayoutMinWidths[g]);
         widgets[i]->move(x, borderHeight());
-        widgets[i]->resize(childrenWidth[i], destWidget->height() - 2 * borderHeight());
-        x += childrenWidth[i] + spacing();
+        widgets[i]->resize(m_LayoutWidths[g], destWidget->height() - 2 * borderHeight());
+        x += m_LayoutWidths[g] + spacing();
     }
 }
 
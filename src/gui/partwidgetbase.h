@@ -55,6 +55,15 @@ protected:
     virtual void positionChildren(const QWidget* destWidget, const PartitionNode::Partitions& partitions, QList<PartWidget*> widgets) const;
 
 private:
+    QList<qint32> groupPartitions(const PartitionNode::Partitions& partitions, qint64 totalLength, qint32 availableWidth) const;
+
+private:
+    // layout of the last call to positionChildren(), reused while partitions and width are the same
+    mutable QList<qint64> m_LayoutKey;
+    mutable QList<qint32> m_LayoutGroups;
+    mutable QList<qint32> m_LayoutWidths;
+    mutable QList<qint32> m_LayoutMinWidths;
+
     static const qint32 m_Spacing;
     static const qint32 m_BorderWidth;
     static const qint32 m_BorderHeight;
@@ -0,0 +1,69 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/cachelogicalvolumejob.h"
+
+#include "core/partition.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+/** Creates a new CacheLogicalVolumeJob that attaches a cache.
+    @param dev the Volume Group of the Logical Volume
+    @param lv the Logical Volume to cache
+    @param fastPV the Physical Volume the cache is created on
+    @param cache type, mode and size of the cache
+*/
+CacheLogicalVolumeJob::CacheLogicalVolumeJob(LvmDevice& dev, Partition& lv, const Partition* fastPV, const LvmDevice::LVCache& cache) :
+    Job(),
+    m_Device(dev),
+    m_LogicalVolume(lv),
+    m_FastPV(fastPV),
+    m_Cache(cache),
+    m_Type(Type::Attach)
+{
+}
+
+/** Creates a new CacheLogicalVolumeJob that detaches the cache.
+    @param dev the Volume Group of the Logical Volume
+    @param lv the cached Logical Volume
+*/
+CacheLogicalVolumeJob::CacheLogicalVolumeJob(LvmDevice& dev, Partition& lv) :
+    Job(),
+    m_Device(dev),
+    m_LogicalVolume(lv),
+    m_FastPV(nullptr),
+    m_Type(Type::Detach)
+{
+}
+
+bool CacheLogicalVolumeJob::run(Report& parent)
+{
+    bool rval = false;
+
+    Report* report = jobStarted(parent);
+
+    if (type() == Type::Attach)
+        rval = LvmDevice::attachCache(*report, device(), logicalVolume(), *m_FastPV, m_Cache);
+    else
+        rval = LvmDevice::detachCache(*report, device(), logicalVolume());
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+QString CacheLogicalVolumeJob::description() const
+{
+    if (type() == Type::Detach)
+        return xi18nc("@info/plain", "Flush and detach the cache of logical volume <filename>%1</filename>", logicalVolume().partitionPath());
+
+    if (m_Cache.type == LvmDevice::LVCache::Type::WriteCache)
+        return xi18nc("@info/plain", "Attach a write cache on <filename>%2</filename> to logical volume <filename>%1</filename>", logicalVolume().partitionPath(), m_FastPV->deviceNode());
+
+    return xi18nc("@info/plain", "Attach a cache on <filename>%2</filename> to logical volume <filename>%1</filename>", logicalVolume().partitionPath(), m_FastPV->deviceNode());
+}
@@ -0,0 +1,65 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CACHELOGICALVOLUMEJOB_H
+#define KPMCORE_CACHELOGICALVOLUMEJOB_H
+
+#include "core/lvmdevice.h"
+#include "jobs/job.h"
+
+class Partition;
+class Report;
+
+class QString;
+
+/** Attach a fast-tier cache to or detach it from an LVM Logical Volume.
+    @author KPMcore contributors
+*/
+class CacheLogicalVolumeJob : public Job
+{
+
+public:
+    enum class Type {
+        Attach,
+        Detach
+    };
+
+public:
+    CacheLogicalVolumeJob(LvmDevice& dev, Partition& lv, const Partition* fastPV, const LvmDevice::LVCache& cache);
+    CacheLogicalVolumeJob(LvmDevice& dev, Partition& lv);
+
+public:
+    bool run(Report& parent) override;
+    QString description() const override;
+
+protected:
+    LvmDevice& device() {
+        return m_Device;
+    }
+    const LvmDevice& device() const {
+        return m_Device;
+    }
+
+    Partition& logicalVolume() {
+        return m_LogicalVolume;
+    }
+    const Partition& logicalVolume() const {
+        return m_LogicalVolume;
+    }
+
+    CacheLogicalVolumeJob::Type type() const {
+        return m_Type;
+    }
+
+private:
+    LvmDevice& m_Device;
+    Partition& m_LogicalVolume;
+    const Partition* m_FastPV;
+    LvmDevice::LVCache m_Cache;
+    CacheLogicalVolumeJob::Type m_Type;
+};
+
+#endif
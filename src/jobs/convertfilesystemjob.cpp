@@ -0,0 +1,92 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/convertfilesystemjob.h"
+
+#include "core/partition.h"
+
+#include "fs/btrfs.h"
+#include "fs/filesystem.h"
+
+#include "util/capacity.h"
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+/** Creates a new ConvertFileSystemJob.
+
+    Converting from ext to btrfs keeps the original file system as an image inside the btrfs,
+    converting from btrfs back to ext restores that image.
+
+    @param p the Partition the FileSystem is on
+    @param oldFs the FileSystem currently on the Partition
+    @param newFs the FileSystem it is converted to
+*/
+ConvertFileSystemJob::ConvertFileSystemJob(Partition& p, const FileSystem& oldFs, const FileSystem& newFs) :
+    Job(),
+    m_Partition(p),
+    m_OldFileSystem(oldFs),
+    m_NewFileSystem(newFs)
+{
+}
+
+bool ConvertFileSystemJob::run(Report& parent)
+{
+    bool rval = false;
+
+    Report* report = jobStarted(parent);
+
+    const QString deviceNode = partition().deviceNode();
+
+    if (isRollback()) {
+        // btrfs-convert only checks that the image is there, make sure what comes back is consistent
+        rval = FS::btrfs::rollback(*report, deviceNode) && m_NewFileSystem.check(*report, deviceNode);
+    } else {
+        // btrfs-convert refuses file systems that were not cleanly unmounted or need repair
+        rval = m_OldFileSystem.check(*report, deviceNode) && checkFreeSpace(*report) &&
+               FS::btrfs::convert(*report, deviceNode, [this] (int percent) { emitProgress(percent); });
+
+        if (!rval)
+            report->line() << xi18nc("@info:progress", "The original file system on partition <filename>%1</filename> has been left unchanged.", deviceNode);
+    }
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+/** @return true if a converted btrfs is turned back into the FileSystem it was converted from */
+bool ConvertFileSystemJob::isRollback() const
+{
+    return m_OldFileSystem.type() == FileSystem::Type::Btrfs;
+}
+
+/** Makes sure the converted file system's metadata will fit next to the data. */
+bool ConvertFileSystemJob::checkFreeSpace(Report& report) const
+{
+    const QString deviceNode = partition().deviceNode();
+    const qint64 capacity = m_OldFileSystem.length() * m_OldFileSystem.sectorSize();
+    const qint64 used = m_OldFileSystem.readUsedCapacity(deviceNode);
+
+    if (used < 0) {
+        report.line() << xi18nc("@info:progress", "Could not read the used capacity of the file system on partition <filename>%1</filename>.", deviceNode);
+        return false;
+    }
+
+    const qint64 needed = FS::btrfs::convertSpaceNeeded(used);
+    if (capacity - used >= needed)
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Not enough free space on partition <filename>%1</filename> to convert the file system: %2 needed, %3 available.",
+                            deviceNode, Capacity::formatByteSize(needed), Capacity::formatByteSize(capacity - used));
+    return false;
+}
+
+QString ConvertFileSystemJob::description() const
+{
+    return xi18nc("@info/plain", "Convert file system on partition <filename>%1</filename> from %2 to %3 in place",
+                  partition().deviceNode(), m_OldFileSystem.name(), m_NewFileSystem.name());
+}
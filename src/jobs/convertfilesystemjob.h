@@ -0,0 +1,48 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CONVERTFILESYSTEMJOB_H
+#define KPMCORE_CONVERTFILESYSTEMJOB_H
+
+#include "jobs/job.h"
+
+class FileSystem;
+class Partition;
+class Report;
+
+class QString;
+
+/** Convert a FileSystem to another type in place.
+    @author KPMcore contributors
+*/
+class ConvertFileSystemJob : public Job
+{
+
+public:
+    ConvertFileSystemJob(Partition& p, const FileSystem& oldFs, const FileSystem& newFs);
+
+public:
+    bool run(Report& parent) override;
+    QString description() const override;
+
+protected:
+    Partition& partition() {
+        return m_Partition;
+    }
+    const Partition& partition() const {
+        return m_Partition;
+    }
+
+    bool isRollback() const;
+    bool checkFreeSpace(Report& report) const;
+
+private:
+    Partition& m_Partition;
+    const FileSystem& m_OldFileSystem;
+    const FileSystem& m_NewFileSystem;
+};
+
+#endif
@@ -29,10 +29,31 @@ CopyFileSystemJob::CopyFileSystemJob(Device& targetdevice, Partition& targetpart
     m_TargetDevice(targetdevice),
     m_TargetPartition(targetpartition),
     m_SourceDevice(sourcedevice),
-    m_SourcePartition(sourcepartition)
+    m_SourcePartition(sourcepartition),
+    m_RescueMode(false),
+    m_FillBadSectors(true),
+    m_RetryPasses(1),
+    m_CloneMode(false)
 {
 }
 
+/** Copies the file system in rescue mode.
+
+    In rescue mode the file system is always copied block by block. Read errors on the
+    source do not abort copying, see Job::rescueBlocks().
+
+    @param rescueMapFile file to keep track of rescued areas in, may be empty
+    @param fillBadSectors write zeros for unreadable sectors instead of leaving holes
+    @param retryPasses number of times to retry bad sectors
+*/
+void CopyFileSystemJob::setRescueMode(const QString& rescueMapFile, bool fillBadSectors, int retryPasses)
+{
+    m_RescueMode = true;
+    m_RescueMapFile = rescueMapFile;
+    m_FillBadSectors = fillBadSectors;
+    m_RetryPasses = retryPasses;
+}
+
 qint32 CopyFileSystemJob::numSteps() const
 {
     return 100;
@@ -46,9 +67,9 @@ bool CopyFileSystemJob::run(Report& parent)
 
     if (targetPartition().fileSystem().length() < sourcePartition().fileSystem().length())
         report->line() << xi18nc("@info:progress", "Cannot copy file system: File system on target partition <filename>%1</filename> is smaller than the file system on source partition <filename>%2</filename>.", targetPartition().deviceNode(), sourcePartition().deviceNode());
-    else if (sourcePartition().fileSystem().supportCopy() == FileSystem::cmdSupportFileSystem)
+    else if (!rescueMode() && sourcePartition().fileSystem().supportCopy() == FileSystem::cmdSupportFileSystem)
         rval = sourcePartition().fileSystem().copy(*report, targetPartition().deviceNode(), sourcePartition().deviceNode());
-    else if (sourcePartition().fileSystem().supportCopy() == FileSystem::cmdSupportCore) {
+    else if (rescueMode() || cloneMode() || sourcePartition().fileSystem().supportCopy() == FileSystem::cmdSupportCore) {
         CopySourceDevice copySource(sourceDevice(), sourcePartition().fileSystem().firstByte(), sourcePartition().fileSystem().lastByte());
         CopyTargetDevice copyTarget(targetDevice(), targetPartition().fileSystem().firstByte(), targetPartition().fileSystem().lastByte());
 
@@ -57,7 +78,10 @@ bool CopyFileSystemJob::run(Report& parent)
         else if (!copyTarget.open())
             report->line() << xi18nc("@info:progress", "Could not open file system on target partition <filename>%1</filename> for copying.", targetPartition().deviceNode());
         else {
-            rval = copyBlocks(*report, copyTarget, copySource);
+            if (rescueMode())
+                rval = rescueBlocks(*report, copyTarget, copySource, sourceDevice().logicalSize(), m_RescueMapFile, m_RetryPasses, m_FillBadSectors);
+            else
+                rval = copyBlocks(*report, copyTarget, copySource);
             report->line() << xi18nc("@info:progress", "Closing device. This may take a while, especially on slow devices like Memory Sticks.");
         }
     }
@@ -68,8 +92,8 @@ bool CopyFileSystemJob::run(Report& parent)
 
         targetPartition().fileSystem().setLastSector(newLastSector);
 
-        // and set a new UUID, if the target filesystem supports UUIDs
-        if (targetPartition().fileSystem().supportUpdateUUID() == FileSystem::cmdSupportFileSystem) {
+        // and set a new UUID, if the target filesystem supports UUIDs and is not part of a clone
+        if (!cloneMode() && targetPartition().fileSystem().supportUpdateUUID() == FileSystem::cmdSupportFileSystem) {
             targetPartition().fileSystem().updateUUID(*report, targetPartition().deviceNode());
             targetPartition().fileSystem().setUUID(targetPartition().fileSystem().readUUID(targetPartition().deviceNode()));
         }
@@ -10,14 +10,13 @@
 
 #include "jobs/job.h"
 
+#include <QString>
 #include <QtGlobal>
 
 class Partition;
 class Device;
 class Report;
 
-class QString;
-
 /** Copy a FileSystem.
 
     Copy a FileSystem on a given Partition and Device to another Partition on a (possibly other) Device.
@@ -34,6 +33,18 @@ public:
     qint32 numSteps() const override;
     QString description() const override;
 
+    void setRescueMode(const QString& rescueMapFile, bool fillBadSectors, int retryPasses);
+    bool rescueMode() const {
+        return m_RescueMode;    /**< @return true if read errors on the source do not abort copying */
+    }
+
+    void setCloneMode(bool b) {
+        m_CloneMode = b;    /**< @param b if true, keep the file system UUID and copy unsupported file systems block by block */
+    }
+    bool cloneMode() const {
+        return m_CloneMode;    /**< @return true if this job is part of cloning a whole device */
+    }
+
 protected:
     Partition& targetPartition() {
         return m_TargetPartition;
@@ -68,6 +79,11 @@ private:
     Partition& m_TargetPartition;
     Device& m_SourceDevice;
     Partition& m_SourcePartition;
+    bool m_RescueMode;
+    QString m_RescueMapFile;
+    bool m_FillBadSectors;
+    int m_RetryPasses;
+    bool m_CloneMode;
 };
 
 #endif
@@ -0,0 +1,61 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/createbtrfsjob.h"
+
+#include "core/partition.h"
+
+#include "fs/btrfs.h"
+
+#include "util/report.h"
+
+#include <QStringList>
+
+#include <KLocalizedString>
+
+/** Creates a new CreateBtrfsJob
+    @param members the Partitions the file system spans, each already holding the new btrfs FileSystem
+    @param label the label of the new file system
+*/
+CreateBtrfsJob::CreateBtrfsJob(const QVector<Partition*>& members, const QString& label) :
+    Job(),
+    m_Members(members),
+    m_Label(label)
+{
+}
+
+bool CreateBtrfsJob::run(Report& parent)
+{
+    Report* report = jobStarted(parent);
+
+    QStringList deviceNodes;
+    for (const auto &p : members())
+        deviceNodes << p->deviceNode();
+
+    // All members share the profiles, the first one creates the file system for everybody
+    FS::btrfs& fs = static_cast<FS::btrfs&>(members().first()->fileSystem());
+    bool rval = fs.createMultiDevice(*report, deviceNodes, m_Label);
+
+    if (rval) {
+        const QString uuid = fs.readUUID(deviceNodes.first());
+
+        for (const auto &p : members())
+            p->fileSystem().setUUID(uuid);
+    }
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+QString CreateBtrfsJob::description() const
+{
+    QStringList deviceNodes;
+    for (const auto &p : members())
+        deviceNodes << p->deviceNode();
+
+    return xi18nc("@info:progress", "Create Btrfs file system on <filename>%1</filename>", deviceNodes.join(QStringLiteral(", ")));
+}
@@ -0,0 +1,40 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATEBTRFSJOB_H
+#define KPMCORE_CREATEBTRFSJOB_H
+
+#include "jobs/job.h"
+
+#include <QString>
+#include <QVector>
+
+class Partition;
+class Report;
+
+/** Create one btrfs file system on several Partitions.
+    @author KPMcore contributors
+*/
+class CreateBtrfsJob : public Job
+{
+public:
+    CreateBtrfsJob(const QVector<Partition*>& members, const QString& label);
+
+public:
+    bool run(Report& parent) override;
+    QString description() const override;
+
+protected:
+    const QVector<Partition*>& members() const {
+        return m_Members;
+    }
+
+private:
+    QVector<Partition*> m_Members;
+    QString m_Label;
+};
+
+#endif
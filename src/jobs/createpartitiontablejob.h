@@ -27,6 +27,9 @@ public:
 public:
     bool run(Report& parent) override;
     QString description() const override;
+    bool needsPartitionNodes() const override {
+        return false;
+    }
 
 protected:
     Device& device() {
@@ -0,0 +1,55 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/createpartitiontablelayoutjob.h"
+
+#include "backend/corebackendmanager.h"
+#include "backend/corebackenddevice.h"
+#include "backend/corebackend.h"
+
+#include "core/device.h"
+#include "core/partitiontable.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+/** Creates a new CreatePartitionTableLayoutJob
+    @param d the Device whose PartitionTable is to be written
+*/
+CreatePartitionTableLayoutJob::CreatePartitionTableLayoutJob(Device& d) :
+    Job(),
+    m_Device(d)
+{
+}
+
+bool CreatePartitionTableLayoutJob::run(Report& parent)
+{
+    bool rval = false;
+
+    Report* report = jobStarted(parent);
+
+    if (device().type() == Device::Type::Disk_Device || device().type() == Device::Type::SoftwareRAID_Device) {
+        std::unique_ptr<CoreBackendDevice> backendDevice = CoreBackendManager::self()->backend()->openDevice(device());
+
+        if (backendDevice != nullptr) {
+            Q_ASSERT(device().partitionTable());
+
+            rval = backendDevice->createPartitionTableLayout(*report, *device().partitionTable());
+        } else
+            report->line() << xi18nc("@info:progress", "Creating partition table failed: Could not open device <filename>%1</filename>.", device().deviceNode());
+    } else
+        report->line() << xi18nc("@info:progress", "Creating partition table failed: Device <filename>%1</filename> is not a disk.", device().deviceNode());
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+QString CreatePartitionTableLayoutJob::description() const
+{
+    return xi18nc("@info:progress", "Create partition table with all partitions on device <filename>%1</filename>", device().deviceNode());
+}
@@ -0,0 +1,46 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATEPARTITIONTABLELAYOUTJOB_H
+#define KPMCORE_CREATEPARTITIONTABLELAYOUTJOB_H
+
+#include "jobs/job.h"
+
+class Device;
+class Report;
+
+class QString;
+
+/** Create a PartitionTable together with all of its Partitions.
+
+    Unlike a CreatePartitionTableJob followed by a CreatePartitionJob for each Partition
+    the changes are only committed to the OS once.
+*/
+class CreatePartitionTableLayoutJob : public Job
+{
+public:
+    explicit CreatePartitionTableLayoutJob(Device& d);
+
+public:
+    bool run(Report& parent) override;
+    QString description() const override;
+    bool needsPartitionNodes() const override {
+        return false;
+    }
+
+protected:
+    Device& device() {
+        return m_Device;
+    }
+    const Device& device() const {
+        return m_Device;
+    }
+
+private:
+    Device& m_Device;
+};
+
+#endif
@@ -0,0 +1,47 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/createsnapshotjob.h"
+
+#include "core/partition.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+/** Creates a new CreateSnapshotJob
+    @param origin the Logical Volume to snapshot
+    @param name the name of the snapshot
+    @param type the kind of snapshot to create
+    @param extents size of a copy-on-write snapshot in extents, 0 for the size of the origin
+*/
+CreateSnapshotJob::CreateSnapshotJob(const Partition& origin, const QString& name, LvmDevice::SnapshotType type, qint64 extents) :
+    Job(),
+    m_Origin(origin),
+    m_Name(name),
+    m_Type(type),
+    m_Extents(extents)
+{
+}
+
+bool CreateSnapshotJob::run(Report& parent)
+{
+    Report* report = jobStarted(parent);
+
+    const bool rval = LvmDevice::createLVSnapshot(*report, origin(), m_Name, m_Type, m_Extents);
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+QString CreateSnapshotJob::description() const
+{
+    if (m_Type == LvmDevice::SnapshotType::Thin)
+        return xi18nc("@info/plain", "Create thin snapshot %2 of logical volume <filename>%1</filename>", origin().partitionPath(), m_Name);
+
+    return xi18nc("@info/plain", "Create snapshot %2 of logical volume <filename>%1</filename>", origin().partitionPath(), m_Name);
+}
@@ -0,0 +1,42 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATESNAPSHOTJOB_H
+#define KPMCORE_CREATESNAPSHOTJOB_H
+
+#include "core/lvmdevice.h"
+#include "jobs/job.h"
+
+#include <QString>
+
+class Partition;
+class Report;
+
+/** Create a snapshot of an LVM Logical Volume.
+    @author KPMcore contributors
+*/
+class CreateSnapshotJob : public Job
+{
+public:
+    CreateSnapshotJob(const Partition& origin, const QString& name, LvmDevice::SnapshotType type, qint64 extents);
+
+public:
+    bool run(Report& parent) override;
+    QString description() const override;
+
+protected:
+    const Partition& origin() const {
+        return m_Origin;
+    }
+
+private:
+    const Partition& m_Origin;
+    QString m_Name;
+    LvmDevice::SnapshotType m_Type;
+    qint64 m_Extents;
+};
+
+#endif
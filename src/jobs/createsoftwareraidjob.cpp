@@ -0,0 +1,54 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/createsoftwareraidjob.h"
+
+#include "util/report.h"
+
+#include <QStringList>
+
+#include <KLocalizedString>
+
+/** Creates a new CreateSoftwareRaidJob
+    @param name the name of the array, e.g. md0
+    @param members the Partitions the array is made of
+    @param raidLevel the RAID level
+    @param chunkSize the chunk size in KiB, 0 for the mdadm default
+    @param options layout, bitmap, resync and write hole protection settings
+*/
+CreateSoftwareRaidJob::CreateSoftwareRaidJob(const QString& name, const QVector<const Partition*>& members, qint32 raidLevel, qint32 chunkSize, const SoftwareRAID::ArrayOptions& options) :
+    Job(),
+    m_Name(name),
+    m_Members(members),
+    m_RaidLevel(raidLevel),
+    m_ChunkSize(chunkSize),
+    m_Options(options)
+{
+}
+
+bool CreateSoftwareRaidJob::run(Report& parent)
+{
+    Report* report = jobStarted(parent);
+
+    QStringList devicePathList;
+    for (const auto &p : members())
+        devicePathList.append(p->partitionPath());
+
+    const bool rval = SoftwareRAID::createSoftwareRAID(*report, name(), devicePathList, m_RaidLevel, m_ChunkSize, m_Options);
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+QString CreateSoftwareRaidJob::description() const
+{
+    QStringList devices;
+    for (const auto &p : members())
+        devices.append(p->deviceNode());
+
+    return xi18nc("@info/plain", "Create a new RAID %1 array: <filename>/dev/%2</filename> with members: %3", m_RaidLevel, name(), devices.join(QStringLiteral(", ")));
+}
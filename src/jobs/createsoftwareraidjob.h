@@ -0,0 +1,52 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATESOFTWARERAIDJOB_H
+#define KPMCORE_CREATESOFTWARERAIDJOB_H
+
+#include "core/partition.h"
+#include "core/raid/softwareraid.h"
+#include "jobs/job.h"
+
+#include <QVector>
+
+class Report;
+
+class QString;
+
+/** Create a software RAID array.
+
+    The member Partitions may still be to be created when the Job is set up, their device
+    nodes are only looked up when it runs.
+
+    @author KPMcore contributors
+*/
+class CreateSoftwareRaidJob : public Job
+{
+public:
+    CreateSoftwareRaidJob(const QString& name, const QVector<const Partition*>& members, qint32 raidLevel, qint32 chunkSize, const SoftwareRAID::ArrayOptions& options);
+
+public:
+    bool run(Report& parent) override;
+    QString description() const override;
+
+protected:
+    const QString& name() const {
+        return m_Name;
+    }
+    const QVector<const Partition*>& members() const {
+        return m_Members;
+    }
+
+private:
+    QString m_Name;
+    QVector<const Partition*> m_Members;
+    qint32 m_RaidLevel;
+    qint32 m_ChunkSize;
+    SoftwareRAID::ArrayOptions m_Options;
+};
+
+#endif
@@ -0,0 +1,46 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/createthinpooljob.h"
+
+#include "core/lvmdevice.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+/** Creates a new CreateThinPoolJob
+    @param d the Volume Group to create the pool in
+    @param name the name of the new thin pool
+    @param extents size of the pool data in extents
+    @param metadataSize size of the pool metadata in MiB, 0 lets LVM choose it
+    @param chunkSize chunk size in KiB, 0 for the LVM default
+*/
+CreateThinPoolJob::CreateThinPoolJob(LvmDevice& d, const QString& name, qint64 extents, qint64 metadataSize, qint64 chunkSize) :
+    Job(),
+    m_Device(d),
+    m_Name(name),
+    m_Extents(extents),
+    m_MetadataSize(metadataSize),
+    m_ChunkSize(chunkSize)
+{
+}
+
+bool CreateThinPoolJob::run(Report& parent)
+{
+    Report* report = jobStarted(parent);
+
+    const bool rval = LvmDevice::createThinPool(*report, device(), m_Name, m_Extents, m_MetadataSize, m_ChunkSize);
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+QString CreateThinPoolJob::description() const
+{
+    return xi18nc("@info/plain", "Create thin pool %2 in volume group <filename>%1</filename>", device().name(), m_Name);
+}
@@ -0,0 +1,45 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATETHINPOOLJOB_H
+#define KPMCORE_CREATETHINPOOLJOB_H
+
+#include "jobs/job.h"
+
+#include <QString>
+
+class LvmDevice;
+class Report;
+
+/** Create an LVM thin pool.
+    @author KPMcore contributors
+*/
+class CreateThinPoolJob : public Job
+{
+public:
+    CreateThinPoolJob(LvmDevice& d, const QString& name, qint64 extents, qint64 metadataSize, qint64 chunkSize);
+
+public:
+    bool run(Report& parent) override;
+    QString description() const override;
+
+protected:
+    LvmDevice& device() {
+        return m_Device;
+    }
+    const LvmDevice& device() const {
+        return m_Device;
+    }
+
+private:
+    LvmDevice& m_Device;
+    QString m_Name;
+    qint64 m_Extents;
+    qint64 m_MetadataSize;
+    qint64 m_ChunkSize;
+};
+
+#endif
@@ -0,0 +1,44 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/createthinvolumejob.h"
+
+#include "core/lvmdevice.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+/** Creates a new CreateThinVolumeJob
+    @param d the Volume Group of the thin pool
+    @param pool the name of the thin pool
+    @param name the name of the new Logical Volume
+    @param size virtual size of the new Logical Volume in bytes
+*/
+CreateThinVolumeJob::CreateThinVolumeJob(LvmDevice& d, const QString& pool, const QString& name, qint64 size) :
+    Job(),
+    m_Device(d),
+    m_Pool(pool),
+    m_Name(name),
+    m_Size(size)
+{
+}
+
+bool CreateThinVolumeJob::run(Report& parent)
+{
+    Report* report = jobStarted(parent);
+
+    const bool rval = LvmDevice::createThinLV(*report, device(), m_Pool, m_Name, m_Size);
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+QString CreateThinVolumeJob::description() const
+{
+    return xi18nc("@info/plain", "Create thin logical volume %2 in pool <filename>%1</filename>", device().deviceNode() + QLatin1Char('/') + m_Pool, m_Name);
+}
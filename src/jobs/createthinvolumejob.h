@@ -0,0 +1,44 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATETHINVOLUMEJOB_H
+#define KPMCORE_CREATETHINVOLUMEJOB_H
+
+#include "jobs/job.h"
+
+#include <QString>
+
+class LvmDevice;
+class Report;
+
+/** Create a thin LVM Logical Volume in a thin pool.
+    @author KPMcore contributors
+*/
+class CreateThinVolumeJob : public Job
+{
+public:
+    CreateThinVolumeJob(LvmDevice& d, const QString& pool, const QString& name, qint64 size);
+
+public:
+    bool run(Report& parent) override;
+    QString description() const override;
+
+protected:
+    LvmDevice& device() {
+        return m_Device;
+    }
+    const LvmDevice& device() const {
+        return m_Device;
+    }
+
+private:
+    LvmDevice& m_Device;
+    QString m_Pool;
+    QString m_Name;
+    qint64 m_Size;
+};
+
+#endif
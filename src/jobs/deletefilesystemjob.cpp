@@ -88,6 +88,12 @@ bool DeleteFileSystemJob::run(Report& parent)
     return rval;
 }
 
+/** @return true if the file system is removed with its own tools, others only lose their signatures */
+bool DeleteFileSystemJob::needsPartitionNodes() const
+{
+    return partition().fileSystem().type() == FileSystem::Type::Lvm2_PV || partition().fileSystem().type() == FileSystem::Type::Zfs;
+}
+
 QString DeleteFileSystemJob::description() const
 {
     return xi18nc("@info:progress", "Delete file system on <filename>%1</filename>", partition().deviceNode());
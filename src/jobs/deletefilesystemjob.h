@@ -30,6 +30,7 @@ public:
 public:
     bool run(Report& parent) override;
     QString description() const override;
+    bool needsPartitionNodes() const override;
 
 protected:
     Partition& partition() {
@@ -0,0 +1,131 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/fanoutcopyfilesystemjob.h"
+
+#include "core/partition.h"
+#include "core/device.h"
+#include "core/copysourcedevice.h"
+#include "core/copytargetdevice.h"
+
+#include "fs/filesystem.h"
+
+#include "util/report.h"
+
+#include <QStringList>
+
+#include <KLocalizedString>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+/** Creates a new FanOutCopyFileSystemJob
+    @param sourcedevice the Device the source FileSystem is on
+    @param sourcepartition the Partition the source FileSystem is on
+    @param targets the Devices and Partitions the FileSystem is to be copied to
+*/
+FanOutCopyFileSystemJob::FanOutCopyFileSystemJob(Device& sourcedevice, Partition& sourcepartition, const QVector<Target>& targets) :
+    Job(),
+    m_SourceDevice(sourcedevice),
+    m_SourcePartition(sourcepartition),
+    m_Targets(targets)
+{
+}
+
+qint32 FanOutCopyFileSystemJob::numSteps() const
+{
+    return 100;
+}
+
+bool FanOutCopyFileSystemJob::run(Report& parent)
+{
+    bool rval = false;
+
+    Report* report = jobStarted(parent);
+
+    m_FailedTargets.clear();
+
+    CopySourceDevice copySource(sourceDevice(), sourcePartition().fileSystem().firstByte(), sourcePartition().fileSystem().lastByte());
+
+    // Targets that cannot take the file system are failed right away, the others are copied to
+    std::vector<std::unique_ptr<CopyTargetDevice>> copyTargets;
+    QList<CopyTarget*> openTargets;
+    QList<int> openIndexes;
+
+    for (int i = 0; i < targets().size(); ++i) {
+        Partition& p = *targets()[i].second;
+        copyTargets.push_back(std::make_unique<CopyTargetDevice>(*targets()[i].first, p.fileSystem().firstByte(), p.fileSystem().lastByte()));
+
+        if (p.fileSystem().length() < sourcePartition().fileSystem().length()) {
+            report->line() << xi18nc("@info:progress", "Cannot copy file system: File system on target partition <filename>%1</filename> is smaller than the file system on source partition <filename>%2</filename>.", p.deviceNode(), sourcePartition().deviceNode());
+            m_FailedTargets.append(i);
+        } else if (!copyTargets.back()->open()) {
+            report->line() << xi18nc("@info:progress", "Could not open file system on target partition <filename>%1</filename> for copying.", p.deviceNode());
+            m_FailedTargets.append(i);
+        } else {
+            openTargets.append(copyTargets.back().get());
+            openIndexes.append(i);
+        }
+    }
+
+    if (!copySource.open())
+        report->line() << xi18nc("@info:progress", "Could not open file system on source partition <filename>%1</filename> for copying.", sourcePartition().deviceNode());
+    else if (!openTargets.isEmpty()) {
+        QList<int> failed;
+        rval = copyBlocks(*report, openTargets, copySource, failed);
+
+        for (const auto &index : std::as_const(failed))
+            m_FailedTargets.append(openIndexes[index]);
+
+        report->line() << xi18nc("@info:progress", "Closing device. This may take a while, especially on slow devices like Memory Sticks.");
+    }
+
+    std::sort(m_FailedTargets.begin(), m_FailedTargets.end());
+
+    for (int i = 0; i < targets().size(); ++i) {
+        Partition& p = *targets()[i].second;
+
+        if (m_FailedTargets.contains(i)) {
+            report->line() << xi18nc("@info:progress", "Copying to target partition <filename>%1</filename> failed.", p.deviceNode());
+            continue;
+        }
+
+        // set the target file system to the length of the source
+        p.fileSystem().setLastSector(p.fileSystem().firstSector() + sourcePartition().fileSystem().length() - 1);
+
+        // give each copy its own UUID, if the file system supports that; a copy that keeps the
+        // UUID of the source must not be used alongside it
+        if (p.fileSystem().supportUpdateUUID() == FileSystem::cmdSupportFileSystem) {
+            const bool updated = p.fileSystem().updateUUID(*report, p.deviceNode());
+            p.fileSystem().setUUID(p.fileSystem().readUUID(p.deviceNode()));
+
+            if (!updated) {
+                report->line() << xi18nc("@info:progress", "Could not set a new UUID for the file system on target partition <filename>%1</filename>.", p.deviceNode());
+                m_FailedTargets.append(i);
+                continue;
+            }
+        }
+
+        if (!p.fileSystem().updateBootSector(*report, p.deviceNode()))
+            m_FailedTargets.append(i);
+    }
+
+    rval = rval && m_FailedTargets.size() < targets().size();
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+QString FanOutCopyFileSystemJob::description() const
+{
+    QStringList targetNodes;
+    for (const auto &target : targets())
+        targetNodes.append(target.second->deviceNode());
+
+    return xi18nc("@info:progress", "Copy file system on partition <filename>%1</filename> to partitions %2", sourcePartition().deviceNode(), targetNodes.join(QStringLiteral(", ")));
+}
@@ -0,0 +1,71 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_FANOUTCOPYFILESYSTEMJOB_H
+#define KPMCORE_FANOUTCOPYFILESYSTEMJOB_H
+
+#include "jobs/job.h"
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+class Partition;
+class Device;
+class Report;
+
+/** Copy a FileSystem to several Partitions at once.
+
+    The source is read only once and written to all targets in parallel. A target that fails
+    is dropped and the others are copied to without it.
+
+    @author KPMcore contributors
+*/
+class FanOutCopyFileSystemJob : public Job
+{
+public:
+    using Target = QPair<Device*, Partition*>;
+
+    FanOutCopyFileSystemJob(Device& sourcedevice, Partition& sourcepartition, const QVector<Target>& targets);
+
+public:
+    bool run(Report& parent) override;
+    qint32 numSteps() const override;
+    QString description() const override;
+
+    const QList<int>& failedTargets() const {
+        return m_FailedTargets;    /**< @return indexes of the targets that did not receive all data or could not get a new UUID or boot sector in the last run */
+    }
+
+protected:
+    Partition& sourcePartition() {
+        return m_SourcePartition;
+    }
+    const Partition& sourcePartition() const {
+        return m_SourcePartition;
+    }
+
+    Device& sourceDevice() {
+        return m_SourceDevice;
+    }
+    const Device& sourceDevice() const {
+        return m_SourceDevice;
+    }
+
+    const QVector<Target>& targets() const {
+        return m_Targets;
+    }
+
+private:
+    Device& m_SourceDevice;
+    Partition& m_SourcePartition;
+    QVector<Target> m_Targets;
+    QList<int> m_FailedTargets;
+};
+
+#endif
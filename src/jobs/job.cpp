@@ -18,12 +18,16 @@
 #include "util/externalcommand.h"
 #include "util/report.h"
 
+#include <QFile>
 #include <QIcon>
 #include <QTime>
 #include <QVariantMap>
+#include <QVector>
 
 #include <KLocalizedString>
 
+#include <memory>
+
 Job::Job() :
     m_Report(nullptr),
     m_Status(Status::Pending)
@@ -39,6 +43,30 @@ bool Job::copyBlocks(Report& report, CopyTarget& target, CopySource& source)
     return copyCmd.copyBlocks(source, target);
 }
 
+/** Copies data to several targets at once, reading the source only once.
+    @param report the Report to write output to
+    @param targets the CopyTargets to write to
+    @param source the CopySource to read from
+    @param failedTargets indexes into @p targets of the targets that did not receive all data
+    @return true if at least one target received all data
+*/
+bool Job::copyBlocks(Report& report, const QList<CopyTarget*>& targets, CopySource& source, QList<int>& failedTargets)
+{
+    m_Report = &report;
+    ExternalCommand copyCmd;
+    connect(&copyCmd, &ExternalCommand::progress, this, &Job::progress, Qt::QueuedConnection);
+    connect(&copyCmd, &ExternalCommand::reportSignal, this, &Job::updateReport, Qt::QueuedConnection);
+    // the overall progress is that of the slowest target, log each change of the others
+    auto percents = std::make_shared<QVector<int>>(targets.size(), -1);
+    connect(&copyCmd, &ExternalCommand::targetProgress, this, [this, targets, percents] (int index, int percent) {
+        if (index < 0 || index >= targets.size() || (*percents)[index] == percent)
+            return;
+        (*percents)[index] = percent;
+        updateReport(xi18nc("@info:progress", "Target <filename>%1</filename> at byte %2: %3% copied.", targets[index]->path(), targets[index]->firstByte(), percent));
+    }, Qt::QueuedConnection);
+    return copyCmd.copyBlocks(source, targets, failedTargets);
+}
+
 bool Job::rollbackCopyBlocks(Report& report, CopyTarget& origTarget, CopySource& origSource)
 {
     if (!origSource.overlaps(origTarget)) {
@@ -89,6 +117,56 @@ bool Job::rollbackCopyBlocks(Report& report, CopyTarget& origTarget, CopySource&
     return false;
 }
 
+/** Copies data from a failing source, continuing after read errors.
+
+    The state of the rescue is kept in a map file, so that running the copy again only
+    retries the areas that could not be read before.
+
+    @param report the Report to write output to
+    @param target the CopyTarget to write to
+    @param source the CopySource to rescue data from
+    @param sectorSize the logical sector size of the source
+    @param rescueMapFile file to load the rescue map from and save it to, may be empty
+    @param retryPasses number of times to retry bad sectors
+    @param fillBadSectors write zeros for unreadable sectors instead of leaving holes
+    @return true if all readable data was copied
+*/
+bool Job::rescueBlocks(Report& report, CopyTarget& target, CopySource& source, qint64 sectorSize, const QString& rescueMapFile, int retryPasses, bool fillBadSectors)
+{
+    m_Report = &report;
+
+    QByteArray rescueMap;
+    QFile mapFile(rescueMapFile);
+    if (!rescueMapFile.isEmpty() && mapFile.exists()) {
+        if (mapFile.open(QIODevice::ReadOnly)) {
+            rescueMap = mapFile.readAll();
+            mapFile.close();
+            report.line() << xi18nc("@info:progress", "Continuing rescue using map file <filename>%1</filename>.", rescueMapFile);
+        }
+        else
+            report.line() << xi18nc("@info:progress", "Could not read rescue map file <filename>%1</filename>.", rescueMapFile);
+    }
+
+    auto saveMap = [&mapFile, &rescueMapFile] (const QByteArray& map) {
+        if (rescueMapFile.isEmpty())
+            return;
+        if (mapFile.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            mapFile.write(map);
+            mapFile.close();
+        }
+    };
+
+    ExternalCommand rescueCmd;
+    connect(&rescueCmd, &ExternalCommand::progress, this, &Job::progress, Qt::QueuedConnection);
+    connect(&rescueCmd, &ExternalCommand::reportSignal, this, &Job::updateReport, Qt::QueuedConnection);
+    connect(&rescueCmd, &ExternalCommand::rescueMapChanged, this, saveMap);
+
+    const bool rval = rescueCmd.rescueBlocks(source, target, sectorSize, rescueMap, retryPasses, fillBadSectors);
+    saveMap(rescueMap);
+
+    return rval;
+}
+
 void Job::emitProgress(int i)
 {
     Q_EMIT progress(i);
@@ -13,6 +13,7 @@
 
 #include "util/libpartitionmanagerexport.h"
 
+#include <QList>
 #include <QObject>
 #include <QtGlobal>
 
@@ -61,6 +62,9 @@ public:
         return 1;    /**< @return the number of steps the job takes to complete */
     }
     virtual QString description() const = 0; /**< @return the Job's description */
+    virtual bool needsPartitionNodes() const {
+        return true;    /**< @return true if the Job runs external tools on the device nodes of partitions */
+    }
     virtual bool run(Report& parent) = 0; /**< @param parent parent Report to add new child to for this Job @return true if successfully run */
 
     virtual QString statusIcon() const;
@@ -75,7 +79,9 @@ public:
 
 protected:
     bool copyBlocks(Report& report, CopyTarget& target, CopySource& source);
+    bool copyBlocks(Report& report, const QList<CopyTarget*>& targets, CopySource& source, QList<int>& failedTargets);
     bool rollbackCopyBlocks(Report& report, CopyTarget& origTarget, CopySource& origSource);
+    bool rescueBlocks(Report& report, CopyTarget& target, CopySource& source, qint64 sectorSize, const QString& rescueMapFile, int retryPasses, bool fillBadSectors);
 
     Report* jobStarted(Report& parent);
     void jobFinished(Report& report, bool b);
@@ -0,0 +1,91 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "jobs/reencryptjob.h"
+
+#include "core/partition.h"
+
+#include "fs/filesystem.h"
+
+#include "util/report.h"
+
+#include <KLocalizedString>
+
+/** Creates a new ReencryptJob.
+    @param p the Partition to work on
+    @param type what to do with the Partition
+    @param fs the plain FileSystem to encrypt or the LUKS2 FileSystem to re-encrypt or decrypt
+    @param passphrase the new passphrase when encrypting, an existing one otherwise
+    @param options cipher and resilience settings
+*/
+ReencryptJob::ReencryptJob(Partition& p, FS::luks2::ReencryptMode type, const FileSystem& fs, const QString& passphrase, const FS::luks2::ReencryptOptions& options) :
+    Job(),
+    m_Partition(p),
+    m_Type(type),
+    m_FileSystem(fs),
+    m_Passphrase(passphrase),
+    m_Options(options)
+{
+}
+
+bool ReencryptJob::run(Report& parent)
+{
+    bool rval = false;
+
+    Report* report = jobStarted(parent);
+
+    const auto forwardProgress = [this] (int percent) { emitProgress(percent); };
+    const QString deviceNode = partition().partitionPath();
+
+    switch (type()) {
+    case FS::luks2::ReencryptMode::Encrypt:
+        // A resumed run already has the file system shrunk and a LUKS2 header in place
+        rval = (m_Options.resume || shrinkFileSystem(*report)) &&
+               FS::luks2::encrypt(*report, deviceNode, m_Passphrase, m_Options, forwardProgress);
+        break;
+    case FS::luks2::ReencryptMode::Reencrypt:
+        rval = FS::luks2::reencrypt(*report, deviceNode, m_Passphrase, m_Options, forwardProgress);
+        break;
+    case FS::luks2::ReencryptMode::Decrypt:
+        rval = FS::luks2::decrypt(*report, deviceNode, static_cast<const FS::luks&>(m_FileSystem).outerUuid(), m_Passphrase, m_Options, forwardProgress);
+        break;
+    }
+
+    jobFinished(*report, rval);
+
+    return rval;
+}
+
+/** Makes room for the LUKS2 header at the end of the FileSystem. */
+bool ReencryptJob::shrinkFileSystem(Report& report)
+{
+    if (m_FileSystem.type() == FileSystem::Type::Unformatted)
+        return true;
+
+    const qint64 newLength = m_FileSystem.length() * m_FileSystem.sectorSize() - FS::luks2::reencryptHeaderSize;
+
+    report.line() << xi18nc("@info:progress", "Shrinking file system on partition <filename>%1</filename> to make room for the encryption header.", partition().deviceNode());
+
+    if (m_FileSystem.resize(report, partition().partitionPath(), newLength))
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Could not shrink the file system on partition <filename>%1</filename>.", partition().deviceNode());
+    return false;
+}
+
+QString ReencryptJob::description() const
+{
+    switch (type()) {
+    case FS::luks2::ReencryptMode::Encrypt:
+        return xi18nc("@info/plain", "Encrypt partition <filename>%1</filename> in place", partition().deviceNode());
+    case FS::luks2::ReencryptMode::Reencrypt:
+        return xi18nc("@info/plain", "Re-encrypt partition <filename>%1</filename>", partition().deviceNode());
+    case FS::luks2::ReencryptMode::Decrypt:
+        break;
+    }
+
+    return xi18nc("@info/plain", "Decrypt partition <filename>%1</filename> in place", partition().deviceNode());
+}
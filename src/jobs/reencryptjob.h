@@ -0,0 +1,54 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_REENCRYPTJOB_H
+#define KPMCORE_REENCRYPTJOB_H
+
+#include "fs/luks2.h"
+#include "jobs/job.h"
+
+class FileSystem;
+class Partition;
+class Report;
+
+class QString;
+
+/** Encrypt, re-encrypt or decrypt a Partition in place.
+    @author KPMcore contributors
+*/
+class ReencryptJob : public Job
+{
+
+public:
+    ReencryptJob(Partition& p, FS::luks2::ReencryptMode type, const FileSystem& fs, const QString& passphrase, const FS::luks2::ReencryptOptions& options);
+
+public:
+    bool run(Report& parent) override;
+    QString description() const override;
+
+protected:
+    Partition& partition() {
+        return m_Partition;
+    }
+    const Partition& partition() const {
+        return m_Partition;
+    }
+
+    FS::luks2::ReencryptMode type() const {
+        return m_Type;
+    }
+
+    bool shrinkFileSystem(Report& report);
+
+private:
+    Partition& m_Partition;
+    FS::luks2::ReencryptMode m_Type;
+    const FileSystem& m_FileSystem;
+    QString m_Passphrase;
+    FS::luks2::ReencryptOptions m_Options;
+};
+
+#endif
@@ -12,6 +12,7 @@
 #include "backend/corebackenddevice.h"
 #include "backend/corebackendpartitiontable.h"
 
+#include "core/backupimage.h"
 #include "core/partition.h"
 #include "core/device.h"
 #include "core/copysourcefile.h"
@@ -44,16 +45,29 @@ qint32 RestoreFileSystemJob::numSteps() const
 
 bool RestoreFileSystemJob::run(Report& parent)
 {
-    // Restoring is file system independent because we currently have no way of
-    // detecting the file system in a given image file. We cannot even find out if the
-    // file the user gave us is a valid image file or just some junk.
+    // Images in the native format of a file system's tools are restored with those tools. Anything
+    // else is restored file system independently because we currently have no way of detecting
+    // the file system in a raw image file. We cannot even find out if the file the user gave us
+    // is a valid image file or just some junk.
 
     bool rval = false;
 
     Report* report = jobStarted(parent);
 
-    // Again, a scope for copyTarget and copySource. See MoveFileSystemJob::run()
-    {
+    const BackupImage image(fileName());
+    const FileSystem* restorer = FileSystemFactory::map().value(image.fileSystemType());
+
+    if (restorer && restorer->supportBackup() == FileSystem::cmdSupportFileSystem) {
+        rval = restorer->restore(*report, targetDevice(), targetPartition().deviceNode(), fileName());
+
+        if (rval)
+            updateFileSystem(*report, targetPartition().firstSector() + image.length() / targetPartition().sectorSize() - 1);
+    } else if (image.format() != BackupImage::Format::Raw) {
+        // Copying an image in a tool's own format would write its header, not the file system
+        const QString tool = image.format() == BackupImage::Format::NtfsClone ? QStringLiteral("ntfsclone") : QStringLiteral("e2image");
+        report->line() << xi18nc("@info:progress", "The backup file <filename>%1</filename> can only be restored with <command>%2</command>, which is not installed.", fileName(), tool);
+    } else {
+        // Again, a scope for copyTarget and copySource. See MoveFileSystemJob::run()
         // FileSystems are restored to _partitions_, so don't use first and last sector of file system here
         CopyTargetDevice copyTarget(targetDevice(), targetPartition().firstByte(), targetPartition().lastByte());
         CopySourceFile copySource(fileName());
@@ -65,34 +79,40 @@ bool RestoreFileSystemJob::run(Report& parent)
         else {
             rval = copyBlocks(*report, copyTarget, copySource);
 
-            if (rval) {
-                // create a new file system for what was restored with the length of the image file
-                const qint64 newLastSector = targetPartition().firstSector() + copySource.length() - 1;
+            // create a new file system for what was restored with the length of the image file
+            if (rval)
+                updateFileSystem(*report, targetPartition().firstSector() + copySource.length() - 1);
 
-                std::unique_ptr<CoreBackendDevice> backendDevice = CoreBackendManager::self()->backend()->openDevice(targetDevice());
+            report->line() << xi18nc("@info:progress", "Closing device. This may take a few seconds.");
+        }
+    }
 
-                FileSystem::Type t = FileSystem::Type::Unknown;
+    jobFinished(*report, rval);
 
-                if (backendDevice) {
-                    std::unique_ptr<CoreBackendPartitionTable> backendPartitionTable = backendDevice->openPartitionTable();
+    return rval;
+}
 
-                    if (backendPartitionTable)
-                        t = backendPartitionTable->detectFileSystemBySector(*report, targetDevice(), targetPartition().firstSector());
-                }
+/** Replaces the FileSystem of the target Partition with the one that was restored.
+    @param report the Report to write information to
+    @param newLastSector the last sector of the restored FileSystem
+*/
+void RestoreFileSystemJob::updateFileSystem(Report& report, qint64 newLastSector)
+{
+    std::unique_ptr<CoreBackendDevice> backendDevice = CoreBackendManager::self()->backend()->openDevice(targetDevice());
 
-                FileSystem* fs = FileSystemFactory::create(t, targetPartition().firstSector(), newLastSector, targetPartition().sectorSize());
+    FileSystem::Type t = FileSystem::Type::Unknown;
 
-                targetPartition().deleteFileSystem();
-                targetPartition().setFileSystem(fs);
-            }
+    if (backendDevice) {
+        std::unique_ptr<CoreBackendPartitionTable> backendPartitionTable = backendDevice->openPartitionTable();
 
-            report->line() << xi18nc("@info:progress", "Closing device. This may take a few seconds.");
-        }
+        if (backendPartitionTable)
+            t = backendPartitionTable->detectFileSystemBySector(report, targetDevice(), targetPartition().firstSector());
     }
 
-    jobFinished(*report, rval);
+    FileSystem* fs = FileSystemFactory::create(t, targetPartition().firstSector(), newLastSector, targetPartition().sectorSize());
 
-    return rval;
+    targetPartition().deleteFileSystem();
+    targetPartition().setFileSystem(fs);
 }
 
 QString RestoreFileSystemJob::description() const
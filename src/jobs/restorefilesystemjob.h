@@ -51,6 +51,8 @@ protected:
         return m_FileName;
     }
 
+    void updateFileSystem(Report& report, qint64 newLastSector);
+
 private:
     Device& m_TargetDevice;
     Partition& m_TargetPartition;
@@ -33,6 +33,9 @@ public:
     bool run(Report& parent) override;
     qint32 numSteps() const override;
     QString description() const override;
+    bool needsPartitionNodes() const override {
+        return false;
+    }
 
 protected:
     Device& device() {
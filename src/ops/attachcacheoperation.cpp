@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/attachcacheoperation.h"
+
+#include "jobs/cachelogicalvolumejob.h"
+
+#include "core/partition.h"
+
+#include <QString>
+
+#include <KLocalizedString>
+
+/** Creates a new AttachCacheOperation.
+    @param d the Volume Group of the Logical Volume
+    @param lv the Logical Volume to cache
+    @param fastPV the Physical Volume the cache is created on
+    @param cache type, mode and size of the cache
+*/
+AttachCacheOperation::AttachCacheOperation(LvmDevice& d, Partition& lv, const Partition& fastPV, const LvmDevice::LVCache& cache) :
+    Operation(),
+    m_Device(d),
+    m_LogicalVolume(lv),
+    m_FastPV(fastPV),
+    m_Cache(cache),
+    m_CacheJob(new CacheLogicalVolumeJob(d, lv, &fastPV, cache))
+{
+    addJob(cacheJob());
+}
+
+QString AttachCacheOperation::description() const
+{
+    if (m_Cache.type == LvmDevice::LVCache::Type::WriteCache)
+        return xi18nc("@info:status", "Attach a write cache on <filename>%2</filename> to logical volume <filename>%1</filename>", logicalVolume().partitionPath(), m_FastPV.deviceNode());
+
+    if (m_Cache.mode == LvmDevice::LVCache::Mode::WriteBack)
+        return xi18nc("@info:status", "Attach a write-back cache on <filename>%2</filename> to logical volume <filename>%1</filename>", logicalVolume().partitionPath(), m_FastPV.deviceNode());
+
+    return xi18nc("@info:status", "Attach a write-through cache on <filename>%2</filename> to logical volume <filename>%1</filename>", logicalVolume().partitionPath(), m_FastPV.deviceNode());
+}
+
+bool AttachCacheOperation::targets(const Device& d) const
+{
+    return d == device();
+}
+
+bool AttachCacheOperation::targets(const Partition& p) const
+{
+    return p == logicalVolume();
+}
+
+void AttachCacheOperation::preview()
+{
+    device().setFreePE(device().freePE() - m_Cache.extents);
+
+    // the cache goes on the fast Physical Volume only, later Operations must not count on its extents
+    device().allocatePVExtents(m_FastPV, m_Cache.extents);
+}
+
+void AttachCacheOperation::undo()
+{
+    device().setFreePE(device().freePE() + m_Cache.extents);
+    device().allocatePVExtents(m_FastPV, -m_Cache.extents);
+}
+
+/** Can a cache be attached to a Logical Volume?
+    @param d the Volume Group of the Logical Volume, can be nullptr
+    @param lv the Logical Volume to cache, can be nullptr
+    @param fastPV the Physical Volume the cache should go on, can be nullptr
+    @param cache type, mode and size of the cache
+    @return true if @p fastPV belongs to @p d, has enough free extents and @p lv is not cached yet
+*/
+bool AttachCacheOperation::canAttach(const LvmDevice* d, const Partition* lv, const Partition* fastPV, const LvmDevice::LVCache& cache)
+{
+    if (d == nullptr || lv == nullptr || fastPV == nullptr || cache.extents <= 0)
+        return false;
+
+    if (!lv->roles().has(PartitionRole::Lvm_Lv) || lv->state() != Partition::State::None || d->cacheStatus(lv->partitionPath()).attached)
+        return false;
+
+    if (!d->physicalVolumes().contains(fastPV))
+        return false;
+
+    return cache.extents <= d->pvFreePE(*fastPV) && cache.extents <= d->freePE();
+}
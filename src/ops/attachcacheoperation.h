@@ -0,0 +1,80 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_ATTACHCACHEOPERATION_H
+#define KPMCORE_ATTACHCACHEOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "ops/operation.h"
+
+#include "core/lvmdevice.h"
+
+#include <QString>
+
+class CacheLogicalVolumeJob;
+class OperationStack;
+class Partition;
+
+/** Attach a fast-tier cache to an LVM Logical Volume.
+
+    Creates a dm-cache pool or a dm-writecache volume on a chosen Physical Volume of the
+    Volume Group, typically an SSD next to slower disks, and puts it in front of the Logical Volume.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT AttachCacheOperation : public Operation
+{
+    Q_DISABLE_COPY(AttachCacheOperation)
+
+    friend class OperationStack;
+
+public:
+    AttachCacheOperation(LvmDevice& d, Partition& lv, const Partition& fastPV, const LvmDevice::LVCache& cache);
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("speedometer");
+    }
+
+    QString description() const override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition& p) const override;
+
+    void preview() override;
+    void undo() override;
+
+    static bool canAttach(const LvmDevice* d, const Partition* lv, const Partition* fastPV, const LvmDevice::LVCache& cache);
+
+protected:
+    LvmDevice& device() {
+        return m_Device;
+    }
+    const LvmDevice& device() const {
+        return m_Device;
+    }
+
+    Partition& logicalVolume() {
+        return m_LogicalVolume;
+    }
+    const Partition& logicalVolume() const {
+        return m_LogicalVolume;
+    }
+
+    CacheLogicalVolumeJob* cacheJob() {
+        return m_CacheJob;
+    }
+
+private:
+    LvmDevice& m_Device;
+    Partition& m_LogicalVolume;
+    const Partition& m_FastPV;
+    LvmDevice::LVCache m_Cache;
+    CacheLogicalVolumeJob* m_CacheJob;
+};
+
+#endif
@@ -59,6 +59,9 @@ bool CheckOperation::canCheck(const Partition* p)
     if (p == nullptr)
         return false;
 
+    if (p->fileSystem().hasExternalJournal() && p->fileSystem().externalJournal().isEmpty())
+        return false;
+
     if (p->isMounted())
         return p->fileSystem().supportCheckOnline() != FileSystem::cmdSupportNone;
 
@@ -42,6 +42,9 @@ public:
 
     bool targets(const Device& d) const override;
     bool targets(const Partition& p) const override;
+    QList<const Partition*> concurrentPartitions() const override {
+        return { &checkedPartition() };
+    }
 
     static bool canCheck(const Partition* p);
 
@@ -0,0 +1,250 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/clonedeviceoperation.h"
+
+#include "core/device.h"
+#include "core/partition.h"
+#include "core/partitionalignment.h"
+#include "core/partitiontable.h"
+
+#include "jobs/createpartitiontablelayoutjob.h"
+#include "jobs/copyfilesystemjob.h"
+#include "jobs/resizefilesystemjob.h"
+
+#include "fs/filesystemfactory.h"
+
+#include "util/globallog.h"
+#include "util/report.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QList>
+#include <QString>
+
+#include <KLocalizedString>
+
+typedef QList<std::pair<Partition*, Partition*>> PartitionPairs;
+
+static QList<Partition*> sortedChildren(PartitionNode& parent)
+{
+    QList<Partition*> result;
+    for (const auto &p : parent.children())
+        if (!p->roles().has(PartitionRole::Unallocated))
+            result.append(p);
+
+    std::sort(result.begin(), result.end(), [] (const Partition* a, const Partition* b) { return a->firstSector() < b->firstSector(); });
+
+    return result;
+}
+
+/* Clones the children of sourceParent into targetParent, scaling their geometry by factor.
+   Returns false if the resulting geometry does not fit the target. */
+static bool cloneChildren(PartitionNode& targetParent, PartitionNode& sourceParent, const Device& targetDevice, double factor,
+                          qint64 minFirst, qint64 maxLast, PartitionPairs& pairs)
+{
+    const qint64 align = PartitionAlignment::sectorAlignment(targetDevice);
+    // logical partitions need room for their extended boot record in front of them
+    const qint64 gap = targetParent.isRoot() ? 0 : 1;
+    qint64 previousLast = minFirst - 1 - gap;
+
+    const QList<Partition*> children = sortedChildren(sourceParent);
+    for (const auto &source : children) {
+        qint64 first = source->firstSector();
+        qint64 last = source->lastSector();
+
+        if (factor > 1.0) {
+            first = (static_cast<qint64>(first * factor) + align - 1) / align * align;
+            last = std::max(first + source->length(), static_cast<qint64>((source->lastSector() + 1) * factor) / align * align) - 1;
+        }
+
+        if (first <= previousLast + gap || last > maxLast)
+            return false;
+
+        previousLast = last;
+
+        Partition* p = new Partition(&targetParent, targetDevice, source->roles(), FileSystemFactory::create(source->fileSystem()),
+                                     first, last, PartitionTable::partitionPath(targetDevice.deviceNode(), source->number()), source->availableFlags(),
+                                     QString(), false, source->activeFlags(), Partition::State::Copy);
+        p->setLabel(source->label());
+        p->setType(source->type());
+        p->setAttributes(source->attributes());
+        p->fileSystem().setFirstSector(first);
+        p->fileSystem().setLastSector(first + source->fileSystem().length() - 1);
+        targetParent.append(p);
+
+        if (source->roles().has(PartitionRole::Extended)) {
+            if (!cloneChildren(*p, *source, targetDevice, factor, first + 1, last, pairs))
+                return false;
+        } else
+            pairs.append({ source, p });
+    }
+
+    return true;
+}
+
+static PartitionTable* createClonedTable(const Device& targetDevice, Device& sourceDevice, double factor, PartitionPairs& pairs)
+{
+    const PartitionTable::TableType type = sourceDevice.partitionTable()->type();
+    PartitionTable* ptable = new PartitionTable(type, PartitionTable::defaultFirstUsable(targetDevice, type), PartitionTable::defaultLastUsable(targetDevice, type));
+
+    pairs.clear();
+    if (!cloneChildren(*ptable, *sourceDevice.partitionTable(), targetDevice, factor, ptable->firstUsable(), ptable->lastUsable(), pairs)) {
+        delete ptable;
+        return nullptr;
+    }
+
+    return ptable;
+}
+
+/** Creates a new CloneDeviceOperation.
+    @param targetDevice the Device to clone to
+    @param sourceDevice the Device to clone
+    @param scaleToTarget if true, scale the Partitions proportionally to fill a larger target Device
+*/
+CloneDeviceOperation::CloneDeviceOperation(Device& targetDevice, Device& sourceDevice, bool scaleToTarget) :
+    Operation(),
+    m_TargetDevice(targetDevice),
+    m_SourceDevice(sourceDevice),
+    m_Scaled(false),
+    m_OldPartitionTable(targetDevice.partitionTable()),
+    m_PartitionTable(nullptr),
+    m_CreateLayoutJob(new CreatePartitionTableLayoutJob(targetDevice))
+{
+    Q_ASSERT(canClone(&targetDevice, &sourceDevice));
+
+    PartitionPairs pairs;
+
+    if (scaleToTarget && targetDevice.totalLogical() > sourceDevice.totalLogical()) {
+        const double factor = static_cast<double>(targetDevice.totalLogical()) / sourceDevice.totalLogical();
+        m_PartitionTable = createClonedTable(targetDevice, sourceDevice, factor, pairs);
+        m_Scaled = m_PartitionTable != nullptr;
+
+        if (!m_Scaled)
+            Log(Log::Level::warning) << xi18nc("@info:status", "Partitions of <filename>%1</filename> cannot be scaled to fit <filename>%2</filename>, cloning them with their original sizes.", sourceDevice.deviceNode(), targetDevice.deviceNode());
+    }
+
+    if (m_PartitionTable == nullptr)
+        m_PartitionTable = createClonedTable(targetDevice, sourceDevice, 1.0, pairs);
+
+    if (!isValid()) {
+        Log(Log::Level::error) << xi18nc("@info:status", "Partitions of <filename>%1</filename> do not fit on <filename>%2</filename>.", sourceDevice.deviceNode(), targetDevice.deviceNode());
+        return;
+    }
+
+    addJob(createLayoutJob());
+
+    // pairs are in ascending order of the source partitions, so the source is read front to back
+    for (const auto &pair : std::as_const(pairs)) {
+        CopyFileSystemJob* copyJob = new CopyFileSystemJob(targetDevice, *pair.second, sourceDevice, *pair.first);
+        copyJob->setCloneMode(true);
+        addJob(copyJob);
+
+        if (isScaled() && pair.second->length() > pair.first->fileSystem().length() &&
+                pair.first->fileSystem().supportGrow() != FileSystem::cmdSupportNone)
+            addJob(new ResizeFileSystemJob(targetDevice, *pair.second));
+    }
+}
+
+CloneDeviceOperation::~CloneDeviceOperation()
+{
+    if (status() == StatusPending)
+        delete m_PartitionTable;
+}
+
+bool CloneDeviceOperation::targets(const Device& d) const
+{
+    return d == targetDevice();
+}
+
+void CloneDeviceOperation::preview()
+{
+    if (!isValid())
+        return;
+
+    targetDevice().setPartitionTable(partitionTable());
+    targetDevice().partitionTable()->updateUnallocated(targetDevice());
+}
+
+void CloneDeviceOperation::undo()
+{
+    if (!isValid())
+        return;
+
+    targetDevice().setPartitionTable(oldPartitionTable());
+
+    if (targetDevice().partitionTable())
+        targetDevice().partitionTable()->updateUnallocated(targetDevice());
+}
+
+bool CloneDeviceOperation::execute(Report& parent)
+{
+    if (!isValid()) {
+        Report* report = parent.newChild(description());
+        report->line() << xi18nc("@info:status", "Partitions of <filename>%1</filename> do not fit on <filename>%2</filename>.", sourceDevice().deviceNode(), targetDevice().deviceNode());
+        setStatus(StatusError);
+        return false;
+    }
+
+    targetDevice().setPartitionTable(partitionTable());
+    return Operation::execute(parent);
+}
+
+/** Can a Device be cloned to another Device?
+
+    Both Devices must be disks with the same logical sector size, the source must have a
+    partition table without pending changes and its Partitions must fit on the target. Nothing
+    on the target may be mounted.
+
+    @param targetDevice pointer to the Device to clone to, can be nullptr
+    @param sourceDevice pointer to the Device to clone, can be nullptr
+    @return true if @p sourceDevice can be cloned to @p targetDevice
+*/
+bool CloneDeviceOperation::canClone(const Device* targetDevice, const Device* sourceDevice)
+{
+    if (targetDevice == nullptr || sourceDevice == nullptr || *targetDevice == *sourceDevice)
+        return false;
+
+    if (targetDevice->type() != Device::Type::Disk_Device || sourceDevice->type() != Device::Type::Disk_Device)
+        return false;
+
+    if (targetDevice->logicalSize() != sourceDevice->logicalSize())
+        return false;
+
+    if (targetDevice->partitionTable() != nullptr && targetDevice->partitionTable()->isChildMounted())
+        return false;
+
+    const PartitionTable* ptable = sourceDevice->partitionTable();
+    if (ptable == nullptr || ptable->type() == PartitionTable::TableType::none || ptable->isReadOnly())
+        return false;
+
+    const PartitionTable::TableType type = ptable->type();
+    const qint64 firstUsable = PartitionTable::defaultFirstUsable(*targetDevice, type);
+    const qint64 lastUsable = PartitionTable::defaultLastUsable(*targetDevice, type);
+
+    for (const auto &p : ptable->children()) {
+        if (p->roles().has(PartitionRole::Unallocated))
+            continue;
+
+        if (p->state() != Partition::State::None || p->firstSector() < firstUsable || p->lastSector() > lastUsable)
+            return false;
+
+        for (const auto &child : p->children())
+            if (!child->roles().has(PartitionRole::Unallocated) && child->state() != Partition::State::None)
+                return false;
+    }
+
+    return true;
+}
+
+QString CloneDeviceOperation::description() const
+{
+    if (isScaled())
+        return xi18nc("@info:status", "Clone device <filename>%1</filename> to <filename>%2</filename>, scaling partitions to fit", sourceDevice().deviceNode(), targetDevice().deviceNode());
+
+    return xi18nc("@info:status", "Clone device <filename>%1</filename> to <filename>%2</filename>", sourceDevice().deviceNode(), targetDevice().deviceNode());
+}
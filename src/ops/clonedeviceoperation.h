@@ -0,0 +1,107 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CLONEDEVICEOPERATION_H
+#define KPMCORE_CLONEDEVICEOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "ops/operation.h"
+
+#include <QString>
+
+class Device;
+class Partition;
+class PartitionTable;
+class OperationStack;
+class CreatePartitionTableLayoutJob;
+
+/** Clone a whole Device.
+
+    Replicates the PartitionTable of the source Device on the target Device and copies all
+    Partitions in ascending order of their position on the source. Unallocated space is not
+    copied. The table is written in one go and new disk and partition identifiers are
+    generated for the clone, while the file systems keep their UUIDs.
+
+    If the target Device is larger, the Partitions can optionally be scaled proportionally.
+    File systems that can grow are then grown to fill their Partitions.
+
+    If the Partitions do not fit on the target Device, the Operation is not valid. It then
+    neither changes the preview nor runs.
+*/
+class LIBKPMCORE_EXPORT CloneDeviceOperation : public Operation
+{
+    Q_DISABLE_COPY(CloneDeviceOperation)
+
+    friend class OperationStack;
+
+public:
+    CloneDeviceOperation(Device& targetDevice, Device& sourceDevice, bool scaleToTarget = false);
+    ~CloneDeviceOperation();
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("edit-copy");
+    }
+    QString description() const override;
+    void preview() override;
+    void undo() override;
+    bool execute(Report& parent) override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition&) const override {
+        return false;
+    }
+
+    bool isScaled() const {
+        return m_Scaled;    /**< @return true if the Partitions are scaled to fill the target Device */
+    }
+    bool isValid() const {
+        return m_PartitionTable != nullptr;    /**< @return true if the Partitions fit on the target Device */
+    }
+
+    static bool canClone(const Device* targetDevice, const Device* sourceDevice);
+
+protected:
+    Device& targetDevice() {
+        return m_TargetDevice;
+    }
+    const Device& targetDevice() const {
+        return m_TargetDevice;
+    }
+
+    Device& sourceDevice() {
+        return m_SourceDevice;
+    }
+    const Device& sourceDevice() const {
+        return m_SourceDevice;
+    }
+
+    PartitionTable* partitionTable() {
+        return m_PartitionTable;
+    }
+    const PartitionTable* partitionTable() const {
+        return m_PartitionTable;
+    }
+
+    PartitionTable* oldPartitionTable() {
+        return m_OldPartitionTable;
+    }
+
+    CreatePartitionTableLayoutJob* createLayoutJob() {
+        return m_CreateLayoutJob;
+    }
+
+private:
+    Device& m_TargetDevice;
+    Device& m_SourceDevice;
+    bool m_Scaled;
+    PartitionTable* m_OldPartitionTable;
+    PartitionTable* m_PartitionTable;
+    CreatePartitionTableLayoutJob* m_CreateLayoutJob;
+};
+
+#endif
@@ -0,0 +1,115 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/convertfilesystemoperation.h"
+
+#include "core/device.h"
+#include "core/partition.h"
+
+#include "jobs/convertfilesystemjob.h"
+
+#include "fs/btrfs.h"
+#include "fs/filesystemfactory.h"
+
+#include <QString>
+
+#include <KLocalizedString>
+
+/** Creates a new ConvertFileSystemOperation.
+    @param d the Device the Partition is on
+    @param p the Partition with the FileSystem to convert
+    @param newType the type to convert the FileSystem to
+*/
+ConvertFileSystemOperation::ConvertFileSystemOperation(Device& d, Partition& p, FileSystem::Type newType) :
+    Operation(),
+    m_TargetDevice(d),
+    m_Partition(p),
+    m_OldFileSystem(&p.fileSystem()),
+    m_NewFileSystem(nullptr),
+    m_ConvertJob(nullptr)
+{
+    // Data stays where it is, so does the usage. A rollback restores the old label and UUID,
+    // which are the same ones the conversion copied.
+    m_NewFileSystem = FileSystemFactory::create(newType, oldFileSystem()->firstSector(), oldFileSystem()->lastSector(), oldFileSystem()->sectorSize(),
+                                                oldFileSystem()->sectorsUsed(), oldFileSystem()->label(), {}, oldFileSystem()->uuid());
+
+    m_ConvertJob = new ConvertFileSystemJob(partition(), *oldFileSystem(), *newFileSystem());
+    addJob(convertJob());
+}
+
+ConvertFileSystemOperation::~ConvertFileSystemOperation()
+{
+    if (&partition().fileSystem() == newFileSystem())
+        delete oldFileSystem();
+    else
+        delete newFileSystem();
+}
+
+bool ConvertFileSystemOperation::targets(const Device& d) const
+{
+    return d == targetDevice();
+}
+
+bool ConvertFileSystemOperation::targets(const Partition& p) const
+{
+    return p == partition();
+}
+
+void ConvertFileSystemOperation::preview()
+{
+    partition().setFileSystem(newFileSystem());
+}
+
+void ConvertFileSystemOperation::undo()
+{
+    partition().setFileSystem(oldFileSystem());
+}
+
+bool ConvertFileSystemOperation::execute(Report& parent)
+{
+    preview();
+
+    return Operation::execute(parent);
+}
+
+QString ConvertFileSystemOperation::description() const
+{
+    return xi18nc("@info:status", "Convert file system on partition <filename>%1</filename> from %2 to %3 in place",
+                  partition().deviceNode(), oldFileSystem()->name(), newFileSystem()->name());
+}
+
+/** Can a Partition's FileSystem be converted in place?
+
+    Converting to btrfs needs enough free space for the new metadata. Converting a btrfs back
+    only works if it was converted from @p newType and the saved image is still there, which
+    is only found out when the Operation runs.
+
+    @param p the Partition in question, may be nullptr
+    @param newType the type to convert to
+    @return true if @p p is unmounted and its FileSystem can be converted to @p newType
+*/
+bool ConvertFileSystemOperation::canConvert(const Partition* p, FileSystem::Type newType)
+{
+    if (p == nullptr || p->isMounted() || FS::btrfs::m_Convert == FileSystem::cmdSupportNone)
+        return false;
+
+    const FileSystem& fs = p->fileSystem();
+
+    if (fs.type() == FileSystem::Type::Btrfs)
+        return FS::btrfs::canConvertFrom(newType) && static_cast<const FS::btrfs&>(fs).members().size() <= 1;
+
+    if (newType != FileSystem::Type::Btrfs || !FS::btrfs::canConvertFrom(fs.type()) || fs.hasExternalJournal())
+        return false;
+
+    // Without the usage the free space cannot be checked
+    if (fs.sectorsUsed() < 0)
+        return false;
+
+    const qint64 capacity = fs.length() * fs.sectorSize();
+    const qint64 used = fs.sectorsUsed() * fs.sectorSize();
+
+    return capacity - used >= FS::btrfs::convertSpaceNeeded(used);
+}
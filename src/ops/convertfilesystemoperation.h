@@ -0,0 +1,89 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CONVERTFILESYSTEMOPERATION_H
+#define KPMCORE_CONVERTFILESYSTEMOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "fs/filesystem.h"
+#include "ops/operation.h"
+
+#include <QString>
+
+class ConvertFileSystemJob;
+class Device;
+class OperationStack;
+class Partition;
+
+/** Convert a FileSystem to another type in place.
+
+    Instead of copying the data out and back in, only new metadata is written next to the
+    existing data. An ext2, ext3 or ext4 FileSystem becomes btrfs, with the original kept as an
+    image inside it. Converting such a btrfs back to the ext type rolls back to that image, as
+    long as it has not been deleted.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT ConvertFileSystemOperation : public Operation
+{
+    friend class OperationStack;
+
+    Q_DISABLE_COPY(ConvertFileSystemOperation)
+
+public:
+    ConvertFileSystemOperation(Device& d, Partition& p, FileSystem::Type newType);
+    ~ConvertFileSystemOperation();
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("view-refresh");
+    }
+    QString description() const override;
+    void preview() override;
+    void undo() override;
+    bool execute(Report& parent) override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition& p) const override;
+
+    static bool canConvert(const Partition* p, FileSystem::Type newType);
+
+protected:
+    Device& targetDevice() {
+        return m_TargetDevice;
+    }
+    const Device& targetDevice() const {
+        return m_TargetDevice;
+    }
+
+    Partition& partition() {
+        return m_Partition;
+    }
+    const Partition& partition() const {
+        return m_Partition;
+    }
+
+    FileSystem* newFileSystem() const {
+        return m_NewFileSystem;
+    }
+    FileSystem* oldFileSystem() const {
+        return m_OldFileSystem;
+    }
+
+    ConvertFileSystemJob* convertJob() {
+        return m_ConvertJob;
+    }
+
+private:
+    Device& m_TargetDevice;
+    Partition& m_Partition;
+    FileSystem* m_OldFileSystem;
+    FileSystem* m_NewFileSystem;
+    ConvertFileSystemJob* m_ConvertJob;
+};
+
+#endif
@@ -41,6 +41,7 @@ CopyOperation::CopyOperation(Device& targetdevice, Partition* copiedpartition, D
     m_SourcePartition(sourcepartition),
     m_OverwrittenPartition(nullptr),
     m_MustDeleteOverwritten(false),
+    m_RescueMode(false),
     m_CheckSourceJob(nullptr),
     m_CreatePartitionJob(nullptr),
     m_CopyFSJob(nullptr),
@@ -107,6 +108,22 @@ void CopyOperation::undo()
         insertPreviewPartition(targetDevice(), *overwrittenPartition());
 }
 
+/** Copies the Partition in rescue mode.
+
+    Use this to copy from a failing device: The source is not checked before copying and
+    read errors do not abort copying. Rescued areas are recorded in a map file, so running
+    the copy again only retries the areas that could not be read.
+
+    @param rescueMapFile file to keep track of rescued areas in, may be empty
+    @param fillBadSectors write zeros for unreadable sectors instead of leaving holes
+    @param retryPasses number of times to retry sectors that could not be read
+*/
+void CopyOperation::setRescueMode(const QString& rescueMapFile, bool fillBadSectors, int retryPasses)
+{
+    m_RescueMode = true;
+    copyFSJob()->setRescueMode(rescueMapFile, fillBadSectors, retryPasses);
+}
+
 bool CopyOperation::execute(Report& parent)
 {
     bool rval = false;
@@ -114,8 +131,10 @@ bool CopyOperation::execute(Report& parent)
 
     Report* report = parent.newChild(description());
 
-    // check the source first
-    if ((rval = checkSourceJob()->run(*report))) {
+    // check the source first, unless it is failing and we should not stress it any further
+    if (m_RescueMode || (rval = checkSourceJob()->run(*report))) {
+        rval = true;
+
         // At this point, if the target partition is to be created and not overwritten, it
         // will still have the wrong device path (the one of the source device). We need
         // to adjust that before we're creating it.
@@ -147,6 +166,11 @@ bool CopyOperation::execute(Report& parent)
                         report->line() << xi18nc("@info:status", "<warning>Maximizing file system on target partition <filename>%1</filename> to the size of the partition failed.</warning>", copiedPartition().deviceNode());
                         warning = true;
                     }
+                } else if (m_RescueMode) {
+                    // rescued data is still better than no data
+                    report->line() << xi18nc("@info:status", "<warning>Checking target partition <filename>%1</filename> after rescuing data failed.</warning>", copiedPartition().deviceNode());
+                    rval = true;
+                    warning = true;
                 } else
                     report->line() << xi18nc("@info:status", "Checking target partition <filename>%1</filename> after copy failed.", copiedPartition().deviceNode());
             } else {
@@ -281,6 +305,10 @@ bool CopyOperation::canCopy(const Partition* p)
     if (p->roles().has(PartitionRole::Lvm_Lv))
         return false;
 
+    // The copy would share the journal with the original or have none at all
+    if (p->fileSystem().hasExternalJournal())
+        return false;
+
     // Normally, copying partitions that have not been written to disk yet should
     // be forbidden here. The operation stack, however, will take care of these
     // problematic cases when pushing the CopyOperation onto the stack.
@@ -57,6 +57,8 @@ public:
     bool targets(const Device& d) const override;
     bool targets(const Partition& p) const override;
 
+    void setRescueMode(const QString& rescueMapFile, bool fillBadSectors = true, int retryPasses = 1);
+
     static bool canCopy(const Partition* p);
     static bool canPaste(const Partition* p, const Partition* source);
 
@@ -133,6 +135,7 @@ private:
     Partition* m_SourcePartition;
     Partition* m_OverwrittenPartition;
     bool m_MustDeleteOverwritten;
+    bool m_RescueMode;
 
     CheckFileSystemJob* m_CheckSourceJob;
     CreatePartitionJob* m_CreatePartitionJob;
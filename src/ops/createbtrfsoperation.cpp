@@ -0,0 +1,129 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/createbtrfsoperation.h"
+
+#include "core/device.h"
+#include "core/partition.h"
+
+#include "fs/btrfs.h"
+#include "fs/filesystemfactory.h"
+
+#include "jobs/createbtrfsjob.h"
+
+#include <QStringList>
+
+#include <KLocalizedString>
+
+/** Creates a new CreateBtrfsOperation.
+    @param members the Partitions the file system spans
+    @param label the label of the new file system
+    @param dataProfile the data block group profile, empty for the mkfs.btrfs default
+    @param metadataProfile the metadata block group profile, empty for the mkfs.btrfs default
+*/
+CreateBtrfsOperation::CreateBtrfsOperation(const QVector<Partition*>& members, const QString& label, const QString& dataProfile, const QString& metadataProfile) :
+    Operation(),
+    m_Members(members),
+    m_DataProfile(dataProfile),
+    m_MetadataProfile(metadataProfile),
+    m_CreateJob(new CreateBtrfsJob(members, label))
+{
+    for (const auto &p : members) {
+        FS::btrfs* fs = static_cast<FS::btrfs*>(FileSystemFactory::cloneWithNewType(FileSystem::Type::Btrfs, p->fileSystem()));
+
+        // We never know anything about the number of used sectors on a new file system.
+        fs->setSectorsUsed(-1);
+        fs->setLabel(label);
+        fs->setDataProfile(dataProfile);
+        fs->setMetadataProfile(metadataProfile);
+
+        m_NewFileSystems.append(fs);
+        m_OldFileSystems.append(&p->fileSystem());
+    }
+
+    addJob(createJob());
+}
+
+CreateBtrfsOperation::~CreateBtrfsOperation()
+{
+    for (int i = 0; i < members().size(); i++) {
+        if (&members()[i]->fileSystem() == m_NewFileSystems[i])
+            delete m_OldFileSystems[i];
+        else
+            delete m_NewFileSystems[i];
+    }
+}
+
+QString CreateBtrfsOperation::description() const
+{
+    QStringList deviceNodes;
+    for (const auto &p : members())
+        deviceNodes << p->deviceNode();
+
+    const QString dataProfile = m_DataProfile.isEmpty() ? xi18nc("@info/plain btrfs profile", "default") : m_DataProfile;
+    const QString metadataProfile = m_MetadataProfile.isEmpty() ? xi18nc("@info/plain btrfs profile", "default") : m_MetadataProfile;
+
+    return xi18nc("@info:status", "Create Btrfs file system with %1 data and %2 metadata on <filename>%3</filename>", dataProfile, metadataProfile, deviceNodes.join(QStringLiteral(", ")));
+}
+
+bool CreateBtrfsOperation::targets(const Device& d) const
+{
+    for (const auto &p : members()) {
+        if (p->devicePath() == d.deviceNode())
+            return true;
+    }
+    return false;
+}
+
+bool CreateBtrfsOperation::targets(const Partition& partition) const
+{
+    for (const auto &p : members()) {
+        if (partition == *p)
+            return true;
+    }
+    return false;
+}
+
+void CreateBtrfsOperation::preview()
+{
+    for (int i = 0; i < members().size(); i++)
+        members()[i]->setFileSystem(m_NewFileSystems[i]);
+}
+
+void CreateBtrfsOperation::undo()
+{
+    for (int i = 0; i < members().size(); i++)
+        members()[i]->setFileSystem(m_OldFileSystems[i]);
+}
+
+bool CreateBtrfsOperation::execute(Report& parent)
+{
+    preview();
+
+    return Operation::execute(parent);
+}
+
+/** Can a btrfs file system be created on the given Partitions?
+    @param members the Partitions the file system would span
+    @param dataProfile the data block group profile
+    @param metadataProfile the metadata block group profile
+    @return true if mkfs.btrfs is available, no Partition is mounted or given twice and there are enough for both profiles
+*/
+bool CreateBtrfsOperation::canCreate(const QVector<const Partition*>& members, const QString& dataProfile, const QString& metadataProfile)
+{
+    if (members.isEmpty() || FS::btrfs::m_Create != FileSystem::cmdSupportFileSystem)
+        return false;
+
+    for (int i = 0; i < members.size(); i++) {
+        if (members[i] == nullptr || members[i]->isMounted() || members.indexOf(members[i]) != i)
+            return false;
+    }
+
+    const qint32 dataDevices = FS::btrfs::minDevices(dataProfile);
+    const qint32 metadataDevices = FS::btrfs::minDevices(metadataProfile);
+
+    return dataDevices > 0 && metadataDevices > 0 && members.size() >= qMax(dataDevices, metadataDevices);
+}
@@ -0,0 +1,73 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATEBTRFSOPERATION_H
+#define KPMCORE_CREATEBTRFSOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "ops/operation.h"
+
+#include <QString>
+#include <QVector>
+
+class CreateBtrfsJob;
+class FileSystem;
+class OperationStack;
+class Partition;
+
+/** Create a btrfs file system spanning several Partitions.
+
+    Data and metadata are distributed over the Partitions with the given block group
+    profiles, e.g. raid0 data and raid1 metadata for a striped scratch file system.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT CreateBtrfsOperation : public Operation
+{
+    Q_DISABLE_COPY(CreateBtrfsOperation)
+
+    friend class OperationStack;
+
+public:
+    CreateBtrfsOperation(const QVector<Partition*>& members, const QString& label, const QString& dataProfile, const QString& metadataProfile);
+    ~CreateBtrfsOperation();
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("document-new");
+    }
+
+    QString description() const override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition& p) const override;
+
+    void preview() override;
+    void undo() override;
+    bool execute(Report& parent) override;
+
+    static bool canCreate(const QVector<const Partition*>& members, const QString& dataProfile, const QString& metadataProfile);
+
+protected:
+    const QVector<Partition*>& members() const {
+        return m_Members;
+    }
+
+    CreateBtrfsJob* createJob() {
+        return m_CreateJob;
+    }
+
+private:
+    QVector<Partition*> m_Members;
+    QVector<FileSystem*> m_NewFileSystems;
+    QVector<FileSystem*> m_OldFileSystems;
+    QString m_DataProfile;
+    QString m_MetadataProfile;
+    CreateBtrfsJob* m_CreateJob;
+};
+
+#endif
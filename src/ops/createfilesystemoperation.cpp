@@ -25,13 +25,17 @@
     @param d the Device to create the new FileSystem on
     @param p the Partition to create the new FileSystem in
     @param newType the type of the new FileSystem
+    @param journal the Partition to put the journal or log of an ext3, ext4 or XFS file system on, nullptr to keep it inside
 */
-CreateFileSystemOperation::CreateFileSystemOperation(Device& d, Partition& p, FileSystem::Type newType) :
+CreateFileSystemOperation::CreateFileSystemOperation(Device& d, Partition& p, FileSystem::Type newType, Partition* journal) :
     Operation(),
     m_TargetDevice(d),
     m_Partition(p),
     m_NewFileSystem(FileSystemFactory::cloneWithNewType(newType, partition().fileSystem())),
     m_OldFileSystem(&p.fileSystem()),
+    m_Journal(journal),
+    m_JournalWasMounted(journal && journal->isMounted()),
+    m_JournalMountPoint(journal ? journal->mountPoint() : QString()),
     m_DeleteJob(new DeleteFileSystemJob(targetDevice(), partition())),
     m_CreateJob(new CreateFileSystemJob(targetDevice(), partition())),
     m_CheckJob(new CheckFileSystemJob(partition()))
@@ -59,16 +63,40 @@ bool CreateFileSystemOperation::targets(const Device& d) const
 
 bool CreateFileSystemOperation::targets(const Partition& p) const
 {
-    return p == partition();
+    return p == partition() || (m_Journal && p == *m_Journal);
+}
+
+QList<const Partition*> CreateFileSystemOperation::concurrentPartitions() const
+{
+    if (m_Journal)
+        return { &partition(), m_Journal };
+
+    return { &partition() };
 }
 
 void CreateFileSystemOperation::preview()
 {
+    // A journal partition that is still to be created only gets its device node when the operations run
+    if (m_Journal) {
+        newFileSystem()->setExternalJournal(m_Journal->deviceNode());
+
+        // From now on the journal partition is in use, just like after a scan
+        m_Journal->fileSystem().setJournalOwner(partition().deviceNode());
+        m_Journal->setMountPoint(partition().deviceNode());
+        m_Journal->setMounted(true);
+    }
+
     partition().setFileSystem(newFileSystem());
 }
 
 void CreateFileSystemOperation::undo()
 {
+    if (m_Journal) {
+        m_Journal->fileSystem().setJournalOwner(QString());
+        m_Journal->setMountPoint(m_JournalMountPoint);
+        m_Journal->setMounted(m_JournalWasMounted);
+    }
+
     partition().setFileSystem(oldFileSystem());
 }
 
@@ -79,7 +107,39 @@ bool CreateFileSystemOperation::execute(Report& parent)
     return Operation::execute(parent);
 }
 
+/** Can a FileSystem be created on a Partition?
+
+    Neither @p p nor @p journal may be in use, which includes holding the external journal or
+    log of another FileSystem.
+
+    @param p the Partition in question, may be nullptr
+    @param newType the type of the new FileSystem
+    @param journal the Partition to put the journal or log on, nullptr to keep it inside
+    @return true if a FileSystem of type @p newType can be created on @p p
+*/
+bool CreateFileSystemOperation::canCreate(const Partition* p, FileSystem::Type newType, const Partition* journal)
+{
+    const auto inUse = [] (const Partition* partition) {
+        return partition->isMounted() || !partition->fileSystem().journalOwner().isEmpty() ||
+                partition->roles().has(PartitionRole::Extended) || partition->roles().has(PartitionRole::Unallocated);
+    };
+
+    if (p == nullptr || inUse(p))
+        return false;
+
+    if (journal == nullptr)
+        return true;
+
+    if (journal == p || inUse(journal))
+        return false;
+
+    return newType == FileSystem::Type::Ext3 || newType == FileSystem::Type::Ext4 || newType == FileSystem::Type::Xfs;
+}
+
 QString CreateFileSystemOperation::description() const
 {
+    if (m_Journal)
+        return xi18nc("@info:status", "Create filesystem %1 on partition <filename>%2</filename> with its journal on <filename>%3</filename>", newFileSystem()->name(), partition().deviceNode(), m_Journal->deviceNode());
+
     return xi18nc("@info:status", "Create filesystem %1 on partition <filename>%2</filename>", newFileSystem()->name(), partition().deviceNode());
 }
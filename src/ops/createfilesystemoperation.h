@@ -37,7 +37,7 @@ class LIBKPMCORE_EXPORT CreateFileSystemOperation : public Operation
     Q_DISABLE_COPY(CreateFileSystemOperation)
 
 public:
-    CreateFileSystemOperation(Device& d, Partition& p, FileSystem::Type newType);
+    CreateFileSystemOperation(Device& d, Partition& p, FileSystem::Type newType, Partition* journal = nullptr);
     ~CreateFileSystemOperation();
 
 public:
@@ -51,6 +51,9 @@ public:
 
     bool targets(const Device& d) const override;
     bool targets(const Partition& p) const override;
+    QList<const Partition*> concurrentPartitions() const override;
+
+    static bool canCreate(const Partition* p, FileSystem::Type newType, const Partition* journal = nullptr);
 
 protected:
     Device& targetDevice() {
@@ -74,6 +77,10 @@ protected:
         return m_OldFileSystem;
     }
 
+    Partition* journal() const {
+        return m_Journal;
+    }
+
     DeleteFileSystemJob* deleteJob() {
         return m_DeleteJob;
     }
@@ -89,6 +96,9 @@ private:
     Partition& m_Partition;
     FileSystem* m_NewFileSystem;
     FileSystem* m_OldFileSystem;
+    Partition* m_Journal;
+    bool m_JournalWasMounted;
+    QString m_JournalMountPoint;
     DeleteFileSystemJob* m_DeleteJob;
     CreateFileSystemJob* m_CreateJob;
     CheckFileSystemJob* m_CheckJob;
@@ -0,0 +1,120 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/createsnapshotoperation.h"
+
+#include "jobs/createsnapshotjob.h"
+
+#include "core/partition.h"
+
+#include "fs/filesystemfactory.h"
+
+#include <QString>
+
+#include <KLocalizedString>
+
+/** @return the kind of snapshot @p origin gets, as known from the last scan */
+static LvmDevice::SnapshotType snapshotType(const LvmDevice& d, const Partition& origin)
+{
+    return d.thinStatus(origin.partitionPath()).pool.isEmpty() ? LvmDevice::SnapshotType::CopyOnWrite : LvmDevice::SnapshotType::Thin;
+}
+
+/** Creates a new CreateSnapshotOperation.
+    @param d the Volume Group of the Logical Volume
+    @param origin the Logical Volume to snapshot
+    @param name the name of the snapshot
+    @param extents size of a copy-on-write snapshot in extents, 0 for the size of the origin
+*/
+CreateSnapshotOperation::CreateSnapshotOperation(LvmDevice& d, const Partition& origin, const QString& name, qint64 extents) :
+    Operation(),
+    m_Device(d),
+    m_Origin(origin),
+    m_Name(name),
+    m_Type(snapshotType(d, origin)),
+    m_Extents(extents),
+    m_Snapshot(createLogicalVolume(d, name, m_Type == LvmDevice::SnapshotType::Thin ? origin.length() : usedExtents(),
+                                   FileSystemFactory::create(origin.fileSystem()))),
+    m_SnapshotJob(new CreateSnapshotJob(origin, name, m_Type, extents))
+{
+    addJob(snapshotJob());
+}
+
+CreateSnapshotOperation::~CreateSnapshotOperation()
+{
+    if (status() == StatusPending)
+        delete m_Snapshot;
+}
+
+QString CreateSnapshotOperation::description() const
+{
+    if (m_Type == LvmDevice::SnapshotType::Thin)
+        return xi18nc("@info:status", "Create thin snapshot %2 of logical volume <filename>%1</filename>", origin().partitionPath(), m_Name);
+
+    return xi18nc("@info:status", "Create snapshot %2 of logical volume <filename>%1</filename>", origin().partitionPath(), m_Name);
+}
+
+bool CreateSnapshotOperation::targets(const Device& d) const
+{
+    return d == device();
+}
+
+bool CreateSnapshotOperation::targets(const Partition& p) const
+{
+    return p == origin() || p == snapshot();
+}
+
+/** @return the extents of the Volume Group the snapshot takes, none for a thin snapshot */
+qint64 CreateSnapshotOperation::usedExtents() const
+{
+    if (m_Type == LvmDevice::SnapshotType::Thin)
+        return 0;
+
+    return m_Extents > 0 ? m_Extents : origin().length();
+}
+
+void CreateSnapshotOperation::preview()
+{
+    if (m_Type == LvmDevice::SnapshotType::Thin) {
+        LvmDevice::LVThinStatus status;
+        status.pool = device().thinStatus(origin().partitionPath()).pool;
+        device().setThinStatus(snapshot().partitionPath(), status);
+    }
+
+    insertPreviewPartition(device(), snapshot());
+}
+
+void CreateSnapshotOperation::undo()
+{
+    removePreviewPartition(device(), snapshot());
+    device().setThinStatus(snapshot().partitionPath(), LvmDevice::LVThinStatus());
+}
+
+/** Can a snapshot of a Logical Volume be created?
+    @param d the Volume Group of the Logical Volume, can be nullptr
+    @param origin the Logical Volume to snapshot, can be nullptr
+    @param name the name of the snapshot
+    @param extents size of a copy-on-write snapshot in extents, 0 for the size of the origin
+    @return true if @p origin exists, is no thin pool and a copy-on-write snapshot fits into @p d
+*/
+bool CreateSnapshotOperation::canCreate(const LvmDevice* d, const Partition* origin, const QString& name, qint64 extents)
+{
+    if (d == nullptr || origin == nullptr || name.isEmpty() || extents < 0)
+        return false;
+
+    if (!origin->roles().has(PartitionRole::Lvm_Lv) || origin->state() != Partition::State::None)
+        return false;
+
+    if (d->thinStatus(origin->partitionPath()).isPool)
+        return false;
+
+    if (d->containsLV(name))
+        return false;
+
+    if (snapshotType(*d, *origin) == LvmDevice::SnapshotType::Thin)
+        return true;
+
+    return (extents > 0 ? extents : origin->length()) <= d->freePE();
+}
@@ -0,0 +1,89 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATESNAPSHOTOPERATION_H
+#define KPMCORE_CREATESNAPSHOTOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "ops/operation.h"
+
+#include "core/lvmdevice.h"
+
+#include <QString>
+
+class CreateSnapshotJob;
+class OperationStack;
+class Partition;
+
+/** Create a snapshot of an LVM Logical Volume.
+
+    Thin Logical Volumes get a thin snapshot in their pool, all others a copy-on-write
+    snapshot that takes extents of the Volume Group. The preview shows the snapshot as a
+    new Logical Volume with the file system of its origin.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT CreateSnapshotOperation : public Operation
+{
+    Q_DISABLE_COPY(CreateSnapshotOperation)
+
+    friend class OperationStack;
+
+public:
+    CreateSnapshotOperation(LvmDevice& d, const Partition& origin, const QString& name, qint64 extents = 0);
+    ~CreateSnapshotOperation() override;
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("camera-photo");
+    }
+    QString description() const override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition& p) const override;
+
+    void preview() override;
+    void undo() override;
+
+    static bool canCreate(const LvmDevice* d, const Partition* origin, const QString& name, qint64 extents = 0);
+
+protected:
+    LvmDevice& device() {
+        return m_Device;
+    }
+    const LvmDevice& device() const {
+        return m_Device;
+    }
+
+    const Partition& origin() const {
+        return m_Origin;
+    }
+
+    Partition& snapshot() {
+        return *m_Snapshot;
+    }
+    const Partition& snapshot() const {
+        return *m_Snapshot;
+    }
+
+    CreateSnapshotJob* snapshotJob() {
+        return m_SnapshotJob;
+    }
+
+    qint64 usedExtents() const;
+
+private:
+    LvmDevice& m_Device;
+    const Partition& m_Origin;
+    QString m_Name;
+    LvmDevice::SnapshotType m_Type;
+    qint64 m_Extents;
+    Partition* m_Snapshot;
+    CreateSnapshotJob* m_SnapshotJob;
+};
+
+#endif
@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/createsoftwareraidoperation.h"
+
+#include "core/partition.h"
+
+#include "jobs/createsoftwareraidjob.h"
+
+#include <KLocalizedString>
+
+/** Creates a new CreateSoftwareRaidOperation.
+    @param name the name of the array, e.g. md0
+    @param members the Partitions the array is made of
+    @param raidLevel the RAID level
+    @param chunkSize the chunk size in KiB, 0 for the mdadm default
+    @param options layout, bitmap, resync and write hole protection settings
+*/
+CreateSoftwareRaidOperation::CreateSoftwareRaidOperation(const QString& name, const QVector<const Partition*>& members, qint32 raidLevel, qint32 chunkSize, const SoftwareRAID::ArrayOptions& options) :
+    Operation(),
+    m_CreateSoftwareRaidJob(new CreateSoftwareRaidJob(name, members, raidLevel, chunkSize, options)),
+    m_Members(members),
+    m_Name(name),
+    m_RaidLevel(raidLevel)
+{
+    addJob(createSoftwareRaidJob());
+}
+
+QString CreateSoftwareRaidOperation::description() const
+{
+    return xi18nc("@info/plain", "Create a new RAID %1 array named \'%2\'.", m_RaidLevel, m_Name);
+}
+
+bool CreateSoftwareRaidOperation::targets(const Partition& partition) const
+{
+    for (const auto &p : members()) {
+        if (partition == *p)
+            return true;
+    }
+    return false;
+}
+
+/** Can a RAID array of the given level be made of the given Partitions?
+    @param members the Partitions the array would be made of
+    @param raidLevel the RAID level
+    @return true if there are enough members for the level and none of them is mounted
+*/
+bool CreateSoftwareRaidOperation::canCreate(const QVector<const Partition*>& members, qint32 raidLevel)
+{
+    const qint32 minimum = raidLevel == 6 ? 4 : (raidLevel == 4 || raidLevel == 5) ? 3 : (raidLevel == 0 || raidLevel == 1 || raidLevel == 10) ? 2 : 0;
+    if (minimum == 0 || members.size() < minimum)
+        return false;
+
+    for (const auto &p : members)
+        if (p->isMounted())
+            return false;
+
+    return true;
+}
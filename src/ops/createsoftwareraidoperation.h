@@ -0,0 +1,72 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATESOFTWARERAIDOPERATION_H
+#define KPMCORE_CREATESOFTWARERAIDOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "ops/operation.h"
+
+#include "core/raid/softwareraid.h"
+
+#include <QString>
+#include <QVector>
+
+class CreateSoftwareRaidJob;
+class OperationStack;
+
+/** Create a software RAID array.
+
+    The new array only shows up as a Device after the Operations have been applied and the
+    Devices have been scanned again.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT CreateSoftwareRaidOperation : public Operation
+{
+    Q_DISABLE_COPY(CreateSoftwareRaidOperation)
+
+    friend class OperationStack;
+
+public:
+    CreateSoftwareRaidOperation(const QString& name, const QVector<const Partition*>& members, qint32 raidLevel,
+                                qint32 chunkSize = 0, const SoftwareRAID::ArrayOptions& options = {});
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("document-new");
+    }
+
+    QString description() const override;
+
+    bool targets(const Device&) const override {
+        return false;
+    }
+    bool targets(const Partition& p) const override;
+
+    void preview() override {}
+    void undo() override {}
+
+    static bool canCreate(const QVector<const Partition*>& members, qint32 raidLevel);
+
+protected:
+    CreateSoftwareRaidJob* createSoftwareRaidJob() {
+        return m_CreateSoftwareRaidJob;
+    }
+
+    const QVector<const Partition*>& members() const {
+        return m_Members;
+    }
+
+private:
+    CreateSoftwareRaidJob* m_CreateSoftwareRaidJob;
+    const QVector<const Partition*> m_Members;
+    QString m_Name;
+    qint32 m_RaidLevel;
+};
+
+#endif
@@ -0,0 +1,88 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/createthinpooloperation.h"
+
+#include "jobs/createthinpooljob.h"
+
+#include "core/lvmdevice.h"
+#include "core/partition.h"
+
+#include "fs/filesystemfactory.h"
+
+#include <QString>
+
+#include <KLocalizedString>
+
+/** Creates a new CreateThinPoolOperation.
+    @param d the Volume Group to create the pool in
+    @param name the name of the new thin pool
+    @param extents size of the pool data in extents
+    @param metadataSize size of the pool metadata in MiB, 0 lets LVM choose it
+    @param chunkSize chunk size in KiB, 0 for the LVM default
+*/
+CreateThinPoolOperation::CreateThinPoolOperation(LvmDevice& d, const QString& name, qint64 extents, qint64 metadataSize, qint64 chunkSize) :
+    Operation(),
+    m_Device(d),
+    m_Name(name),
+    m_Pool(createLogicalVolume(d, name, extents, FileSystemFactory::create(FileSystem::Type::Unknown, 0, extents - 1, d.logicalSize()))),
+    m_PoolJob(new CreateThinPoolJob(d, name, extents, metadataSize, chunkSize))
+{
+    addJob(poolJob());
+}
+
+CreateThinPoolOperation::~CreateThinPoolOperation()
+{
+    if (status() == StatusPending)
+        delete m_Pool;
+}
+
+QString CreateThinPoolOperation::description() const
+{
+    return xi18nc("@info:status", "Create thin pool %2 in volume group <filename>%1</filename>", device().name(), m_Name);
+}
+
+bool CreateThinPoolOperation::targets(const Device& d) const
+{
+    return d == device();
+}
+
+bool CreateThinPoolOperation::targets(const Partition& p) const
+{
+    return p == pool();
+}
+
+void CreateThinPoolOperation::preview()
+{
+    LvmDevice::LVThinStatus status;
+    status.isPool = true;
+    device().setThinStatus(pool().partitionPath(), status);
+
+    insertPreviewPartition(device(), pool());
+}
+
+void CreateThinPoolOperation::undo()
+{
+    removePreviewPartition(device(), pool());
+    device().setThinStatus(pool().partitionPath(), LvmDevice::LVThinStatus());
+}
+
+/** Can a thin pool be created?
+    @param d the Volume Group to create the pool in, can be nullptr
+    @param name the name of the new thin pool
+    @param extents size of the pool data in extents
+    @return true if @p name is free and the pool fits into @p d
+*/
+bool CreateThinPoolOperation::canCreate(const LvmDevice* d, const QString& name, qint64 extents)
+{
+    if (d == nullptr || name.isEmpty() || extents <= 0)
+        return false;
+
+    if (d->containsLV(name))
+        return false;
+
+    return extents <= d->freePE();
+}
@@ -0,0 +1,79 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATETHINPOOLOPERATION_H
+#define KPMCORE_CREATETHINPOOLOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "ops/operation.h"
+
+#include <QString>
+
+class CreateThinPoolJob;
+class LvmDevice;
+class OperationStack;
+class Partition;
+
+/** Create an LVM thin pool.
+
+    The pool takes its data extents from the Volume Group. Thin Logical Volumes and thin
+    snapshots created in it afterwards take no extents of their own. The metadata LVM
+    allocates for the pool is not part of the preview.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT CreateThinPoolOperation : public Operation
+{
+    Q_DISABLE_COPY(CreateThinPoolOperation)
+
+    friend class OperationStack;
+
+public:
+    CreateThinPoolOperation(LvmDevice& d, const QString& name, qint64 extents, qint64 metadataSize = 0, qint64 chunkSize = 0);
+    ~CreateThinPoolOperation() override;
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("document-new");
+    }
+    QString description() const override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition& p) const override;
+
+    void preview() override;
+    void undo() override;
+
+    static bool canCreate(const LvmDevice* d, const QString& name, qint64 extents);
+
+protected:
+    LvmDevice& device() {
+        return m_Device;
+    }
+    const LvmDevice& device() const {
+        return m_Device;
+    }
+
+    Partition& pool() {
+        return *m_Pool;
+    }
+    const Partition& pool() const {
+        return *m_Pool;
+    }
+
+    CreateThinPoolJob* poolJob() {
+        return m_PoolJob;
+    }
+
+private:
+    LvmDevice& m_Device;
+    QString m_Name;
+    Partition* m_Pool;
+    CreateThinPoolJob* m_PoolJob;
+};
+
+#endif
@@ -0,0 +1,95 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/createthinvolumeoperation.h"
+
+#include "jobs/createthinvolumejob.h"
+
+#include "core/lvmdevice.h"
+#include "core/partition.h"
+
+#include "fs/filesystemfactory.h"
+
+#include <QString>
+
+#include <KLocalizedString>
+
+/** @return the number of extents of @p d that hold @p size bytes, as lvcreate rounds it */
+static qint64 extentsFor(const LvmDevice& d, qint64 size)
+{
+    return (size + d.peSize() - 1) / d.peSize();
+}
+
+/** Creates a new CreateThinVolumeOperation.
+    @param d the Volume Group of the thin pool
+    @param pool the name of the thin pool
+    @param name the name of the new Logical Volume
+    @param size virtual size of the new Logical Volume in bytes
+*/
+CreateThinVolumeOperation::CreateThinVolumeOperation(LvmDevice& d, const QString& pool, const QString& name, qint64 size) :
+    Operation(),
+    m_Device(d),
+    m_Pool(pool),
+    m_LogicalVolume(createLogicalVolume(d, name, extentsFor(d, size),
+                                        FileSystemFactory::create(FileSystem::Type::Unformatted, 0, extentsFor(d, size) - 1, d.logicalSize()))),
+    m_VolumeJob(new CreateThinVolumeJob(d, pool, name, size))
+{
+    addJob(volumeJob());
+}
+
+CreateThinVolumeOperation::~CreateThinVolumeOperation()
+{
+    if (status() == StatusPending)
+        delete m_LogicalVolume;
+}
+
+QString CreateThinVolumeOperation::description() const
+{
+    return xi18nc("@info:status", "Create thin logical volume <filename>%2</filename> in pool %1", m_Pool, logicalVolume().partitionPath());
+}
+
+bool CreateThinVolumeOperation::targets(const Device& d) const
+{
+    return d == device();
+}
+
+bool CreateThinVolumeOperation::targets(const Partition& p) const
+{
+    return p == logicalVolume();
+}
+
+void CreateThinVolumeOperation::preview()
+{
+    LvmDevice::LVThinStatus status;
+    status.pool = m_Pool;
+    device().setThinStatus(logicalVolume().partitionPath(), status);
+
+    insertPreviewPartition(device(), logicalVolume());
+}
+
+void CreateThinVolumeOperation::undo()
+{
+    removePreviewPartition(device(), logicalVolume());
+    device().setThinStatus(logicalVolume().partitionPath(), LvmDevice::LVThinStatus());
+}
+
+/** Can a thin Logical Volume be created?
+    @param d the Volume Group of the thin pool, can be nullptr
+    @param pool the name of the thin pool
+    @param name the name of the new Logical Volume
+    @param size virtual size of the new Logical Volume in bytes
+    @return true if @p pool is a thin pool of @p d and @p name is free
+*/
+bool CreateThinVolumeOperation::canCreate(const LvmDevice* d, const QString& pool, const QString& name, qint64 size)
+{
+    if (d == nullptr || name.isEmpty() || size <= 0)
+        return false;
+
+    if (!d->thinPools().contains(pool) || d->containsLV(name))
+        return false;
+
+    return true;
+}
@@ -0,0 +1,78 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_CREATETHINVOLUMEOPERATION_H
+#define KPMCORE_CREATETHINVOLUMEOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "ops/operation.h"
+
+#include <QString>
+
+class CreateThinVolumeJob;
+class LvmDevice;
+class OperationStack;
+class Partition;
+
+/** Create a thin LVM Logical Volume.
+
+    The Logical Volume is created unformatted in an existing thin pool and takes no extents
+    of the Volume Group. Its size is virtual and may exceed the size of the pool.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT CreateThinVolumeOperation : public Operation
+{
+    Q_DISABLE_COPY(CreateThinVolumeOperation)
+
+    friend class OperationStack;
+
+public:
+    CreateThinVolumeOperation(LvmDevice& d, const QString& pool, const QString& name, qint64 size);
+    ~CreateThinVolumeOperation() override;
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("document-new");
+    }
+    QString description() const override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition& p) const override;
+
+    void preview() override;
+    void undo() override;
+
+    static bool canCreate(const LvmDevice* d, const QString& pool, const QString& name, qint64 size);
+
+protected:
+    LvmDevice& device() {
+        return m_Device;
+    }
+    const LvmDevice& device() const {
+        return m_Device;
+    }
+
+    Partition& logicalVolume() {
+        return *m_LogicalVolume;
+    }
+    const Partition& logicalVolume() const {
+        return *m_LogicalVolume;
+    }
+
+    CreateThinVolumeJob* volumeJob() {
+        return m_VolumeJob;
+    }
+
+private:
+    LvmDevice& m_Device;
+    QString m_Pool;
+    Partition* m_LogicalVolume;
+    CreateThinVolumeJob* m_VolumeJob;
+};
+
+#endif
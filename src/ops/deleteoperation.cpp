@@ -112,6 +112,10 @@ bool DeleteOperation::canDelete(const Partition* p)
     if (p->isMounted())
         return false;
 
+    // holds the external journal or log of another file system
+    if (!p->fileSystem().journalOwner().isEmpty())
+        return false;
+
     if (p->fileSystem().type() == FileSystem::Type::Lvm2_PV) {
         if (LvmDevice::s_DirtyPVs.contains(p))
             return false;
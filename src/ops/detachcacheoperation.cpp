@@ -0,0 +1,54 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/detachcacheoperation.h"
+
+#include "jobs/cachelogicalvolumejob.h"
+
+#include "core/lvmdevice.h"
+#include "core/partition.h"
+
+#include <QString>
+
+#include <KLocalizedString>
+
+/** Creates a new DetachCacheOperation.
+    @param d the Volume Group of the Logical Volume
+    @param lv the cached Logical Volume
+*/
+DetachCacheOperation::DetachCacheOperation(LvmDevice& d, Partition& lv) :
+    Operation(),
+    m_Device(d),
+    m_LogicalVolume(lv),
+    m_CacheJob(new CacheLogicalVolumeJob(d, lv))
+{
+    addJob(cacheJob());
+}
+
+QString DetachCacheOperation::description() const
+{
+    return xi18nc("@info:status", "Flush and detach the cache of logical volume <filename>%1</filename>", logicalVolume().partitionPath());
+}
+
+bool DetachCacheOperation::targets(const Device& d) const
+{
+    return d == device();
+}
+
+bool DetachCacheOperation::targets(const Partition& p) const
+{
+    return p == logicalVolume();
+}
+
+/** Can the cache of a Logical Volume be detached?
+    @param d the Volume Group of the Logical Volume, can be nullptr
+    @param lv the Logical Volume, can be nullptr
+    @return true if @p lv had a cache attached when it was scanned
+*/
+bool DetachCacheOperation::canDetach(const LvmDevice* d, const Partition* lv)
+{
+    return d != nullptr && lv != nullptr && d->cacheStatus(lv->partitionPath()).attached;
+}
@@ -0,0 +1,76 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_DETACHCACHEOPERATION_H
+#define KPMCORE_DETACHCACHEOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "ops/operation.h"
+
+#include <QString>
+
+class CacheLogicalVolumeJob;
+class LvmDevice;
+class OperationStack;
+class Partition;
+
+/** Detach the cache from an LVM Logical Volume.
+
+    Dirty blocks are written back to the Logical Volume before the cache is removed.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT DetachCacheOperation : public Operation
+{
+    Q_DISABLE_COPY(DetachCacheOperation)
+
+    friend class OperationStack;
+
+public:
+    DetachCacheOperation(LvmDevice& d, Partition& lv);
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("edit-delete");
+    }
+
+    QString description() const override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition& p) const override;
+
+    void preview() override {}
+    void undo() override {}
+
+    static bool canDetach(const LvmDevice* d, const Partition* lv);
+
+protected:
+    LvmDevice& device() {
+        return m_Device;
+    }
+    const LvmDevice& device() const {
+        return m_Device;
+    }
+
+    Partition& logicalVolume() {
+        return m_LogicalVolume;
+    }
+    const Partition& logicalVolume() const {
+        return m_LogicalVolume;
+    }
+
+    CacheLogicalVolumeJob* cacheJob() {
+        return m_CacheJob;
+    }
+
+private:
+    LvmDevice& m_Device;
+    Partition& m_LogicalVolume;
+    CacheLogicalVolumeJob* m_CacheJob;
+};
+
+#endif
@@ -0,0 +1,203 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/fanoutcopyoperation.h"
+#include "ops/copyoperation.h"
+
+#include "core/partition.h"
+#include "core/device.h"
+
+#include "jobs/checkfilesystemjob.h"
+#include "jobs/fanoutcopyfilesystemjob.h"
+#include "jobs/resizefilesystemjob.h"
+
+#include "util/capacity.h"
+#include "util/report.h"
+
+#include <QSet>
+#include <QString>
+#include <QStringList>
+
+#include <KLocalizedString>
+
+/** Creates a new FanOutCopyOperation.
+    @param sourcedevice the Device where to copy from
+    @param sourcepartition pointer to the Partition to copy from. May not be nullptr.
+    @param targets the Devices and existing Partitions to overwrite with copies of the source
+*/
+FanOutCopyOperation::FanOutCopyOperation(Device& sourcedevice, Partition* sourcepartition, const QVector<Target>& targets) :
+    Operation(),
+    m_SourceDevice(sourcedevice),
+    m_SourcePartition(sourcepartition),
+    m_CheckSourceJob(nullptr),
+    m_CopyFSJob(nullptr)
+{
+    QVector<FanOutCopyFileSystemJob::Target> copyTargets;
+
+    for (const auto &target : targets) {
+        Copy c;
+        c.device = target.first;
+        c.overwritten = target.second;
+        c.copied = CopyOperation::createCopy(*target.second, sourcePartition());
+        // Like CopyOperation, own the overwritten Partition unless another Operation does
+        c.mustDeleteOverwritten = target.second->state() == Partition::State::None;
+        c.checkJob = nullptr;
+        c.maximizeJob = nullptr;
+        m_Copies.append(c);
+
+        copyTargets.append({ c.device, c.copied });
+    }
+
+    addJob(m_CheckSourceJob = new CheckFileSystemJob(sourcePartition()));
+    addJob(m_CopyFSJob = new FanOutCopyFileSystemJob(sourceDevice(), sourcePartition(), copyTargets));
+
+    for (auto &c : m_Copies) {
+        addJob(c.checkJob = new CheckFileSystemJob(*c.copied));
+        addJob(c.maximizeJob = new ResizeFileSystemJob(*c.device, *c.copied));
+    }
+}
+
+FanOutCopyOperation::~FanOutCopyOperation()
+{
+    if (status() == StatusPending)
+        for (const auto &c : std::as_const(m_Copies))
+            delete c.copied;
+
+    if (status() == StatusFinishedSuccess || status() == StatusFinishedWarning || status() == StatusError)
+        cleanupOverwrittenPartitions();
+}
+
+QString FanOutCopyOperation::description() const
+{
+    QStringList targetNodes;
+    for (const auto &c : m_Copies)
+        targetNodes.append(c.overwritten->deviceNode());
+
+    return xi18nc("@info:status", "Copy partition <filename>%1</filename> (%2, %3) to %4 partitions: %5",
+                  sourcePartition().deviceNode(),
+                  Capacity::formatByteSize(sourcePartition().capacity()),
+                  sourcePartition().fileSystem().name(),
+                  m_Copies.size(),
+                  targetNodes.join(QStringLiteral(", ")));
+}
+
+bool FanOutCopyOperation::targets(const Device& d) const
+{
+    for (const auto &c : m_Copies)
+        if (d == *c.device)
+            return true;
+
+    return false;
+}
+
+bool FanOutCopyOperation::targets(const Partition& p) const
+{
+    for (const auto &c : m_Copies)
+        if (p == *c.copied)
+            return true;
+
+    return false;
+}
+
+void FanOutCopyOperation::preview()
+{
+    for (const auto &c : std::as_const(m_Copies)) {
+        removePreviewPartition(*c.device, *c.overwritten);
+        insertPreviewPartition(*c.device, *c.copied);
+    }
+}
+
+void FanOutCopyOperation::undo()
+{
+    for (auto it = m_Copies.crbegin(); it != m_Copies.crend(); ++it) {
+        removePreviewPartition(*it->device, *it->copied);
+        insertPreviewPartition(*it->device, *it->overwritten);
+    }
+}
+
+bool FanOutCopyOperation::execute(Report& parent)
+{
+    bool rval = false;
+    bool warning = false;
+
+    Report* report = parent.newChild(description());
+
+    if (m_CheckSourceJob->run(*report)) {
+        // The copies take over the place of the Partitions they overwrite
+        for (const auto &c : std::as_const(m_Copies)) {
+            c.copied->setState(Partition::State::None);
+            c.copied->setDevicePath(c.overwritten->devicePath());
+            c.copied->setPartitionPath(c.overwritten->partitionPath());
+        }
+
+        rval = m_CopyFSJob->run(*report);
+
+        if (rval) {
+            const QList<int>& failed = m_CopyFSJob->failedTargets();
+            warning = !failed.isEmpty();
+
+            for (int i = 0; i < m_Copies.size(); ++i) {
+                const Copy& c = m_Copies[i];
+                if (failed.contains(i))
+                    continue;
+
+                if (!c.checkJob->run(*report)) {
+                    report->line() << xi18nc("@info:status", "<warning>Checking target partition <filename>%1</filename> after copy failed.</warning>", c.copied->deviceNode());
+                    warning = true;
+                } else if (!c.maximizeJob->run(*report)) {
+                    report->line() << xi18nc("@info:status", "<warning>Maximizing file system on target partition <filename>%1</filename> to the size of the partition failed.</warning>", c.copied->deviceNode());
+                    warning = true;
+                }
+            }
+        } else
+            report->line() << xi18nc("@info:status", "Copying source to the target partitions failed.");
+    } else
+        report->line() << xi18nc("@info:status", "Checking source partition <filename>%1</filename> failed.", sourcePartition().deviceNode());
+
+    if (rval)
+        setStatus(warning ? StatusFinishedWarning : StatusFinishedSuccess);
+    else
+        setStatus(StatusError);
+
+    report->setStatus(xi18nc("@info:status (success, error, warning...) of operation", "%1: %2", description(), statusText()));
+
+    return rval;
+}
+
+void FanOutCopyOperation::cleanupOverwrittenPartitions()
+{
+    for (auto &c : m_Copies) {
+        if (c.mustDeleteOverwritten) {
+            delete c.overwritten;
+            c.overwritten = nullptr;
+            c.mustDeleteOverwritten = false;
+        }
+    }
+}
+
+/** Can a Partition be copied onto several other Partitions?
+    @param source the Partition to copy, may be nullptr
+    @param targets the existing Partitions to overwrite
+    @return true if @p source can be copied onto all of @p targets
+*/
+bool FanOutCopyOperation::canFanOut(const Partition* source, const QVector<const Partition*>& targets)
+{
+    if (!CopyOperation::canCopy(source) || targets.isEmpty())
+        return false;
+
+    QSet<const Partition*> seen;
+    for (const auto &p : targets) {
+        if (p == nullptr || seen.contains(p) || p->roles().has(PartitionRole::Unallocated))
+            return false;
+
+        if (!CopyOperation::canPaste(p, source))
+            return false;
+
+        seen.insert(p);
+    }
+
+    return true;
+}
@@ -0,0 +1,99 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_FANOUTCOPYOPERATION_H
+#define KPMCORE_FANOUTCOPYOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "ops/operation.h"
+
+#include <QPair>
+#include <QString>
+#include <QVector>
+
+class Partition;
+class OperationStack;
+class Device;
+class Report;
+
+class CheckFileSystemJob;
+class FanOutCopyFileSystemJob;
+class ResizeFileSystemJob;
+
+/** Copy a Partition onto several Partitions at once.
+
+    Overwrites each target Partition with a copy of the source, reading the source only once.
+    Targets that fail are dropped and the Operation finishes with a warning as long as at least
+    one copy succeeded.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT FanOutCopyOperation : public Operation
+{
+    friend class OperationStack;
+
+    Q_DISABLE_COPY(FanOutCopyOperation)
+
+public:
+    using Target = QPair<Device*, Partition*>;
+
+    FanOutCopyOperation(Device& sourcedevice, Partition* sourcepartition, const QVector<Target>& targets);
+    ~FanOutCopyOperation();
+
+public:
+    QString iconName() const override {
+        return QStringLiteral("edit-copy");
+    }
+    QString description() const override;
+
+    bool execute(Report& parent) override;
+    void preview() override;
+    void undo() override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition& p) const override;
+
+    static bool canFanOut(const Partition* source, const QVector<const Partition*>& targets);
+
+protected:
+    Device& sourceDevice() {
+        return m_SourceDevice;
+    }
+    const Device& sourceDevice() const {
+        return m_SourceDevice;
+    }
+
+    Partition& sourcePartition() {
+        return *m_SourcePartition;
+    }
+    const Partition& sourcePartition() const {
+        return *m_SourcePartition;
+    }
+
+    void cleanupOverwrittenPartitions();
+
+private:
+    /** A target as it is before and after the Operation */
+    struct Copy
+    {
+        Device* device;
+        Partition* overwritten;
+        Partition* copied;
+        bool mustDeleteOverwritten;
+        CheckFileSystemJob* checkJob;
+        ResizeFileSystemJob* maximizeJob;
+    };
+
+    Device& m_SourceDevice;
+    Partition* m_SourcePartition;
+    QVector<Copy> m_Copies;
+
+    CheckFileSystemJob* m_CheckSourceJob;
+    FanOutCopyFileSystemJob* m_CopyFSJob;
+};
+
+#endif
@@ -185,6 +185,11 @@ bool NewOperation::targets(const Partition& p) const
     return p == newPartition();
 }
 
+QList<const Partition*> NewOperation::concurrentPartitions() const
+{
+    return { &newPartition() };
+}
+
 void NewOperation::preview()
 {
     insertPreviewPartition(targetDevice(), newPartition());
@@ -56,6 +56,7 @@ public:
 
     bool targets(const Device& d) const override;
     bool targets(const Partition& p) const override;
+    QList<const Partition*> concurrentPartitions() const override;
 
     static bool canCreateNew(const Partition* p);
     static Partition* createNew(const Partition& cloneFrom, FileSystem::Type type);
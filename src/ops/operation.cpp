@@ -10,11 +10,14 @@
 #include "core/partition.h"
 #include "core/device.h"
 #include "core/lvmdevice.h"
+#include "core/partitiontable.h"
 
 #include "jobs/job.h"
 
 #include "util/report.h"
 
+#include <algorithm>
+
 #include <QDebug>
 #include <QIcon>
 #include <QString>
@@ -42,8 +45,10 @@ void Operation::insertPreviewPartition(Device& device, Partition& p)
 
     if (p.parent()->insert(&p)) {
         if (device.type() == Device::Type::LVM_Device) {
+            // thin Logical Volumes live in their pool and take no extents of the Volume Group
             const LvmDevice& lvm = static_cast<const LvmDevice&>(device);
-            lvm.setFreePE(lvm.freePE() - p.length());
+            if (lvm.thinStatus(p.partitionPath()).pool.isEmpty())
+                lvm.setFreePE(lvm.freePE() - p.length());
         }
     }
     else
@@ -59,7 +64,8 @@ void Operation::removePreviewPartition(Device& device, Partition& p)
     if (p.parent()->remove(&p)) {
         if (device.type() == Device::Type::LVM_Device) {
             const LvmDevice& lvm = static_cast<const LvmDevice&>(device);
-            lvm.setFreePE(lvm.freePE() + p.length());
+            if (lvm.thinStatus(p.partitionPath()).pool.isEmpty())
+                lvm.setFreePE(lvm.freePE() + p.length());
         }
 
         device.partitionTable()->updateUnallocated(device);
@@ -68,6 +74,31 @@ void Operation::removePreviewPartition(Device& device, Partition& p)
         qWarning() << "failed to remove partition " << p.deviceNode() << " at " << &p << " from preview.";
 }
 
+/** Creates a Logical Volume for the preview of an Operation that creates it.
+
+    The Logical Volume is placed after the last one in the Volume Group, like the scan does.
+    Its state is Partition::State::None because no NewOperation creates it: later Operations
+    on it run after the Operation that creates it.
+
+    @param d the Volume Group of the new Logical Volume
+    @param name the name of the new Logical Volume
+    @param length the length of the new Logical Volume in extents
+    @param fs the FileSystem of the new Logical Volume, the Partition takes ownership
+    @return the new Logical Volume, not yet inserted into @p d
+*/
+Partition* Operation::createLogicalVolume(LvmDevice& d, const QString& name, qint64 length, FileSystem* fs)
+{
+    Q_ASSERT(d.partitionTable());
+
+    qint64 first = d.partitionTable()->firstUsable();
+    for (const auto &p : d.partitionTable()->children())
+        if (!p->roles().has(PartitionRole::Unallocated))
+            first = std::max(first, p->lastSector() + 1);
+
+    return new Partition(d.partitionTable(), d, PartitionRole(PartitionRole::Lvm_Lv), fs, first, first + length - 1,
+                         d.deviceNode() + QLatin1Char('/') + name);
+}
+
 /** @return text describing the Operation's current status */
 QString Operation::statusText() const
 {
@@ -143,6 +174,23 @@ void Operation::onJobFinished()
     }
 }
 
+/** Tells the OperationRunner if this Operation may run at the same time as other Operations.
+
+    Operations that only work on the contents of some Partitions can be run concurrently with
+    Operations on other Partitions. The default is to run alone, which is what Operations
+    changing the layout of a Device or working on a whole Device must do.
+
+    Only commands run through ExternalCommand::run() let the helper serve other calls in the
+    meantime. Copying, reading or writing blocks holds the helper until it is done, so
+    Operations doing that gain nothing from running concurrently and should run alone.
+
+    @return the Partitions this Operation reads or writes, empty if it must run alone
+*/
+QList<const Partition*> Operation::concurrentPartitions() const
+{
+    return {};
+}
+
 /** @return total number of steps to run this Operation */
 qint32 Operation::totalProgress() const
 {
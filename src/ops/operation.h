@@ -20,6 +20,8 @@
 
 class Partition;
 class Device;
+class LvmDevice;
+class FileSystem;
 class Job;
 class OperationPrivate;
 class OperationStack;
@@ -102,6 +104,8 @@ public:
     virtual bool targets(const Device&) const = 0;
     virtual bool targets(const Partition&) const = 0;
 
+    virtual QList<const Partition*> concurrentPartitions() const;
+
     /**< @return the current status */
     virtual OperationStatus status() const;
 
@@ -120,6 +124,8 @@ protected:
     void insertPreviewPartition(Device& targetDevice, Partition& newPartition);
     void removePreviewPartition(Device& device, Partition& p);
 
+    static Partition* createLogicalVolume(LvmDevice& d, const QString& name, qint64 length, FileSystem* fs);
+
     void addJob(Job* job);
 
     QList<Job*>& jobs();
@@ -0,0 +1,165 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "ops/reencryptoperation.h"
+
+#include "core/device.h"
+#include "core/partition.h"
+
+#include "jobs/reencryptjob.h"
+
+#include "fs/filesystemfactory.h"
+#include "fs/luks2.h"
+
+#include <QString>
+
+#include <KLocalizedString>
+
+/** Creates a new ReencryptOperation.
+    @param d the Device the Partition is on
+    @param p the Partition to encrypt, re-encrypt or decrypt
+    @param type what to do with the Partition
+    @param passphrase the passphrase of the new LUKS2 header when encrypting, an existing one otherwise
+    @param options cipher and resilience settings
+*/
+ReencryptOperation::ReencryptOperation(Device& d, Partition& p, FS::luks2::ReencryptMode type, const QString& passphrase, const FS::luks2::ReencryptOptions& options) :
+    Operation(),
+    m_TargetDevice(d),
+    m_Partition(p),
+    m_Type(type),
+    m_OldFileSystem(&p.fileSystem()),
+    m_NewFileSystem(nullptr),
+    m_OldRoles(p.roles().roles()),
+    m_ReencryptJob(nullptr)
+{
+    QString key = passphrase;
+
+    if (type == FS::luks2::ReencryptMode::Encrypt) {
+        FS::luks2* luksFs = static_cast<FS::luks2*>(FileSystemFactory::create(FileSystem::Type::Luks2, oldFileSystem()->firstSector(),
+                                                                              oldFileSystem()->lastSector(), oldFileSystem()->sectorSize()));
+        luksFs->createInnerFileSystem(oldFileSystem()->type());
+        luksFs->setPassphrase(passphrase);
+        m_NewFileSystem = luksFs;
+    } else {
+        const FS::luks* luksFs = static_cast<const FS::luks*>(oldFileSystem());
+        if (key.isEmpty())
+            key = luksFs->passphrase();
+
+        // A locked device does not tell what is inside, the next scan will
+        if (type == FS::luks2::ReencryptMode::Decrypt)
+            m_NewFileSystem = luksFs->innerFS() ? FileSystemFactory::create(*luksFs->innerFS())
+                                                : FileSystemFactory::create(FileSystem::Type::Unknown, oldFileSystem()->firstSector(),
+                                                                            oldFileSystem()->lastSector(), oldFileSystem()->sectorSize());
+    }
+
+    m_ReencryptJob = new ReencryptJob(partition(), type, *oldFileSystem(), key, options);
+    addJob(reencryptJob());
+}
+
+ReencryptOperation::~ReencryptOperation()
+{
+    if (newFileSystem() == nullptr)
+        return;
+
+    if (&partition().fileSystem() == newFileSystem())
+        delete oldFileSystem();
+    else
+        delete newFileSystem();
+}
+
+bool ReencryptOperation::targets(const Device& d) const
+{
+    return d == targetDevice();
+}
+
+bool ReencryptOperation::targets(const Partition& p) const
+{
+    return p == partition();
+}
+
+void ReencryptOperation::preview()
+{
+    if (newFileSystem() == nullptr)
+        return;
+
+    partition().setFileSystem(newFileSystem());
+
+    if (type() == FS::luks2::ReencryptMode::Encrypt)
+        partition().setRoles(PartitionRole(m_OldRoles | PartitionRole::Luks));
+    else
+        partition().setRoles(PartitionRole(m_OldRoles & ~PartitionRole::Roles(PartitionRole::Luks)));
+}
+
+void ReencryptOperation::undo()
+{
+    if (newFileSystem() == nullptr)
+        return;
+
+    partition().setFileSystem(oldFileSystem());
+    partition().setRoles(PartitionRole(m_OldRoles));
+}
+
+bool ReencryptOperation::execute(Report& parent)
+{
+    preview();
+
+    return Operation::execute(parent);
+}
+
+QString ReencryptOperation::description() const
+{
+    switch (type()) {
+    case FS::luks2::ReencryptMode::Encrypt:
+        return xi18nc("@info:status", "Encrypt partition <filename>%1</filename> in place", partition().deviceNode());
+    case FS::luks2::ReencryptMode::Reencrypt:
+        return xi18nc("@info:status", "Re-encrypt partition <filename>%1</filename> with a new key", partition().deviceNode());
+    case FS::luks2::ReencryptMode::Decrypt:
+        break;
+    }
+
+    return xi18nc("@info:status", "Decrypt partition <filename>%1</filename> in place", partition().deviceNode());
+}
+
+/** Can a Partition be encrypted in place?
+    @param p the Partition in question, may be nullptr
+    @return true if @p p is unmounted and its FileSystem can be shrunk to make room for the header
+*/
+bool ReencryptOperation::canEncrypt(const Partition* p)
+{
+    if (p == nullptr || p->isMounted() || p->roles().has(PartitionRole::Luks) || FS::luks::m_Create == FileSystem::cmdSupportNone)
+        return false;
+
+    const FileSystem& fs = p->fileSystem();
+    if (!FS::luks::canEncryptType(fs.type()) && fs.type() != FileSystem::Type::Unformatted)
+        return false;
+
+    if (fs.type() != FileSystem::Type::Unformatted && fs.supportShrink() != FileSystem::cmdSupportFileSystem)
+        return false;
+
+    return fs.length() * fs.sectorSize() > 2 * FS::luks2::reencryptHeaderSize;
+}
+
+/** Can a Partition get a new volume key or cipher?
+    @param p the Partition in question, may be nullptr
+    @return true if @p p is LUKS2, unlocked or not
+*/
+bool ReencryptOperation::canReencrypt(const Partition* p)
+{
+    return p != nullptr && p->roles().has(PartitionRole::Luks) && dynamic_cast<const FS::luks2*>(&p->fileSystem()) != nullptr;
+}
+
+/** Can a Partition be decrypted in place?
+    @param p the Partition in question, may be nullptr
+    @return true if @p p is a locked LUKS2 device
+*/
+bool ReencryptOperation::canDecrypt(const Partition* p)
+{
+    if (!canReencrypt(p))
+        return false;
+
+    const FS::luks* luksFs = static_cast<const FS::luks*>(&p->fileSystem());
+    return !luksFs->isCryptOpen() && !luksFs->outerUuid().isEmpty();
+}
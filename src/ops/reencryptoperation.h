@@ -0,0 +1,100 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_REENCRYPTOPERATION_H
+#define KPMCORE_REENCRYPTOPERATION_H
+
+#include "util/libpartitionmanagerexport.h"
+
+#include "core/partitionrole.h"
+
+#include "fs/luks2.h"
+#include "ops/operation.h"
+
+#include <QString>
+
+class Device;
+class FileSystem;
+class OperationStack;
+class Partition;
+class ReencryptJob;
+
+/** Encrypt, re-encrypt or decrypt a Partition in place.
+
+    Encrypting shrinks the FileSystem by the size of the LUKS2 header and encrypts the data
+    without copying it elsewhere. Re-encrypting changes the volume key and optionally the
+    cipher, online if the LUKS2 device is unlocked. Decrypting turns a locked LUKS2 device
+    back into its plain contents. Interrupted runs are picked up again with the resume option.
+
+    @author KPMcore contributors
+*/
+class LIBKPMCORE_EXPORT ReencryptOperation : public Operation
+{
+    friend class OperationStack;
+
+    Q_DISABLE_COPY(ReencryptOperation)
+
+public:
+    ReencryptOperation(Device& d, Partition& p, FS::luks2::ReencryptMode type, const QString& passphrase, const FS::luks2::ReencryptOptions& options = {});
+    ~ReencryptOperation();
+
+public:
+    QString iconName() const override {
+        return type() == FS::luks2::ReencryptMode::Decrypt ? QStringLiteral("object-unlocked") : QStringLiteral("object-locked");
+    }
+    QString description() const override;
+    void preview() override;
+    void undo() override;
+    bool execute(Report& parent) override;
+
+    bool targets(const Device& d) const override;
+    bool targets(const Partition& p) const override;
+
+    static bool canEncrypt(const Partition* p);
+    static bool canReencrypt(const Partition* p);
+    static bool canDecrypt(const Partition* p);
+
+protected:
+    Device& targetDevice() {
+        return m_TargetDevice;
+    }
+    const Device& targetDevice() const {
+        return m_TargetDevice;
+    }
+
+    Partition& partition() {
+        return m_Partition;
+    }
+    const Partition& partition() const {
+        return m_Partition;
+    }
+
+    FS::luks2::ReencryptMode type() const {
+        return m_Type;
+    }
+
+    FileSystem* newFileSystem() const {
+        return m_NewFileSystem;
+    }
+    FileSystem* oldFileSystem() const {
+        return m_OldFileSystem;
+    }
+
+    ReencryptJob* reencryptJob() {
+        return m_ReencryptJob;
+    }
+
+private:
+    Device& m_TargetDevice;
+    Partition& m_Partition;
+    FS::luks2::ReencryptMode m_Type;
+    FileSystem* m_OldFileSystem;
+    FileSystem* m_NewFileSystem;
+    PartitionRole::Roles m_OldRoles;
+    ReencryptJob* m_ReencryptJob;
+};
+
+#endif
@@ -400,6 +400,10 @@ bool ResizeOperation::canMove(const Partition* p)
     if (p->roles().has(PartitionRole::Extended) && p->hasChildren())
         return false;
 
+    // moving ends with a check, which needs to find the journal
+    if (p->fileSystem().hasExternalJournal() && p->fileSystem().externalJournal().isEmpty())
+        return false;
+
     return p->fileSystem().supportMove() != FileSystem::cmdSupportNone;
 }
 
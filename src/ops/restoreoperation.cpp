@@ -9,6 +9,7 @@
 
 #include "ops/restoreoperation.h"
 
+#include "core/backupimage.h"
 #include "core/partition.h"
 #include "core/device.h"
 #include "core/partitiontable.h"
@@ -45,7 +46,7 @@ RestoreOperation::RestoreOperation(Device& d, Partition* p, const QString& filen
     m_FileName(filename),
     m_OverwrittenPartition(nullptr),
     m_MustDeleteOverwritten(false),
-    m_ImageLength(QFileInfo(filename).size() / 512), // 512 being the "sector size" of an image file.
+    m_ImageLength(BackupImage(filename).length() / 512), // 512 being the "sector size" of an image file.
     m_CreatePartitionJob(nullptr),
     m_RestoreJob(nullptr),
     m_CheckTargetJob(nullptr),
@@ -215,7 +216,7 @@ Partition* RestoreOperation::createRestorePartition(const Device& device, Partit
     if (!fileInfo.exists())
         return nullptr;
 
-    const qint64 end = start + fileInfo.size() / device.logicalSize() - 1;
+    const qint64 end = start + BackupImage(filename).length() / device.logicalSize() - 1;
     Partition* p = new Partition(&parent, device, PartitionRole(r), FileSystemFactory::create(FileSystem::Type::Unknown, start, end, device.logicalSize()), start, end, QString());
 
     p->setState(Partition::State::Restore);
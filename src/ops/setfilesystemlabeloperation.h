@@ -45,6 +45,9 @@ public:
 
     bool targets(const Device& d) const override;
     bool targets(const Partition& p) const override;
+    QList<const Partition*> concurrentPartitions() const override {
+        return { &labeledPartition() };
+    }
 
 protected:
     Partition& labeledPartition() {
@@ -40,7 +40,7 @@ bool DummyDevice::close()
 
 std::unique_ptr<CoreBackendPartitionTable> DummyDevice::openPartitionTable()
 {
-    return std::make_unique<DummyPartitionTable>(DummyPartitionTable());
+    return std::make_unique<DummyPartitionTable>();
 }
 
 bool DummyDevice::createPartitionTable(Report& report, const PartitionTable& ptable)
@@ -0,0 +1,252 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+/** @file
+*/
+
+#include "plugins/image/imagebackend.h"
+#include "plugins/image/imagedevice.h"
+#include "plugins/image/imagelayout.h"
+
+#include "core/diskdevice.h"
+#include "core/partition.h"
+#include "core/partitiontable.h"
+
+#include "fs/filesystemfactory.h"
+
+#include "util/globallog.h"
+
+#include <QFileInfo>
+#include <QString>
+#include <QStringList>
+
+#include <KLocalizedString>
+#include <KPluginFactory>
+
+K_PLUGIN_FACTORY_WITH_JSON(ImageBackendFactory, "pmimagebackendplugin.json", registerPlugin<ImageBackend>();)
+
+constexpr qint64 imageSectorSize = 512;
+
+ImageBackend::ImageBackend(QObject*, const QList<QVariant>&) :
+    CoreBackend()
+{
+}
+
+void ImageBackend::initFSSupport()
+{
+}
+
+QList<Device*> ImageBackend::scanDevices(bool excludeReadOnly)
+{
+    return scanDevices(excludeReadOnly ? ScanFlags() : ScanFlag::includeReadOnly);
+}
+
+QList<Device*> ImageBackend::scanDevices(const ScanFlags scanFlags)
+{
+    QList<Device*> result;
+
+    const QStringList images = qEnvironmentVariable("KPMCORE_IMAGE_FILES").split(QLatin1Char(':'), Qt::SkipEmptyParts);
+    for (int i = 0; i < images.size(); i++) {
+        const QFileInfo info(images[i]);
+        if (!scanFlags.testFlag(ScanFlag::includeReadOnly) && !info.isWritable())
+            continue;
+
+        Device* d = scanDevice(images[i]);
+        if (d != nullptr)
+            result.append(d);
+
+        emitScanProgress(images[i], (i + 1) * 100 / images.size());
+    }
+
+    return result;
+}
+
+/** Scans an image file.
+
+    Nothing but the image file itself is read, file systems are only recognized by their
+    signatures and their labels and UUIDs are read from their superblocks. Their usage is
+    not determined. Partitions are named after the loop device if the image is attached to
+    one already and after the image file otherwise, see attachDevice().
+
+    @param deviceNode path of the image file
+    @return the scanned Device or nullptr if the file is not a usable image
+*/
+Device* ImageBackend::scanDevice(const QString& deviceNode)
+{
+    const QFileInfo info(deviceNode);
+    if (!info.isFile() || info.size() < 2 * imageSectorSize)
+        return nullptr;
+
+    ImageLayout layout(deviceNode, imageSectorSize);
+    if (!layout.read()) {
+        if (layout.hasExtended())
+            Log(Log::Level::warning) << xi18nc("@info:status", "Image <filename>%1</filename> has logical partitions, which are not supported.", deviceNode);
+        else
+            Log(Log::Level::warning) << xi18nc("@info:status", "The partition table of image <filename>%1</filename> is damaged.", deviceNode);
+        return nullptr;
+    }
+
+    Log(Log::Level::information) << xi18nc("@info:status", "Image found: %1", deviceNode);
+
+    DiskDevice* d = new DiskDevice(info.fileName(), deviceNode, 255, 63, layout.totalSectors() / 255 / 63, imageSectorSize, QStringLiteral("media-floppy"));
+
+    if (layout.type() == PartitionTable::TableType::none)
+        return d;
+
+    const QString loop = ImageLayout::loopDevice(deviceNode);
+
+    CoreBackend::setPartitionTableForDevice(*d, new PartitionTable(layout.type(), layout.firstUsable(), layout.lastUsable()));
+    CoreBackend::setPartitionTableMaxPrimaries(*d->partitionTable(), layout.maxEntries());
+
+    for (const auto &entry : layout.entries()) {
+        PartitionTable::Flags activeFlags = entry.bootable ? PartitionTable::Flag::Boot : PartitionTable::Flag::None;
+        if (entry.type == QStringLiteral("C12A7328-F81F-11D2-BA4B-00A0C93EC93B"))
+            activeFlags |= PartitionTable::Flag::Boot;
+        else if (entry.type == QStringLiteral("21686148-6449-6E6F-744E-656564454649"))
+            activeFlags |= PartitionTable::Flag::BiosGrub;
+
+        const FileSystem::Type type = layout.detectFileSystem(entry.firstSector * imageSectorSize);
+        QString label;
+        QString uuid;
+        layout.readIdentity(entry.firstSector * imageSectorSize, type, label, uuid);
+
+        FileSystem* fs = FileSystemFactory::create(type, entry.firstSector, entry.lastSector, imageSectorSize, -1, label, {}, uuid);
+        Partition* partition = new Partition(d->partitionTable(), *d, PartitionRole(PartitionRole::Primary), fs, entry.firstSector, entry.lastSector,
+                                             PartitionTable::partitionPath(loop.isEmpty() ? deviceNode : loop, entry.number), availableFlags(layout.type()),
+                                             QString(), false, activeFlags);
+
+        partition->setType(entry.type);
+        partition->setUUID(entry.uuid);
+        partition->setLabel(entry.label);
+        partition->setAttributes(entry.attributes);
+
+        d->partitionTable()->append(partition);
+    }
+
+    d->partitionTable()->updateUnallocated(*d);
+
+    return d;
+}
+
+FileSystem::Type ImageBackend::detectFileSystem(const QString& deviceNode)
+{
+    // Partitions of images have no device nodes, only whole images can be probed here
+    if (!QFileInfo(deviceNode).isFile())
+        return FileSystem::Type::Unknown;
+
+    return ImageLayout(deviceNode, imageSectorSize).detectFileSystem(0);
+}
+
+QString ImageBackend::readLabel(const QString& deviceNode) const
+{
+    if (!QFileInfo(deviceNode).isFile())
+        return QString();
+
+    const ImageLayout layout(deviceNode, imageSectorSize);
+    QString label;
+    QString uuid;
+    layout.readIdentity(0, layout.detectFileSystem(0), label, uuid);
+
+    return label;
+}
+
+QString ImageBackend::readUUID(const QString& deviceNode) const
+{
+    if (!QFileInfo(deviceNode).isFile())
+        return QString();
+
+    const ImageLayout layout(deviceNode, imageSectorSize);
+    QString label;
+    QString uuid;
+    layout.readIdentity(0, layout.detectFileSystem(0), label, uuid);
+
+    return uuid;
+}
+
+/** Attaches the image to a loop device, so file system tools can work on its partitions.
+
+    An image that is attached already is used as it is. The partitions of @p d are renamed
+    after the loop device's partitions.
+
+    @param d the image
+    @return true if the partitions have device nodes
+*/
+bool ImageBackend::attachDevice(Device& d)
+{
+    if (!QFileInfo(d.deviceNode()).isFile() || d.partitionTable() == nullptr)
+        return true;
+
+    QString loop = ImageLayout::loopDevice(d.deviceNode());
+    if (loop.isEmpty()) {
+        loop = ImageLayout::attachLoopDevice(d.deviceNode());
+        if (loop.isEmpty())
+            return false;
+
+        m_AttachedLoops.insert(d.deviceNode(), loop);
+    }
+
+    setPartitionNodes(d, loop);
+
+    return true;
+}
+
+/** Detaches the loop device attachDevice() attached the image to.
+    @param d the image
+*/
+void ImageBackend::detachDevice(Device& d)
+{
+    const QString loop = m_AttachedLoops.take(d.deviceNode());
+    if (loop.isEmpty())
+        return;
+
+    if (!ImageLayout::detachLoopDevice(loop))
+        Log(Log::Level::warning) << xi18nc("@info:status", "Could not detach image <filename>%1</filename> from loop device <filename>%2</filename>.", d.deviceNode(), loop);
+
+    if (d.partitionTable())
+        setPartitionNodes(d, d.deviceNode());
+}
+
+void ImageBackend::setPartitionNodes(Device& d, const QString& node)
+{
+    for (const auto &p : d.partitionTable()->children())
+        if (p->number() > 0)
+            p->setPartitionPath(PartitionTable::partitionPath(node, p->number()));
+}
+
+PartitionTable::Flags ImageBackend::availableFlags(PartitionTable::TableType type)
+{
+    if (type == PartitionTable::gpt)
+        return PartitionTable::Flag::BiosGrub | PartitionTable::Flag::Boot;
+
+    return PartitionTable::Flag::Boot;
+}
+
+std::unique_ptr<CoreBackendDevice> ImageBackend::openDevice(const Device& d)
+{
+    std::unique_ptr<ImageDevice> device = std::make_unique<ImageDevice>(d);
+
+    if (!device->open())
+        device = nullptr;
+
+    return device;
+}
+
+std::unique_ptr<CoreBackendDevice> ImageBackend::openDeviceExclusive(const Device& d)
+{
+    std::unique_ptr<ImageDevice> device = std::make_unique<ImageDevice>(d);
+
+    if (!device->openExclusive())
+        device = nullptr;
+
+    return device;
+}
+
+bool ImageBackend::closeDevice(std::unique_ptr<CoreBackendDevice> coreDevice)
+{
+    return coreDevice->close();
+}
+
+#include "imagebackend.moc"
@@ -0,0 +1,60 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_IMAGEBACKEND_H
+#define KPMCORE_IMAGEBACKEND_H
+
+#include "backend/corebackend.h"
+#include "core/partitiontable.h"
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QVariant>
+
+class Device;
+class KPluginFactory;
+
+/** Backend plugin for raw disk image files.
+
+    Treats (sparse) image files as disks. Partition tables are read and written
+    directly in the image file and data is copied in-process, so no helper and no
+    root privileges are needed. Only Operations that run file system tools attach the
+    image to a loop device for as long as they run. Images to scan are taken from the colon separated
+    list in the KPMCORE_IMAGE_FILES environment variable, other images can be
+    opened with scanDevice().
+*/
+class ImageBackend : public CoreBackend
+{
+    Q_DISABLE_COPY(ImageBackend)
+
+public:
+    ImageBackend(QObject* parent, const QList<QVariant>& args);
+
+public:
+    void initFSSupport() override;
+
+    QList<Device*> scanDevices(bool excludeReadOnly = false) override;
+    QList<Device*> scanDevices(const ScanFlags scanFlags) override;
+    std::unique_ptr<CoreBackendDevice> openDevice(const Device& d) override;
+    std::unique_ptr<CoreBackendDevice> openDeviceExclusive(const Device& d) override;
+    bool closeDevice(std::unique_ptr<CoreBackendDevice> coreDevice) override;
+    Device* scanDevice(const QString& deviceNode) override;
+    FileSystem::Type detectFileSystem(const QString& deviceNode) override;
+    QString readLabel(const QString& deviceNode) const override;
+    QString readUUID(const QString& deviceNode) const override;
+    bool attachDevice(Device& d) override;
+    void detachDevice(Device& d) override;
+
+private:
+    static PartitionTable::Flags availableFlags(PartitionTable::TableType type);
+    static void setPartitionNodes(Device& d, const QString& node);
+
+private:
+    QHash<QString, QString> m_AttachedLoops;
+};
+
+#endif
@@ -0,0 +1,127 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "plugins/image/imagedevice.h"
+#include "plugins/image/imagelayout.h"
+#include "plugins/image/imagepartitiontable.h"
+
+#include "core/partition.h"
+#include "core/partitiontable.h"
+
+#include "util/report.h"
+
+#include <QFileInfo>
+
+#include <KLocalizedString>
+
+ImageDevice::ImageDevice(const Device& d) :
+    CoreBackendDevice(d.deviceNode()),
+    m_device(&d)
+{
+}
+
+ImageDevice::~ImageDevice()
+{
+    close();
+}
+
+bool ImageDevice::open()
+{
+    return QFileInfo(m_device->deviceNode()).isFile();
+}
+
+bool ImageDevice::openExclusive()
+{
+    if (!open())
+        return false;
+
+    setExclusive(true);
+
+    return true;
+}
+
+bool ImageDevice::close()
+{
+    if (isExclusive())
+        setExclusive(false);
+
+    return true;
+}
+
+std::unique_ptr<CoreBackendPartitionTable> ImageDevice::openPartitionTable()
+{
+    return std::make_unique<ImagePartitionTable>(m_device);
+}
+
+bool ImageDevice::createPartitionTable(Report& report, const PartitionTable& ptable)
+{
+    if (ptable.type() != PartitionTable::TableType::gpt && ptable.type() != PartitionTable::TableType::msdos &&
+            ptable.type() != PartitionTable::TableType::msdos_sectorbased) {
+        report.line() << xi18nc("@info:progress", "Partition table type %1 is not supported for image <filename>%2</filename>.", ptable.typeName(), m_device->deviceNode());
+        return false;
+    }
+
+    ImageLayout layout(m_device->deviceNode(), m_device->logicalSize());
+    layout.create(ptable.type());
+
+    if (layout.write()) {
+        ImageLayout::reread(m_device->deviceNode());
+        return true;
+    }
+
+    report.line() << xi18nc("@info:progress", "Could not write partition table of image <filename>%1</filename>.", m_device->deviceNode());
+    return false;
+}
+
+/** Writes the new table together with all partitions with a single write to the image. */
+bool ImageDevice::createPartitionTableLayout(Report& report, PartitionTable& ptable)
+{
+    if (!createPartitionTable(report, ptable))
+        return false;
+
+    ImageLayout layout(m_device->deviceNode(), m_device->logicalSize());
+    if (!layout.read())
+        return false;
+
+    QString loop = ImageLayout::loopDevice(m_device->deviceNode());
+    if (loop.isEmpty())
+        loop = m_device->deviceNode();
+
+    for (const auto &p : ptable.children()) {
+        if (p->roles().has(PartitionRole::Unallocated))
+            continue;
+
+        const qint32 number = p->number() > 0 ? p->number() : layout.freeNumber();
+        if (!p->roles().has(PartitionRole::Primary) || number < 1 || number > layout.maxEntries() || layout.find(number) != nullptr) {
+            report.line() << xi18nc("@info:progress", "Failed to add partition <filename>%1</filename> to device <filename>%2</filename>.", p->deviceNode(), m_device->deviceNode());
+            return false;
+        }
+
+        ImageLayoutEntry entry;
+        entry.number = number;
+        entry.firstSector = p->firstSector();
+        entry.lastSector = p->lastSector();
+        entry.type = p->type().isEmpty() ? ImageLayout::defaultType(p->fileSystem().type(), layout.type()) : p->type();
+        entry.label = p->label();
+        entry.attributes = p->attributes();
+        entry.bootable = p->activeFlags().testFlag(PartitionTable::Flag::Boot);
+        layout.entries().append(entry);
+        p->setPartitionPath(PartitionTable::partitionPath(loop, number));
+    }
+
+    if (!layout.write()) {
+        report.line() << xi18nc("@info:progress", "Failed to write partition layout to device <filename>%1</filename>.", m_device->deviceNode());
+        return false;
+    }
+
+    ImageLayout::reread(m_device->deviceNode());
+
+    for (const auto &p : ptable.children())
+        if (!p->roles().has(PartitionRole::Unallocated))
+            p->setState(Partition::State::None);
+
+    return true;
+}
@@ -0,0 +1,42 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef IMAGEDEVICE__H
+#define IMAGEDEVICE__H
+
+#include "backend/corebackenddevice.h"
+#include "core/device.h"
+
+#include <QtGlobal>
+
+class Partition;
+class PartitionTable;
+class Report;
+class CoreBackendPartitionTable;
+
+class ImageDevice : public CoreBackendDevice
+{
+    Q_DISABLE_COPY(ImageDevice)
+
+public:
+    explicit ImageDevice(const Device& d);
+    ~ImageDevice();
+
+public:
+    bool open() override;
+    bool openExclusive() override;
+    bool close() override;
+
+    std::unique_ptr<CoreBackendPartitionTable> openPartitionTable() override;
+
+    bool createPartitionTable(Report& report, const PartitionTable& ptable) override;
+    bool createPartitionTableLayout(Report& report, PartitionTable& ptable) override;
+
+private:
+    const Device *m_device;
+};
+
+#endif
@@ -0,0 +1,645 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "plugins/image/imagelayout.h"
+
+#include "util/externalcommand.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QRandomGenerator>
+#include <QtEndian>
+#include <QUuid>
+
+static const QByteArray gptSignature = QByteArrayLiteral("EFI PART");
+constexpr qint32 gptHeaderSize = 92;
+constexpr qint32 gptEntrySize = 128;
+constexpr qint32 gptDefaultEntries = 128;
+
+static quint32 crc32(const QByteArray& data)
+{
+    quint32 crc = 0xFFFFFFFF;
+    for (const char c : data) {
+        crc ^= static_cast<quint8>(c);
+        for (int i = 0; i < 8; i++)
+            crc = (crc >> 1) ^ ((crc & 1) ? 0xEDB88320 : 0);
+    }
+
+    return ~crc;
+}
+
+static QByteArray guidToBytes(const QString& guid)
+{
+    const QUuid uuid(guid);
+    QByteArray result(16, '\0');
+    qToLittleEndian<quint32>(uuid.data1, result.data());
+    qToLittleEndian<quint16>(uuid.data2, result.data() + 4);
+    qToLittleEndian<quint16>(uuid.data3, result.data() + 6);
+    std::memcpy(result.data() + 8, uuid.data4, 8);
+
+    return result;
+}
+
+static QString guidFromBytes(const char* data)
+{
+    const uchar* d = reinterpret_cast<const uchar*>(data);
+    const QUuid uuid(qFromLittleEndian<quint32>(d), qFromLittleEndian<quint16>(d + 4), qFromLittleEndian<quint16>(d + 6),
+                     d[8], d[9], d[10], d[11], d[12], d[13], d[14], d[15]);
+
+    return uuid.isNull() ? QString() : uuid.toString(QUuid::WithoutBraces).toUpper();
+}
+
+/** Creates a new ImageLayout. Call read() or create() before using it.
+    @param fileName the image file
+    @param sectorSize the logical sector size of the image
+*/
+ImageLayout::ImageLayout(const QString& fileName, qint64 sectorSize) :
+    m_FileName(fileName),
+    m_SectorSize(sectorSize),
+    m_TotalSectors(QFile(fileName).size() / sectorSize),
+    m_Type(PartitionTable::TableType::none),
+    m_MaxEntries(0),
+    m_FirstUsable(0),
+    m_LastUsable(0),
+    m_HasExtended(false)
+{
+}
+
+/** Reads the partition table from the image file.
+    @return false if the file could not be read, the table is damaged or it has an
+            extended partition, see hasExtended()
+*/
+bool ImageLayout::read()
+{
+    m_Type = PartitionTable::TableType::none;
+    m_HasExtended = false;
+    m_Entries.clear();
+
+    if (m_TotalSectors < 2)
+        return true;
+
+    const QByteArray mbr = readBytes(0, m_SectorSize);
+    if (mbr.size() != m_SectorSize)
+        return false;
+
+    if (static_cast<quint8>(mbr[510]) != 0x55 || static_cast<quint8>(mbr[511]) != 0xaa)
+        return true;
+
+    // A valid GPT takes precedence over the protective MBR, fall back to the backup header if needed
+    if (readGpt(readBytes(m_SectorSize, m_SectorSize)) || readGpt(readBytes((m_TotalSectors - 1) * m_SectorSize, m_SectorSize)))
+        return true;
+
+    const uchar* d = reinterpret_cast<const uchar*>(mbr.constData());
+    for (qint32 i = 0; i < 4; i++) {
+        const uchar* entry = d + 446 + i * 16;
+        if (entry[4] == 0xee)
+            return false; // protective MBR without a valid GPT
+        if (entry[4] == 0)
+            continue;
+
+        // Logical partitions are not supported, writing the table back would lose them
+        if (entry[4] == 0x05 || entry[4] == 0x0f || entry[4] == 0x85) {
+            m_HasExtended = true;
+            m_Entries.clear();
+            return false;
+        }
+
+        ImageLayoutEntry e;
+        e.number = i + 1;
+        e.firstSector = qFromLittleEndian<quint32>(entry + 8);
+        e.lastSector = e.firstSector + qFromLittleEndian<quint32>(entry + 12) - 1;
+        e.type = QString::number(entry[4], 16);
+        e.bootable = entry[0] == 0x80;
+        m_Entries.append(e);
+    }
+
+    m_Type = PartitionTable::TableType::msdos;
+    m_MaxEntries = 4;
+    m_DiskId = QStringLiteral("0x%1").arg(qFromLittleEndian<quint32>(d + 440), 8, 16, QLatin1Char('0'));
+
+    return true;
+}
+
+bool ImageLayout::readGpt(const QByteArray& header)
+{
+    if (header.size() < gptHeaderSize || !header.startsWith(gptSignature))
+        return false;
+
+    const uchar* d = reinterpret_cast<const uchar*>(header.constData());
+    const quint32 headerSize = qFromLittleEndian<quint32>(d + 12);
+    if (headerSize < gptHeaderSize || headerSize > static_cast<quint32>(header.size()))
+        return false;
+
+    QByteArray crcData = header.left(headerSize);
+    std::memset(crcData.data() + 16, 0, 4);
+    if (crc32(crcData) != qFromLittleEndian<quint32>(d + 16))
+        return false;
+
+    const qint64 firstUsable = qFromLittleEndian<quint64>(d + 40);
+    const qint64 lastUsable = qFromLittleEndian<quint64>(d + 48);
+    const qint64 entriesLba = qFromLittleEndian<quint64>(d + 72);
+    const quint32 numEntries = qFromLittleEndian<quint32>(d + 80);
+    const quint32 entrySize = qFromLittleEndian<quint32>(d + 84);
+    if (entrySize < gptEntrySize || numEntries == 0 || numEntries > 1024 || firstUsable > lastUsable)
+        return false;
+
+    const QByteArray entries = readBytes(entriesLba * m_SectorSize, numEntries * entrySize);
+    if (entries.size() != static_cast<qint32>(numEntries * entrySize) || crc32(entries) != qFromLittleEndian<quint32>(d + 88))
+        return false;
+
+    for (quint32 i = 0; i < numEntries; i++) {
+        const char* entry = entries.constData() + i * entrySize;
+        const QString type = guidFromBytes(entry);
+        if (type.isEmpty())
+            continue;
+
+        const uchar* e = reinterpret_cast<const uchar*>(entry);
+        ImageLayoutEntry partition;
+        partition.number = i + 1;
+        partition.type = type;
+        partition.uuid = guidFromBytes(entry + 16);
+        partition.firstSector = qFromLittleEndian<quint64>(e + 32);
+        partition.lastSector = qFromLittleEndian<quint64>(e + 40);
+        partition.attributes = qFromLittleEndian<quint64>(e + 48);
+
+        QString name;
+        for (qint32 c = 0; c < 36; c++) {
+            const quint16 unit = qFromLittleEndian<quint16>(e + 56 + 2 * c);
+            if (unit == 0)
+                break;
+            name += QChar(unit);
+        }
+        partition.label = name;
+
+        m_Entries.append(partition);
+    }
+
+    m_Type = PartitionTable::TableType::gpt;
+    m_MaxEntries = numEntries;
+    m_DiskId = guidFromBytes(header.constData() + 56);
+
+    // write() puts the entries right after the header and before the backup header, keep
+    // the usable range the table was created with as far as that leaves room for them
+    const qint64 entriesSectors = (m_MaxEntries * gptEntrySize + m_SectorSize - 1) / m_SectorSize;
+    m_FirstUsable = qMax<qint64>(firstUsable, 2 + entriesSectors);
+    m_LastUsable = qMin<qint64>(lastUsable, m_TotalSectors - 2 - entriesSectors);
+
+    return true;
+}
+
+/** Replaces the table in memory with a new, empty table. Call write() to store it.
+    @param type the type of the new table, gpt or msdos
+*/
+void ImageLayout::create(PartitionTable::TableType type)
+{
+    m_Type = type == PartitionTable::TableType::msdos_sectorbased ? PartitionTable::TableType::msdos : type;
+    m_Entries.clear();
+
+    if (m_Type == PartitionTable::TableType::gpt) {
+        const qint64 entriesSectors = (gptDefaultEntries * gptEntrySize + m_SectorSize - 1) / m_SectorSize;
+        m_MaxEntries = gptDefaultEntries;
+        m_FirstUsable = 2 + entriesSectors;
+        m_LastUsable = m_TotalSectors - 2 - entriesSectors;
+        m_DiskId = QUuid::createUuid().toString(QUuid::WithoutBraces).toUpper();
+    } else {
+        m_MaxEntries = 4;
+        m_DiskId = QStringLiteral("0x%1").arg(QRandomGenerator::global()->generate(), 8, 16, QLatin1Char('0'));
+    }
+}
+
+/** Writes the partition table to the image file.
+    @return true on success
+*/
+bool ImageLayout::write() const
+{
+    if (m_Type == PartitionTable::TableType::gpt)
+        return writeGpt();
+    if (m_Type == PartitionTable::TableType::msdos)
+        return writeMbr();
+
+    return false;
+}
+
+bool ImageLayout::writeMbr() const
+{
+    QFile file(m_FileName);
+    if (!file.open(QIODevice::ReadWrite))
+        return false;
+
+    QByteArray mbr = readBytes(0, m_SectorSize);
+    mbr.resize(m_SectorSize);
+    uchar* d = reinterpret_cast<uchar*>(mbr.data());
+
+    // keep the boot code, replace everything else
+    std::memset(d + 440, 0, 512 - 440);
+    qToLittleEndian<quint32>(m_DiskId.mid(2).toUInt(nullptr, 16), d + 440);
+
+    for (const auto &e : m_Entries) {
+        if (e.number < 1 || e.number > 4)
+            return false;
+
+        uchar* entry = d + 446 + (e.number - 1) * 16;
+        entry[0] = e.bootable ? 0x80 : 0;
+        entry[1] = entry[5] = 0xfe;
+        entry[2] = entry[3] = entry[6] = entry[7] = 0xff;
+        entry[4] = static_cast<uchar>(e.type.toUInt(nullptr, 16));
+        qToLittleEndian<quint32>(static_cast<quint32>(e.firstSector), entry + 8);
+        qToLittleEndian<quint32>(static_cast<quint32>(e.lastSector - e.firstSector + 1), entry + 12);
+    }
+    d[510] = 0x55;
+    d[511] = 0xaa;
+
+    if (!file.seek(0) || file.write(mbr) != mbr.size())
+        return false;
+
+    // remove stale GPT headers, so the image is not detected as GPT any more
+    for (const qint64 lba : { qint64(1), m_TotalSectors - 1 }) {
+        if (readBytes(lba * m_SectorSize, gptSignature.size()) == gptSignature &&
+                (!file.seek(lba * m_SectorSize) || file.write(QByteArray(m_SectorSize, '\0')) != m_SectorSize))
+            return false;
+    }
+
+    return file.flush();
+}
+
+bool ImageLayout::writeGpt() const
+{
+    QFile file(m_FileName);
+    if (!file.open(QIODevice::ReadWrite))
+        return false;
+
+    const qint64 entriesSectors = (m_MaxEntries * gptEntrySize + m_SectorSize - 1) / m_SectorSize;
+
+    QByteArray entries(entriesSectors * m_SectorSize, '\0');
+    for (const auto &e : m_Entries) {
+        if (e.number < 1 || e.number > m_MaxEntries)
+            return false;
+
+        char* entry = entries.data() + (e.number - 1) * gptEntrySize;
+        uchar* u = reinterpret_cast<uchar*>(entry);
+        std::memcpy(entry, guidToBytes(e.type).constData(), 16);
+        std::memcpy(entry + 16, guidToBytes(e.uuid.isEmpty() ? QUuid::createUuid().toString() : e.uuid).constData(), 16);
+        qToLittleEndian<quint64>(e.firstSector, u + 32);
+        qToLittleEndian<quint64>(e.lastSector, u + 40);
+        qToLittleEndian<quint64>(e.attributes, u + 48);
+        for (qint32 c = 0; c < qMin(e.label.size(), 36); c++)
+            qToLittleEndian<quint16>(e.label.at(c).unicode(), u + 56 + 2 * c);
+    }
+    const quint32 entriesCrc = crc32(entries.left(m_MaxEntries * gptEntrySize));
+
+    auto header = [&] (qint64 currentLba, qint64 backupLba, qint64 entriesLba) {
+        QByteArray h(m_SectorSize, '\0');
+        uchar* d = reinterpret_cast<uchar*>(h.data());
+        std::memcpy(h.data(), gptSignature.constData(), 8);
+        qToLittleEndian<quint32>(0x00010000, d + 8);
+        qToLittleEndian<quint32>(gptHeaderSize, d + 12);
+        qToLittleEndian<quint64>(currentLba, d + 24);
+        qToLittleEndian<quint64>(backupLba, d + 32);
+        qToLittleEndian<quint64>(firstUsable(), d + 40);
+        qToLittleEndian<quint64>(lastUsable(), d + 48);
+        std::memcpy(h.data() + 56, guidToBytes(m_DiskId).constData(), 16);
+        qToLittleEndian<quint64>(entriesLba, d + 72);
+        qToLittleEndian<quint32>(m_MaxEntries, d + 80);
+        qToLittleEndian<quint32>(gptEntrySize, d + 84);
+        qToLittleEndian<quint32>(entriesCrc, d + 88);
+        qToLittleEndian<quint32>(crc32(h.left(gptHeaderSize)), d + 16);
+        return h;
+    };
+
+    // protective MBR, keeping the boot code
+    QByteArray mbr = readBytes(0, m_SectorSize);
+    mbr.resize(m_SectorSize);
+    uchar* d = reinterpret_cast<uchar*>(mbr.data());
+    std::memset(d + 440, 0, 512 - 440);
+    d[446 + 2] = 0x02;
+    d[446 + 4] = 0xee;
+    d[446 + 5] = d[446 + 6] = d[446 + 7] = 0xff;
+    qToLittleEndian<quint32>(1, d + 446 + 8);
+    qToLittleEndian<quint32>(static_cast<quint32>(qMin<qint64>(m_TotalSectors - 1, 0xffffffff)), d + 446 + 12);
+    d[510] = 0x55;
+    d[511] = 0xaa;
+
+    const qint64 lastLba = m_TotalSectors - 1;
+    const qint64 backupEntriesLba = lastLba - entriesSectors;
+
+    return file.seek(0) && file.write(mbr) == mbr.size() &&
+           file.seek(m_SectorSize) && file.write(header(1, lastLba, 2)) == m_SectorSize &&
+           file.seek(2 * m_SectorSize) && file.write(entries) == entries.size() &&
+           file.seek(backupEntriesLba * m_SectorSize) && file.write(entries) == entries.size() &&
+           file.seek(lastLba * m_SectorSize) && file.write(header(lastLba, 1, backupEntriesLba)) == m_SectorSize &&
+           file.flush();
+}
+
+/** @return the first sector partitions may start at, for GPT as given in its header */
+qint64 ImageLayout::firstUsable() const
+{
+    if (m_Type == PartitionTable::TableType::gpt)
+        return m_FirstUsable;
+
+    return 1;
+}
+
+/** @return the last sector partitions may end at, for GPT as given in its header */
+qint64 ImageLayout::lastUsable() const
+{
+    if (m_Type == PartitionTable::TableType::gpt)
+        return m_LastUsable;
+
+    return qMin<qint64>(m_TotalSectors - 1, 0xffffffff);
+}
+
+/** @param number the partition number to look for
+    @return the entry with the given number or nullptr if there is none
+*/
+ImageLayoutEntry* ImageLayout::find(qint32 number)
+{
+    for (auto &e : m_Entries)
+        if (e.number == number)
+            return &e;
+
+    return nullptr;
+}
+
+/** @return the lowest unused partition number or -1 if the table is full */
+qint32 ImageLayout::freeNumber() const
+{
+    for (qint32 number = 1; number <= m_MaxEntries; number++) {
+        if (std::none_of(m_Entries.begin(), m_Entries.end(), [number] (const ImageLayoutEntry& e) { return e.number == number; }))
+            return number;
+    }
+
+    return -1;
+}
+
+/** Overwrites an area of the image with zeros.
+    @param offset first byte to overwrite
+    @param length number of bytes to overwrite
+    @return true on success
+*/
+bool ImageLayout::wipe(qint64 offset, qint64 length) const
+{
+    QFile file(m_FileName);
+    if (!file.open(QIODevice::ReadWrite) || !file.seek(offset))
+        return false;
+
+    const QByteArray zeros(qMin<qint64>(length, 1024 * 1024), '\0');
+    while (length > 0) {
+        const qint64 size = qMin<qint64>(length, zeros.size());
+        if (file.write(zeros.constData(), size) != size)
+            return false;
+        length -= size;
+    }
+
+    return file.flush();
+}
+
+/** @param offset first byte to read
+    @param length number of bytes to read
+    @return the bytes read, may be shorter than @p length at the end of the image
+*/
+QByteArray ImageLayout::readBytes(qint64 offset, qint64 length) const
+{
+    QFile file(m_FileName);
+    if (!file.open(QIODevice::ReadOnly) || !file.seek(offset))
+        return QByteArray();
+
+    return file.read(length);
+}
+
+/** Detects a file system by looking for its signature.
+
+    Only the most common file systems are recognized, this is enough to show the layout of
+    an image without running external tools.
+
+    @param offset byte offset of the start of the file system in the image
+    @return the detected file system type
+*/
+FileSystem::Type ImageLayout::detectFileSystem(qint64 offset) const
+{
+    const QByteArray data = readBytes(offset, 0x10100);
+    auto has = [&data] (qint32 pos, const QByteArray& magic) {
+        return data.size() >= pos + magic.size() && data.mid(pos, magic.size()) == magic;
+    };
+
+    if (has(0, QByteArrayLiteral("LUKS\xba\xbe")))
+        return static_cast<quint8>(data.size() > 7 ? data[7] : 0) == 2 ? FileSystem::Type::Luks2 : FileSystem::Type::Luks;
+    if (has(0, QByteArrayLiteral("XFSB")))
+        return FileSystem::Type::Xfs;
+    if (has(3, QByteArrayLiteral("NTFS    ")))
+        return FileSystem::Type::Ntfs;
+    if (has(3, QByteArrayLiteral("EXFAT   ")))
+        return FileSystem::Type::Exfat;
+    if (has(82, QByteArrayLiteral("FAT32   ")))
+        return FileSystem::Type::Fat32;
+    if (has(54, QByteArrayLiteral("FAT16   ")))
+        return FileSystem::Type::Fat16;
+    if (has(54, QByteArrayLiteral("FAT12   ")))
+        return FileSystem::Type::Fat12;
+    if (has(0x10040, QByteArrayLiteral("_BHRfS_M")))
+        return FileSystem::Type::Btrfs;
+    if (has(4086, QByteArrayLiteral("SWAPSPACE2")) || has(4086, QByteArrayLiteral("SWAP-SPACE")))
+        return FileSystem::Type::LinuxSwap;
+    if (has(1080, QByteArrayLiteral("\x53\xef"))) {
+        const uchar* sb = reinterpret_cast<const uchar*>(data.constData()) + 1024;
+        const quint32 compat = qFromLittleEndian<quint32>(sb + 92);
+        const quint32 incompat = qFromLittleEndian<quint32>(sb + 96);
+        if (incompat & (0x40 | 0x80 | 0x200)) // extents, 64bit, flex_bg
+            return FileSystem::Type::Ext4;
+        if (compat & 0x4) // has_journal
+            return FileSystem::Type::Ext3;
+        return FileSystem::Type::Ext2;
+    }
+
+    return FileSystem::Type::Unknown;
+}
+
+static QString readString(const QByteArray& data, qint32 pos, qint32 length)
+{
+    const QByteArray bytes = data.mid(pos, length);
+    const qint32 end = bytes.indexOf('\0');
+
+    return QString::fromUtf8(end < 0 ? bytes : bytes.left(end)).trimmed();
+}
+
+static QString readSerial(const QByteArray& data, qint32 pos)
+{
+    const quint32 serial = qFromLittleEndian<quint32>(reinterpret_cast<const uchar*>(data.constData()) + pos);
+
+    return QStringLiteral("%1-%2").arg(serial >> 16, 4, 16, QLatin1Char('0')).arg(serial & 0xffff, 4, 16, QLatin1Char('0')).toUpper();
+}
+
+static QString readUuid(const QByteArray& data, qint32 pos)
+{
+    const QUuid uuid = QUuid::fromRfc4122(data.mid(pos, 16));
+
+    return uuid.isNull() ? QString() : uuid.toString(QUuid::WithoutBraces);
+}
+
+/** Reads the label and UUID of a file system from its superblock, as blkid would show them.
+
+    @param offset byte offset of the start of the file system in the image
+    @param type the type detectFileSystem() found at @p offset
+    @param label set to the label, empty if it has none or it cannot be read
+    @param uuid set to the UUID, empty if it has none or it cannot be read
+*/
+void ImageLayout::readIdentity(qint64 offset, FileSystem::Type type, QString& label, QString& uuid) const
+{
+    label.clear();
+    uuid.clear();
+
+    const QByteArray data = readBytes(offset, 0x10000 + 0x12b + 256);
+    if (data.size() < (type == FileSystem::Type::Btrfs ? 0x10000 + 0x12b + 256 : 4096))
+        return;
+
+    switch (type) {
+    case FileSystem::Type::Ext2:
+    case FileSystem::Type::Ext3:
+    case FileSystem::Type::Ext4:
+        uuid = readUuid(data, 1024 + 104);
+        label = readString(data, 1024 + 120, 16);
+        break;
+    case FileSystem::Type::Xfs:
+        uuid = readUuid(data, 32);
+        label = readString(data, 108, 12);
+        break;
+    case FileSystem::Type::Btrfs:
+        uuid = readUuid(data, 0x10000 + 0x20);
+        label = readString(data, 0x10000 + 0x12b, 256);
+        break;
+    case FileSystem::Type::LinuxSwap:
+        uuid = readUuid(data, 1024 + 12);
+        label = readString(data, 1024 + 28, 16);
+        break;
+    case FileSystem::Type::Fat12:
+    case FileSystem::Type::Fat16:
+        uuid = readSerial(data, 39);
+        label = readString(data, 43, 11);
+        break;
+    case FileSystem::Type::Fat32:
+        uuid = readSerial(data, 67);
+        label = readString(data, 71, 11);
+        break;
+    case FileSystem::Type::Exfat:
+        uuid = readSerial(data, 100);
+        break;
+    case FileSystem::Type::Ntfs:
+        uuid = QStringLiteral("%1").arg(qFromLittleEndian<quint64>(reinterpret_cast<const uchar*>(data.constData()) + 0x48), 16, 16, QLatin1Char('0')).toUpper();
+        break;
+    case FileSystem::Type::Luks2:
+        label = readString(data, 24, 48);
+        Q_FALLTHROUGH();
+    case FileSystem::Type::Luks:
+        uuid = readString(data, 168, 40);
+        break;
+    default:
+        break;
+    }
+
+    // FAT without a label has "NO NAME" in its boot sector
+    if (label == QStringLiteral("NO NAME"))
+        label.clear();
+}
+
+static QByteArray readSysfs(const QString& path)
+{
+    QFile file(path);
+    if (!file.open(QIODevice::ReadOnly))
+        return QByteArray();
+
+    return file.readAll().trimmed();
+}
+
+/** Finds the loop device an image file is attached to with partition scanning.
+
+    Only sysfs is read, so this works without privileges.
+
+    @param fileName the image file
+    @return the loop device, empty if there is none
+*/
+QString ImageLayout::loopDevice(const QString& fileName)
+{
+    const QString canonicalName = QFileInfo(fileName).canonicalFilePath();
+    if (canonicalName.isEmpty())
+        return QString();
+
+    const QStringList loops = QDir(QStringLiteral("/sys/block")).entryList({ QStringLiteral("loop*") }, QDir::Dirs | QDir::NoDotAndDotDot);
+    for (const auto &loop : loops) {
+        const QString dir = QStringLiteral("/sys/block/%1/loop/").arg(loop);
+        if (QString::fromLocal8Bit(readSysfs(dir + QStringLiteral("backing_file"))) == canonicalName &&
+                readSysfs(dir + QStringLiteral("offset")) == "0" && readSysfs(dir + QStringLiteral("partscan")) == "1")
+            return QStringLiteral("/dev/") + loop;
+    }
+
+    return QString();
+}
+
+/** Attaches an image file to a new loop device with partition scanning.
+    @param fileName the image file
+    @return the loop device, empty on failure
+*/
+QString ImageLayout::attachLoopDevice(const QString& fileName)
+{
+    ExternalCommand setup(QStringLiteral("losetup"), { QStringLiteral("--find"), QStringLiteral("--show"), QStringLiteral("--partscan"), fileName });
+    if (!setup.run(-1) || setup.exitCode() != 0)
+        return QString();
+
+    return setup.output().trimmed();
+}
+
+/** Detaches a loop device attached with attachLoopDevice().
+    @param loop the loop device
+    @return true on success
+*/
+bool ImageLayout::detachLoopDevice(const QString& loop)
+{
+    ExternalCommand detach(QStringLiteral("losetup"), { QStringLiteral("--detach"), loop });
+
+    return detach.run(-1) && detach.exitCode() == 0;
+}
+
+/** Tells the kernel about changes to the partition table, if the image is attached to a loop device.
+    @param fileName the image file
+*/
+void ImageLayout::reread(const QString& fileName)
+{
+    const QString loop = loopDevice(fileName);
+    if (loop.isEmpty())
+        return;
+
+    ExternalCommand(QStringLiteral("partx"), { QStringLiteral("--update"), loop }).run();
+    ExternalCommand(QStringLiteral("udevadm"), { QStringLiteral("settle") }).run();
+}
+
+/** @return the partition type to use for a new partition with the given file system */
+QString ImageLayout::defaultType(FileSystem::Type t, PartitionTable::TableType tableType)
+{
+    const bool gpt = tableType == PartitionTable::TableType::gpt;
+
+    switch (t) {
+    case FileSystem::Type::LinuxSwap:
+        return gpt ? QStringLiteral("0657FD6D-A4AB-43C4-84E5-0933C84B4F4F") : QStringLiteral("82");
+    case FileSystem::Type::Fat12:
+    case FileSystem::Type::Fat16:
+        return gpt ? QStringLiteral("EBD0A0A2-B9E5-4433-87C0-68B6B72699C7") : QStringLiteral("6");
+    case FileSystem::Type::Fat32:
+        return gpt ? QStringLiteral("EBD0A0A2-B9E5-4433-87C0-68B6B72699C7") : QStringLiteral("c");
+    case FileSystem::Type::Ntfs:
+    case FileSystem::Type::Exfat:
+    case FileSystem::Type::Udf:
+        return gpt ? QStringLiteral("EBD0A0A2-B9E5-4433-87C0-68B6B72699C7") : QStringLiteral("7");
+    case FileSystem::Type::Hfs:
+    case FileSystem::Type::HfsPlus:
+        return gpt ? QStringLiteral("48465300-0000-11AA-AA11-00306543ECAC") : QStringLiteral("af");
+    case FileSystem::Type::Extended:
+        return QStringLiteral("5");
+    default:
+        return gpt ? QStringLiteral("0FC63DAF-8483-4772-8E79-3D69D8477DE4") : QStringLiteral("83");
+    }
+}
@@ -0,0 +1,106 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef IMAGELAYOUT__H
+#define IMAGELAYOUT__H
+
+#include "core/partitiontable.h"
+
+#include "fs/filesystem.h"
+
+#include <QByteArray>
+#include <QString>
+#include <QVector>
+#include <QtGlobal>
+
+/** One partition table entry in an image file. */
+struct ImageLayoutEntry
+{
+    qint32 number = 0;
+    qint64 firstSector = 0;
+    qint64 lastSector = 0;
+    QString type;           /**< GPT type GUID or MBR type in hex, as printed by sfdisk */
+    QString uuid;           /**< GPT partition GUID */
+    QString label;          /**< GPT partition name */
+    quint64 attributes = 0; /**< GPT attribute bits */
+    bool bootable = false;  /**< MBR active flag */
+};
+
+/** Partition table of a disk image file.
+
+    Reads and writes GPT and MBR partition tables directly in the image file, so image
+    files can be partitioned without loop devices or elevated privileges. On MBR only
+    primary partitions are supported, tables with an extended partition are rejected.
+
+    File system tools need device nodes. While an Operation runs them, the image is attached
+    to a loop device with partition scanning and its partitions show up as the loop device's
+    partitions. Reading the layout never needs a loop device.
+*/
+class ImageLayout
+{
+public:
+    explicit ImageLayout(const QString& fileName, qint64 sectorSize = 512);
+
+public:
+    bool read();
+    bool write() const;
+    void create(PartitionTable::TableType type);
+
+    ImageLayoutEntry* find(qint32 number);
+    qint32 freeNumber() const;
+
+    bool wipe(qint64 offset, qint64 length) const;
+    QByteArray readBytes(qint64 offset, qint64 length) const;
+    FileSystem::Type detectFileSystem(qint64 offset) const;
+    void readIdentity(qint64 offset, FileSystem::Type type, QString& label, QString& uuid) const;
+
+    PartitionTable::TableType type() const {
+        return m_Type;    /**< @return the type of the partition table, none if there is no table */
+    }
+    qint64 totalSectors() const {
+        return m_TotalSectors;    /**< @return the size of the image in sectors */
+    }
+    qint64 firstUsable() const;
+    qint64 lastUsable() const;
+    bool hasExtended() const {
+        return m_HasExtended;    /**< @return true if read() found an MBR extended partition */
+    }
+    qint32 maxEntries() const {
+        return m_MaxEntries;    /**< @return the maximum number of partitions */
+    }
+
+    QVector<ImageLayoutEntry>& entries() {
+        return m_Entries;    /**< @return the partitions in this table */
+    }
+    const QVector<ImageLayoutEntry>& entries() const {
+        return m_Entries;    /**< @return the partitions in this table */
+    }
+
+    static QString defaultType(FileSystem::Type t, PartitionTable::TableType tableType);
+    static QString loopDevice(const QString& fileName);
+    static QString attachLoopDevice(const QString& fileName);
+    static bool detachLoopDevice(const QString& loop);
+    static void reread(const QString& fileName);
+
+private:
+    bool readGpt(const QByteArray& header);
+    bool writeGpt() const;
+    bool writeMbr() const;
+
+private:
+    QString m_FileName;
+    qint64 m_SectorSize;
+    qint64 m_TotalSectors;
+    PartitionTable::TableType m_Type;
+    QString m_DiskId;
+    qint32 m_MaxEntries;
+    qint64 m_FirstUsable;
+    qint64 m_LastUsable;
+    bool m_HasExtended;
+    QVector<ImageLayoutEntry> m_Entries;
+};
+
+#endif
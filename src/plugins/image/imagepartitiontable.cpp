@@ -0,0 +1,239 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "plugins/image/imagepartitiontable.h"
+#include "plugins/image/imagelayout.h"
+
+#include "core/partition.h"
+#include "core/device.h"
+
+#include "fs/filesystem.h"
+
+#include "util/report.h"
+
+#include <algorithm>
+
+#include <KLocalizedString>
+
+static const QString espType = QStringLiteral("C12A7328-F81F-11D2-BA4B-00A0C93EC93B");
+static const QString biosGrubType = QStringLiteral("21686148-6449-6E6F-744E-656564454649");
+
+ImagePartitionTable::ImagePartitionTable(const Device* d) :
+    CoreBackendPartitionTable(d->deviceNode()),
+    m_device(d)
+{
+}
+
+ImagePartitionTable::~ImagePartitionTable()
+{
+}
+
+bool ImagePartitionTable::open()
+{
+    return true;
+}
+
+bool ImagePartitionTable::commit(quint32 timeout)
+{
+    // Changes are written to the image immediately, only the loop device has to pick them up
+    Q_UNUSED(timeout)
+
+    ImageLayout::reread(m_device->deviceNode());
+
+    return true;
+}
+
+bool ImagePartitionTable::readLayout(Report& report, ImageLayout& layout) const
+{
+    if (layout.read() && layout.type() != PartitionTable::TableType::none)
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Could not read partition table of image <filename>%1</filename>.", m_device->deviceNode());
+    return false;
+}
+
+bool ImagePartitionTable::writeLayout(Report& report, const ImageLayout& layout) const
+{
+    if (layout.write())
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Could not write partition table of image <filename>%1</filename>.", m_device->deviceNode());
+    return false;
+}
+
+bool ImagePartitionTable::modifyEntry(Report& report, const Partition& partition, const std::function<void(ImageLayout&, ImageLayoutEntry&)>& modify) const
+{
+    ImageLayout layout(m_device->deviceNode(), m_device->logicalSize());
+    if (!readLayout(report, layout))
+        return false;
+
+    ImageLayoutEntry* entry = layout.find(partition.number());
+    if (entry == nullptr) {
+        report.line() << xi18nc("@info:progress", "Could not find partition <filename>%1</filename> in image <filename>%2</filename>.", partition.deviceNode(), m_device->deviceNode());
+        return false;
+    }
+
+    modify(layout, *entry);
+
+    return writeLayout(report, layout);
+}
+
+QString ImagePartitionTable::createPartition(Report& report, const Partition& partition)
+{
+    if (!partition.roles().has(PartitionRole::Primary)) {
+        report.line() << xi18nc("@info:progress", "Only primary partitions can be created in image <filename>%1</filename>.", m_device->deviceNode());
+        return QString();
+    }
+
+    ImageLayout layout(m_device->deviceNode(), m_device->logicalSize());
+    if (!readLayout(report, layout))
+        return QString();
+
+    ImageLayoutEntry entry;
+    entry.number = layout.freeNumber();
+    entry.firstSector = partition.firstSector();
+    entry.lastSector = partition.lastSector();
+    entry.type = partition.type().isEmpty() ? ImageLayout::defaultType(partition.fileSystem().type(), layout.type()) : partition.type();
+    entry.uuid = partition.uuid();
+    entry.label = partition.label();
+    entry.attributes = partition.attributes();
+
+    if (entry.number < 0 || entry.firstSector < layout.firstUsable() || entry.lastSector > layout.lastUsable()) {
+        report.line() << xi18nc("@info:progress", "Failed to add partition <filename>%1</filename> to device <filename>%2</filename>.", partition.deviceNode(), m_device->deviceNode());
+        return QString();
+    }
+
+    layout.entries().append(entry);
+    if (!writeLayout(report, layout))
+        return QString();
+
+    const QString loop = ImageLayout::loopDevice(m_device->deviceNode());
+
+    return PartitionTable::partitionPath(loop.isEmpty() ? m_device->deviceNode() : loop, entry.number);
+}
+
+bool ImagePartitionTable::deletePartition(Report& report, const Partition& partition)
+{
+    ImageLayout layout(m_device->deviceNode(), m_device->logicalSize());
+    if (!readLayout(report, layout))
+        return false;
+
+    const qint32 count = layout.entries().size();
+    layout.entries().erase(std::remove_if(layout.entries().begin(), layout.entries().end(),
+                                          [&partition] (const ImageLayoutEntry& e) { return e.number == partition.number(); }),
+                           layout.entries().end());
+
+    if (layout.entries().size() == count) {
+        report.line() << xi18nc("@info:progress", "Could not delete partition <filename>%1</filename>.", partition.deviceNode());
+        return false;
+    }
+
+    return writeLayout(report, layout);
+}
+
+bool ImagePartitionTable::updateGeometry(Report& report, const Partition& partition, qint64 sectorStart, qint64 sectorEnd)
+{
+    return modifyEntry(report, partition, [sectorStart, sectorEnd] (ImageLayout&, ImageLayoutEntry& e) {
+        e.firstSector = sectorStart;
+        e.lastSector = sectorEnd;
+    });
+}
+
+bool ImagePartitionTable::clobberFileSystem(Report& report, const Partition& partition)
+{
+    // Signatures are at the start of the partition for most file systems and at the end for some RAID metadata
+    const qint64 length = partition.length() * m_device->logicalSize();
+    const qint64 headLength = qMin<qint64>(length, 1024 * 1024);
+    const qint64 tailLength = qMin<qint64>(length, 128 * 1024);
+
+    ImageLayout layout(m_device->deviceNode(), m_device->logicalSize());
+    if (layout.wipe(partition.firstByte(), headLength) && layout.wipe(partition.firstByte() + length - tailLength, tailLength))
+        return true;
+
+    report.line() << xi18nc("@info:progress", "Failed to erase filesystem signature on partition <filename>%1</filename>.", partition.partitionPath());
+
+    return false;
+}
+
+bool ImagePartitionTable::resizeFileSystem(Report& report, const Partition& partition, qint64 newLength)
+{
+    Q_UNUSED(report)
+    Q_UNUSED(partition)
+    Q_UNUSED(newLength)
+
+    return false;
+}
+
+FileSystem::Type ImagePartitionTable::detectFileSystemBySector(Report& report, const Device& device, qint64 sector)
+{
+    Q_UNUSED(report)
+
+    return ImageLayout(device.deviceNode(), device.logicalSize()).detectFileSystem(sector * device.logicalSize());
+}
+
+bool ImagePartitionTable::setPartitionLabel(Report& report, const Partition& partition, const QString& label)
+{
+    return modifyEntry(report, partition, [&label] (ImageLayout&, ImageLayoutEntry& e) { e.label = label; });
+}
+
+QString ImagePartitionTable::getPartitionUUID(Report& report, const Partition& partition)
+{
+    ImageLayout layout(m_device->deviceNode(), m_device->logicalSize());
+    if (!readLayout(report, layout))
+        return QString();
+
+    const ImageLayoutEntry* entry = layout.find(partition.number());
+    return entry ? entry->uuid : QString();
+}
+
+bool ImagePartitionTable::setPartitionUUID(Report& report, const Partition& partition, const QString& uuid)
+{
+    if (uuid.isEmpty())
+        return true;
+
+    return modifyEntry(report, partition, [&uuid] (ImageLayout&, ImageLayoutEntry& e) { e.uuid = uuid.toUpper(); });
+}
+
+bool ImagePartitionTable::setPartitionAttributes(Report& report, const Partition& partition, quint64 attrs)
+{
+    return modifyEntry(report, partition, [attrs] (ImageLayout&, ImageLayoutEntry& e) { e.attributes = attrs; });
+}
+
+bool ImagePartitionTable::setPartitionSystemType(Report& report, const Partition& partition)
+{
+    return modifyEntry(report, partition, [&partition] (ImageLayout& layout, ImageLayoutEntry& e) {
+        e.type = partition.type().isEmpty() ? ImageLayout::defaultType(partition.fileSystem().type(), layout.type()) : partition.type();
+    });
+}
+
+bool ImagePartitionTable::setFlag(Report& report, const Partition& partition, PartitionTable::Flag flag, bool state)
+{
+    if (flag != PartitionTable::Flag::Boot && flag != PartitionTable::Flag::BiosGrub)
+        return true;
+
+    ImageLayout layout(m_device->deviceNode(), m_device->logicalSize());
+    if (!readLayout(report, layout))
+        return false;
+
+    ImageLayoutEntry* entry = layout.find(partition.number());
+    if (entry == nullptr)
+        return false;
+
+    if (layout.type() == PartitionTable::TableType::msdos) {
+        if (flag != PartitionTable::Flag::Boot)
+            return true;
+
+        // We only allow setting one active partition per device
+        for (auto &e : layout.entries())
+            e.bootable = false;
+        entry->bootable = state;
+    } else if (state)
+        entry->type = flag == PartitionTable::Flag::Boot ? espType : biosGrubType;
+    else
+        entry->type = ImageLayout::defaultType(partition.fileSystem().type(), layout.type());
+
+    return writeLayout(report, layout);
+}
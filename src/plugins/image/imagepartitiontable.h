@@ -0,0 +1,56 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef IMAGEPARTITIONTABLE__H
+#define IMAGEPARTITIONTABLE__H
+
+#include "backend/corebackendpartitiontable.h"
+
+#include "fs/filesystem.h"
+
+#include <functional>
+
+#include <QtGlobal>
+
+class ImageLayout;
+struct ImageLayoutEntry;
+class Report;
+class Partition;
+
+class ImagePartitionTable : public CoreBackendPartitionTable
+{
+public:
+    explicit ImagePartitionTable(const Device *d);
+    ~ImagePartitionTable();
+
+public:
+    bool open() override;
+
+    bool commit(quint32 timeout = 10) override;
+
+    QString createPartition(Report& report, const Partition& partition) override;
+    bool deletePartition(Report& report, const Partition& partition) override;
+    bool updateGeometry(Report& report, const Partition& partition, qint64 sector_start, qint64 sector_end) override;
+    bool clobberFileSystem(Report& report, const Partition& partition) override;
+    bool resizeFileSystem(Report& report, const Partition& partition, qint64 newLength) override;
+    FileSystem::Type detectFileSystemBySector(Report& report, const Device& device, qint64 sector) override;
+    bool setPartitionLabel(Report& report, const Partition& partition, const QString& label) override;
+    QString getPartitionUUID(Report& report, const Partition& partition) override;
+    bool setPartitionUUID(Report& report, const Partition& partition, const QString& uuid) override;
+    bool setPartitionAttributes(Report& report, const Partition& partition, quint64 attrs) override;
+    bool setPartitionSystemType(Report& report, const Partition& partition) override;
+    bool setFlag(Report& report, const Partition& partition, PartitionTable::Flag flag, bool state) override;
+
+private:
+    bool readLayout(Report& report, ImageLayout& layout) const;
+    bool writeLayout(Report& report, const ImageLayout& layout) const;
+    bool modifyEntry(Report& report, const Partition& partition, const std::function<void(ImageLayout&, ImageLayoutEntry&)>& modify) const;
+
+private:
+    const Device *m_device;
+};
+
+#endif
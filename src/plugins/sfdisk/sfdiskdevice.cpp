@@ -5,13 +5,21 @@
 */
 
 #include "plugins/sfdisk/sfdiskdevice.h"
+#include "plugins/sfdisk/sfdiskgptattributes.h"
 #include "plugins/sfdisk/sfdiskpartitiontable.h"
 
+#include "core/partition.h"
 #include "core/partitiontable.h"
 
+#include "fs/filesystem.h"
+
 #include "util/externalcommand.h"
 #include "util/report.h"
 
+#include <utility>
+
+#include <KLocalizedString>
+
 SfdiskDevice::SfdiskDevice(const Device& d) :
     CoreBackendDevice(d.deviceNode()),
     m_device(&d)
@@ -52,13 +60,17 @@ std::unique_ptr<CoreBackendPartitionTable> SfdiskDevice::openPartitionTable()
     return std::make_unique<SfdiskPartitionTable>(m_device);
 }
 
-bool SfdiskDevice::createPartitionTable(Report& report, const PartitionTable& ptable)
+static QByteArray tableTypeName(const PartitionTable& ptable)
 {
-    QByteArray tableType;
     if (ptable.type() == PartitionTable::msdos || ptable.type() == PartitionTable::msdos_sectorbased)
-        tableType = QByteArrayLiteral("dos");
-    else
-        tableType = ptable.typeName().toLocal8Bit();
+        return QByteArrayLiteral("dos");
+
+    return ptable.typeName().toLocal8Bit();
+}
+
+bool SfdiskDevice::createPartitionTable(Report& report, const PartitionTable& ptable)
+{
+    const QByteArray tableType = tableTypeName(ptable);
 
     ExternalCommand createCommand(report, QStringLiteral("sfdisk"), { QStringLiteral("--wipe=always"), m_device->deviceNode() } );
     if ( createCommand.write(QByteArrayLiteral("label: ") + tableType +
@@ -68,3 +80,64 @@ bool SfdiskDevice::createPartitionTable(Report& report, const PartitionTable& pt
 
     return false;
 }
+
+/** Writes the whole layout with a single sfdisk script.
+
+    Disk and partition identifiers are left out of the script, so sfdisk generates new ones.
+    Partitions keep their numbers, because sfdisk takes them from the device names in the script.
+*/
+bool SfdiskDevice::createPartitionTableLayout(Report& report, PartitionTable& ptable)
+{
+    const bool isGpt = ptable.type() == PartitionTable::TableType::gpt;
+
+    QList<Partition*> partitions;
+    for (const auto &p : ptable.children()) {
+        partitions.append(p);
+        for (const auto &child : p->children())
+            partitions.append(child);
+    }
+
+    QByteArray script = QByteArrayLiteral("label: ") + tableTypeName(ptable) + QByteArrayLiteral("\n");
+    for (const auto &p : std::as_const(partitions)) {
+        if (p->roles().has(PartitionRole::Unallocated))
+            continue;
+
+        p->setPartitionPath(PartitionTable::partitionPath(m_device->deviceNode(), p->number()));
+
+        QString type = p->type();
+        if (type.isEmpty() && p->roles().has(PartitionRole::Extended))
+            type = QStringLiteral("5");
+        else if (type.isEmpty())
+            type = SfdiskPartitionTable::getPartitionType(p->fileSystem().type(), ptable.type());
+
+        QByteArray line = p->partitionPath().toLocal8Bit() + QByteArrayLiteral(" : start=") + QByteArray::number(p->firstSector()) +
+                          QByteArrayLiteral(", size=") + QByteArray::number(p->length());
+        if (!type.isEmpty())
+            line += QByteArrayLiteral(", type=") + type.toLocal8Bit();
+        if (isGpt && !p->label().isEmpty())
+            line += QByteArrayLiteral(", name=\"") + QString(p->label()).remove(QLatin1Char('"')).toUtf8() + QByteArrayLiteral("\"");
+        if (isGpt && p->attributes() != 0)
+            line += QByteArrayLiteral(", attrs=\"") + SfdiskGptAttributes::toStringList(p->attributes()).join(QLatin1Char(' ')).toLocal8Bit() + QByteArrayLiteral("\"");
+        if (!isGpt && p->activeFlags().testFlag(PartitionTable::Flag::Boot))
+            line += QByteArrayLiteral(", bootable");
+
+        script += line + QByteArrayLiteral("\n");
+    }
+    script += QByteArrayLiteral("write\n");
+
+    ExternalCommand createCommand(report, QStringLiteral("sfdisk"), { QStringLiteral("--force"), QStringLiteral("--wipe=always"), m_device->deviceNode() } );
+    const bool rval = createCommand.write(script) && createCommand.start(-1) && createCommand.exitCode() == 0;
+
+    SfdiskPartitionTable(m_device).commit();
+
+    if (!rval) {
+        report.line() << xi18nc("@info:progress", "Failed to write partition layout to device <filename>%1</filename>.", m_device->deviceNode());
+        return false;
+    }
+
+    for (const auto &p : std::as_const(partitions))
+        if (!p->roles().has(PartitionRole::Unallocated))
+            p->setState(Partition::State::None);
+
+    return true;
+}
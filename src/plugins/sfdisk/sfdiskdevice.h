@@ -34,6 +34,7 @@ public:
     std::unique_ptr<CoreBackendPartitionTable> openPartitionTable() override;
 
     bool createPartitionTable(Report& report, const PartitionTable& ptable) override;
+    bool createPartitionTableLayout(Report& report, PartitionTable& ptable) override;
 
 private:
     const Device *m_device;
@@ -29,7 +29,7 @@
 #include <KLocalizedString>
 
 SfdiskPartitionTable::SfdiskPartitionTable(const Device* d) :
-    CoreBackendPartitionTable(),
+    CoreBackendPartitionTable(d->deviceNode()),
     m_device(d)
 {
 }
@@ -78,12 +78,8 @@ QString SfdiskPartitionTable::createPartition(Report& report, const Partition& p
         QRegularExpression re(QStringLiteral("Created a new partition (\\d+)"));
         QRegularExpressionMatch rem = re.match(createCommand.output());
 
-        if (rem.hasMatch()) {
-            if ( partition.devicePath().back().isDigit() )
-                return partition.devicePath() + QLatin1Char('p') + rem.captured(1);
-            else
-                return partition.devicePath() + rem.captured(1);
-        }
+        if (rem.hasMatch())
+            return PartitionTable::partitionPath(partition.devicePath(), rem.captured(1).toInt());
     }
 
     report.line() << xi18nc("@info:progress", "Failed to add partition <filename>%1</filename> to device <filename>%2</filename>.", partition.deviceNode(), m_device->deviceNode());
@@ -184,7 +180,7 @@ static struct {
     // Add ZFS too
 };
 
-static QLatin1String getPartitionType(FileSystem::Type t, PartitionTable::TableType tableType)
+QLatin1String SfdiskPartitionTable::getPartitionType(FileSystem::Type t, PartitionTable::TableType tableType)
 {
     quint8 type;
     switch (tableType) {
@@ -43,6 +43,8 @@ public:
     bool setPartitionSystemType(Report& report, const Partition& partition) override;
     bool setFlag(Report& report, const Partition& partition, PartitionTable::Flag flag, bool state) override;
 
+    static QLatin1String getPartitionType(FileSystem::Type t, PartitionTable::TableType tableType);
+
 private:
     const Device *m_device;
 };
@@ -0,0 +1,229 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+/* Applies a declarative partition layout to the devices named in it.
+
+   Progress is written to stdout as one JSON object per line, so the tool can be driven by
+   provisioning scripts. With --plan only the Operations that would be run are printed.
+
+   Runs are recorded in a PlanJournal. If a run of the same layout was interrupted, the journal
+   is validated against the devices and only what is still missing is planned and run.
+
+   What can only be planned once RAID arrays or volume groups exist is planned in another pass,
+   after the devices have been scanned again. */
+
+#include "tools/layoutapplier.h"
+
+#include "backend/corebackendmanager.h"
+
+#include "core/devicescanner.h"
+#include "core/operationrunner.h"
+#include "core/operationstack.h"
+#include "core/planjournal.h"
+
+#include "ops/operation.h"
+
+#include "util/report.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <KLocalizedString>
+
+#include <cstdio>
+#include <utility>
+
+static void printEvent(const QString& event, QJsonObject values = {})
+{
+    values.insert(QStringLiteral("event"), event);
+    const QByteArray line = QJsonDocument(values).toJson(QJsonDocument::Compact) + '\n';
+
+    std::fwrite(line.constData(), 1, line.size(), stdout);
+    std::fflush(stdout);
+}
+
+static QString statusName(Operation::OperationStatus status)
+{
+    switch (status) {
+    case Operation::StatusFinishedSuccess:
+        return QStringLiteral("success");
+    case Operation::StatusFinishedWarning:
+        return QStringLiteral("warning");
+    case Operation::StatusError:
+        return QStringLiteral("error");
+    default:
+        return QStringLiteral("pending");
+    }
+}
+
+int main(int argc, char** argv)
+{
+    QCoreApplication app(argc, argv);
+    QCoreApplication::setApplicationName(QStringLiteral("kpmcore_apply"));
+
+    // Messages end up in machine readable output, keep them independent of the locale
+    KLocalizedString::setLanguages({ QStringLiteral("en_US") });
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Applies a declarative partition layout."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("layout"), QStringLiteral("JSON layout file, - for standard input."));
+    const QCommandLineOption planOption(QStringLiteral("plan"), QStringLiteral("Only print the operations that would be run."));
+    const QCommandLineOption destructiveOption(QStringLiteral("allow-destructive"), QStringLiteral("Allow operations that destroy existing data."));
+    const QCommandLineOption backendOption(QStringLiteral("backend"), QStringLiteral("Backend plugin to use."), QStringLiteral("name"), CoreBackendManager::defaultBackendName());
+    const QCommandLineOption journalOption(QStringLiteral("journal"), QStringLiteral("Journal file to resume interrupted runs from."), QStringLiteral("file"), PlanJournal::defaultPath());
+    const QCommandLineOption discardJournalOption(QStringLiteral("discard-journal"), QStringLiteral("Ignore the journal of an interrupted run."));
+    parser.addOptions({ planOption, destructiveOption, backendOption, journalOption, discardJournalOption });
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    QFile file(parser.positionalArguments().first());
+    const bool opened = file.fileName() == QStringLiteral("-") ? file.open(stdin, QIODevice::ReadOnly) : file.open(QIODevice::ReadOnly);
+    if (!opened) {
+        printEvent(QStringLiteral("error"), { { QStringLiteral("message"), QStringLiteral("Could not open layout file %1.").arg(file.fileName()) } });
+        return 1;
+    }
+
+    if (!CoreBackendManager::self()->load(parser.value(backendOption))) {
+        printEvent(QStringLiteral("error"), { { QStringLiteral("message"), QStringLiteral("Could not load backend plugin %1.").arg(parser.value(backendOption)) } });
+        return 1;
+    }
+
+    OperationStack operationStack;
+    LayoutApplier applier(operationStack);
+    applier.setAllowDestructive(parser.isSet(destructiveOption));
+
+    const QByteArray layout = file.readAll();
+    const QString planId = QString::fromLatin1(QCryptographicHash::hash(layout, QCryptographicHash::Sha256).toHex());
+
+    PlanJournal journal(parser.value(journalOption));
+
+    if (!applier.load(layout)) {
+        for (const auto &message : applier.errors())
+            printEvent(QStringLiteral("error"), { { QStringLiteral("message"), message } });
+        return 1;
+    }
+
+    // RAID arrays and volume groups only show up once they have been created, what is on them
+    // is planned in another pass after scanning again
+    const qint32 maxPasses = 3;
+    bool changed = false;
+
+    for (qint32 pass = 1; ; pass++) {
+        DeviceScanner scanner(nullptr, operationStack);
+        scanner.scan(applier.deviceNodes());
+
+        QStringList errors;
+
+        // The journal has to be checked against the devices as scanned, before planning changes them
+        if (pass == 1 && !parser.isSet(discardJournalOption) && journal.load()) {
+            if (journal.planId() != planId)
+                errors.append(QStringLiteral("Journal %1 belongs to an interrupted run of a different layout.").arg(journal.path()));
+            else if (!journal.validate(operationStack.previewDevices()))
+                errors.append(journal.errors());
+            else {
+                QJsonArray completed;
+                for (const auto &index : journal.completed())
+                    completed.append(journal.entries()[index].description);
+                printEvent(QStringLiteral("resume"), { { QStringLiteral("completed"), completed } });
+            }
+        }
+
+        if (errors.isEmpty())
+            applier.plan();
+
+        errors.append(applier.errors());
+        if (!errors.isEmpty()) {
+            for (const auto &message : std::as_const(errors))
+                printEvent(QStringLiteral("error"), { { QStringLiteral("message"), message } });
+            return 1;
+        }
+
+        QJsonArray plan;
+        for (const auto &op : operationStack.operations())
+            plan.append(op->description());
+        printEvent(QStringLiteral("plan"), { { QStringLiteral("pass"), pass }, { QStringLiteral("operations"), plan },
+                                             { QStringLiteral("deferred"), QJsonArray::fromStringList(applier.deferred()) } });
+
+        if (parser.isSet(planOption)) {
+            printEvent(QStringLiteral("done"), { { QStringLiteral("status"), operationStack.size() == 0 && applier.deferred().isEmpty() ? QStringLiteral("unchanged") : QStringLiteral("planned") } });
+            return 0;
+        }
+
+        if (operationStack.size() == 0) {
+            if (!applier.deferred().isEmpty()) {
+                for (const auto &item : applier.deferred())
+                    printEvent(QStringLiteral("error"), { { QStringLiteral("message"), QStringLiteral("Could not plan: %1").arg(item) } });
+                return 1;
+            }
+
+            // An interrupted run that got everything done but did not finish leaves nothing to resume
+            journal.finish();
+            printEvent(QStringLiteral("done"), { { QStringLiteral("status"), changed ? QStringLiteral("success") : QStringLiteral("unchanged") } });
+            return 0;
+        }
+
+        // The runner previews every Operation after running it, so start from the devices as scanned
+        for (auto it = operationStack.operations().rbegin(); it != operationStack.operations().rend(); ++it)
+            (*it)->undo();
+
+        journal.setPlanId(planId);
+
+        Report report(nullptr);
+        OperationRunner runner(nullptr, operationStack);
+        runner.setReport(&report);
+        runner.setJournal(&journal);
+
+        const int total = operationStack.size();
+        QString result;
+
+        // Operations on different devices can run at the same time, each reports its own progress
+        for (int i = 0; i < total; i++) {
+            QObject::connect(operationStack.operations()[i], &Operation::progress, &app, [pass, i] (int percent) {
+                printEvent(QStringLiteral("progress"), { { QStringLiteral("pass"), pass }, { QStringLiteral("index"), i + 1 }, { QStringLiteral("percent"), percent } });
+            });
+        }
+
+        QObject::connect(&runner, &OperationRunner::opStarted, &app, [pass, total] (int index, Operation* op) {
+            printEvent(QStringLiteral("operation"), { { QStringLiteral("pass"), pass }, { QStringLiteral("index"), index }, { QStringLiteral("total"), total }, { QStringLiteral("description"), op->description() } });
+        });
+        QObject::connect(&runner, &OperationRunner::opFinished, &app, [pass] (int index, Operation* op) {
+            printEvent(QStringLiteral("operationFinished"), { { QStringLiteral("pass"), pass }, { QStringLiteral("index"), index }, { QStringLiteral("status"), statusName(op->status()) } });
+        });
+        QObject::connect(&runner, &OperationRunner::finished, &app, [&result] { result = QStringLiteral("success"); QCoreApplication::quit(); });
+        QObject::connect(&runner, &OperationRunner::cancelled, &app, [&result] { result = QStringLiteral("cancelled"); QCoreApplication::quit(); });
+        QObject::connect(&runner, &OperationRunner::error, &app, [&result] { result = QStringLiteral("error"); QCoreApplication::quit(); });
+
+        runner.start();
+        app.exec();
+        runner.wait();
+
+        if (result != QStringLiteral("success")) {
+            printEvent(QStringLiteral("done"), { { QStringLiteral("status"), result }, { QStringLiteral("report"), report.toText() } });
+            return 2;
+        }
+
+        changed = true;
+
+        if (applier.deferred().isEmpty()) {
+            printEvent(QStringLiteral("done"), { { QStringLiteral("status"), result } });
+            return 0;
+        }
+
+        if (pass == maxPasses) {
+            for (const auto &item : applier.deferred())
+                printEvent(QStringLiteral("error"), { { QStringLiteral("message"), QStringLiteral("Could not plan: %1").arg(item) } });
+            return 1;
+        }
+    }
+}
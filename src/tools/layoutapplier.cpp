@@ -0,0 +1,694 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "tools/layoutapplier.h"
+
+#include "core/device.h"
+#include "core/lvmdevice.h"
+#include "core/operationstack.h"
+#include "core/partition.h"
+#include "core/partitionalignment.h"
+#include "core/partitionrole.h"
+#include "core/raid/softwareraid.h"
+
+#include "ops/createfilesystemoperation.h"
+#include "ops/createpartitiontableoperation.h"
+#include "ops/createsoftwareraidoperation.h"
+#include "ops/createvolumegroupoperation.h"
+#include "ops/deleteoperation.h"
+#include "ops/newoperation.h"
+#include "ops/resizeoperation.h"
+#include "ops/setfilesystemlabeloperation.h"
+#include "ops/setpartflagsoperation.h"
+
+#include "fs/filesystemfactory.h"
+#include "fs/luks.h"
+#include "fs/lvm2_pv.h"
+
+#include <utility>
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonParseError>
+#include <QRegularExpression>
+#include <QVector>
+
+#include <KLocalizedString>
+
+/** Creates a new LayoutApplier.
+    @param ostack the OperationStack holding the scanned Devices, planned Operations are pushed onto it
+*/
+LayoutApplier::LayoutApplier(OperationStack& ostack) :
+    m_OperationStack(ostack),
+    m_AllowDestructive(false)
+{
+}
+
+/** Loads a layout.
+    @param data the layout as JSON document
+    @return true if the layout could be parsed
+*/
+bool LayoutApplier::load(const QByteArray& data)
+{
+    QJsonParseError parseError;
+    const QJsonDocument document = QJsonDocument::fromJson(data, &parseError);
+
+    if (parseError.error != QJsonParseError::NoError)
+        return error(xi18nc("@info:status", "Could not parse layout: %1 at offset %2.", parseError.errorString(), parseError.offset));
+
+    if (!document.isObject())
+        return error(xi18nc("@info:status", "The layout must be a JSON object."));
+
+    m_Layout = document.object();
+
+    for (const auto &device : m_Layout.value(QStringLiteral("devices")).toArray())
+        if (device.toObject().value(QStringLiteral("path")).toString().isEmpty())
+            return error(xi18nc("@info:status", "Every device in the layout needs a path."));
+
+    for (const auto &array : m_Layout.value(QStringLiteral("raid")).toArray())
+        if (!array.toObject().value(QStringLiteral("path")).toString().startsWith(QStringLiteral("/dev/md")))
+            return error(xi18nc("@info:status", "Every RAID array in the layout needs a path like /dev/md0."));
+
+    return true;
+}
+
+/** @return the device nodes named in the layout, these are the only disks that need to be scanned */
+QStringList LayoutApplier::deviceNodes() const
+{
+    QStringList result;
+    for (const auto &device : m_Layout.value(QStringLiteral("devices")).toArray())
+        result.append(device.toObject().value(QStringLiteral("path")).toString());
+
+    return result;
+}
+
+/** Pushes the Operations needed to reach the loaded layout onto the OperationStack.
+
+    Planning stops at the first Device with an error, errors() tells what went wrong. What can
+    only be planned once Operations have been run is listed in deferred().
+
+    @return true if all Devices could be planned
+*/
+bool LayoutApplier::plan()
+{
+    m_Partitions.clear();
+    m_Deferred.clear();
+    m_NewArrays.clear();
+
+    const QJsonArray arrays = m_Layout.value(QStringLiteral("raid")).toArray();
+    for (const auto &array : arrays) {
+        const QString path = array.toObject().value(QStringLiteral("path")).toString();
+        if (findDevice(path) == nullptr)
+            m_NewArrays.append(path);
+    }
+
+    for (const auto &device : m_Layout.value(QStringLiteral("devices")).toArray()) {
+        const QString path = device.toObject().value(QStringLiteral("path")).toString();
+        if (m_NewArrays.contains(path)) {
+            m_Deferred.append(xi18nc("@info:status", "Partitions of RAID array <filename>%1</filename>.", path));
+            continue;
+        }
+
+        if (!planDevice(device.toObject()))
+            return false;
+    }
+
+    for (const auto &array : arrays)
+        if (!planRaid(array.toObject()))
+            return false;
+
+    for (const auto &vg : m_Layout.value(QStringLiteral("volumeGroups")).toArray())
+        if (!planVolumeGroup(vg.toObject()))
+            return false;
+
+    return true;
+}
+
+bool LayoutApplier::planDevice(const QJsonObject& desc)
+{
+    const QString deviceNode = desc.value(QStringLiteral("path")).toString();
+    Device* d = findDevice(deviceNode);
+
+    if (d == nullptr)
+        return error(xi18nc("@info:status", "Device <filename>%1</filename> could not be found.", deviceNode));
+
+    const QString tableName = desc.value(QStringLiteral("table")).toString(QStringLiteral("gpt"));
+    const PartitionTable::TableType type = PartitionTable::nameToTableType(tableName);
+
+    if (type == PartitionTable::TableType::unknownTableType || type == PartitionTable::TableType::none)
+        return error(xi18nc("@info:status", "Unknown partition table type %1 for device <filename>%2</filename>.", tableName, deviceNode));
+
+    const PartitionTable* ptable = d->partitionTable();
+    if (ptable == nullptr || ptable->type() != type) {
+        bool hasPartitions = false;
+        if (ptable != nullptr)
+            for (const auto &p : ptable->children())
+                hasPartitions = hasPartitions || !p->roles().has(PartitionRole::Unallocated);
+
+        if (hasPartitions && !allowDestructive())
+            return error(xi18nc("@info:status", "Device <filename>%1</filename> has a %2 partition table, replacing it would destroy all data on the device.", deviceNode, ptable->typeName()));
+
+        if (!CreatePartitionTableOperation::canCreate(d))
+            return error(xi18nc("@info:status", "Cannot create a new partition table on device <filename>%1</filename>.", deviceNode));
+
+        push(new CreatePartitionTableOperation(*d, type));
+    }
+
+    qint64 previousLast = -1;
+    const QJsonArray partitions = desc.value(QStringLiteral("partitions")).toArray();
+    for (int i = 0; i < partitions.size(); i++) {
+        const QJsonObject partition = partitions[i].toObject();
+        if (!planPartition(*d, partition, partition.value(QStringLiteral("number")).toInt(i + 1), previousLast))
+            return false;
+    }
+
+    return true;
+}
+
+bool LayoutApplier::planPartition(Device& d, const QJsonObject& desc, qint32 number, qint64& previousLast)
+{
+    PartitionTable* ptable = d.partitionTable();
+    const qint64 align = PartitionAlignment::sectorAlignment(d);
+
+    Partition* existing = nullptr;
+    for (const auto &p : ptable->children())
+        if (!p->roles().has(PartitionRole::Unallocated) && !p->roles().has(PartitionRole::Extended) && p->number() == number)
+            existing = p;
+
+    qint64 first = 0;
+    if (desc.contains(QStringLiteral("start"))) {
+        const qint64 start = parseSize(desc.value(QStringLiteral("start")).toVariant().toString());
+        if (start < 0)
+            return error(xi18nc("@info:status", "Invalid start for partition %1 on device <filename>%2</filename>.", number, d.deviceNode()));
+        first = start / d.logicalSize();
+    } else
+        first = (qMax(previousLast + 1, ptable->firstUsable()) + align - 1) / align * align;
+
+    const QString sizeSpec = desc.value(QStringLiteral("size")).toVariant().toString();
+    qint64 last = 0;
+    if (sizeSpec == QStringLiteral("*")) {
+        // the rest of the free space behind the start of the partition
+        qint64 end = ptable->lastUsable();
+        for (const auto &p : ptable->children())
+            if (p != existing && !p->roles().has(PartitionRole::Unallocated) && p->firstSector() > first)
+                end = qMin(end, p->firstSector() - 1);
+
+        last = (end + 1) / align * align - 1;
+        if (last < first)
+            last = end;
+    } else {
+        const qint64 size = parseSize(sizeSpec);
+        if (size <= 0)
+            return error(xi18nc("@info:status", "Invalid size for partition %1 on device <filename>%2</filename>.", number, d.deviceNode()));
+        last = first + (size + d.logicalSize() - 1) / d.logicalSize() - 1;
+    }
+
+    if (existing == nullptr || qAbs(existing->firstSector() - first) >= align) {
+        if (existing != nullptr) {
+            if (!allowDestructive())
+                return error(xi18nc("@info:status", "Partition <filename>%1</filename> does not start where the layout wants it to, recreating it would destroy its data.", existing->deviceNode()));
+
+            if (!DeleteOperation::canDelete(existing))
+                return error(xi18nc("@info:status", "Partition <filename>%1</filename> cannot be deleted.", existing->deviceNode()));
+
+            push(new DeleteOperation(d, existing));
+        }
+
+        previousLast = last;
+        return planNewPartition(d, desc, number, first, last);
+    }
+
+    if (qAbs(existing->lastSector() - last) >= align) {
+        const bool grow = last > existing->lastSector();
+
+        if (grow) {
+            const Partition* free = ptable->findPartitionBySector(existing->lastSector() + 1, PartitionRole(PartitionRole::Unallocated));
+            if (free == nullptr || free->lastSector() < last)
+                return error(xi18nc("@info:status", "There is not enough free space behind partition <filename>%1</filename> to grow it.", existing->deviceNode()));
+        }
+
+        if (grow ? !ResizeOperation::canGrow(existing) : !ResizeOperation::canShrink(existing))
+            return error(xi18nc("@info:status", "Partition <filename>%1</filename> cannot be resized.", existing->deviceNode()));
+
+        push(new ResizeOperation(d, *existing, existing->firstSector(), last));
+    }
+
+    previousLast = existing->lastSector();
+    m_Partitions[d.deviceNode()][number] = existing;
+
+    return planFileSystem(d, *existing, desc);
+}
+
+bool LayoutApplier::planNewPartition(Device& d, const QJsonObject& desc, qint32 number, qint64 first, qint64 last)
+{
+    PartitionTable* ptable = d.partitionTable();
+    const Partition* free = ptable->findPartitionBySector(first, PartitionRole(PartitionRole::Unallocated));
+
+    if (free == nullptr || free->lastSector() < last || !free->parent()->isRoot())
+        return error(xi18nc("@info:status", "Partition %1 does not fit into the free space on device <filename>%2</filename>.", number, d.deviceNode()));
+
+    if (ptable->numPrimaries() >= ptable->maxPrimaries())
+        return error(xi18nc("@info:status", "Device <filename>%1</filename> cannot hold another primary partition.", d.deviceNode()));
+
+    PartitionTable::Flags flags;
+    if (!parseFlags(desc, flags))
+        return false;
+
+    FileSystem* fs = createFileSystem(desc, d, first, last);
+    if (fs == nullptr)
+        return false;
+
+    PartitionRole::Roles roles = PartitionRole::Primary;
+    if (desc.contains(QStringLiteral("luks")))
+        roles |= PartitionRole::Luks;
+
+    Partition* p = new Partition(ptable, d, PartitionRole(roles), fs, first, last, QString(), free->availableFlags(),
+                                 QString(), false, PartitionTable::Flag::None, Partition::State::New);
+    p->setLabel(desc.value(QStringLiteral("name")).toString());
+
+    push(new NewOperation(d, p));
+
+    if (flags != PartitionTable::Flag::None)
+        push(new SetPartFlagsOperation(d, *p, flags));
+
+    m_Partitions[d.deviceNode()][number] = p;
+
+    return true;
+}
+
+bool LayoutApplier::planFileSystem(Device& d, Partition& p, const QJsonObject& desc)
+{
+    if (desc.contains(QStringLiteral("fs"))) {
+        FileSystem::Type type;
+        FileSystem::Type innerType;
+        if (!parseFileSystem(desc, type, innerType))
+            return false;
+
+        const FileSystem::Type current = p.fileSystem().type();
+        bool matches = current == type;
+
+        if (matches && innerType != FileSystem::Type::Unknown) {
+            // a closed LUKS container is accepted as it is, its contents cannot be checked
+            const FS::luks* luksFs = dynamic_cast<const FS::luks*>(&p.fileSystem());
+            matches = luksFs && (luksFs->innerFS() == nullptr || luksFs->innerFS()->type() == innerType);
+        }
+
+        if (!matches) {
+            if (current != FileSystem::Type::Unformatted && current != FileSystem::Type::Unknown && !allowDestructive())
+                return error(xi18nc("@info:status", "Partition <filename>%1</filename> contains a %2 file system, formatting it would destroy its data.", p.deviceNode(), p.fileSystem().name()));
+
+            if (p.isMounted())
+                return error(xi18nc("@info:status", "Partition <filename>%1</filename> is mounted and cannot be formatted.", p.deviceNode()));
+
+            push(new CreateFileSystemOperation(d, p, type));
+
+            if (innerType != FileSystem::Type::Unknown) {
+                FileSystem* fs = createFileSystem(desc, d, p.firstSector(), p.lastSector());
+                if (fs == nullptr)
+                    return false;
+
+                FS::luks* luksFs = dynamic_cast<FS::luks*>(&p.fileSystem());
+                luksFs->setPassphrase(static_cast<FS::luks*>(fs)->passphrase());
+                luksFs->createInnerFileSystem(innerType);
+                delete fs;
+            }
+        }
+    }
+
+    if (desc.contains(QStringLiteral("label"))) {
+        const QString label = desc.value(QStringLiteral("label")).toString();
+
+        if (p.fileSystem().label() != label) {
+            if (p.fileSystem().supportSetLabel() == FileSystem::cmdSupportNone)
+                return error(xi18nc("@info:status", "The label of partition <filename>%1</filename> cannot be changed.", p.deviceNode()));
+
+            push(new SetFileSystemLabelOperation(p, label));
+        }
+    }
+
+    if (desc.contains(QStringLiteral("flags"))) {
+        PartitionTable::Flags flags;
+        if (!parseFlags(desc, flags))
+            return false;
+
+        if (p.activeFlags() != flags)
+            push(new SetPartFlagsOperation(d, p, flags));
+    }
+
+    return true;
+}
+
+bool LayoutApplier::planRaid(const QJsonObject& desc)
+{
+    const QString path = desc.value(QStringLiteral("path")).toString();
+    const qint32 level = desc.value(QStringLiteral("level")).toInt(-1);
+
+    if (!m_NewArrays.contains(path)) {
+        const SoftwareRAID* raid = dynamic_cast<const SoftwareRAID*>(findDevice(path));
+        if (raid == nullptr)
+            return error(xi18nc("@info:status", "Device <filename>%1</filename> is not a RAID array.", path));
+
+        if (raid->raidLevel() != level)
+            return error(xi18nc("@info:status", "RAID array <filename>%1</filename> already exists with RAID level %2, changing it is not supported.", path, raid->raidLevel()));
+
+        return true;
+    }
+
+    QVector<const Partition*> members;
+    for (const auto &member : desc.value(QStringLiteral("members")).toArray()) {
+        bool deferred = false;
+        const Partition* p = findMember(member.toObject(), deferred);
+
+        if (deferred) {
+            m_Deferred.append(xi18nc("@info:status", "RAID array <filename>%1</filename>.", path));
+            return true;
+        }
+
+        if (p == nullptr)
+            return error(xi18nc("@info:status", "A member of RAID array <filename>%1</filename> is not part of the layout.", path));
+
+        const FileSystem::Type type = p->fileSystem().type();
+        if (p->state() == Partition::State::None && type != FileSystem::Type::Unformatted && type != FileSystem::Type::Unknown &&
+                type != FileSystem::Type::LinuxRaidMember && !allowDestructive())
+            return error(xi18nc("@info:status", "Partition <filename>%1</filename> contains a %2 file system, adding it to a RAID array would destroy its data.", p->deviceNode(), p->fileSystem().name()));
+
+        members.append(p);
+    }
+
+    if (!CreateSoftwareRaidOperation::canCreate(members, level))
+        return error(xi18nc("@info:status", "RAID array <filename>%1</filename> cannot be created with RAID level %2 from %3 members.", path, level, members.size()));
+
+    SoftwareRAID::ArrayOptions options;
+    options.bitmap = desc.value(QStringLiteral("bitmap")).toBool(true);
+
+    push(new CreateSoftwareRaidOperation(path.mid(5), members, level, desc.value(QStringLiteral("chunkSize")).toInt(0), options));
+
+    return true;
+}
+
+bool LayoutApplier::planVolumeGroup(const QJsonObject& desc)
+{
+    const QString name = desc.value(QStringLiteral("name")).toString();
+    if (name.isEmpty())
+        return error(xi18nc("@info:status", "Every volume group in the layout needs a name."));
+
+    QVector<const Partition*> pvList;
+    qint32 alreadyMembers = 0;
+
+    for (const auto &pv : desc.value(QStringLiteral("pvs")).toArray()) {
+        const QString deviceNode = pv.toObject().value(QStringLiteral("device")).toString();
+        const qint32 number = pv.toObject().value(QStringLiteral("partition")).toInt();
+
+        bool deferred = false;
+        const Partition* p = findMember(pv.toObject(), deferred);
+
+        if (deferred) {
+            m_Deferred.append(xi18nc("@info:status", "Volume group %1 and its logical volumes.", name));
+            return true;
+        }
+
+        if (p == nullptr)
+            return error(xi18nc("@info:status", "Physical volume %1 on device <filename>%2</filename> of volume group %3 is not part of the layout.", number, deviceNode, name));
+
+        const FS::luks* luksFs = dynamic_cast<const FS::luks*>(&p->fileSystem());
+        const FileSystem::Type type = luksFs && luksFs->innerFS() ? luksFs->innerFS()->type() : p->fileSystem().type();
+        if (type != FileSystem::Type::Lvm2_PV)
+            return error(xi18nc("@info:status", "Partition %1 on device <filename>%2</filename> must be an LVM physical volume to be used by volume group %3.", number, deviceNode, name));
+
+        pvList.append(p);
+    }
+
+    for (const auto &p : std::as_const(pvList)) {
+        if (p->state() != Partition::State::None)
+            continue;
+
+        const FS::luks* luksFs = dynamic_cast<const FS::luks*>(&p->fileSystem());
+        const QString vgName = FS::lvm2_pv::getVGName(luksFs ? luksFs->mapperName() : p->partitionPath());
+
+        if (vgName == name)
+            alreadyMembers++;
+        else if (!vgName.isEmpty())
+            return error(xi18nc("@info:status", "Partition <filename>%1</filename> already belongs to volume group %2.", p->deviceNode(), vgName));
+    }
+
+    const QJsonArray lvs = desc.value(QStringLiteral("lvs")).toArray();
+
+    if (!pvList.isEmpty() && alreadyMembers == pvList.size()) {
+        LvmDevice* d = dynamic_cast<LvmDevice*>(findDevice(QStringLiteral("/dev/") + name));
+        if (d == nullptr)
+            return error(xi18nc("@info:status", "Volume group %1 could not be found.", name));
+
+        for (const auto &lv : lvs)
+            if (!planLogicalVolume(*d, lv.toObject()))
+                return false;
+
+        return true;
+    }
+
+    if (alreadyMembers > 0)
+        return error(xi18nc("@info:status", "Volume group %1 already exists with different physical volumes, changing them is not supported.", name));
+
+    if (pvList.isEmpty())
+        return error(xi18nc("@info:status", "Volume group %1 needs at least one physical volume.", name));
+
+    push(new CreateVolumeGroupOperation(name, pvList, desc.value(QStringLiteral("peSize")).toInt(4)));
+
+    if (!lvs.isEmpty())
+        m_Deferred.append(xi18nc("@info:status", "Logical volumes of volume group %1.", name));
+
+    return true;
+}
+
+bool LayoutApplier::planLogicalVolume(LvmDevice& d, const QJsonObject& desc)
+{
+    const QString name = desc.value(QStringLiteral("name")).toString();
+    if (name.isEmpty())
+        return error(xi18nc("@info:status", "Every logical volume of volume group %1 needs a name.", d.name()));
+
+    const QString lvPath = d.deviceNode() + QLatin1Char('/') + name;
+    PartitionTable* ptable = d.partitionTable();
+
+    const QString sizeSpec = desc.value(QStringLiteral("size")).toVariant().toString();
+    const qint64 size = sizeSpec == QStringLiteral("*") ? 0 : parseSize(sizeSpec);
+    if (size < 0 || (size == 0 && sizeSpec != QStringLiteral("*")))
+        return error(xi18nc("@info:status", "Invalid size for logical volume <filename>%1</filename>.", lvPath));
+
+    const qint64 extents = (size + d.peSize() - 1) / d.peSize();
+
+    for (const auto &p : ptable->children()) {
+        if (p->partitionPath() != lvPath)
+            continue;
+
+        if (size > 0 && p->length() != extents)
+            return error(xi18nc("@info:status", "Logical volume <filename>%1</filename> has a different size than the layout wants it to have, resizing logical volumes is not supported.", lvPath));
+
+        return planFileSystem(d, *p, desc);
+    }
+
+    // LVM allocates extents wherever they are free, the layout only needs enough of them
+    const Partition* free = nullptr;
+    for (const auto &p : ptable->children())
+        if (p->roles().has(PartitionRole::Unallocated) && (free == nullptr || p->length() > free->length()))
+            free = p;
+
+    if (free == nullptr || free->length() < extents)
+        return error(xi18nc("@info:status", "There is not enough free space in volume group %1 for logical volume <filename>%2</filename>.", d.name(), lvPath));
+
+    const qint64 first = free->firstSector();
+    const qint64 last = size > 0 ? first + extents - 1 : free->lastSector();
+
+    LvmDevice::LVLayout layout;
+    if (!parseLVLayout(desc.value(QStringLiteral("layout")).toObject(), lvPath, layout))
+        return false;
+
+    if (layout.type != LvmDevice::LVLayout::Type::Linear && !d.canAllocate(layout, last - first + 1))
+        return error(xi18nc("@info:status", "Volume group %1 does not have enough free extents on %2 physical volumes for logical volume <filename>%3</filename>.", d.name(), layout.devices(), lvPath));
+
+    FileSystem* fs = createFileSystem(desc, d, first, last);
+    if (fs == nullptr)
+        return false;
+
+    // picked up by LvmDevice::createLV() when the Logical Volume is created
+    d.setLVLayout(lvPath, layout);
+
+    PartitionRole::Roles roles = PartitionRole::Lvm_Lv;
+    if (desc.contains(QStringLiteral("luks")))
+        roles |= PartitionRole::Luks;
+
+    Partition* p = new Partition(ptable, d, PartitionRole(roles), fs, first, last, lvPath, PartitionTable::Flag::None,
+                                 QString(), false, PartitionTable::Flag::None, Partition::State::New);
+
+    push(new NewOperation(d, p));
+
+    return true;
+}
+
+/** Reads the segment layout of a Logical Volume, e.g. { "type": "raid10", "stripes": 2, "mirrors": 1 }.
+    A missing layout means linear.
+*/
+bool LayoutApplier::parseLVLayout(const QJsonObject& desc, const QString& lvPath, LvmDevice::LVLayout& layout)
+{
+    using Type = LvmDevice::LVLayout::Type;
+    static const QMap<QString, Type> types = {
+        { QStringLiteral("linear"), Type::Linear },
+        { QStringLiteral("striped"), Type::Striped },
+        { QStringLiteral("raid0"), Type::Raid0 },
+        { QStringLiteral("raid1"), Type::Raid1 },
+        { QStringLiteral("raid10"), Type::Raid10 },
+        { QStringLiteral("raid5"), Type::Raid5 },
+    };
+
+    const QString type = desc.value(QStringLiteral("type")).toString(QStringLiteral("linear"));
+    if (!types.contains(type))
+        return error(xi18nc("@info:status", "Unknown segment type %1 for logical volume <filename>%2</filename>.", type, lvPath));
+
+    layout.type = types.value(type);
+    layout.stripes = desc.value(QStringLiteral("stripes")).toInt(layout.type == Type::Raid1 ? 1 : 2);
+    layout.stripeSize = desc.value(QStringLiteral("stripeSize")).toInt(0);
+    layout.mirrors = desc.value(QStringLiteral("mirrors")).toInt(1);
+    layout.regionSize = desc.value(QStringLiteral("regionSize")).toInt(0);
+
+    if (layout.stripes < 1 || layout.mirrors < 1 || layout.stripeSize < 0 || layout.regionSize < 0)
+        return error(xi18nc("@info:status", "Invalid segment layout for logical volume <filename>%1</filename>.", lvPath));
+
+    return true;
+}
+
+/** Looks up a Partition the layout refers to by device and partition number.
+    @param desc the reference, with "device" and "partition"
+    @param deferred set to true if the Partition is on a RAID array that is still to be created
+    @return the Partition, nullptr if it is not part of the layout or deferred
+*/
+const Partition* LayoutApplier::findMember(const QJsonObject& desc, bool& deferred) const
+{
+    const QString deviceNode = desc.value(QStringLiteral("device")).toString();
+    deferred = m_NewArrays.contains(deviceNode);
+
+    return deferred ? nullptr : m_Partitions.value(deviceNode).value(desc.value(QStringLiteral("partition")).toInt(), nullptr);
+}
+
+Device* LayoutApplier::findDevice(const QString& deviceNode) const
+{
+    for (const auto &d : m_OperationStack.previewDevices())
+        if (d->deviceNode() == deviceNode)
+            return d;
+
+    return nullptr;
+}
+
+FileSystem* LayoutApplier::createFileSystem(const QJsonObject& desc, const Device& d, qint64 first, qint64 last)
+{
+    FileSystem::Type type;
+    FileSystem::Type innerType;
+    if (!parseFileSystem(desc, type, innerType))
+        return nullptr;
+
+    const QString label = desc.value(QStringLiteral("label")).toString();
+
+    if (innerType == FileSystem::Type::Unknown)
+        return FileSystemFactory::create(type, first, last, d.logicalSize(), -1, label);
+
+    const QJsonObject luksDesc = desc.value(QStringLiteral("luks")).toObject();
+    QString passphrase = luksDesc.value(QStringLiteral("passphrase")).toString();
+
+    if (luksDesc.contains(QStringLiteral("passphraseFile"))) {
+        QFile file(luksDesc.value(QStringLiteral("passphraseFile")).toString());
+        if (!file.open(QIODevice::ReadOnly)) {
+            error(xi18nc("@info:status", "Could not read passphrase file <filename>%1</filename>.", file.fileName()));
+            return nullptr;
+        }
+
+        passphrase = QString::fromUtf8(file.readAll());
+        if (passphrase.endsWith(QLatin1Char('\n')))
+            passphrase.chop(1);
+    }
+
+    if (passphrase.isEmpty()) {
+        error(xi18nc("@info:status", "Encrypted partitions need a passphrase or a passphrase file."));
+        return nullptr;
+    }
+
+    FS::luks* fs = static_cast<FS::luks*>(FileSystemFactory::create(type, first, last, d.logicalSize(), -1, label));
+    fs->createInnerFileSystem(innerType);
+    fs->setPassphrase(passphrase);
+
+    return fs;
+}
+
+bool LayoutApplier::parseFileSystem(const QJsonObject& desc, FileSystem::Type& type, FileSystem::Type& innerType)
+{
+    const QString name = desc.value(QStringLiteral("fs")).toString(QStringLiteral("unformatted"));
+    const FileSystem::Type t = FileSystem::typeForName(name, { QStringLiteral("en_US") });
+
+    if (t == FileSystem::Type::Unknown || t == FileSystem::Type::Extended || t == FileSystem::Type::Luks || t == FileSystem::Type::Luks2)
+        return error(xi18nc("@info:status", "Unsupported file system %1 in layout.", name));
+
+    if (desc.contains(QStringLiteral("luks"))) {
+        type = desc.value(QStringLiteral("luks")).toObject().value(QStringLiteral("version")).toInt(2) == 1 ? FileSystem::Type::Luks : FileSystem::Type::Luks2;
+        innerType = t;
+    } else {
+        type = t;
+        innerType = FileSystem::Type::Unknown;
+    }
+
+    return true;
+}
+
+bool LayoutApplier::parseFlags(const QJsonObject& desc, PartitionTable::Flags& flags)
+{
+    flags = PartitionTable::Flag::None;
+
+    for (const auto &value : desc.value(QStringLiteral("flags")).toArray()) {
+        const QString name = value.toString();
+        const PartitionTable::Flags flag = PartitionTable::flagsFromList({ name });
+
+        if (flag == PartitionTable::Flag::None)
+            return error(xi18nc("@info:status", "Unknown partition flag %1 in layout.", name));
+
+        flags |= flag;
+    }
+
+    return true;
+}
+
+void LayoutApplier::push(Operation* op)
+{
+    m_OperationStack.push(op);
+}
+
+bool LayoutApplier::error(const QString& message)
+{
+    m_Errors.append(message);
+    return false;
+}
+
+/** Parses a size in bytes with an optional binary unit suffix.
+    @param s the size, for example "512MiB"
+    @return the size in bytes or -1 if @p s is not a valid size
+*/
+qint64 LayoutApplier::parseSize(const QString& s)
+{
+    static const QRegularExpression re(QStringLiteral("^\\s*(\\d+)\\s*(B|K|KiB|M|MiB|G|GiB|T|TiB)?\\s*$"));
+    const QRegularExpressionMatch match = re.match(s);
+
+    if (!match.hasMatch())
+        return -1;
+
+    const qint64 value = match.captured(1).toLongLong();
+    const QString unit = match.captured(2);
+
+    if (unit.startsWith(QLatin1Char('K')))
+        return value * 1024;
+    if (unit.startsWith(QLatin1Char('M')))
+        return value * 1024 * 1024;
+    if (unit.startsWith(QLatin1Char('G')))
+        return value * 1024 * 1024 * 1024;
+    if (unit.startsWith(QLatin1Char('T')))
+        return value * 1024 * 1024 * 1024 * 1024;
+
+    return value;
+}
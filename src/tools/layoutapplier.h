@@ -0,0 +1,118 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef LAYOUTAPPLIER_H
+#define LAYOUTAPPLIER_H
+
+#include "core/lvmdevice.h"
+#include "core/partitiontable.h"
+
+#include "fs/filesystem.h"
+
+#include <QJsonObject>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+class Device;
+class Operation;
+class OperationStack;
+class Partition;
+
+/** Computes the Operations needed to bring Devices into a declared state.
+
+    The layout is a JSON document describing partition tables, partitions, file systems,
+    LUKS containers, software RAID arrays, LVM volume groups and their logical volumes:
+
+    @code
+    {
+        "devices": [ {
+            "path": "/dev/sdb",
+            "table": "gpt",
+            "partitions": [
+                { "size": "512MiB", "fs": "fat32", "label": "EFI", "flags": [ "boot" ] },
+                { "size": "*", "fs": "lvm2 pv", "luks": { "passphraseFile": "/run/key" } }
+            ]
+        } ],
+        "raid": [ { "path": "/dev/md0", "level": 1, "members": [ { "device": "/dev/sdc", "partition": 1 },
+                                                                 { "device": "/dev/sdd", "partition": 1 } ] } ],
+        "volumeGroups": [ {
+            "name": "vg0", "peSize": 4, "pvs": [ { "device": "/dev/sdb", "partition": 2 } ],
+            "lvs": [ { "name": "root", "size": "20GiB", "fs": "ext4", "layout": { "type": "raid1", "mirrors": 1 } },
+                     { "name": "home", "size": "*", "fs": "xfs" } ]
+        } ]
+    }
+    @endcode
+
+    RAID arrays and volume groups only show up as Devices once they have been created. Their
+    contents, such as the partitions of an array listed under "devices" or the logical volumes
+    of a new volume group, are therefore deferred: plan() leaves them out and lists them in
+    deferred(), they are planned after the Operations have been run and the Devices have been
+    scanned again.
+
+    Partitions are matched by number, which defaults to their position in the list. Sizes are
+    given in bytes or with a KiB, MiB, GiB or TiB suffix, "*" takes the rest of the free space.
+    Partitions without a start follow the previous one. Everything that already matches is
+    left alone, so planning the same layout a second time results in no Operations at all.
+    Changes that would destroy data are refused unless explicitly allowed.
+
+    @author KPMcore contributors
+*/
+class LayoutApplier
+{
+public:
+    explicit LayoutApplier(OperationStack& ostack);
+
+public:
+    bool load(const QByteArray& data);
+    QStringList deviceNodes() const;
+    bool plan();
+
+    const QStringList& errors() const {
+        return m_Errors;    /**< @return the errors found while loading or planning */
+    }
+    const QStringList& deferred() const {
+        return m_Deferred;    /**< @return what plan() left for after the planned Operations have been run */
+    }
+
+    bool allowDestructive() const {
+        return m_AllowDestructive;    /**< @return true if Operations destroying data may be planned */
+    }
+    void setAllowDestructive(bool allow) {
+        m_AllowDestructive = allow;
+    }
+
+private:
+    bool planDevice(const QJsonObject& desc);
+    bool planPartition(Device& d, const QJsonObject& desc, qint32 number, qint64& previousLast);
+    bool planNewPartition(Device& d, const QJsonObject& desc, qint32 number, qint64 first, qint64 last, const QString& sizeSpec);
+    bool planFileSystem(Device& d, Partition& p, const QJsonObject& desc);
+    bool planRaid(const QJsonObject& desc);
+    bool planVolumeGroup(const QJsonObject& desc);
+    bool planLogicalVolume(LvmDevice& d, const QJsonObject& desc);
+    bool parseLVLayout(const QJsonObject& desc, const QString& lvPath, LvmDevice::LVLayout& layout);
+    const Partition* findMember(const QJsonObject& desc, bool& deferred) const;
+
+    Device* findDevice(const QString& deviceNode) const;
+    FileSystem* createFileSystem(const QJsonObject& desc, const Device& d, qint64 first, qint64 last);
+    bool parseFileSystem(const QJsonObject& desc, FileSystem::Type& type, FileSystem::Type& innerType);
+    bool parseFlags(const QJsonObject& desc, PartitionTable::Flags& flags);
+    void push(Operation* op);
+    bool error(const QString& message);
+
+    static qint64 parseSize(const QString& s);
+
+private:
+    OperationStack& m_OperationStack;
+    QJsonObject m_Layout;
+    QMap<QString, QMap<qint32, Partition*>> m_Partitions;
+    QStringList m_Errors;
+    QStringList m_Deferred;
+    QStringList m_NewArrays;
+    bool m_AllowDestructive;
+};
+
+#endif
@@ -26,10 +26,14 @@
 #include "externalcommandhelper_interface.h"
 
 #include <QCryptographicHash>
+#include <QDBusArgument>
 #include <QDBusConnection>
 #include <QDBusInterface>
 #include <QDBusReply>
+#include <QElapsedTimer>
 #include <QEventLoop>
+#include <QFile>
+#include <QFileInfo>
 #include <QtGlobal>
 #include <QStandardPaths>
 #include <QString>
@@ -40,6 +44,10 @@
 #include <KJob>
 #include <KLocalizedString>
 
+#include <atomic>
+
+static std::atomic<quint64> helperCallCount{0};
+
 struct ExternalCommandPrivate
 {
     Report *m_Report;
@@ -113,17 +121,62 @@ bool ExternalCommand::start(int timeout)
     if ( qEnvironmentVariableIsSet( "KPMCORE_DEBUG" ))
         qDebug() << xi18nc("@info:status", "Command: %1 %2", command(), args().join(QStringLiteral(" ")));
 
-    QString cmd = QStandardPaths::findExecutable(command());
-    if (cmd.isEmpty())
-        cmd = QStandardPaths::findExecutable(command(), { QStringLiteral("/sbin/"), QStringLiteral("/usr/sbin/"), QStringLiteral("/usr/local/sbin/") });
+    auto interface = helperInterface();
+    if (!interface)
+        return false;
+
+    bool rval = false;
+
+    QDBusPendingCall pcall = interface->RunCommand(findCommand(), args(), d->m_Input, d->processChannelMode);
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pcall, this);
+    QEventLoop loop;
+
+    auto exitLoop = [&] (QDBusPendingCallWatcher *watcher) {
+        loop.exit();
+
+        if (watcher->isError())
+            qWarning() << watcher->error();
+        else {
+            QDBusPendingReply<QVariantMap> reply = *watcher;
+
+            d->m_Output = reply.value()[QStringLiteral("output")].toByteArray();
+            setExitCode(reply.value()[QStringLiteral("exitCode")].toInt());
+            rval = reply.value()[QStringLiteral("success")].toBool();
+        }
+    };
+
+    connect(watcher, &QDBusPendingCallWatcher::finished, exitLoop);
+    loop.exec();
+
+    return rval;
+}
+
+/** Executes the external command and forwards its progress.
+
+    The command has to print its progress as JSON lines containing device_bytes and
+    device_size, like cryptsetup does with --progress-json. Those lines are emitted as
+    progress() and left out of the output.
+
+    @return true on success
+*/
+bool ExternalCommand::runWithProgress()
+{
+    if (command().isEmpty())
+        return false;
+
+    if (report())
+        report()->setCommand(xi18nc("@info:status", "Command: %1 %2", command(), args().join(QStringLiteral(" "))));
 
     auto interface = helperInterface();
     if (!interface)
         return false;
 
+    connect(interface, &OrgKdeKpmcoreExternalcommandInterface::progress, this, &ExternalCommand::progress);
+
     bool rval = false;
 
-    QDBusPendingCall pcall = interface->RunCommand(cmd, args(), d->m_Input, d->processChannelMode);
+    QDBusPendingCall pcall = interface->RunCommandWithProgress(findCommand(), args(), d->m_Input);
 
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pcall, this);
     QEventLoop loop;
@@ -145,14 +198,174 @@ bool ExternalCommand::start(int timeout)
     connect(watcher, &QDBusPendingCallWatcher::finished, exitLoop);
     loop.exec();
 
+    disconnect(interface, &OrgKdeKpmcoreExternalcommandInterface::progress, this, &ExternalCommand::progress);
+
+    return rval;
+}
+
+/** Runs several commands at the same time.
+
+    All commands are sent to the helper in one call, which runs up to @p maxParallel of them
+    concurrently. Output and exit code of each command are available as if it had been run
+    on its own. Output is always merged.
+
+    @param commands the commands to run
+    @param maxParallel the maximum number of commands running at once
+    @return true if the commands could be handed to the helper
+*/
+bool ExternalCommand::runParallel(const QList<ExternalCommand*>& commands, int maxParallel)
+{
+    if (commands.isEmpty())
+        return true;
+
+    QStringList cmds;
+    QVariantList arguments;
+    QVariantList inputs;
+
+    for (const auto &c : commands) {
+        if (c->report())
+            c->report()->setCommand(xi18nc("@info:status", "Command: %1 %2", c->command(), c->args().join(QStringLiteral(" "))));
+
+        cmds << c->findCommand();
+        arguments << c->args();
+        inputs << c->d->m_Input;
+    }
+
+    auto interface = commands.first()->helperInterface();
+    if (!interface)
+        return false;
+
+    QDBusPendingCall pcall = interface->RunCommands(cmds, arguments, inputs, maxParallel);
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pcall, interface);
+    QEventLoop loop;
+    bool rval = false;
+
+    auto exitLoop = [&] (QDBusPendingCallWatcher *watcher) {
+        loop.exit();
+
+        if (watcher->isError()) {
+            qWarning() << watcher->error();
+            return;
+        }
+
+        QDBusPendingReply<QVariantList> reply = *watcher;
+        const QVariantList replies = reply.value();
+        if (replies.size() != commands.size())
+            return;
+
+        for (int i = 0; i < commands.size(); ++i) {
+            const QVariantMap r = qdbus_cast<QVariantMap>(replies[i]);
+            commands[i]->d->m_Output = r[QStringLiteral("output")].toByteArray();
+            commands[i]->setExitCode(r[QStringLiteral("success")].toBool() ? r[QStringLiteral("exitCode")].toInt() : -1);
+        }
+
+        rval = true;
+    };
+
+    connect(watcher, &QDBusPendingCallWatcher::finished, exitLoop);
+    loop.exec();
+
+    return rval;
+}
+
+/** @return the full path of the command, which may be in a sbin directory that is not in PATH */
+QString ExternalCommand::findCommand() const
+{
+    QString cmd = QStandardPaths::findExecutable(command());
+    if (cmd.isEmpty())
+        cmd = QStandardPaths::findExecutable(command(), { QStringLiteral("/sbin/"), QStringLiteral("/usr/sbin/"), QStringLiteral("/usr/local/sbin/") });
+
+    return cmd;
+}
+
+/** Copies blocks between regular files the user can access without going through the helper.
+
+    Like the helper, blocks are copied back to front if the target lies behind the source, so that
+    overlapping areas within one file are handled correctly.
+
+    @param source the CopySource to read from, must be a regular file
+    @param target the CopyTarget to write to, must be a regular file or a CopyTargetByteArray
+    @param blockSize number of bytes per block to copy
+    @return true on success
+*/
+bool ExternalCommand::copyLocalBlocks(const CopySource& source, CopyTarget& target, qint64 blockSize)
+{
+    CopyTargetByteArray *byteArrayTarget = dynamic_cast<CopyTargetByteArray*>(&target);
+
+    QFile sourceFile(source.path());
+    QFile targetFile(target.path());
+    if (!sourceFile.open(QIODevice::ReadOnly) || (!byteArrayTarget && !targetFile.open(QIODevice::ReadWrite))) {
+        setExitCode(1);
+        return false;
+    }
+
+    if (byteArrayTarget)
+        byteArrayTarget->m_Array.clear();
+
+    const bool backwards = !byteArrayTarget && source.path() == target.path() && target.firstByte() > source.firstByte();
+    const qint64 length = source.length();
+
+    Q_EMIT reportSignal(xi18nc("@info:progress", "Copying %1 bytes from %2 to %3 in <filename>%4</filename>.", length, source.firstByte(), target.firstByte(), target.path()));
+
+    bool rval = true;
+    qint64 bytesCopied = 0;
+    int percent = 0;
+    QElapsedTimer timer;
+    timer.start();
+
+    while (rval && bytesCopied < length) {
+        const qint64 size = qMin(blockSize, length - bytesCopied);
+        const qint64 offset = backwards ? length - bytesCopied - size : bytesCopied;
+
+        QByteArray buffer;
+        rval = sourceFile.seek(source.firstByte() + offset);
+        if (rval) {
+            buffer = sourceFile.read(size);
+            rval = buffer.size() == size;
+        }
+
+        if (rval && byteArrayTarget)
+            byteArrayTarget->m_Array += buffer;
+        else if (rval)
+            rval = targetFile.seek(target.firstByte() + offset) && targetFile.write(buffer) == size;
+
+        if (rval) {
+            bytesCopied += size;
+            target.setBytesWritten(bytesCopied);
+
+            if (bytesCopied * 100 / length != percent) {
+                percent = bytesCopied * 100 / length;
+                Q_EMIT progress(percent);
+            }
+        }
+    }
+
+    if (!byteArrayTarget)
+        rval = targetFile.flush() && rval;
+
+    if (rval && timer.elapsed() > 1000)
+        Q_EMIT reportSignal(xi18nc("@info:progress", "Copying took %1 seconds.", timer.elapsed() / 1000));
+
+    setExitCode(!rval);
     return rval;
 }
 
+/** @return true if @p path is a regular file and not a device node */
+static bool isRegularFile(const QString& path)
+{
+    const QFileInfo info(path);
+    return info.isFile() && !info.isSymLink() && info.isReadable();
+}
+
 bool ExternalCommand::copyBlocks(const CopySource& source, CopyTarget& target)
 {
     bool rval = true;
     const qint64 blockSize = 10 * 1024 * 1024; // number of bytes per block to copy
 
+    // Image files can be accessed directly, there is no need to ask for elevated privileges
+    if (isRegularFile(source.path()) && (target.path().isEmpty() || (isRegularFile(target.path()) && QFileInfo(target.path()).isWritable())))
+        return copyLocalBlocks(source, target, blockSize);
+
     auto interface = helperInterface();
     if (!interface)
         return false;
@@ -187,13 +400,139 @@ bool ExternalCommand::copyBlocks(const CopySource& source, CopyTarget& target)
     return rval;
 }
 
+/** Copies blocks from one source to several targets, reading the source only once.
+
+    Targets that fail or stall are dropped without stopping the copy to the other targets.
+
+    @param source the CopySource to read from
+    @param targets the CopyTargets to write to, may share a device as long as they do not overlap
+    @param failedTargets indexes into @p targets of the targets that did not receive all data
+    @return true if at least one target received all data
+*/
+bool ExternalCommand::copyBlocks(const CopySource& source, const QList<CopyTarget*>& targets, QList<int>& failedTargets)
+{
+    bool rval = true;
+    const qint64 blockSize = 10 * 1024 * 1024; // number of bytes per block to copy
+
+    QStringList targetDevices;
+    QVariantList targetOffsets;
+    for (const auto &target : targets) {
+        targetDevices.append(target->path());
+        targetOffsets.append(target->firstByte());
+    }
+
+    failedTargets.clear();
+
+    auto interface = helperInterface();
+    if (!interface)
+        return false;
+
+    connect(interface, &OrgKdeKpmcoreExternalcommandInterface::progress, this, &ExternalCommand::progress);
+    connect(interface, &OrgKdeKpmcoreExternalcommandInterface::report, this, &ExternalCommand::reportSignal);
+    connect(interface, &OrgKdeKpmcoreExternalcommandInterface::targetProgress, this, &ExternalCommand::targetProgress);
+
+    QDBusPendingCall pcall = interface->FanOutCopyBlocks(source.path(), source.firstByte(), source.length(), targetDevices, targetOffsets, blockSize);
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pcall, this);
+    QEventLoop loop;
+
+    auto exitLoop = [&] (QDBusPendingCallWatcher *watcher) {
+        loop.exit();
+        if (watcher->isError()) {
+            qWarning() << watcher->error();
+            rval = false;
+            for (int i = 0; i < targets.size(); ++i)
+                failedTargets.append(i);
+        }
+        else {
+            QDBusPendingReply<QVariantMap> reply = *watcher;
+            rval = reply.value()[QStringLiteral("success")].toBool();
+            for (const auto &index : reply.value()[QStringLiteral("failedTargets")].toList())
+                failedTargets.append(index.toInt());
+        }
+        setExitCode(!rval);
+    };
+
+    connect(watcher, &QDBusPendingCallWatcher::finished, exitLoop);
+    loop.exec();
+
+    return rval;
+}
+
+/** Copies blocks from a failing device without giving up on read errors.
+    @param source the CopySource to rescue data from
+    @param target the CopyTarget to write the data to
+    @param sectorSize smallest unit to retry reading
+    @param rescueMap map of already rescued areas from a previous run, updated on return
+    @param retryPasses number of times to retry bad sectors
+    @param fillBadSectors write zeros for unreadable sectors instead of leaving holes
+    @return true if all readable data was written to the target
+*/
+bool ExternalCommand::rescueBlocks(const CopySource& source, CopyTarget& target, qint64 sectorSize, QByteArray& rescueMap, int retryPasses, bool fillBadSectors)
+{
+    bool rval = true;
+    const qint64 blockSize = 10 * 1024 * 1024; // number of bytes per block to copy in the first pass
+
+    if (sectorSize <= 0)
+        return false;
+
+    auto interface = helperInterface();
+    if (!interface)
+        return false;
+
+    connect(interface, &OrgKdeKpmcoreExternalcommandInterface::progress, this, &ExternalCommand::progress);
+    connect(interface, &OrgKdeKpmcoreExternalcommandInterface::report, this, &ExternalCommand::reportSignal);
+    connect(interface, &OrgKdeKpmcoreExternalcommandInterface::rescueMapChanged, this, &ExternalCommand::rescueMapChanged);
+
+    QDBusPendingCall pcall = interface->RescueBlocks(source.path(), source.firstByte(), source.length(),
+                                                     target.path(), target.firstByte(), blockSize / sectorSize * sectorSize,
+                                                     sectorSize, rescueMap, retryPasses, fillBadSectors);
+
+    QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pcall, this);
+    QEventLoop loop;
+
+    auto exitLoop = [&] (QDBusPendingCallWatcher *watcher) {
+        loop.exit();
+        if (watcher->isError()) {
+            qWarning() << watcher->error();
+            rval = false;
+        }
+        else {
+            QDBusPendingReply<QVariantMap> reply = *watcher;
+            rval = reply.value()[QStringLiteral("success")].toBool();
+            if (reply.value().contains(QStringLiteral("rescueMap")))
+                rescueMap = reply.value()[QStringLiteral("rescueMap")].toByteArray();
+        }
+        setExitCode(!rval);
+    };
+
+    connect(watcher, &QDBusPendingCallWatcher::finished, exitLoop);
+    loop.exec();
+
+    return rval;
+}
+
 QByteArray ExternalCommand::readData(const CopySourceDevice& source)
+{
+    return readData(source.path(), source.firstByte(), source.length());
+}
+
+/** Reads data from a block device through the helper.
+
+    Reads during a scan are served from the helper's read cache, see setReadCacheEnabled().
+
+    @param deviceNode the block device to read from
+    @param offset offset in bytes to start reading at
+    @param length number of bytes to read, at most 1 MiB
+    @return the data, empty on failure
+*/
+QByteArray ExternalCommand::readData(const QString& deviceNode, qint64 offset, qint64 length)
 {
     auto interface = helperInterface();
     if (!interface)
         return {};
 
-    QDBusPendingCall pcall = interface->ReadData(source.path(), source.firstByte(), source.length());
+    QDBusPendingCall pcall = interface->ReadData(deviceNode, offset, length);
 
     QDBusPendingCallWatcher *watcher = new QDBusPendingCallWatcher(pcall, this);
 
@@ -217,6 +556,24 @@ QByteArray ExternalCommand::readData(const CopySourceDevice& source)
     return target;
 }
 
+/** Enables or disables the helper's read cache.
+
+    While enabled, every region read with readData() is only read from the device once.
+    Only enable it while nothing but the helper itself writes to the devices, i.e. while
+    scanning. Disabling discards the cache.
+
+    @param enable true to enable the cache
+*/
+void ExternalCommand::setReadCacheEnabled(bool enable)
+{
+    ExternalCommand cmd;
+    auto interface = cmd.helperInterface();
+    if (!interface)
+        return;
+
+    interface->EnableReadCache(enable).waitForFinished();
+}
+
 bool ExternalCommand::writeData(Report& commandReport, const QByteArray& buffer, const QString& deviceNode, const quint64 firstByte)
 {
     d->m_Report = commandReport.newChild();
@@ -241,6 +598,36 @@ bool ExternalCommand::createFile(const QByteArray& fileContents, const QString&
     return waitForDbusReply(pcall);
 }
 
+/** Creates @p path as a directory only root can access, or checks that it already is one.
+    @return true on success */
+bool ExternalCommand::createStateDirectory(const QString& path)
+{
+    auto interface = helperInterface();
+    if (!interface)
+        return false;
+
+    QDBusPendingCall pcall = interface->CreateStateDirectory(path);
+    return waitForDbusReply(pcall);
+}
+
+/** Removes a file kept in a directory made by createStateDirectory().
+    @return true on success */
+bool ExternalCommand::removeStateFile(const QString& path)
+{
+    auto interface = helperInterface();
+    if (!interface)
+        return false;
+
+    QDBusPendingCall pcall = interface->RemoveStateFile(path);
+    return waitForDbusReply(pcall);
+}
+
+/** @return the number of calls made to the helper so far, useful to measure how much a task costs */
+quint64 ExternalCommand::helperCalls()
+{
+    return helperCallCount;
+}
+
 OrgKdeKpmcoreExternalcommandInterface* ExternalCommand::helperInterface()
 {
     if (!QDBusConnection::systemBus().isConnected()) {
@@ -248,6 +635,8 @@ OrgKdeKpmcoreExternalcommandInterface* ExternalCommand::helperInterface()
         return nullptr;
     }
 
+    ++helperCallCount;
+
     auto *interface = new org::kde::kpmcore::externalcommand(QStringLiteral("org.kde.kpmcore.helperinterface"),
                 QStringLiteral("/Helper"), QDBusConnection::systemBus(), this);
     interface->setTimeout(10 * 24 * 3600 * 1000); // 10 days
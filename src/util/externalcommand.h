@@ -55,9 +55,14 @@ public:
 
 public:
     bool copyBlocks(const CopySource& source, CopyTarget& target);
+    bool copyBlocks(const CopySource& source, const QList<CopyTarget*>& targets, QList<int>& failedTargets);
+    bool rescueBlocks(const CopySource& source, CopyTarget& target, qint64 sectorSize, QByteArray& rescueMap, int retryPasses, bool fillBadSectors);
     QByteArray readData(const CopySourceDevice& source);
+    QByteArray readData(const QString& deviceNode, qint64 offset, qint64 length);
     bool writeData(Report& commandReport, const QByteArray& buffer, const QString& deviceNode, const quint64 firstByte); // same as copyBlocks but from QByteArray
     bool createFile(const QByteArray& filePath, const QString& fileContents); // similar to writeData but creates a new file
+    bool createStateDirectory(const QString& path); // a directory only root can access
+    bool removeStateFile(const QString& path); // removes a file created in such a directory
 
     /**< @param cmd the command to run */
     void setCommand(const QString& cmd);
@@ -76,6 +81,11 @@ public:
 
     bool start(int timeout = 30000);
     bool run(int timeout = 30000);
+    bool runWithProgress();
+
+    static bool runParallel(const QList<ExternalCommand*>& commands, int maxParallel);
+    static void setReadCacheEnabled(bool enable);
+    static quint64 helperCalls();
 
     /**< @return the exit code */
     int exitCode() const;
@@ -91,10 +101,14 @@ public:
 Q_SIGNALS:
     void progress(int);
     void reportSignal(const QString&);
+    void rescueMapChanged(const QByteArray&);
+    void targetProgress(int, int);
 
 private:
     void setExitCode(int i);
     void onReadOutput();
+    QString findCommand() const;
+    bool copyLocalBlocks(const CopySource& source, CopyTarget& target, qint64 blockSize);
     bool waitForDbusReply(QDBusPendingCall &pcall);
     OrgKdeKpmcoreExternalcommandInterface* helperInterface();
 
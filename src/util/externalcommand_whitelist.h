@@ -19,6 +19,7 @@ QStringLiteral("udevadm"),
 QStringLiteral("blockdev"),
 QStringLiteral("blkid"),
 QStringLiteral("partx"),
+QStringLiteral("losetup"),
 QStringLiteral("sfdisk"),
 QStringLiteral("wipefs"),
 QStringLiteral("lvm"),
@@ -31,6 +32,7 @@ QStringLiteral("smartctl"),
 QStringLiteral("btrfs"),
 QStringLiteral("mkfs.btrfs"),
 QStringLiteral("btrfstune"),
+QStringLiteral("btrfs-convert"),
 QStringLiteral("fsck.exfat"),
 QStringLiteral("mkexfatfs"),
 QStringLiteral("mkfs.exfat"),
@@ -38,6 +40,7 @@ QStringLiteral("exfatlabel"),
 QStringLiteral("tune.exfat"),
 QStringLiteral("dumpe2fs"),
 QStringLiteral("e2fsck"),
+QStringLiteral("e2image"),
 QStringLiteral("mkfs.ext2"),
 QStringLiteral("resize2fs"),
 QStringLiteral("e2label"),
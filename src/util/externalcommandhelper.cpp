@@ -12,17 +12,36 @@
 
 #include "externalcommandhelper.h"
 #include "externalcommand_whitelist.h"
+#include "lvmshell.h"
+#include "rescuemap.h"
 
+#include <algorithm>
+#include <cerrno>
 #include <filesystem>
+#include <functional>
+#include <memory>
+#include <vector>
+
+#include <sys/stat.h>
+#include <sys/sysmacros.h>
+#include <unistd.h>
 
 #include <QtDBus>
 
 #include <QCoreApplication>
 #include <QDebug>
+#include <QDir>
 #include <QElapsedTimer>
 #include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QMutex>
+#include <QRegularExpression>
 #include <QString>
+#include <QThread>
 #include <QVariant>
+#include <QWaitCondition>
 
 #include <KLocalizedString>
 #include <PolkitQt1/Authority>
@@ -154,6 +173,91 @@ bool ExternalCommandHelper::CreateFile(const QString &filePath, const QByteArray
     return true;
 }
 
+/** Creates a directory only root can access, for files that have to outlive a run, such as the
+    LUKS2 header of a device that is being decrypted.
+
+    mkdir fails if the path exists, so a directory created by someone else is only accepted if
+    it is a real directory owned by root that nobody else can access.
+
+    @param path the absolute path of the directory
+    @return true if the directory exists and is private to root
+*/
+bool ExternalCommandHelper::CreateStateDirectory(const QString& path)
+{
+    if (!isCallerAuthorized()) {
+        return false;
+    }
+
+    if (!QDir::isAbsolutePath(path) || QDir::cleanPath(path) != path) {
+        qCritical() << xi18n("<filename>%1</filename> is not an absolute path.", path);
+        return false;
+    }
+
+    const QByteArray nativePath = QFile::encodeName(path);
+    if (mkdir(nativePath.constData(), 0700) == 0)
+        return true;
+
+    struct stat info;
+    if (errno != EEXIST || lstat(nativePath.constData(), &info) != 0 || !S_ISDIR(info.st_mode) ||
+            info.st_uid != 0 || (info.st_mode & (S_IRWXG | S_IRWXO)) != 0) {
+        qCritical() << xi18n("Could not create the private directory <filename>%1</filename>.", path);
+        return false;
+    }
+
+    return true;
+}
+
+/** Removes a file from a directory made by CreateStateDirectory().
+
+    Only regular files named like the LUKS2 headers kept while decrypting are removed,
+    this helper must not be usable to remove arbitrary files.
+
+    @param path the absolute path of the file
+    @return true if the file was removed
+*/
+bool ExternalCommandHelper::RemoveStateFile(const QString& path)
+{
+    if (!isCallerAuthorized()) {
+        return false;
+    }
+
+    const QFileInfo file(path);
+    if (!file.isAbsolute() || QDir::cleanPath(path) != path ||
+            !file.fileName().startsWith(QStringLiteral("kpmcore-decrypt-")) || file.suffix() != QStringLiteral("luks2"))
+        return false;
+
+    struct stat info;
+    if (lstat(QFile::encodeName(file.path()).constData(), &info) != 0 || !S_ISDIR(info.st_mode) ||
+            info.st_uid != 0 || (info.st_mode & (S_IRWXG | S_IRWXO)) != 0)
+        return false;
+
+    if (lstat(QFile::encodeName(path).constData(), &info) != 0 || !S_ISREG(info.st_mode))
+        return false;
+
+    return unlink(QFile::encodeName(path).constData()) == 0;
+}
+
+/** @return true if the device, or the device a file lives on, is a rotational disk or unknown */
+static bool isRotational(const QString& path)
+{
+    struct stat info;
+    if (stat(path.toLocal8Bit().constData(), &info) != 0)
+        return true;
+
+    const dev_t device = S_ISBLK(info.st_mode) ? info.st_rdev : info.st_dev;
+    const QString sysfsPath = QStringLiteral("/sys/dev/block/%1:%2").arg(major(device)).arg(minor(device));
+
+    // Partitions share the queue of their disk
+    QFile file(sysfsPath + QStringLiteral("/queue/rotational"));
+    if (!file.exists())
+        file.setFileName(sysfsPath + QStringLiteral("/../queue/rotational"));
+
+    if (!file.open(QIODevice::ReadOnly))
+        return true;
+
+    return file.readAll().trimmed() != "0";
+}
+
 // If targetDevice is empty then return QByteArray with data that was read from disk.
 QVariantMap ExternalCommandHelper::CopyBlocks(const QString& sourceDevice, const qint64 sourceOffset, const qint64 sourceLength, const QString& targetDevice, const qint64 targetOffset, const qint64 blockSize)
 {
@@ -161,6 +265,8 @@ QVariantMap ExternalCommandHelper::CopyBlocks(const QString& sourceDevice, const
         return {};
     }
 
+    m_ReadCache.clear();
+
     // Avoid division by zero further down
     if (!blockSize) {
         return {};
@@ -171,6 +277,11 @@ QVariantMap ExternalCommandHelper::CopyBlocks(const QString& sourceDevice, const
         return {};
     }
 
+    // Number of blocks in flight at once on non-rotational devices
+    constexpr qint64 maxBlocksInFlight = 8;
+    // Bytes read in one go before writing them on rotational disks
+    constexpr qint64 stagingSize = 128 * 1024 * 1024;
+
     QVariantMap reply;
     reply[QStringLiteral("success")] = true;
 
@@ -186,23 +297,37 @@ QVariantMap ExternalCommandHelper::CopyBlocks(const QString& sourceDevice, const
     };
     qint8 copyDirection = targetOffset > sourceOffset ? CopyDirection::Right : CopyDirection::Left;
 
-    // Let readOffset (r) and writeOffset (w) be the offsets of the first block that we move.
-    // When we move data to the left:
+    // Blocks are numbered in the order they are copied. When we move data to the left:
     // ______target______         ______source______
-    // r                     <-   w=================
-    qint64 readOffset = sourceOffset;
-    qint64 writeOffset = targetOffset;
-
-    // When we move data to the right, we start moving data from the last block
+    // 0                     <-   0 1 2 ============
+    // When we move data to the right, we start with the last block and the
+    // remainder ends up at the start:
     // ______source______         ______target______
-    // =================r    ->                    w
-    if (copyDirection == CopyDirection::Right) {
-        readOffset = sourceOffset + sourceLength - blockSize;
-        writeOffset = targetOffset + sourceLength - blockSize;
-    }
+    // ============ 2 1 0    ->                    0
+    auto blockStart = [&] (qint64 block) {
+        return copyDirection == CopyDirection::Left ? block * blockSize : std::max<qint64>(0, sourceLength - (block + 1) * blockSize);
+    };
+    auto blockEnd = [&] (qint64 block) {
+        return copyDirection == CopyDirection::Left ? std::min(sourceLength, (block + 1) * blockSize) : sourceLength - block * blockSize;
+    };
+
+    const qint64 blocksToCopy = (sourceLength + blockSize - 1) / blockSize;
+
+    // Blocks are copied in waves, the blocks of one wave do not depend on each other.
+    // A block only overwrites source data that belongs to blocks copied before it, at a
+    // distance of delta bytes. Blocks within delta of each other can therefore all be in flight
+    // at once, and without any overlap the order does not matter at all. On rotational disks
+    // a whole wave is read before it is written instead, which is safe for any wave size and
+    // turns many short seeks into one long read and one long write.
+    const qint64 delta = qAbs(targetOffset - sourceOffset);
+    const bool overlapping = sourceDevice == targetDevice && delta < sourceLength;
+    const bool rotational = isRotational(sourceDevice) || isRotational(targetDevice);
 
-    const qint64 blocksToCopy = sourceLength / blockSize;
-    const qint64 lastBlock = sourceLength % blockSize;
+    qint64 waveBlocks = maxBlocksInFlight;
+    if (rotational)
+        waveBlocks = std::max<qint64>(1, stagingSize / blockSize);
+    else if (overlapping)
+        waveBlocks = std::clamp<qint64>(delta / blockSize, 1, maxBlocksInFlight);
 
     qint64 bytesWritten = 0;
     qint64 blocksCopied = 0;
@@ -214,26 +339,61 @@ QVariantMap ExternalCommandHelper::CopyBlocks(const QString& sourceDevice, const
     timer.start();
 
     QString reportText = xi18nc("@info:progress", "Copying %1 blocks (%2 bytes) from %3 to %4, direction: %5.", blocksToCopy,
-                                              sourceLength, readOffset, writeOffset, copyDirection == CopyDirection::Left ? i18nc("direction: left", "left")
+                                              sourceLength, sourceOffset, targetOffset, copyDirection == CopyDirection::Left ? i18nc("direction: left", "left")
                                               : i18nc("direction: right", "right"));
     Q_EMIT report(reportText);
 
+    if (waveBlocks > 1)
+        Q_EMIT report(rotational ? xi18nc("@info:progress", "Staging up to %1 blocks at a time.", waveBlocks)
+                                 : xi18nc("@info:progress", "Copying up to %1 blocks in parallel.", waveBlocks));
+
     bool rval = true;
 
-    while (blocksCopied < blocksToCopy) {
-        if (!(rval = readData(sourceDevice, buffer, readOffset + blockSize * blocksCopied * copyDirection, blockSize)))
-            break;
+    while (rval && blocksCopied < blocksToCopy) {
+        const qint64 waveEnd = std::min(blocksToCopy, blocksCopied + waveBlocks);
 
-        if (!(rval = writeData(targetDevice, buffer, writeOffset + blockSize * blocksCopied * copyDirection)))
-            break;
+        if (rotational || waveEnd - blocksCopied == 1) {
+            const qint64 start = std::min(blockStart(blocksCopied), blockStart(waveEnd - 1));
+            const qint64 end = std::max(blockEnd(blocksCopied), blockEnd(waveEnd - 1));
+
+            if (!(rval = readData(sourceDevice, buffer, sourceOffset + start, end - start)))
+                break;
 
-        bytesWritten += buffer.size();
+            if (!(rval = writeData(targetDevice, buffer, targetOffset + start)))
+                break;
+        } else {
+            std::vector<QThread*> workers;
+            std::vector<char> copied(waveEnd - blocksCopied, false);
 
-        if (++blocksCopied * 100 / blocksToCopy != percent) {
+            for (qint64 block = blocksCopied; block < waveEnd; ++block) {
+                const qint64 start = blockStart(block);
+                const qint64 size = blockEnd(block) - start;
+                char& ok = copied[block - blocksCopied];
+
+                workers.push_back(QThread::create([this, &ok, &sourceDevice, &targetDevice, sourceOffset, targetOffset, start, size] () {
+                    QByteArray blockBuffer;
+                    ok = readData(sourceDevice, blockBuffer, sourceOffset + start, size) && writeData(targetDevice, blockBuffer, targetOffset + start);
+                }));
+                workers.back()->start();
+            }
+
+            for (auto worker : workers) {
+                worker->wait();
+                delete worker;
+            }
+
+            if (!(rval = std::all_of(copied.begin(), copied.end(), [] (char ok) { return ok; })))
+                break;
+        }
+
+        bytesWritten += std::max(blockEnd(blocksCopied), blockEnd(waveEnd - 1)) - std::min(blockStart(blocksCopied), blockStart(waveEnd - 1));
+        blocksCopied = waveEnd;
+
+        if (blocksCopied * 100 / blocksToCopy != percent) {
             percent = blocksCopied * 100 / blocksToCopy;
 
             if (percent % 5 == 0 && timer.elapsed() > 1000) {
-                const qint64 mibsPerSec = (blocksCopied * blockSize / 1024 / 1024) / (timer.elapsed() / 1000);
+                const qint64 mibsPerSec = (bytesWritten / 1024 / 1024) / (timer.elapsed() / 1000);
                 const qint64 estSecsLeft = (100 - percent) * timer.elapsed() / percent / 1000;
                 reportText = xi18nc("@info:progress", "Copying %1 MiB/second, estimated time left: %2", mibsPerSec, QTime(0, 0).addSecs(estSecsLeft).toString());
                 Q_EMIT report(reportText);
@@ -242,30 +402,481 @@ QVariantMap ExternalCommandHelper::CopyBlocks(const QString& sourceDevice, const
         }
     }
 
-    // copy the remainder
-    if (rval && lastBlock > 0) {
-        Q_ASSERT(lastBlock < blockSize);
+    reportText = xi18ncp("@info:progress argument 2 is a string such as 7 bytes (localized accordingly)", "Copying 1 block (%2) finished.", "Copying %1 blocks (%2) finished.", blocksCopied, i18np("1 byte", "%1 bytes", bytesWritten));
+    Q_EMIT report(reportText);
 
-        const qint64 lastBlockReadOffset = copyDirection == CopyDirection::Left ? readOffset + blockSize * blocksCopied : sourceOffset;
-        const qint64 lastBlockWriteOffset = copyDirection == CopyDirection::Left ? writeOffset + blockSize * blocksCopied : targetOffset;
-        reportText = xi18nc("@info:progress", "Copying remainder of block size %1 from %2 to %3.", lastBlock, lastBlockReadOffset, lastBlockWriteOffset);
-        Q_EMIT report(reportText);
-        rval = readData(sourceDevice, buffer, lastBlockReadOffset, lastBlock);
+    reply[QStringLiteral("success")] = rval;
+    return reply;
+}
 
-        if (rval) {
-            rval = writeData(targetDevice, buffer, lastBlockWriteOffset);
+/** Copies blocks from a failing device, rescuing as much data as possible.
+
+    Unlike CopyBlocks() read errors do not abort copying. Instead, the source is copied in
+    several passes, tracking the state of each area in a RescueMap:
+    <ol>
+        <li>Copy untried areas in blocks of blockSize. After a read error or a slow read,
+            skip ahead and leave the skipped area for later.</li>
+        <li>Copy the remaining untried areas without skipping.</li>
+        <li>Retry failed areas with progressively smaller blocks down to sectorSize.
+            Sectors that still cannot be read are marked as bad.</li>
+        <li>Read areas left unscraped by GNU ddrescue sector by sector.</li>
+        <li>Retry bad sectors retryPasses times.</li>
+    </ol>
+    Write errors are fatal. Areas rescued in a previous run are skipped.
+
+    @param rescueMap map from a previous run as returned in the reply, may be empty
+    @param sectorSize smallest unit to retry reading
+    @param retryPasses number of times to retry bad sectors
+    @param fillBadSectors write zeros to the target for bad sectors instead of leaving holes
+    @return reply with "success", the updated "rescueMap" and the number of "badBytes"
+*/
+QVariantMap ExternalCommandHelper::RescueBlocks(const QString& sourceDevice, const qint64 sourceOffset, const qint64 sourceLength,
+                                                const QString& targetDevice, const qint64 targetOffset, const qint64 blockSize,
+                                                const qint64 sectorSize, const QByteArray& rescueMap, const int retryPasses, const bool fillBadSectors)
+{
+    if (!isCallerAuthorized()) {
+        return {};
+    }
+
+    m_ReadCache.clear();
+
+    if (sectorSize <= 0 || blockSize < sectorSize || blockSize % sectorSize) {
+        return {};
+    }
+
+    // Prevent some out of memory situations
+    if (blockSize > 100 * MiB) {
+        return {};
+    }
+
+    // Rescue passes do not copy in a fixed order, so source and target must not overlap
+    if (sourceDevice == targetDevice && sourceOffset < targetOffset + sourceLength && targetOffset < sourceOffset + sourceLength) {
+        qCritical() << xi18n("Source and target for rescuing data must not overlap.");
+        return {};
+    }
+
+    // Reads slower than this are considered slow and the area after them is skipped during the first pass.
+    constexpr qint64 slowReadBytesPerSecond = 1024 * 1024;
+    // Never skip more than this after a single error.
+    constexpr qint64 maxSkipSize = 1024 * 1024 * 1024;
+    // Interval for sending the updated map to the client, so that it survives a crash.
+    constexpr qint64 mapUpdateInterval = 30 * 1000;
+
+    RescueMap map(sourceOffset, sourceLength);
+    map.load(rescueMap);
+
+    enum class ChunkResult {
+        Success,
+        SlowRead,
+        ReadError,
+        WriteError
+    };
+
+    QByteArray buffer;
+    RescueMap::Phase phase = RescueMap::Copying;
+    qint32 pass = 1;
+    auto copyChunk = [&] (qint64 pos, qint64 size, RescueMap::Status failStatus) {
+        map.setCurrent(pos, phase, pass);
+
+        QElapsedTimer readTimer;
+        readTimer.start();
+        if (!readData(sourceDevice, buffer, pos, size)) {
+            map.mark(pos, size, failStatus);
+            return ChunkResult::ReadError;
         }
+        const bool slow = readTimer.elapsed() * slowReadBytesPerSecond > size * 1000;
+
+        if (!writeData(targetDevice, buffer, targetOffset + pos - sourceOffset))
+            return ChunkResult::WriteError;
+
+        map.mark(pos, size, RescueMap::Finished);
+        return slow ? ChunkResult::SlowRead : ChunkResult::Success;
+    };
 
-        if (rval) {
-            Q_EMIT progress(100);
-            bytesWritten += buffer.size();
+    int percent = -1;
+    QElapsedTimer mapTimer;
+    mapTimer.start();
+    auto updateProgress = [&] () {
+        const qint64 done = map.bytes(RescueMap::Finished) + map.bytes(RescueMap::BadSector);
+        const int newPercent = sourceLength > 0 ? done * 100 / sourceLength : 100;
+        if (newPercent != percent) {
+            percent = newPercent;
+            Q_EMIT progress(percent);
+        }
+        if (mapTimer.elapsed() > mapUpdateInterval) {
+            Q_EMIT rescueMapChanged(map.save());
+            mapTimer.restart();
+        }
+    };
+
+    Q_EMIT report(xi18nc("@info:progress", "Rescuing %1 bytes from %2 to %3. Already rescued: %4 bytes, bad: %5 bytes.",
+                         sourceLength, sourceOffset, targetOffset, map.bytes(RescueMap::Finished), map.bytes(RescueMap::BadSector)));
+
+    bool rval = true;
+    const RescueMap::Status blockFailStatus = blockSize == sectorSize ? RescueMap::BadSector : RescueMap::NonTrimmed;
+
+    // First pass: copy untried areas, skip ahead on errors and slow reads
+    const auto untriedRanges = map.ranges(RescueMap::Untried);
+    for (const auto& range : untriedRanges) {
+        const qint64 end = range.pos + range.size;
+        qint64 skipSize = blockSize;
+        for (qint64 pos = range.pos; rval && pos < end;) {
+            const qint64 size = std::min(blockSize, end - pos);
+            const ChunkResult result = copyChunk(pos, size, blockFailStatus);
+            pos += size;
+
+            if (result == ChunkResult::WriteError)
+                rval = false;
+            else if (result == ChunkResult::ReadError || result == ChunkResult::SlowRead) {
+                pos += skipSize;
+                skipSize = std::min(skipSize * 2, maxSkipSize);
+            } else
+                skipSize = blockSize;
+
+            updateProgress();
         }
     }
 
-    reportText = xi18ncp("@info:progress argument 2 is a string such as 7 bytes (localized accordingly)", "Copying 1 block (%2) finished.", "Copying %1 blocks (%2) finished.", blocksCopied, i18np("1 byte", "%1 bytes", bytesWritten));
-    Q_EMIT report(reportText);
+    // Second pass: go back to the skipped areas
+    pass = 2;
+    if (rval && map.bytes(RescueMap::Untried) > 0) {
+        Q_EMIT report(xi18nc("@info:progress", "Copying %1 skipped bytes.", map.bytes(RescueMap::Untried)));
+
+        const auto skippedRanges = map.ranges(RescueMap::Untried);
+        for (const auto& range : skippedRanges) {
+            const qint64 end = range.pos + range.size;
+            for (qint64 pos = range.pos; rval && pos < end; pos += blockSize) {
+                rval = copyChunk(pos, std::min(blockSize, end - pos), blockFailStatus) != ChunkResult::WriteError;
+                updateProgress();
+            }
+        }
+    }
+
+    // Third pass: split failed areas into smaller blocks, down to a single sector
+    phase = RescueMap::Trimming;
+    pass = 1;
+    qint64 chunkSize = blockSize;
+    while (rval && chunkSize > sectorSize && map.bytes(RescueMap::NonTrimmed) > 0) {
+        chunkSize = std::max(sectorSize, chunkSize / 2 / sectorSize * sectorSize);
+        const RescueMap::Status failStatus = chunkSize == sectorSize ? RescueMap::BadSector : RescueMap::NonTrimmed;
+
+        Q_EMIT report(xi18nc("@info:progress", "Retrying %1 unreadable bytes in blocks of %2 bytes.", map.bytes(RescueMap::NonTrimmed), chunkSize));
+
+        const auto failedRanges = map.ranges(RescueMap::NonTrimmed);
+        for (const auto& range : failedRanges) {
+            const qint64 end = range.pos + range.size;
+            for (qint64 pos = range.pos; rval && pos < end; pos += chunkSize) {
+                rval = copyChunk(pos, std::min(chunkSize, end - pos), failStatus) != ChunkResult::WriteError;
+                updateProgress();
+            }
+        }
+    }
+
+    // Areas GNU ddrescue trimmed but did not scrape yet are read sector by sector
+    phase = RescueMap::Scraping;
+    if (rval && map.bytes(RescueMap::NonScraped) > 0) {
+        Q_EMIT report(xi18nc("@info:progress", "Reading %1 unscraped bytes sector by sector.", map.bytes(RescueMap::NonScraped)));
+
+        const auto unscrapedRanges = map.ranges(RescueMap::NonScraped);
+        for (const auto& range : unscrapedRanges) {
+            const qint64 end = range.pos + range.size;
+            for (qint64 pos = range.pos; rval && pos < end; pos += sectorSize) {
+                rval = copyChunk(pos, std::min(sectorSize, end - pos), RescueMap::BadSector) != ChunkResult::WriteError;
+                updateProgress();
+            }
+        }
+    }
+
+    // Fourth pass: retry bad sectors, including those found in previous runs
+    phase = RescueMap::Retrying;
+    for (pass = 1; rval && pass <= retryPasses && map.bytes(RescueMap::BadSector) > 0; ++pass) {
+        Q_EMIT report(xi18nc("@info:progress", "Retry pass %1: retrying %2 bytes in bad sectors.", pass, map.bytes(RescueMap::BadSector)));
+
+        const auto badRanges = map.ranges(RescueMap::BadSector);
+        for (const auto& range : badRanges) {
+            const qint64 end = range.pos + range.size;
+            for (qint64 pos = range.pos; rval && pos < end; pos += sectorSize) {
+                rval = copyChunk(pos, std::min(sectorSize, end - pos), RescueMap::BadSector) != ChunkResult::WriteError;
+                updateProgress();
+            }
+        }
+    }
+
+    if (rval && fillBadSectors) {
+        const auto badRanges = map.ranges(RescueMap::BadSector);
+        for (const auto& range : badRanges) {
+            const qint64 end = range.pos + range.size;
+            for (qint64 pos = range.pos; rval && pos < end; pos += blockSize) {
+                const QByteArray zeros(static_cast<int>(std::min(blockSize, end - pos)), '\0');
+                rval = writeData(targetDevice, zeros, targetOffset + pos - sourceOffset);
+            }
+        }
+    }
 
+    if (rval)
+        map.setCurrent(sourceOffset + sourceLength, RescueMap::Done, 1);
+
+    const QByteArray newMap = map.save();
+    Q_EMIT rescueMapChanged(newMap);
+
+    Q_EMIT report(xi18nc("@info:progress", "Rescuing finished. Rescued: %1 bytes, bad: %2 bytes.", map.bytes(RescueMap::Finished), map.bytes(RescueMap::BadSector)));
+
+    QVariantMap reply;
     reply[QStringLiteral("success")] = rval;
+    reply[QStringLiteral("rescueMap")] = newMap;
+    reply[QStringLiteral("badBytes")] = map.bytes(RescueMap::BadSector);
+    return reply;
+}
+
+/** State shared between the reader and the writer threads of FanOutCopyBlocks() */
+struct FanOutState
+{
+    QMutex mutex;
+    QWaitCondition blockRead;
+    QWaitCondition blockWritten;
+
+    std::vector<QByteArray> ring;
+    qint64 blocksRead = 0;
+    bool readFailed = false;
+
+    std::vector<qint64> blocksWritten;
+    std::vector<bool> dropped;
+    std::vector<QElapsedTimer> lastWrite;
+};
+
+/** Copies blocks from one source to several targets, reading the source only once.
+
+    The source is read into a ring of buffers. Each target has its own writer thread that
+    consumes the ring at its own pace, so the copy runs at the speed of the slowest target.
+    A target that fails to write, or does not make any progress for a while, is dropped
+    and the remaining targets continue without it.
+
+    Several targets can be on the same device, e.g. partitions of one disk, as long as they do not overlap.
+
+    @param targetDevices the target devices or files
+    @param targetOffsets the offset to write to on the target device at the same index
+    @return reply with "success" (true if at least one target received all data) and the indexes of the "failedTargets"
+*/
+QVariantMap ExternalCommandHelper::FanOutCopyBlocks(const QString& sourceDevice, const qint64 sourceOffset, const qint64 sourceLength,
+                                                    const QStringList& targetDevices, const QVariantList& targetOffsets, const qint64 blockSize)
+{
+    if (!isCallerAuthorized()) {
+        return {};
+    }
+
+    m_ReadCache.clear();
+
+    // Avoid division by zero further down
+    if (!blockSize || targetDevices.isEmpty() || targetOffsets.size() != targetDevices.size()) {
+        return {};
+    }
+
+    // Prevent some out of memory situations
+    if (blockSize > 100 * MiB) {
+        return {};
+    }
+
+    auto overlaps = [sourceLength] (qint64 a, qint64 b) { return a < b + sourceLength && b < a + sourceLength; };
+
+    // Blocks are copied strictly from front to back, so no target may overlap with the source
+    // or with another target
+    for (int i = 0; i < targetDevices.size(); ++i) {
+        const qint64 targetOffset = targetOffsets[i].toLongLong();
+        if (targetDevices[i] == sourceDevice && overlaps(sourceOffset, targetOffset))
+            return {};
+
+        for (int j = 0; j < i; ++j)
+            if (targetDevices[j] == targetDevices[i] && overlaps(targetOffsets[j].toLongLong(), targetOffset))
+                return {};
+    }
+
+    // Number of buffers in the ring
+    constexpr int ringSize = 8;
+    // Targets that have not written anything for this long are dropped
+    constexpr qint64 stallTimeout = 60 * 1000;
+
+    const int targetCount = targetDevices.size();
+    const qint64 blocksToCopy = (sourceLength + blockSize - 1) / blockSize;
+
+    auto state = std::make_shared<FanOutState>();
+    state->ring.resize(ringSize);
+    state->blocksWritten.resize(targetCount, 0);
+    state->dropped.resize(targetCount, false);
+    state->lastWrite.resize(targetCount);
+
+    QFile source(sourceDevice);
+    if (!source.open(QIODevice::ReadOnly | QIODevice::Unbuffered)) {
+        qCritical() << xi18n("Could not open device <filename>%1</filename> for reading.", sourceDevice);
+        return {};
+    }
+
+    Q_EMIT report(xi18nc("@info:progress", "Copying %1 blocks (%2 bytes) from %3 to %4 targets.", blocksToCopy, sourceLength, sourceOffset, targetCount));
+
+    std::vector<QThread*> writers;
+    for (int i = 0; i < targetCount; ++i) {
+        const QString targetDevice = targetDevices[i];
+        const qint64 targetOffset = targetOffsets[i].toLongLong();
+        state->lastWrite[i].start();
+
+        writers.push_back(QThread::create([state, i, targetDevice, targetOffset, blockSize, blocksToCopy] () {
+            QFile device(targetDevice);
+            bool ok = device.open(QIODevice::WriteOnly | QIODevice::Unbuffered);
+
+            for (qint64 block = 0; ok && block < blocksToCopy; ++block) {
+                QByteArray buffer;
+                {
+                    QMutexLocker locker(&state->mutex);
+                    while (state->blocksRead <= block && !state->readFailed && !state->dropped[i])
+                        state->blockRead.wait(&state->mutex);
+
+                    if (state->dropped[i] || state->blocksRead <= block)
+                        return;
+
+                    buffer = state->ring[block % ringSize];
+                }
+
+                ok = device.seek(targetOffset + block * blockSize) && device.write(buffer) == buffer.size();
+
+                QMutexLocker locker(&state->mutex);
+                if (ok) {
+                    ++state->blocksWritten[i];
+                    state->lastWrite[i].restart();
+                }
+                state->blockWritten.wakeAll();
+            }
+
+            if (!ok) {
+                QMutexLocker locker(&state->mutex);
+                state->dropped[i] = true;
+                state->blockWritten.wakeAll();
+            }
+        }));
+        writers.back()->start();
+    }
+
+    std::vector<int> percents(targetCount, -1);
+    int percent = -1;
+    auto updateProgress = [&] () {
+        std::vector<qint64> written;
+        std::vector<bool> dropped;
+        {
+            QMutexLocker locker(&state->mutex);
+            written = state->blocksWritten;
+            dropped = state->dropped;
+        }
+
+        int slowest = 100;
+        for (int i = 0; i < targetCount; ++i) {
+            if (dropped[i])
+                continue;
+            const int p = blocksToCopy ? written[i] * 100 / blocksToCopy : 100;
+            slowest = std::min(slowest, p);
+            if (p != percents[i]) {
+                percents[i] = p;
+                Q_EMIT targetProgress(i, p);
+            }
+        }
+        if (slowest != percent) {
+            percent = slowest;
+            Q_EMIT progress(percent);
+        }
+    };
+
+    // Waits until all targets still in use have written the given number of blocks.
+    // Returns false if no target is left.
+    auto waitForWriters = [&] (qint64 blocks) {
+        QMutexLocker locker(&state->mutex);
+        while (true) {
+            bool active = false;
+            bool waiting = false;
+            for (int i = 0; i < targetCount; ++i) {
+                if (state->dropped[i] || state->blocksWritten[i] >= blocks) {
+                    active = active || !state->dropped[i];
+                    continue;
+                }
+                if (state->lastWrite[i].elapsed() > stallTimeout) {
+                    state->dropped[i] = true;
+                    state->blockRead.wakeAll();
+                    Q_EMIT report(xi18nc("@info:progress", "Dropping target <filename>%1</filename>: no progress for %2 seconds.", targetDevices[i], stallTimeout / 1000));
+                    continue;
+                }
+                active = true;
+                waiting = true;
+            }
+
+            if (!active)
+                return false;
+            if (!waiting)
+                return true;
+
+            state->blockWritten.wait(&state->mutex, 1000);
+            locker.unlock();
+            updateProgress();
+            locker.relock();
+        }
+    };
+
+    bool rval = true;
+    for (qint64 block = 0; rval && block < blocksToCopy; ++block) {
+        if (!(rval = waitForWriters(block - ringSize + 1)))
+            break;
+
+        const qint64 size = std::min(blockSize, sourceLength - block * blockSize);
+        QByteArray buffer;
+        if (source.seek(sourceOffset + block * blockSize))
+            buffer = source.read(size);
+
+        QMutexLocker locker(&state->mutex);
+        if (buffer.size() != size) {
+            qCritical() << xi18n("Could not read from device <filename>%1</filename>.", sourceDevice);
+            state->readFailed = true;
+            rval = false;
+        } else {
+            state->ring[block % ringSize] = buffer;
+            ++state->blocksRead;
+        }
+        state->blockRead.wakeAll();
+        locker.unlock();
+
+        updateProgress();
+    }
+
+    if (rval)
+        rval = waitForWriters(blocksToCopy);
+
+    QVariantList failedTargets;
+    QStringList failedNames;
+    for (int i = 0; i < targetCount; ++i) {
+        bool dropped;
+        {
+            QMutexLocker locker(&state->mutex);
+            dropped = state->dropped[i] || state->blocksWritten[i] < blocksToCopy;
+        }
+
+        // A dropped writer might still be stuck writing to a dead device, do not wait for it
+        if (dropped) {
+            failedTargets.append(i);
+            failedNames.append(targetDevices[i] + QLatin1Char('@') + QString::number(targetOffsets[i].toLongLong()));
+            connect(writers[i], &QThread::finished, writers[i], &QObject::deleteLater);
+            if (writers[i]->isFinished())
+                writers[i]->deleteLater();
+        } else {
+            writers[i]->wait();
+            delete writers[i];
+        }
+    }
+
+    updateProgress();
+
+    rval = rval && failedTargets.size() < targetCount;
+    if (failedTargets.isEmpty())
+        Q_EMIT report(xi18nc("@info:progress", "Copying to %1 targets finished.", targetCount));
+    else
+        Q_EMIT report(xi18nc("@info:progress", "Copying finished, failed targets: %1", failedNames.join(QStringLiteral(", "))));
+
+    QVariantMap reply;
+    reply[QStringLiteral("success")] = rval;
+    reply[QStringLiteral("failedTargets")] = failedTargets;
     return reply;
 }
 
@@ -284,6 +895,10 @@ QByteArray ExternalCommandHelper::ReadData(const QString& device, const qint64 o
     }
 
     QByteArray buffer;
+    if (m_ReadCacheEnabled && readCached(device, buffer, offset, length)) {
+        return buffer;
+    }
+
     bool rval = readData(device, buffer, offset, length);
     if (rval) {
         return buffer;
@@ -291,15 +906,74 @@ QByteArray ExternalCommandHelper::ReadData(const QString& device, const qint64 o
     return QByteArray();
 }
 
+/** Keeps data read by ReadData() in memory until the cache is disabled again.
+
+    Meant to be enabled while scanning, when the same superblocks and headers are probed many
+    times and nothing writes to the devices. Writes through the helper drop the cache.
+
+    @param enable true to start caching, false to stop and discard the cache
+*/
+void ExternalCommandHelper::EnableReadCache(const bool enable)
+{
+    if (!isCallerAuthorized()) {
+        return;
+    }
+
+    m_ReadCacheEnabled = enable;
+    m_ReadCache.clear();
+}
+
+/** Serves a read from the cache, reading missing parts in chunks.
+
+    The first read in the probe region at the start of a device fetches all of it at once,
+    that is where signatures, superblocks and headers live. Elsewhere, e.g. for backup
+    superblocks, only the chunks containing the data are read.
+
+    @return false if the data could not be read, e.g. because it reaches past the end of the device
+*/
+bool ExternalCommandHelper::readCached(const QString& device, QByteArray& buffer, const qint64 offset, const qint64 size)
+{
+    constexpr qint64 chunkSize = 64 * 1024;
+    constexpr qint64 probeSize = 1024 * 1024;
+
+    QMap<qint64, QByteArray>& chunks = m_ReadCache[device];
+    const qint64 firstChunk = offset / chunkSize;
+
+    QByteArray data;
+    for (qint64 chunk = firstChunk; chunk * chunkSize < offset + size; ++chunk) {
+        if (!chunks.contains(chunk)) {
+            const bool probe = chunk * chunkSize < probeSize;
+            const qint64 start = probe ? 0 : chunk * chunkSize;
+
+            QByteArray read;
+            if (!readData(device, read, start, probe ? probeSize : chunkSize))
+                return false;
+
+            for (qint64 i = 0; i < read.size() / chunkSize; ++i)
+                chunks.insert(start / chunkSize + i, read.mid(i * chunkSize, chunkSize));
+        }
+
+        data += chunks.value(chunk);
+    }
+
+    buffer = data.mid(offset - firstChunk * chunkSize, size);
+    return true;
+}
+
 bool ExternalCommandHelper::WriteData(const QByteArray& buffer, const QString& targetDevice, const qint64 targetOffset)
 {
     if (!isCallerAuthorized()) {
         return false;
     }
-    // Do not allow using this helper for writing to arbitrary location
-    if ( targetDevice.left(5) != QStringLiteral("/dev/") )
+    // Do not allow using this helper for writing to arbitrary location,
+    // apart from devices only a few tunables of RAID arrays may be written
+    static const QRegularExpression mdTunable(QStringLiteral("^/sys/block/md\\d+/md/(stripe_cache_size|sync_action|sync_speed_min|sync_speed_max)$"));
+    if ( targetDevice.left(5) != QStringLiteral("/dev/") && !mdTunable.match(targetDevice).hasMatch() )
         return false;
 
+    // A partition and its disk are different device nodes for the same data
+    m_ReadCache.clear();
+
     return writeData(targetDevice, buffer, targetOffset);
 }
 
@@ -325,22 +999,222 @@ QVariantMap ExternalCommandHelper::RunCommand(const QString& command, const QStr
         return reply;
     }
 
+    // lvm commands without input go to the lvm shell, saving the start up of lvm for each of them
+    if (basename == QStringLiteral("lvm") && input.isEmpty() && processChannelMode == QProcess::MergedChannels) {
+        if (!m_LvmShell)
+            m_LvmShell = std::make_unique<LvmShell>();
+
+        QByteArray output;
+        int exitCode;
+        if (m_LvmShell->run(command, arguments, output, exitCode)) {
+            reply[QStringLiteral("output")] = output;
+            reply[QStringLiteral("exitCode")] = exitCode;
+            return reply;
+        }
+    }
+
 //  connect(&cmd, &QProcess::readyReadStandardOutput, this, &ExternalCommandHelper::onReadOutput);
 
+    // Reply once the command has finished, so that commands of jobs running concurrently
+    // in the application do not have to wait for each other here
+    setDelayedReply(true);
+    const QDBusMessage request = message();
+    const QDBusConnection bus = connection();
+
+    auto *cmd = new QProcess(this);
+    cmd->setEnvironment( { QStringLiteral("LVM_SUPPRESS_FD_WARNINGS=1") } );
+    cmd->setProcessChannelMode(static_cast<QProcess::ProcessChannelMode>(processChannelMode));
+
+    auto sendReply = [cmd, request, bus, reply] () mutable {
+        reply[QStringLiteral("output")] = cmd->readAllStandardOutput();
+        reply[QStringLiteral("exitCode")] = cmd->exitCode();
+        bus.send(request.createReply(reply));
+        cmd->deleteLater();
+    };
+
+    connect(cmd, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), this, sendReply);
+    connect(cmd, &QProcess::errorOccurred, this, [cmd, sendReply] (QProcess::ProcessError error) mutable {
+        if (error == QProcess::FailedToStart) {
+            cmd->disconnect();
+            sendReply();
+        }
+    });
+
+    cmd->start(command, arguments);
+    cmd->write(input);
+    cmd->closeWriteChannel();
+
+    return reply;
+}
+
+/** Runs a command that reports its progress as JSON lines.
+ *
+ * Lines like the ones printed by cryptsetup --progress-json are turned into progress
+ * signals while the command is running, everything else is returned like in RunCommand().
+ *
+ * @param command the command to run
+ * @param arguments the arguments
+ * @param input the standard input
+ * @return a map with success, output and exitCode
+ */
+QVariantMap ExternalCommandHelper::RunCommandWithProgress(const QString& command, const QStringList& arguments, const QByteArray& input)
+{
+    if (!isCallerAuthorized()) {
+        return {};
+    }
+    QVariantMap reply;
+    reply[QStringLiteral("success")] = false;
+
+    QString basename = command.mid(command.lastIndexOf(QLatin1Char('/')) + 1);
+    if (allowedCommands.find(basename) == allowedCommands.end()) {
+        qInfo() << command <<" command is not one of the whitelisted command";
+        return reply;
+    }
+
     QProcess cmd;
     cmd.setEnvironment( { QStringLiteral("LVM_SUPPRESS_FD_WARNINGS=1") } );
-    cmd.setProcessChannelMode(static_cast<QProcess::ProcessChannelMode>(processChannelMode));
+    cmd.setProcessChannelMode(QProcess::MergedChannels);
     cmd.start(command, arguments);
     cmd.write(input);
     cmd.closeWriteChannel();
-    cmd.waitForFinished(-1);
-    QByteArray output = cmd.readAllStandardOutput();
+
+    QByteArray output;
+    QByteArray pending;
+    int lastPercent = -1;
+
+    // cryptsetup prints JSON objects, btrfs-convert redraws "[done/total]" lines ending in \r
+    static const QRegularExpression counterRe(QStringLiteral("\\[\\s*(\\d+)\\s*/\\s*(\\d+)\\s*\\]"));
+
+    auto parseProgress = [] (const QByteArray& line) -> int {
+        const QJsonObject progress = QJsonDocument::fromJson(line.trimmed()).object();
+        const qint64 size = progress.value(QStringLiteral("device_size")).toVariant().toLongLong();
+        if (size > 0) {
+            const qint64 done = progress.value(progress.contains(QStringLiteral("device_bytes")) ? QStringLiteral("device_bytes") : QStringLiteral("bytes")).toVariant().toLongLong();
+            return static_cast<int>(done * 100 / size);
+        }
+
+        const QRegularExpressionMatch match = counterRe.match(QString::fromLocal8Bit(line));
+        const qint64 total = match.hasMatch() ? match.captured(2).toLongLong() : 0;
+        if (total > 0)
+            return static_cast<int>(match.captured(1).toLongLong() * 100 / total);
+
+        return -1;
+    };
+
+    auto readLines = [&] {
+        pending += cmd.readAll();
+
+        while (true) {
+            const int newline = pending.indexOf('\n');
+            const int carriageReturn = pending.indexOf('\r');
+            const int end = (newline < 0 || (carriageReturn >= 0 && carriageReturn < newline)) ? carriageReturn : newline;
+            if (end < 0)
+                break;
+
+            const QByteArray line = pending.left(end + 1);
+            pending.remove(0, end + 1);
+
+            const int percent = parseProgress(line);
+            if (percent < 0) {
+                output += line;
+                continue;
+            }
+
+            if (percent != lastPercent) {
+                lastPercent = percent;
+                Q_EMIT progress(percent);
+            }
+        }
+    };
+
+    while (!cmd.waitForFinished(250) && cmd.state() != QProcess::NotRunning)
+        readLines();
+    readLines();
+    output += pending;
+
+    reply[QStringLiteral("success")] = cmd.exitStatus() == QProcess::NormalExit && cmd.error() != QProcess::FailedToStart;
     reply[QStringLiteral("output")] = output;
     reply[QStringLiteral("exitCode")] = cmd.exitCode();
 
     return reply;
 }
 
+/** Runs several commands at the same time.
+ *
+ * At most maxParallel commands run at once, the next one starts as soon as one finishes.
+ * This is meant for commands that spend their time in the CPU rather than on I/O, like
+ * unlocking several encrypted devices with a memory hard key derivation.
+ *
+ * @param commands the commands to run
+ * @param arguments a list of arguments for each command
+ * @param inputs the standard input for each command
+ * @param maxParallel the maximum number of commands running at once
+ * @return one map per command with success, output and exitCode like RunCommand()
+ */
+QVariantList ExternalCommandHelper::RunCommands(const QStringList& commands, const QVariantList& arguments, const QVariantList& inputs, const int maxParallel)
+{
+    QVariantList replies;
+
+    if (!isCallerAuthorized() || arguments.size() != commands.size() || inputs.size() != commands.size())
+        return replies;
+
+    QTextCodec::setCodecForLocale(QTextCodec::codecForName("UTF-8"));
+
+    for (int i = 0; i < commands.size(); ++i)
+        replies.append(QVariantMap{ { QStringLiteral("success"), false } });
+
+    std::vector<std::unique_ptr<QProcess>> processes(commands.size());
+    QEventLoop loop;
+    int next = 0;
+    int running = 0;
+
+    std::function<void()> startNext = [&] {
+        while (next < commands.size() && running < std::max(1, maxParallel)) {
+            const int i = next++;
+
+            const QString basename = commands[i].mid(commands[i].lastIndexOf(QLatin1Char('/')) + 1);
+            if (allowedCommands.find(basename) == allowedCommands.end()) {
+                qInfo() << commands[i] <<" command is not one of the whitelisted command";
+                continue;
+            }
+
+            processes[i] = std::make_unique<QProcess>();
+            QProcess* cmd = processes[i].get();
+            cmd->setEnvironment( { QStringLiteral("LVM_SUPPRESS_FD_WARNINGS=1") } );
+            cmd->setProcessChannelMode(QProcess::MergedChannels);
+
+            auto done = [&, i, cmd] (bool success) {
+                replies[i] = QVariantMap{ { QStringLiteral("success"), success },
+                                          { QStringLiteral("output"), cmd->readAllStandardOutput() },
+                                          { QStringLiteral("exitCode"), cmd->exitCode() } };
+                --running;
+                startNext();
+
+                if (running == 0)
+                    loop.quit();
+            };
+
+            connect(cmd, qOverload<int, QProcess::ExitStatus>(&QProcess::finished), &loop, [done] { done(true); });
+            connect(cmd, &QProcess::errorOccurred, &loop, [done] (QProcess::ProcessError error) {
+                if (error == QProcess::FailedToStart)
+                    done(false);
+            });
+
+            ++running;
+            cmd->start(commands[i], qdbus_cast<QStringList>(arguments[i]));
+            cmd->write(qdbus_cast<QByteArray>(inputs[i]));
+            cmd->closeWriteChannel();
+        }
+    };
+
+    startNext();
+
+    if (running > 0)
+        loop.exec();
+
+    return replies;
+}
+
 void ExternalCommandHelper::onReadOutput()
 {
 /*    const QByteArray s = cmd.readAllStandardOutput();
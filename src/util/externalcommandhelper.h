@@ -15,10 +15,13 @@
 #include <unordered_set>
 
 #include <QEventLoop>
+#include <QHash>
+#include <QMap>
 #include <QString>
 #include <QProcess>
 #include <QDBusContext>
 
+class LvmShell;
 class QDBusServiceWatcher;
 constexpr qint64 MiB = 1 << 30;
 
@@ -30,6 +33,8 @@ class ExternalCommandHelper : public QObject, public QDBusContext
 Q_SIGNALS:
     Q_SCRIPTABLE void progress(int);
     Q_SCRIPTABLE void report(QString);
+    Q_SCRIPTABLE void rescueMapChanged(QByteArray);
+    Q_SCRIPTABLE void targetProgress(int, int);
 
 public:
     ExternalCommandHelper();
@@ -38,17 +43,33 @@ public:
 
 public Q_SLOTS:
     Q_SCRIPTABLE QVariantMap RunCommand(const QString& command, const QStringList& arguments, const QByteArray& input, const int processChannelMode);
+    Q_SCRIPTABLE QVariantMap RunCommandWithProgress(const QString& command, const QStringList& arguments, const QByteArray& input);
+    Q_SCRIPTABLE QVariantList RunCommands(const QStringList& commands, const QVariantList& arguments, const QVariantList& inputs, const int maxParallel);
     Q_SCRIPTABLE QVariantMap CopyBlocks(const QString& sourceDevice, const qint64 sourceOffset, const qint64 sourceLength,
                                         const QString& targetDevice, const qint64 targetOffset, const qint64 blockSize);
+    Q_SCRIPTABLE QVariantMap RescueBlocks(const QString& sourceDevice, const qint64 sourceOffset, const qint64 sourceLength,
+                                          const QString& targetDevice, const qint64 targetOffset, const qint64 blockSize,
+                                          const qint64 sectorSize, const QByteArray& rescueMap, const int retryPasses, const bool fillBadSectors);
+    Q_SCRIPTABLE QVariantMap FanOutCopyBlocks(const QString& sourceDevice, const qint64 sourceOffset, const qint64 sourceLength,
+                                              const QStringList& targetDevices, const QVariantList& targetOffsets, const qint64 blockSize);
     Q_SCRIPTABLE QByteArray ReadData(const QString& device, const qint64 offset, const qint64 length);
+    Q_SCRIPTABLE void EnableReadCache(const bool enable);
     Q_SCRIPTABLE bool WriteData(const QByteArray& buffer, const QString& targetDevice, const qint64 targetOffset);
     Q_SCRIPTABLE bool CreateFile(const QString& filePath, const QByteArray& fileContents);
+    Q_SCRIPTABLE bool CreateStateDirectory(const QString& path);
+    Q_SCRIPTABLE bool RemoveStateFile(const QString& path);
 
 private:
     bool isCallerAuthorized();
+    bool readCached(const QString& device, QByteArray& buffer, const qint64 offset, const qint64 size);
 
     void onReadOutput();
     QDBusServiceWatcher *m_serviceWatcher = nullptr;
+
+    bool m_ReadCacheEnabled = false;
+    QHash<QString, QMap<qint64, QByteArray>> m_ReadCache;
+
+    std::unique_ptr<LvmShell> m_LvmShell;
 };
 
 #endif
@@ -0,0 +1,302 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "lvmshell.h"
+
+#include <QDebug>
+#include <QDeadlineTimer>
+#include <QProcess>
+#include <QProcessEnvironment>
+
+#include <fcntl.h>
+#include <unistd.h>
+
+// lvm prints this before reading the next command
+static const QByteArray prompt = QByteArrayLiteral("lvm> ");
+
+// Only the status of each command is reported, as a single row "status <return code>"
+static const QString reportConfig = QStringLiteral("log{report_command_log=1 command_log_selection=\"log_type=status\" command_log_cols=\"log_type,log_ret_code\"}");
+
+// Options that change the layout of the command log row, commands using them run in a separate process
+static const QStringList unframedOptions = { QStringLiteral("--reportformat"), QStringLiteral("--nameprefixes"),
+                                             QStringLiteral("--rows"), QStringLiteral("--config") };
+
+// Commands that may run for a long time, they run in a separate process
+static const QStringList longCommands = { QStringLiteral("pvmove"), QStringLiteral("lvconvert") };
+
+// Resizing commands take long as well when they resize the file system with -r or --resizefs
+static const QStringList resizeCommands = { QStringLiteral("lvextend"), QStringLiteral("lvreduce"), QStringLiteral("lvresize") };
+
+// lvm asks questions with this at the end
+static const QByteArray question = QByteArrayLiteral("[y/n]: ");
+
+// The shell is shut down after this many milliseconds without commands
+constexpr int idleTimeout = 60 * 1000;
+
+// The shell is given up if it does not print its first prompt or finish a command in time
+constexpr int startTimeout = 30 * 1000;
+constexpr int commandTimeout = 10 * 60 * 1000;
+
+namespace
+{
+/** QProcess that lets the child inherit the write end of the report pipe */
+class ReportFdProcess : public QProcess
+{
+public:
+    explicit ReportFdProcess(int reportFd) : m_ReportFd(reportFd) {}
+
+protected:
+    void setupChildProcess() override {
+        ::fcntl(m_ReportFd, F_SETFD, 0);
+    }
+
+private:
+    int m_ReportFd;
+};
+}
+
+LvmShell::LvmShell(QObject* parent) :
+    QObject(parent)
+{
+    m_IdleTimer.setSingleShot(true);
+    m_IdleTimer.setInterval(idleTimeout);
+    connect(&m_IdleTimer, &QTimer::timeout, this, &LvmShell::stop);
+}
+
+LvmShell::~LvmShell()
+{
+    stop();
+}
+
+/** Runs an lvm command in the shell.
+    @param command the path of the lvm binary
+    @param arguments the lvm command and its arguments, e.g. vgs and its options
+    @param output the output of the command, standard output and error merged
+    @param exitCode the exit code lvm would have returned
+    @return false if the command is not run in the shell or could not be sent to it, it
+            has not been run then
+*/
+bool LvmShell::run(const QString& command, const QStringList& arguments, QByteArray& output, int& exitCode)
+{
+    if (arguments.isEmpty() || longCommands.contains(arguments.first()))
+        return false;
+
+    if (resizeCommands.contains(arguments.first()) && (arguments.contains(QStringLiteral("-r")) || arguments.contains(QStringLiteral("--resizefs"))))
+        return false;
+
+    for (const auto &option : unframedOptions)
+        if (arguments.contains(option))
+            return false;
+
+    QByteArray line;
+    for (const auto &argument : arguments) {
+        QByteArray quoted;
+        if (!quote(argument, quoted))
+            return false;
+        line += quoted + ' ';
+
+        if (&argument == &arguments.first()) {
+            quote(reportConfig, quoted);
+            line += "--config " + quoted + ' ';
+        }
+    }
+    line += '\n';
+
+    if (m_Process && m_Command != command)
+        stop();
+
+    if (!m_Process && !start(command))
+        return false;
+
+    m_IdleTimer.stop();
+    m_Report.clear();
+
+    if (m_Process->write(line) != line.size()) {
+        stop();
+        return false;
+    }
+
+    // From here on the command may have been run, it must not be retried
+    if (!readResponse(output, commandTimeout)) {
+        qWarning() << "lvm shell stopped while running" << arguments;
+        stop();
+        exitCode = -1;
+        return true;
+    }
+
+    exitCode = takeExitCode(m_Report, arguments);
+    output += m_Report;
+    m_IdleTimer.start();
+
+    return true;
+}
+
+bool LvmShell::start(const QString& command)
+{
+    int fds[2];
+    if (::pipe2(fds, O_CLOEXEC) != 0)
+        return false;
+
+    ::fcntl(fds[0], F_SETFL, O_NONBLOCK);
+
+    // Keep the environment of the helper, lvm needs PATH to run its tools
+    QProcessEnvironment environment = QProcessEnvironment::systemEnvironment();
+    environment.insert(QStringLiteral("LC_ALL"), QStringLiteral("C"));
+    environment.insert(QStringLiteral("LVM_SUPPRESS_FD_WARNINGS"), QStringLiteral("1"));
+    environment.insert(QStringLiteral("LVM_REPORT_FD"), QString::number(fds[1]));
+
+    m_ReportFd = fds[0];
+    m_Command = command;
+    m_Process = std::make_unique<ReportFdProcess>(fds[1]);
+    m_Process->setProcessEnvironment(environment);
+    m_Process->setProcessChannelMode(QProcess::MergedChannels);
+    m_Process->start(command, QStringList());
+
+    const bool started = m_Process->waitForStarted();
+    ::close(fds[1]);
+
+    QByteArray banner;
+    if (!started || !readResponse(banner, startTimeout)) {
+        stop();
+        return false;
+    }
+
+    return true;
+}
+
+void LvmShell::stop()
+{
+    m_IdleTimer.stop();
+
+    if (m_Process) {
+        if (m_Process->state() == QProcess::Running) {
+            m_Process->write("exit\n");
+            m_Process->closeWriteChannel();
+            if (!m_Process->waitForFinished(5000))
+                m_Process->kill();
+        }
+        m_Process->waitForFinished();
+        m_Process.reset();
+    }
+
+    if (m_ReportFd != -1) {
+        ::close(m_ReportFd);
+        m_ReportFd = -1;
+    }
+
+    m_Command.clear();
+}
+
+/** Reads everything up to the next prompt.
+
+    The report pipe is drained meanwhile, lvm would block on a full pipe before it
+    printed the prompt otherwise. Questions are answered with no.
+
+    @param output the output up to the prompt
+    @param timeout milliseconds to wait for the prompt
+    @return false if the shell stopped or did not print the prompt in time
+*/
+bool LvmShell::readResponse(QByteArray& output, int timeout)
+{
+    const QDeadlineTimer deadline(timeout);
+    output.clear();
+
+    while (!output.endsWith(prompt)) {
+        if (deadline.hasExpired())
+            return false;
+
+        readReport();
+        if (m_Process->bytesAvailable() == 0 && !m_Process->waitForReadyRead(20)) {
+            if (m_Process->state() != QProcess::Running)
+                return false;
+            continue;
+        }
+        output += m_Process->readAll();
+
+        if (output.endsWith(question)) {
+            m_Process->write("n\n");
+            output += "n\n";
+        }
+    }
+
+    readReport();
+    output.chop(prompt.size());
+    return true;
+}
+
+/** Appends what is waiting in the report pipe to the report of the current command. */
+void LvmShell::readReport()
+{
+    char buffer[4096];
+    ssize_t size;
+    while ((size = ::read(m_ReportFd, buffer, sizeof(buffer))) > 0)
+        m_Report.append(buffer, size);
+}
+
+/** Takes the command log out of the report of a command.
+
+    The command log is the last report lvm prints. Its row is "status", the separator
+    given in @p arguments and the return code, preceded by a heading unless the command
+    was run with --noheadings.
+
+    @param report the reports of the command, the command log is removed from them
+    @param arguments the arguments of the command, they set the layout of its reports
+    @return the exit code of the command
+*/
+int LvmShell::takeExitCode(QByteArray& report, const QStringList& arguments)
+{
+    const int separatorIndex = arguments.indexOf(QStringLiteral("--separator"));
+    const QByteArray separator = separatorIndex >= 0 && separatorIndex + 1 < arguments.size() ? arguments[separatorIndex + 1].toLocal8Bit() : QByteArray();
+    const bool headings = !arguments.contains(QStringLiteral("--noheadings"));
+
+    QList<QByteArray> lines = report.split('\n');
+    while (!lines.isEmpty() && lines.last().trimmed().isEmpty())
+        lines.removeLast();
+
+    // ECMD_FAILED, lvm did not get as far as reporting a status
+    int exitCode = 5;
+
+    if (!lines.isEmpty()) {
+        const QByteArray row = lines.last().trimmed();
+        const QList<QByteArray> fields = separator.trimmed().isEmpty() ? row.simplified().split(' ') : QByteArray(row).replace(separator, "\x1f").split('\x1f');
+
+        bool ok = false;
+        int returnCode = 0;
+        if (fields.size() == 2 && fields[0].trimmed() == "status")
+            returnCode = fields[1].trimmed().toInt(&ok);
+
+        if (ok) {
+            lines.removeLast();
+            if (headings && !lines.isEmpty())
+                lines.removeLast();
+
+            // ECMD_PROCESSED, lvm exits with 0 then and with the return code otherwise
+            exitCode = returnCode == 1 ? 0 : returnCode;
+        }
+    }
+
+    report = lines.isEmpty() ? QByteArray() : lines.join('\n') + '\n';
+    return exitCode;
+}
+
+/** Quotes an argument the way the lvm shell splits its input.
+    @return false if the argument cannot be quoted, because it contains both kinds of quotes
+*/
+bool LvmShell::quote(const QString& argument, QByteArray& quoted)
+{
+    const QByteArray arg = argument.toLocal8Bit();
+
+    if (!arg.isEmpty() && !arg.contains(' ') && !arg.contains('\t') && !arg.contains('"') && !arg.contains('\'') && !arg.startsWith('#'))
+        quoted = arg;
+    else if (!arg.contains('\''))
+        quoted = '\'' + arg + '\'';
+    else if (!arg.contains('"'))
+        quoted = '"' + arg + '"';
+    else
+        return false;
+
+    return !arg.contains('\n');
+}
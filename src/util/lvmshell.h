@@ -0,0 +1,62 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_LVMSHELL_H
+#define KPMCORE_LVMSHELL_H
+
+#include <QByteArray>
+#include <QObject>
+#include <QStringList>
+#include <QTimer>
+
+#include <memory>
+
+class QProcess;
+
+/** A long-lived lvm shell session.
+
+    Starting lvm for every command reads the configuration and scans all block devices
+    for labels again, which gets slow with many devices. The helper keeps one lvm shell
+    running instead and feeds commands to it.
+
+    The messages of a command are everything printed until the next prompt. Reports,
+    like the ones of vgs, lvs and pvs, go to a separate pipe given in LVM_REPORT_FD,
+    together with a command log report that holds the exit status of the command. The
+    command log is taken out of the reports again and the rest is appended to the
+    messages, so the output looks like the one of a separate lvm process.
+    The shell is started on demand, restarted after errors and shut down when idle.
+
+    The shell's standard input stays open, so questions lvm asks are answered with no,
+    like a separate lvm process without input would. Commands that take long, like
+    pvmove, are left to separate processes, so they do not hold up the helper.
+*/
+class LvmShell : public QObject
+{
+public:
+    explicit LvmShell(QObject* parent = nullptr);
+    ~LvmShell() override;
+
+public:
+    bool run(const QString& command, const QStringList& arguments, QByteArray& output, int& exitCode);
+
+    static bool quote(const QString& argument, QByteArray& quoted);
+    static int takeExitCode(QByteArray& report, const QStringList& arguments);
+
+private:
+    bool start(const QString& command);
+    void stop();
+    bool readResponse(QByteArray& output, int timeout);
+    void readReport();
+
+private:
+    std::unique_ptr<QProcess> m_Process;
+    QString m_Command;
+    int m_ReportFd = -1;
+    QByteArray m_Report;
+    QTimer m_IdleTimer;
+};
+
+#endif
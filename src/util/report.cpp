@@ -46,6 +46,24 @@ Report* Report::newChild(const QString& cmd)
     return r;
 }
 
+/** Moves the children of another Report to the end of this Report's list of children.
+
+    Reports are not thread safe. Code running in another thread writes to a Report of its own
+    instead, which is then merged into the main Report with this method.
+
+    @param other the Report to take the children from
+*/
+void Report::takeChildren(Report& other)
+{
+    for (const auto &child : std::as_const(other.m_Children)) {
+        child->m_Parent = this;
+        m_Children.append(child);
+    }
+
+    other.m_Children.clear();
+    root()->emitOutputChanged();
+}
+
 /**
     @return the Report converted to HTML
     @see toText()
@@ -43,6 +43,7 @@ Q_SIGNALS:
 
 public:
     Report* newChild(const QString& cmd = QString());
+    void takeChildren(Report& other);
 
     const QList<Report*>& children() const {
         return m_Children;    /**< @return the list of this Report's children */
@@ -0,0 +1,190 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#include "util/rescuemap.h"
+
+#include <utility>
+
+#include <QList>
+#include <QString>
+
+/** Creates a new RescueMap where everything is untried.
+    @param pos first byte covered by the map
+    @param size number of bytes covered by the map
+*/
+RescueMap::RescueMap(qint64 pos, qint64 size) :
+    m_Pos(pos),
+    m_Size(size),
+    m_CurrentPos(pos),
+    m_CurrentPhase(Copying),
+    m_CurrentPass(1)
+{
+    if (size > 0)
+        m_Ranges.append({ pos, size, Untried });
+}
+
+/** Applies the entries of a saved map on top of this map.
+
+    Entries outside of the area covered by this map are clipped, unknown lines are ignored.
+    Areas not mentioned in the saved map keep their current status.
+
+    The status line is optional, older maps written by KPMcore do not have one.
+
+    @param data the text representation of a map as returned by save() or written by GNU ddrescue
+*/
+void RescueMap::load(const QByteArray& data)
+{
+    bool firstLine = true;
+
+    const QList<QByteArray> lines = data.split('\n');
+    for (const QByteArray& rawLine : lines) {
+        const QByteArray line = rawLine.simplified();
+        if (line.isEmpty() || line.startsWith('#'))
+            continue;
+
+        const QList<QByteArray> fields = line.split(' ');
+
+        // The status line is the first one and has a phase character where ranges have their size
+        if (firstLine && fields.size() >= 2 && fields.size() <= 3 && fields[1].size() == 1) {
+            firstLine = false;
+
+            bool okPos = false;
+            const qint64 pos = fields[0].toLongLong(&okPos, 0);
+            const char c = fields[1].at(0);
+            const qint32 pass = fields.size() == 3 ? fields[2].toInt() : 1;
+
+            if (okPos && QByteArrayLiteral("?*/-FG+").contains(c))
+                setCurrent(pos, static_cast<Phase>(c), pass);
+            continue;
+        }
+        firstLine = false;
+
+        if (fields.size() < 3 || fields[2].size() != 1)
+            continue;
+
+        bool okPos = false;
+        bool okSize = false;
+        const qint64 pos = fields[0].toLongLong(&okPos, 0);
+        const qint64 size = fields[1].toLongLong(&okSize, 0);
+        if (!okPos || !okSize)
+            continue;
+
+        const char c = fields[2].at(0);
+        if (c != Untried && c != NonTrimmed && c != NonScraped && c != BadSector && c != Finished)
+            continue;
+
+        const qint64 first = qMax(pos, m_Pos);
+        const qint64 last = qMin(pos + size, m_Pos + m_Size);
+        if (first < last)
+            mark(first, last - first, static_cast<Status>(c));
+    }
+}
+
+/** @return the text representation of this map */
+QByteArray RescueMap::save() const
+{
+    QByteArray result("# Mapfile. Created by KPMcore.\n# current_pos  current_status  current_pass\n");
+
+    result += QStringLiteral("0x%1     %2               %3\n#      pos        size  status\n")
+              .arg(m_CurrentPos, 8, 16, QLatin1Char('0'))
+              .arg(QLatin1Char(static_cast<char>(m_CurrentPhase)))
+              .arg(m_CurrentPass).toLatin1();
+
+    for (const Range& r : m_Ranges) {
+        result += QStringLiteral("0x%1  0x%2  %3\n")
+                  .arg(r.pos, 8, 16, QLatin1Char('0'))
+                  .arg(r.size, 8, 16, QLatin1Char('0'))
+                  .arg(QLatin1Char(static_cast<char>(r.status))).toLatin1();
+    }
+
+    return result;
+}
+
+/** Sets the status of a range of bytes.
+    @param pos first byte of the range
+    @param size number of bytes in the range
+    @param status the new status
+*/
+void RescueMap::mark(qint64 pos, qint64 size, Status status)
+{
+    if (size <= 0)
+        return;
+
+    const qint64 end = pos + size;
+    QVector<Range> result;
+    result.reserve(m_Ranges.size() + 2);
+
+    auto append = [&result] (qint64 p, qint64 s, Status st) {
+        if (s <= 0)
+            return;
+        if (!result.isEmpty() && result.last().status == st && result.last().pos + result.last().size == p)
+            result.last().size += s;
+        else
+            result.append({ p, s, st });
+    };
+
+    bool inserted = false;
+    for (const Range& r : std::as_const(m_Ranges)) {
+        const qint64 rEnd = r.pos + r.size;
+
+        if (rEnd <= pos || r.pos >= end) {
+            if (!inserted && r.pos >= end) {
+                append(pos, size, status);
+                inserted = true;
+            }
+            append(r.pos, r.size, r.status);
+            continue;
+        }
+
+        // part of r before the new range
+        append(r.pos, pos - r.pos, r.status);
+        if (!inserted) {
+            append(pos, size, status);
+            inserted = true;
+        }
+        // part of r after the new range
+        append(end, rEnd - end, r.status);
+    }
+
+    if (!inserted)
+        append(pos, size, status);
+
+    m_Ranges = result;
+}
+
+/** Records where the rescue is.
+    @param pos the position being read
+    @param phase what the rescue is doing
+    @param pass the pass of that phase, starting at 1
+*/
+void RescueMap::setCurrent(qint64 pos, Phase phase, qint32 pass)
+{
+    m_CurrentPos = pos;
+    m_CurrentPhase = phase;
+    m_CurrentPass = qMax(1, pass);
+}
+
+/** @return all ranges with the given status in ascending order */
+QVector<RescueMap::Range> RescueMap::ranges(Status status) const
+{
+    QVector<Range> result;
+    for (const Range& r : m_Ranges)
+        if (r.status == status)
+            result.append(r);
+
+    return result;
+}
+
+/** @return the number of bytes with the given status */
+qint64 RescueMap::bytes(Status status) const
+{
+    qint64 result = 0;
+    for (const Range& r : m_Ranges)
+        if (r.status == status)
+            result += r.size;
+
+    return result;
+}
@@ -0,0 +1,94 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+#ifndef KPMCORE_RESCUEMAP_H
+#define KPMCORE_RESCUEMAP_H
+
+#include <QByteArray>
+#include <QVector>
+#include <QtGlobal>
+
+/** Map of rescued and unreadable areas of a copy source.
+
+    Used by the helper when copying from a failing device in rescue mode. The map
+    covers the whole source area and records for each byte range whether it has not
+    been tried yet, failed to read as part of a larger block, was found to contain
+    bad sectors or has been rescued.
+
+    The text representation is compatible with GNU ddrescue map files: a status line with
+    the current position, the current phase and pass is followed by one line per range
+    with the position, the size (both in hexadecimal) and a status character. Positions
+    are byte offsets on the source device.
+*/
+class RescueMap
+{
+public:
+    /** Status of a range of bytes */
+    enum Status : char {
+        Untried = '?',      /**< Not read yet */
+        NonTrimmed = '*',   /**< Read failed as part of a larger block, retry with smaller blocks */
+        NonScraped = '/',   /**< Edges of a failed block were read, retry the rest sector by sector */
+        BadSector = '-',    /**< Read failed even at sector size */
+        Finished = '+'      /**< Successfully read and written to the target */
+    };
+
+    /** What the rescue was doing when the map was saved */
+    enum Phase : char {
+        Copying = '?',
+        Trimming = '*',
+        Scraping = '/',
+        Retrying = '-',
+        Filling = 'F',
+        Generating = 'G',
+        Done = '+'
+    };
+
+    struct Range {
+        qint64 pos;
+        qint64 size;
+        Status status;
+    };
+
+public:
+    RescueMap(qint64 pos, qint64 size);
+
+public:
+    void load(const QByteArray& data);
+    QByteArray save() const;
+
+    void mark(qint64 pos, qint64 size, Status status);
+    void setCurrent(qint64 pos, Phase phase, qint32 pass);
+
+    QVector<Range> ranges(Status status) const;
+    qint64 bytes(Status status) const;
+
+    qint64 pos() const {
+        return m_Pos;    /**< @return first byte covered by this map */
+    }
+    qint64 size() const {
+        return m_Size;    /**< @return number of bytes covered by this map */
+    }
+
+    qint64 currentPos() const {
+        return m_CurrentPos;    /**< @return the position the rescue was at */
+    }
+    Phase currentPhase() const {
+        return m_CurrentPhase;    /**< @return the phase the rescue was in */
+    }
+    qint32 currentPass() const {
+        return m_CurrentPass;    /**< @return the pass of the current phase, starting at 1 */
+    }
+
+private:
+    qint64 m_Pos;
+    qint64 m_Size;
+    QVector<Range> m_Ranges;
+    qint64 m_CurrentPos;
+    Phase m_CurrentPhase;
+    qint32 m_CurrentPass;
+};
+
+#endif
@@ -0,0 +1,178 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+// Writes GPT and MBR partition tables to temporary image files and reads them back
+
+#include "plugins/image/imagelayout.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QFile>
+#include <QTemporaryDir>
+
+constexpr qint64 sectorSize = 512;
+constexpr qint64 imageSize = 64 * 1024 * 1024;
+
+/** @return the path of a new, empty image file in @p dir */
+static QString makeImage(const QTemporaryDir& dir, const QString& name)
+{
+    const QString path = dir.filePath(name);
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly) || !file.resize(imageSize))
+        return QString();
+
+    return path;
+}
+
+static bool sameEntries(const QVector<ImageLayoutEntry>& a, const QVector<ImageLayoutEntry>& b)
+{
+    if (a.size() != b.size())
+        return false;
+
+    for (qint32 i = 0; i < a.size(); i++) {
+        if (a[i].number != b[i].number || a[i].firstSector != b[i].firstSector || a[i].lastSector != b[i].lastSector ||
+                a[i].type != b[i].type || a[i].uuid != b[i].uuid || a[i].label != b[i].label ||
+                a[i].attributes != b[i].attributes || a[i].bootable != b[i].bootable)
+            return false;
+    }
+
+    return true;
+}
+
+static bool testGpt(const QTemporaryDir& dir)
+{
+    const QString path = makeImage(dir, QStringLiteral("gpt.img"));
+
+    ImageLayout layout(path, sectorSize);
+    layout.create(PartitionTable::TableType::gpt);
+
+    ImageLayoutEntry esp;
+    esp.number = 1;
+    esp.firstSector = 2048;
+    esp.lastSector = 67583;
+    esp.type = QStringLiteral("C12A7328-F81F-11D2-BA4B-00A0C93EC93B");
+    esp.uuid = QStringLiteral("0B6F1C37-5E63-4D2B-9A5F-3F0E2F1F7A01");
+    esp.label = QStringLiteral("EFI system");
+
+    ImageLayoutEntry root;
+    root.number = 3;
+    root.firstSector = 67584;
+    root.lastSector = 129023;
+    root.type = QStringLiteral("0FC63DAF-8483-4772-8E79-3D69D8477DE4");
+    root.uuid = QStringLiteral("6D2A8E90-1C4B-4F6E-8D3A-7B9C0E5F2A02");
+    root.label = QStringLiteral("root");
+    root.attributes = 0x8000000000000001;
+
+    layout.entries() = { esp, root };
+    if (!layout.write()) {
+        qWarning() << "gpt: could not write the table";
+        return false;
+    }
+
+    ImageLayout read(path, sectorSize);
+    if (!read.read() || read.type() != PartitionTable::TableType::gpt || !sameEntries(read.entries(), layout.entries()) ||
+            read.firstUsable() != 34 || read.lastUsable() != imageSize / sectorSize - 34 || read.maxEntries() != 128 ||
+            read.freeNumber() != 2) {
+        qWarning() << "gpt: the table read back differs from the one written";
+        return false;
+    }
+
+    // A damaged primary header is replaced by the backup at the end of the image
+    ImageLayout damaged(path, sectorSize);
+    if (!damaged.wipe(sectorSize, sectorSize) || !damaged.read() || damaged.type() != PartitionTable::TableType::gpt ||
+            !sameEntries(damaged.entries(), layout.entries())) {
+        qWarning() << "gpt: the backup header was not used";
+        return false;
+    }
+
+    return true;
+}
+
+static bool testMbr(const QTemporaryDir& dir)
+{
+    const QString path = makeImage(dir, QStringLiteral("mbr.img"));
+
+    // An MBR written over a GPT must not be taken for a GPT any more
+    ImageLayout gpt(path, sectorSize);
+    gpt.create(PartitionTable::TableType::gpt);
+    if (!gpt.write()) {
+        qWarning() << "mbr: could not write the old GPT";
+        return false;
+    }
+
+    ImageLayout layout(path, sectorSize);
+    layout.create(PartitionTable::TableType::msdos);
+
+    ImageLayoutEntry boot;
+    boot.number = 1;
+    boot.firstSector = 2048;
+    boot.lastSector = 67583;
+    boot.type = QStringLiteral("c");
+    boot.bootable = true;
+
+    ImageLayoutEntry data;
+    data.number = 2;
+    data.firstSector = 67584;
+    data.lastSector = 131071;
+    data.type = QStringLiteral("83");
+
+    layout.entries() = { boot, data };
+    if (!layout.write()) {
+        qWarning() << "mbr: could not write the table";
+        return false;
+    }
+
+    ImageLayout read(path, sectorSize);
+    if (!read.read() || read.type() != PartitionTable::TableType::msdos || !sameEntries(read.entries(), layout.entries()) ||
+            read.maxEntries() != 4 || read.freeNumber() != 3) {
+        qWarning() << "mbr: the table read back differs from the one written";
+        return false;
+    }
+
+    // Logical partitions are not supported and must not be lost by writing the table back
+    ImageLayoutEntry extended;
+    extended.number = 3;
+    extended.firstSector = 2048;
+    extended.lastSector = 131071;
+    extended.type = QStringLiteral("5");
+
+    layout.entries() = { extended };
+    ImageLayout withExtended(path, sectorSize);
+    if (!layout.write() || withExtended.read() || !withExtended.hasExtended()) {
+        qWarning() << "mbr: a table with an extended partition was not rejected";
+        return false;
+    }
+
+    return true;
+}
+
+static bool testEmpty(const QTemporaryDir& dir)
+{
+    ImageLayout layout(makeImage(dir, QStringLiteral("empty.img")), sectorSize);
+
+    if (!layout.read() || layout.type() != PartitionTable::TableType::none || !layout.entries().isEmpty()) {
+        qWarning() << "empty: an image without a table was not read as one";
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    QTemporaryDir dir;
+    if (!dir.isValid())
+        return EXIT_FAILURE;
+
+    bool rval = testGpt(dir);
+    rval = testMbr(dir) && rval;
+    rval = testEmpty(dir) && rval;
+
+    return rval ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,104 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+// Checks how the helper's lvm shell quotes arguments and reads exit codes from command logs
+
+#include "util/lvmshell.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QList>
+
+static bool testQuote()
+{
+    struct Case
+    {
+        QString argument;
+        bool quotable;
+        QByteArray quoted;
+    };
+
+    const QList<Case> cases = {
+        { QStringLiteral("vg0"), true, "vg0" },
+        { QStringLiteral("/dev/sda1"), true, "/dev/sda1" },
+        { QString(), true, "''" },
+        { QStringLiteral("two words"), true, "'two words'" },
+        { QStringLiteral("tab\tseparated"), true, "'tab\tseparated'" },
+        { QStringLiteral("#comment"), true, "'#comment'" },
+        { QStringLiteral("log{type=\"status\"}"), true, "'log{type=\"status\"}'" },
+        { QStringLiteral("it's"), true, "\"it's\"" },
+        { QStringLiteral("both ' and \""), false, QByteArray() },
+        { QStringLiteral("new\nline"), false, QByteArray() },
+    };
+
+    bool rval = true;
+
+    for (const auto &c : cases) {
+        QByteArray quoted;
+        const bool quotable = LvmShell::quote(c.argument, quoted);
+
+        if (quotable != c.quotable || (quotable && quoted != c.quoted)) {
+            qWarning() << "quote(" << c.argument << ") returned" << quotable << quoted;
+            rval = false;
+        }
+    }
+
+    return rval;
+}
+
+static bool testTakeExitCode()
+{
+    struct Case
+    {
+        QStringList arguments;
+        QByteArray report;
+        int exitCode;
+        QByteArray rest;
+        const char* what;
+    };
+
+    const QList<Case> cases = {
+        { { QStringLiteral("vgs") },
+          "  VG  #PV\n  vg0   1\n  LogType LogReturnCode\n  status              1\n",
+          0, "  VG  #PV\n  vg0   1\n", "report with headings" },
+        { { QStringLiteral("vgs"), QStringLiteral("--noheadings"), QStringLiteral("--separator"), QStringLiteral("|") },
+          "vg0|1\nstatus|5\n",
+          5, "vg0|1\n", "failed command with separator" },
+        { { QStringLiteral("lvremove"), QStringLiteral("--noheadings") },
+          "  status 1\n\n",
+          0, QByteArray(), "command log only" },
+        { { QStringLiteral("vgchange") },
+          QByteArray(),
+          5, QByteArray(), "no command log" },
+        { { QStringLiteral("pvs"), QStringLiteral("--noheadings") },
+          "  /dev/sda1 vg0\n",
+          5, "  /dev/sda1 vg0\n", "report without command log" },
+    };
+
+    bool rval = true;
+
+    for (const auto &c : cases) {
+        QByteArray report = c.report;
+        const int exitCode = LvmShell::takeExitCode(report, c.arguments);
+
+        if (exitCode != c.exitCode || report != c.rest) {
+            qWarning() << c.what << ": takeExitCode() returned" << exitCode << "and left" << report;
+            rval = false;
+        }
+    }
+
+    return rval;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    bool rval = testQuote();
+    rval = testTakeExitCode() && rval;
+
+    return rval ? EXIT_SUCCESS : EXIT_FAILURE;
+}
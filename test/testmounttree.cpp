@@ -0,0 +1,166 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+// Arranges partitions by their mount points and checks the order and the skipping of
+// dependent partitions. Nothing is actually mounted, so no root is needed.
+
+#include "core/diskdevice.h"
+#include "core/mounttree.h"
+#include "core/partition.h"
+#include "core/partitiontable.h"
+#include "fs/filesystemfactory.h"
+#include "util/report.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QList>
+#include <QStringList>
+
+#include <memory>
+
+static const QString deviceNode = QStringLiteral("/dev/kpmmounttree");
+
+struct MountSpec
+{
+    QString mountPoint;
+    bool mounted;
+};
+
+/** @return a disk with one small partition of unknown file system for each spec */
+static Device* makeDevice(const QList<MountSpec>& specs)
+{
+    Device* d = new DiskDevice(QStringLiteral("Mount tree test disk"), deviceNode, 1, 2048, 1024, 512);
+    PartitionTable* table = new PartitionTable(PartitionTable::TableType::gpt, 2048, d->totalLogical() - 34);
+    d->setPartitionTable(table);
+
+    qint64 first = 2048;
+    for (const auto &spec : specs) {
+        FileSystem* fs = FileSystemFactory::create(FileSystem::Type::Unknown, first, first + 2047, d->logicalSize());
+        table->append(new Partition(table, *d, PartitionRole(PartitionRole::Primary), fs, first, first + 2047,
+                                    deviceNode + QString::number(table->children().size() + 1), PartitionTable::Flag::None,
+                                    spec.mountPoint, spec.mounted));
+        first += 2048;
+    }
+
+    return d;
+}
+
+/** @return true if a line of @p text contains all of @p parts */
+static bool hasLine(const QString& text, const QStringList& parts)
+{
+    const QStringList lines = text.split(QLatin1Char('\n'));
+    for (const auto &line : lines) {
+        bool all = true;
+        for (const auto &part : parts)
+            all = all && line.contains(part);
+        if (all)
+            return true;
+    }
+
+    return false;
+}
+
+static QList<Partition*> partitions(Device& d)
+{
+    QList<Partition*> result;
+    for (const auto &p : d.partitionTable()->children())
+        result.append(p);
+
+    return result;
+}
+
+static bool testParents()
+{
+    const std::unique_ptr<Device> d(makeDevice({
+        { QStringLiteral("/mnt/kpm/boot/efi"), false },
+        { QStringLiteral("/mnt/kpm"), false },
+        { QStringLiteral("/mnt/kpm/home/user"), false },
+        { QStringLiteral("/mnt/kpm/home"), false },
+        { QStringLiteral("/mnt/kpm/boot"), false },
+        { QStringLiteral("/mnt/kpmx"), false },
+        { QString(), false },
+        { QStringLiteral("/"), false },
+    }));
+
+    const MountTree tree(partitions(*d));
+    const QList<qint32> expected = { 4, 7, 3, 1, 1, 7, -1, -1 };
+
+    bool rval = true;
+    for (qint32 i = 0; i < expected.size(); i++) {
+        if (tree.parent(i) != expected[i] || tree.duplicate(i) != -1) {
+            qWarning() << "parents:" << partitions(*d)[i]->mountPoint() << "has parent" << tree.parent(i) << "instead of" << expected[i];
+            rval = false;
+        }
+    }
+
+    return rval;
+}
+
+static bool testSkip()
+{
+    // Partitions of unknown file systems cannot be mounted, so /mnt/kpm fails and takes its children down
+    const std::unique_ptr<Device> d(makeDevice({
+        { QStringLiteral("/mnt/kpm/home/user"), false },
+        { QStringLiteral("/mnt/kpm"), false },
+        { QStringLiteral("/mnt/kpm/home"), false },
+        { QStringLiteral("/srv"), true },
+    }));
+    const QList<Partition*> parts = partitions(*d);
+
+    MountTree tree(parts);
+    Report report(nullptr);
+    if (tree.mount(report)) {
+        qWarning() << "skip: mounting succeeded although /mnt/kpm cannot be mounted";
+        return false;
+    }
+
+    const QString text = report.toText();
+    if (!hasLine(text, { QStringLiteral("Mounting"), parts[1]->deviceNode(), QStringLiteral("failed") }) ||
+            !hasLine(text, { QStringLiteral("Skipped mounting"), parts[0]->deviceNode() }) ||
+            !hasLine(text, { QStringLiteral("Skipped mounting"), parts[2]->deviceNode() }) ||
+            text.contains(parts[3]->deviceNode()) || !parts[3]->isMounted() || parts[0]->isMounted()) {
+        qWarning() << "skip: unexpected report" << text;
+        return false;
+    }
+
+    return true;
+}
+
+static bool testDuplicates()
+{
+    const std::unique_ptr<Device> d(makeDevice({
+        { QStringLiteral("/srv"), true },
+        { QStringLiteral("/srv/data"), true },
+        { QStringLiteral("/srv/"), true },
+        { QStringLiteral("/srv/data/../data"), true },
+    }));
+    const QList<Partition*> parts = partitions(*d);
+
+    MountTree tree(parts);
+    if (tree.duplicate(0) != -1 || tree.duplicate(1) != -1 || tree.duplicate(2) != 0 || tree.duplicate(3) != 1) {
+        qWarning() << "duplicates: not detected" << tree.duplicate(2) << tree.duplicate(3);
+        return false;
+    }
+
+    Report report(nullptr);
+    if (tree.mount(report) || !report.toText().contains(QStringLiteral("same mount point"))) {
+        qWarning() << "duplicates: not reported" << report.toText();
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    bool rval = testParents();
+    rval = testSkip() && rval;
+    rval = testDuplicates() && rval;
+
+    return rval ? EXIT_SUCCESS : EXIT_FAILURE;
+}
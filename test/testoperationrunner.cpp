@@ -0,0 +1,197 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+// Checks which Operations the OperationRunner lets run at the same time and the order it runs them in
+
+#include "helpers.h"
+
+#include "core/diskdevice.h"
+#include "core/operationrunner.h"
+#include "core/operationstack.h"
+#include "core/partition.h"
+#include "core/partitiontable.h"
+#include "fs/filesystemfactory.h"
+#include "ops/operation.h"
+#include "util/report.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMutex>
+#include <QStringList>
+#include <QThread>
+
+#include <memory>
+
+/** An Operation that only records when it runs */
+class RecordingOperation : public Operation
+{
+public:
+    RecordingOperation(const QString& name, const QList<const Partition*>& partitions, QStringList& log, QMutex& mutex) :
+        m_Name(name), m_Partitions(partitions), m_Log(log), m_Mutex(mutex) {}
+
+    QString iconName() const override {
+        return QString();
+    }
+    QString description() const override {
+        return m_Name;
+    }
+    void preview() override {}
+    void undo() override {}
+    bool targets(const Device&) const override {
+        return false;
+    }
+    bool targets(const Partition&) const override {
+        return false;
+    }
+    QList<const Partition*> concurrentPartitions() const override {
+        return m_Partitions;
+    }
+
+    bool execute(Report&) override {
+        record(QStringLiteral("start "));
+        QThread::msleep(100);
+        record(QStringLiteral("finish "));
+        return true;
+    }
+
+private:
+    void record(const QString& what) {
+        QMutexLocker locker(&m_Mutex);
+        m_Log.append(what + m_Name);
+    }
+
+    QString m_Name;
+    QList<const Partition*> m_Partitions;
+    QStringList& m_Log;
+    QMutex& m_Mutex;
+};
+
+/** @return a 1 GiB GPT disk with two partitions */
+static Device* makeDevice(const QString& deviceNode)
+{
+    Device* d = new DiskDevice(deviceNode, deviceNode, 1, 2048, 1024, 512);
+    PartitionTable* table = new PartitionTable(PartitionTable::TableType::gpt, 2048, d->totalLogical() - 34);
+    d->setPartitionTable(table);
+
+    table->append(new Partition(table, *d, PartitionRole(PartitionRole::Primary), FileSystemFactory::create(FileSystem::Type::Ext4, 2048, 206847, 512),
+                                2048, 206847, deviceNode + QStringLiteral("1")));
+    table->append(new Partition(table, *d, PartitionRole(PartitionRole::Primary), FileSystemFactory::create(FileSystem::Type::Ext4, 206848, 411647, 512),
+                                206848, 411647, deviceNode + QStringLiteral("2")));
+    table->updateUnallocated(*d);
+
+    return d;
+}
+
+static const Partition* partition(const Device& d, qint32 index)
+{
+    return d.partitionTable()->children()[index];
+}
+
+static bool testConflicts(const Device& a, const Device& b)
+{
+    struct Case
+    {
+        QList<const Partition*> first;
+        QList<const Partition*> second;
+        bool rotational;
+        bool conflicts;
+        const char* what;
+    };
+
+    const QList<Case> cases = {
+        { { partition(a, 0) }, { partition(a, 0) }, false, true, "same partition" },
+        { { partition(a, 0) }, { partition(a, 1) }, false, false, "other partition on a solid state device" },
+        { { partition(a, 0) }, { partition(a, 1) }, true, true, "other partition on a rotational device" },
+        { { partition(a, 0) }, { partition(b, 0) }, true, false, "partitions on different devices" },
+        { { partition(a, 0), partition(b, 0) }, { partition(b, 0) }, false, true, "one of several partitions shared" },
+        { {}, { partition(a, 0) }, true, false, "no partitions" },
+    };
+
+    bool rval = true;
+
+    for (const auto &c : cases) {
+        QHash<QString, bool> rotational = { { a.deviceNode(), c.rotational }, { b.deviceNode(), c.rotational } };
+        if (OperationRunner::conflicts(c.first, c.second, rotational) != c.conflicts ||
+                OperationRunner::conflicts(c.second, c.first, rotational) != c.conflicts) {
+            qWarning() << c.what << ": conflicts() did not return" << c.conflicts;
+            rval = false;
+        }
+    }
+
+    return rval;
+}
+
+static bool testScheduling(Device& a, Device& b)
+{
+    QStringList log;
+    QMutex mutex;
+
+    // The fake devices are not found in sysfs and taken for rotational ones, so only
+    // Operations on different devices may overlap
+    OperationStack stack;
+    stack.push(new RecordingOperation(QStringLiteral("a1"), { partition(a, 0) }, log, mutex));
+    stack.push(new RecordingOperation(QStringLiteral("b1"), { partition(b, 0) }, log, mutex));
+    stack.push(new RecordingOperation(QStringLiteral("a2"), { partition(a, 1) }, log, mutex));
+    stack.push(new RecordingOperation(QStringLiteral("alone"), {}, log, mutex));
+    stack.push(new RecordingOperation(QStringLiteral("b2"), { partition(b, 1) }, log, mutex));
+
+    Report report(nullptr);
+    OperationRunner runner(nullptr, stack);
+    runner.setReport(&report);
+
+    QList<int> started;
+    QObject::connect(&runner, &OperationRunner::opStarted, [&started] (int index, Operation*) { started.append(index); });
+
+    runner.run();
+
+    auto at = [&log] (const QString& entry) { return log.indexOf(entry); };
+
+    struct Order
+    {
+        QString before;
+        QString after;
+    };
+
+    const QList<Order> orders = {
+        { QStringLiteral("start b1"), QStringLiteral("finish a1") },
+        { QStringLiteral("finish a1"), QStringLiteral("start a2") },
+        { QStringLiteral("finish a2"), QStringLiteral("start alone") },
+        { QStringLiteral("finish b1"), QStringLiteral("start alone") },
+        { QStringLiteral("finish alone"), QStringLiteral("start b2") },
+    };
+
+    bool rval = log.size() == 10 && started == QList<int>({ 1, 2, 3, 4, 5 });
+
+    for (const auto &o : orders)
+        rval = rval && at(o.before) >= 0 && at(o.before) < at(o.after);
+
+    if (!rval)
+        qWarning() << "unexpected order of Operations:" << log << "started:" << started;
+
+    return rval;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    std::unique_ptr<KPMCoreInitializer> i;
+
+    if (argc == 2)
+        i = std::make_unique<KPMCoreInitializer>(argv[1]);
+    else
+        i = std::make_unique<KPMCoreInitializer>();
+
+    if (!i->isValid())
+        return EXIT_FAILURE;
+
+    const std::unique_ptr<Device> a(makeDevice(QStringLiteral("/dev/kpmrunnera")));
+    const std::unique_ptr<Device> b(makeDevice(QStringLiteral("/dev/kpmrunnerb")));
+
+    bool rval = testConflicts(*a, *b);
+    rval = testScheduling(*a, *b) && rval;
+
+    return rval ? EXIT_SUCCESS : EXIT_FAILURE;
+}
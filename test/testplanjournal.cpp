@@ -0,0 +1,200 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+// Validates plan journals against hand-built devices, as if a run had been interrupted
+// before or after each kind of Operation
+
+#include "helpers.h"
+
+#include "core/diskdevice.h"
+#include "core/operationstack.h"
+#include "core/partition.h"
+#include "core/partitiontable.h"
+#include "core/planjournal.h"
+#include "fs/filesystemfactory.h"
+#include "ops/createfilesystemoperation.h"
+#include "ops/deleteoperation.h"
+#include "ops/newoperation.h"
+#include "ops/resizeoperation.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QList>
+#include <QTemporaryDir>
+
+#include <functional>
+#include <memory>
+
+struct PartitionSpec
+{
+    qint64 first;
+    qint64 last;
+    FileSystem::Type type;
+    QString uuid;
+};
+
+using Layout = QList<PartitionSpec>;
+
+static const QString deviceNode = QStringLiteral("/dev/kpmjournal");
+
+/** @return a 1 GiB GPT disk with the given partitions */
+static Device* makeDevice(const Layout& layout)
+{
+    Device* d = new DiskDevice(QStringLiteral("Journal test disk"), deviceNode, 1, 2048, 1024, 512);
+    PartitionTable* table = new PartitionTable(PartitionTable::TableType::gpt, 2048, d->totalLogical() - 34);
+    d->setPartitionTable(table);
+
+    qint32 number = 1;
+    for (const auto &spec : layout) {
+        FileSystem* fs = FileSystemFactory::create(spec.type, spec.first, spec.last, d->logicalSize(), -1, QString(), {}, spec.uuid);
+        table->append(new Partition(table, *d, PartitionRole(PartitionRole::Primary), fs, spec.first, spec.last,
+                                    deviceNode + QString::number(number++)));
+    }
+    table->updateUnallocated(*d);
+
+    return d;
+}
+
+static Partition* findPartition(Device& d, qint64 first)
+{
+    for (const auto &p : d.partitionTable()->children())
+        if (p->firstSector() == first)
+            return p;
+
+    return nullptr;
+}
+
+/** Validates the journal at @p path with the Operation's status set to @p status against @p layout */
+static bool validate(const QString& path, PlanJournal::Status status, const Layout& layout, PlanJournal::Status& result)
+{
+    PlanJournal journal(path);
+    if (!journal.load() || journal.entries().size() != 1 || !journal.setStatus(0, status))
+        return false;
+
+    const std::unique_ptr<Device> d(makeDevice(layout));
+    const bool valid = journal.validate({ d.get() });
+    result = journal.entries().first().status;
+
+    return valid;
+}
+
+/** Journals the Operation made by @p makeOp on a disk laid out like @p before and checks
+    the journal against the disk as it is before, after and halfway through. @p makeOp fills
+    in the layout after the Operation and one it could have left behind when interrupted.
+*/
+static bool testOperation(const QString& name, const Layout& before, const std::function<Operation*(Device&, Layout&, Layout&)>& makeOp)
+{
+    QTemporaryDir dir;
+    const QString path = dir.filePath(name + QStringLiteral(".json"));
+
+    Layout after;
+    Layout broken;
+    {
+        OperationStack stack;
+        Device* d = makeDevice(before);
+        stack.previewDevices().append(d);
+        stack.push(makeOp(*d, after, broken));
+
+        // Like the OperationRunner, the journal wants the Operations undone
+        stack.operations().first()->undo();
+
+        PlanJournal journal(path);
+        const bool written = journal.begin(stack);
+
+        // The OperationStack undoes its Operations when it goes away
+        stack.operations().first()->preview();
+
+        if (!written) {
+            qWarning() << name << ": could not write the journal";
+            return false;
+        }
+    }
+
+    struct Case
+    {
+        PlanJournal::Status status;
+        const Layout& layout;
+        bool valid;
+        PlanJournal::Status result;
+        const char* what;
+    };
+
+    const QList<Case> cases = {
+        { PlanJournal::Status::Running, before, true, PlanJournal::Status::Pending, "interrupted before it changed anything" },
+        { PlanJournal::Status::Running, after, true, PlanJournal::Status::Done, "interrupted after it was done" },
+        { PlanJournal::Status::Running, broken, false, PlanJournal::Status::Running, "interrupted halfway" },
+        { PlanJournal::Status::Done, after, true, PlanJournal::Status::Done, "done" },
+        { PlanJournal::Status::Done, before, false, PlanJournal::Status::Done, "done, but not found" },
+        { PlanJournal::Status::Pending, before, true, PlanJournal::Status::Pending, "not started" },
+        { PlanJournal::Status::Pending, after, false, PlanJournal::Status::Pending, "not started, but changed" },
+    };
+
+    bool rval = true;
+
+    for (const auto &c : cases) {
+        PlanJournal::Status result;
+        const bool valid = validate(path, c.status, c.layout, result);
+
+        if (valid != c.valid || (valid && result != c.result)) {
+            qWarning() << name << ":" << c.what << ": validation returned" << valid << "with status" << static_cast<int>(result);
+            rval = false;
+        }
+    }
+
+    return rval;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+    std::unique_ptr<KPMCoreInitializer> i;
+
+    if (argc == 2)
+        i = std::make_unique<KPMCoreInitializer>(argv[1]);
+    else
+        i = std::make_unique<KPMCoreInitializer>();
+
+    if (!i->isValid())
+        return EXIT_FAILURE;
+
+    const PartitionSpec first = { 2048, 206847, FileSystem::Type::Ext4, QStringLiteral("0b6f1c37-5e63-4d2b-9a5f-3f0e2f1f7a01") };
+    const PartitionSpec second = { 206848, 411647, FileSystem::Type::Ext4, QStringLiteral("6d2a8e90-1c4b-4f6e-8d3a-7b9c0e5f2a02") };
+
+    bool rval = true;
+
+    rval = testOperation(QStringLiteral("new"), { first }, [first] (Device& d, Layout& after, Layout& broken) {
+        Partition* unallocated = nullptr;
+        for (const auto &p : d.partitionTable()->children())
+            if (p->roles().has(PartitionRole::Unallocated))
+                unallocated = p;
+
+        // The partition was created, but the file system was not
+        Partition* p = NewOperation::createNew(*unallocated, FileSystem::Type::Ext4);
+        after = { first, { p->firstSector(), p->lastSector(), FileSystem::Type::Ext4, QString() } };
+        broken = { first, { p->firstSector(), p->lastSector(), FileSystem::Type::Unknown, QString() } };
+        return new NewOperation(d, p);
+    }) && rval;
+
+    rval = testOperation(QStringLiteral("delete"), { first, second }, [first, second] (Device& d, Layout& after, Layout& broken) {
+        after = { first };
+        broken = { first, { second.first, second.last, FileSystem::Type::Xfs, QString() } };
+        return new DeleteOperation(d, findPartition(d, second.first));
+    }) && rval;
+
+    rval = testOperation(QStringLiteral("resize"), { first }, [first] (Device& d, Layout& after, Layout& broken) {
+        after = { { first.first, 411647, first.type, first.uuid } };
+        broken = { { first.first, 309247, first.type, first.uuid } };
+        return new ResizeOperation(d, *findPartition(d, first.first), first.first, 411647);
+    }) && rval;
+
+    rval = testOperation(QStringLiteral("format"), { first }, [first] (Device& d, Layout& after, Layout& broken) {
+        after = { { first.first, first.last, FileSystem::Type::Btrfs, QString() } };
+        broken = { { first.first, first.last, FileSystem::Type::Xfs, QString() } };
+        return new CreateFileSystemOperation(d, *findPartition(d, first.first), FileSystem::Type::Btrfs);
+    }) && rval;
+
+    return rval ? EXIT_SUCCESS : EXIT_FAILURE;
+}
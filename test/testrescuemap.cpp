@@ -0,0 +1,150 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+// Reads a GNU ddrescue mapfile into a RescueMap and writes it back
+
+#include "util/rescuemap.h"
+
+#include <QCoreApplication>
+#include <QDebug>
+
+// Written by GNU ddrescue 1.27 while copying non-tried blocks of a 2 MiB source
+static const QByteArray ddrescueMap(
+    "# Mapfile. Created by GNU ddrescue version 1.27\n"
+    "# Command line: ddrescue -d /dev/sdb disk.img disk.map\n"
+    "# Start time:   2026-03-02 10:00:00\n"
+    "# Current time: 2026-03-02 10:05:12\n"
+    "# Copying non-tried blocks... Pass 1 (forwards)\n"
+    "# current_pos  current_status  current_pass\n"
+    "0x00120000     ?               1\n"
+    "#      pos        size  status\n"
+    "0x00000000  0x00100000  +\n"
+    "0x00100000  0x00010000  *\n"
+    "0x00110000  0x00001000  -\n"
+    "0x00111000  0x0000F000  /\n"
+    "0x00120000  0x000E0000  ?\n");
+
+constexpr qint64 mapSize = 0x200000;
+
+static bool sameRanges(const RescueMap& a, const RescueMap& b)
+{
+    for (const auto status : { RescueMap::Untried, RescueMap::NonTrimmed, RescueMap::NonScraped, RescueMap::BadSector, RescueMap::Finished }) {
+        const QVector<RescueMap::Range> ra = a.ranges(status);
+        const QVector<RescueMap::Range> rb = b.ranges(status);
+        if (ra.size() != rb.size())
+            return false;
+
+        for (qint32 i = 0; i < ra.size(); i++)
+            if (ra[i].pos != rb[i].pos || ra[i].size != rb[i].size)
+                return false;
+    }
+
+    return true;
+}
+
+static bool testLoad()
+{
+    RescueMap map(0, mapSize);
+    map.load(ddrescueMap);
+
+    if (map.currentPos() != 0x120000 || map.currentPhase() != RescueMap::Copying || map.currentPass() != 1) {
+        qWarning() << "load: wrong status line" << map.currentPos() << map.currentPhase() << map.currentPass();
+        return false;
+    }
+
+    if (map.bytes(RescueMap::Finished) != 0x100000 || map.bytes(RescueMap::NonTrimmed) != 0x10000 ||
+            map.bytes(RescueMap::BadSector) != 0x1000 || map.bytes(RescueMap::NonScraped) != 0xF000 ||
+            map.bytes(RescueMap::Untried) != 0xE0000) {
+        qWarning() << "load: wrong number of bytes per status";
+        return false;
+    }
+
+    const QVector<RescueMap::Range> bad = map.ranges(RescueMap::BadSector);
+    if (bad.size() != 1 || bad.first().pos != 0x110000 || bad.first().size != 0x1000) {
+        qWarning() << "load: wrong bad sector range";
+        return false;
+    }
+
+    return true;
+}
+
+static bool testRoundTrip()
+{
+    RescueMap map(0, mapSize);
+    map.load(ddrescueMap);
+    map.setCurrent(0x111000, RescueMap::Scraping, 2);
+
+    RescueMap read(0, mapSize);
+    read.load(map.save());
+
+    if (!sameRanges(map, read) || read.currentPos() != 0x111000 || read.currentPhase() != RescueMap::Scraping || read.currentPass() != 2) {
+        qWarning() << "round trip: the map read back differs from the one saved" << map.save();
+        return false;
+    }
+
+    return true;
+}
+
+static bool testClip()
+{
+    // Only the area of one partition of the source is rescued
+    RescueMap map(0x100000, 0x20000);
+    map.load(ddrescueMap);
+
+    if (map.bytes(RescueMap::Finished) != 0 || map.bytes(RescueMap::NonTrimmed) != 0x10000 ||
+            map.bytes(RescueMap::BadSector) != 0x1000 || map.bytes(RescueMap::NonScraped) != 0xF000 ||
+            map.bytes(RescueMap::Untried) != 0) {
+        qWarning() << "clip: entries outside of the map were not clipped" << map.save();
+        return false;
+    }
+
+    return true;
+}
+
+static bool testMark()
+{
+    RescueMap map(0, mapSize);
+    map.mark(0, 0x1000, RescueMap::Finished);
+    map.mark(0x2000, 0x1000, RescueMap::Finished);
+    map.mark(0x1000, 0x1000, RescueMap::Finished);
+
+    const QVector<RescueMap::Range> finished = map.ranges(RescueMap::Finished);
+    if (finished.size() != 1 || finished.first().pos != 0 || finished.first().size != 0x3000 ||
+            map.bytes(RescueMap::Untried) != mapSize - 0x3000) {
+        qWarning() << "mark: adjacent ranges were not merged" << map.save();
+        return false;
+    }
+
+    return true;
+}
+
+static bool testWithoutStatusLine()
+{
+    // Maps saved by older versions of KPMcore have no status line
+    RescueMap map(0, mapSize);
+    map.load("0x00000000  0x00001000  +\n0x00001000  0x001FF000  -\n");
+
+    if (map.currentPos() != 0 || map.currentPhase() != RescueMap::Copying || map.currentPass() != 1 ||
+            map.bytes(RescueMap::Finished) != 0x1000 || map.bytes(RescueMap::BadSector) != mapSize - 0x1000) {
+        qWarning() << "old map: not read correctly" << map.save();
+        return false;
+    }
+
+    return true;
+}
+
+int main(int argc, char **argv)
+{
+    QCoreApplication app(argc, argv);
+
+    bool rval = testLoad();
+    rval = testRoundTrip() && rval;
+    rval = testClip() && rval;
+    rval = testMark() && rval;
+    rval = testWithoutStatusLine() && rval;
+
+    return rval ? EXIT_SUCCESS : EXIT_FAILURE;
+}
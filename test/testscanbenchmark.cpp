@@ -0,0 +1,467 @@
+/*
+    SPDX-FileCopyrightText: 2026 KPMcore contributors
+
+    SPDX-License-Identifier: GPL-3.0-or-later
+*/
+
+// Benchmarks scanning devices with real tools on a farm of loop devices.
+//
+// Needs root to set up the loop devices. The farm is made of sparse files, so it takes
+// almost no space. Run with --help for the size of the farm and the number of scans.
+// ctest only runs it when configured with -DKPMCORE_SCAN_BENCHMARK=ON.
+
+#include "helpers.h"
+
+#include "backend/corebackend.h"
+#include "backend/corebackendmanager.h"
+#include "core/devicescanner.h"
+#include "core/operationstack.h"
+#include "util/externalcommand.h"
+
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QProcess>
+#include <QStandardPaths>
+#include <QTemporaryDir>
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include <unistd.h>
+
+// ctest reports tests exiting with this code as skipped
+constexpr int skipReturnCode = 77;
+
+constexpr qint64 partitionSize = 320; // MiB, mkfs.xfs refuses anything smaller than 300 MiB
+constexpr qint64 logicalVolumeSize = 8; // MiB
+
+static const QString volumeGroup = QStringLiteral("kpmbenchvg");
+static const QString mdArray = QStringLiteral("/dev/md/kpmbench");
+static const QString luksName = QStringLiteral("kpmbenchluks");
+
+struct FileSystemTool
+{
+    QString name;
+    QString mkfs;
+    QStringList args;
+};
+
+// One of each file system kpmcore can create with tools that work on a loop device
+static const std::vector<FileSystemTool> fileSystemTools = {
+    { QStringLiteral("ext2"), QStringLiteral("mkfs.ext2"), { QStringLiteral("-q"), QStringLiteral("-F") } },
+    { QStringLiteral("ext3"), QStringLiteral("mkfs.ext3"), { QStringLiteral("-q"), QStringLiteral("-F") } },
+    { QStringLiteral("ext4"), QStringLiteral("mkfs.ext4"), { QStringLiteral("-q"), QStringLiteral("-F") } },
+    { QStringLiteral("btrfs"), QStringLiteral("mkfs.btrfs"), { QStringLiteral("-f") } },
+    { QStringLiteral("xfs"), QStringLiteral("mkfs.xfs"), { QStringLiteral("-f") } },
+    { QStringLiteral("f2fs"), QStringLiteral("mkfs.f2fs"), { QStringLiteral("-f") } },
+    { QStringLiteral("fat32"), QStringLiteral("mkfs.fat"), { QStringLiteral("-F"), QStringLiteral("32") } },
+    { QStringLiteral("exfat"), QStringLiteral("mkfs.exfat"), {} },
+    { QStringLiteral("ntfs"), QStringLiteral("mkfs.ntfs"), { QStringLiteral("-Q"), QStringLiteral("-F") } },
+    { QStringLiteral("jfs"), QStringLiteral("mkfs.jfs"), { QStringLiteral("-q") } },
+    { QStringLiteral("nilfs2"), QStringLiteral("mkfs.nilfs2"), { QStringLiteral("-f") } },
+    { QStringLiteral("reiserfs"), QStringLiteral("mkfs.reiserfs"), { QStringLiteral("-q"), QStringLiteral("-f") } },
+    { QStringLiteral("reiser4"), QStringLiteral("mkfs.reiser4"), { QStringLiteral("-y"), QStringLiteral("-f") } },
+    { QStringLiteral("hfsplus"), QStringLiteral("mkfs.hfsplus"), {} },
+    { QStringLiteral("udf"), QStringLiteral("mkudffs"), {} },
+    { QStringLiteral("minix"), QStringLiteral("mkfs.minix"), {} },
+    { QStringLiteral("linuxswap"), QStringLiteral("mkswap"), { QStringLiteral("-f") } },
+};
+
+static QString findTool(const QString& name)
+{
+    const QString path = QStandardPaths::findExecutable(name);
+    if (!path.isEmpty())
+        return path;
+
+    return QStandardPaths::findExecutable(name, { QStringLiteral("/sbin"), QStringLiteral("/usr/sbin"), QStringLiteral("/usr/local/sbin") });
+}
+
+static bool run(const QString& program, const QStringList& args, QByteArray* output = nullptr, const QByteArray& input = {})
+{
+    QProcess process;
+    process.start(findTool(program), args);
+    process.write(input);
+    process.closeWriteChannel();
+    process.waitForFinished(-1);
+
+    if (output)
+        *output = process.readAllStandardOutput();
+
+    if (process.exitStatus() != QProcess::NormalExit || process.exitCode() != 0) {
+        qWarning().noquote() << program << args.join(QLatin1Char(' ')) << "failed:" << process.readAllStandardError().trimmed();
+        return false;
+    }
+
+    return true;
+}
+
+// Processes started on the whole system since boot
+static quint64 processesStarted()
+{
+    QFile stat(QStringLiteral("/proc/stat"));
+    if (!stat.open(QIODevice::ReadOnly))
+        return 0;
+
+    while (!stat.atEnd()) {
+        const QByteArray line = stat.readLine();
+        if (line.startsWith("processes "))
+            return line.mid(10).trimmed().toULongLong();
+    }
+
+    return 0;
+}
+
+/**
+ * Use RAII to set up loop devices with partition tables, file systems, LUKS, LVM and
+ * a RAID array. Everything is torn down again when the farm is destroyed.
+ */
+class LoopFarm
+{
+public:
+    explicit LoopFarm(const QString& directory) : m_Directory(directory) {}
+    ~LoopFarm();
+
+    bool create(int partitions, int logicalVolumes);
+
+    const QStringList& deviceNodes() const
+    {
+        return m_Loops;
+    }
+
+private:
+    QString attach(const QString& name, qint64 sizeMiB);
+    bool format(const QString& deviceNode, const FileSystemTool& tool);
+    const FileSystemTool* tool(const QString& name) const;
+    bool createGpt(int partitions);
+    bool createMsdos();
+    bool createLuks();
+    bool createVolumeGroup(int logicalVolumes);
+    bool createRaid();
+
+    static QString partitionNode(const QString& deviceNode, int number)
+    {
+        return deviceNode + QLatin1Char('p') + QString::number(number);
+    }
+
+private:
+    QString m_Directory;
+    QStringList m_Loops;
+    std::vector<FileSystemTool> m_Tools;
+    bool m_Luks = false;
+    bool m_VolumeGroup = false;
+    bool m_Raid = false;
+};
+
+LoopFarm::~LoopFarm()
+{
+    if (m_Luks)
+        run(QStringLiteral("cryptsetup"), { QStringLiteral("close"), luksName });
+    if (m_VolumeGroup) {
+        run(QStringLiteral("lvm"), { QStringLiteral("vgchange"), QStringLiteral("--activate"), QStringLiteral("n"), volumeGroup });
+        run(QStringLiteral("lvm"), { QStringLiteral("vgremove"), QStringLiteral("--force"), QStringLiteral("--yes"), volumeGroup });
+    }
+    if (m_Raid)
+        run(QStringLiteral("mdadm"), { QStringLiteral("--stop"), mdArray });
+
+    for (const auto &loop : std::as_const(m_Loops))
+        run(QStringLiteral("losetup"), { QStringLiteral("--detach"), loop });
+}
+
+bool LoopFarm::create(int partitions, int logicalVolumes)
+{
+    for (const auto &t : fileSystemTools)
+        if (!findTool(t.mkfs).isEmpty())
+            m_Tools.push_back(t);
+
+    if (m_Tools.empty()) {
+        qWarning() << "No mkfs tools found.";
+        return false;
+    }
+
+    if (!createGpt(partitions) || !createMsdos())
+        return false;
+
+    // The rest is optional, depending on the tools installed
+    if (!findTool(QStringLiteral("cryptsetup")).isEmpty() && !createLuks())
+        return false;
+    if (!findTool(QStringLiteral("lvm")).isEmpty() && !createVolumeGroup(logicalVolumes))
+        return false;
+    if (!findTool(QStringLiteral("mdadm")).isEmpty() && !createRaid())
+        return false;
+
+    return run(QStringLiteral("udevadm"), { QStringLiteral("settle") });
+}
+
+QString LoopFarm::attach(const QString& name, qint64 sizeMiB)
+{
+    QFile file(m_Directory + QLatin1Char('/') + name);
+    if (!file.open(QIODevice::WriteOnly) || !file.resize(sizeMiB * 1024 * 1024))
+        return {};
+    file.close();
+
+    QByteArray output;
+    if (!run(QStringLiteral("losetup"), { QStringLiteral("--find"), QStringLiteral("--show"), QStringLiteral("--partscan"), file.fileName() }, &output))
+        return {};
+
+    const QString loop = QString::fromLocal8Bit(output.trimmed());
+    m_Loops << loop;
+
+    return loop;
+}
+
+bool LoopFarm::format(const QString& deviceNode, const FileSystemTool& tool)
+{
+    return run(tool.mkfs, tool.args + QStringList{ deviceNode });
+}
+
+const FileSystemTool* LoopFarm::tool(const QString& name) const
+{
+    const auto it = std::find_if(m_Tools.begin(), m_Tools.end(), [&name] (const FileSystemTool& t) { return t.name == name; });
+    return it == m_Tools.end() ? &m_Tools.front() : &*it;
+}
+
+// A GPT disk with many partitions, each file system type in turn
+bool LoopFarm::createGpt(int partitions)
+{
+    const QString loop = attach(QStringLiteral("gpt.img"), partitions * partitionSize + 2);
+    if (loop.isEmpty())
+        return false;
+
+    QByteArray script = "label: gpt\n";
+    for (int i = 0; i < partitions; ++i)
+        script += ",+" + QByteArray::number(partitionSize) + "M\n";
+
+    if (!run(QStringLiteral("sfdisk"), { QStringLiteral("--quiet"), loop }, nullptr, script) || !run(QStringLiteral("udevadm"), { QStringLiteral("settle") }))
+        return false;
+
+    for (int i = 0; i < partitions; ++i)
+        if (!format(partitionNode(loop, i + 1), m_Tools[i % m_Tools.size()]))
+            return false;
+
+    return true;
+}
+
+// An MBR disk with primary and logical partitions
+bool LoopFarm::createMsdos()
+{
+    const QString loop = attach(QStringLiteral("msdos.img"), 5 * partitionSize);
+    if (loop.isEmpty())
+        return false;
+
+    const QByteArray size = QByteArray::number(partitionSize) + "M";
+    const QByteArray script = "label: dos\n,+" + size + "\n,+" + size + "\n,,E\n,+" + size + "\n,+" + size + "\n";
+
+    if (!run(QStringLiteral("sfdisk"), { QStringLiteral("--quiet"), loop }, nullptr, script) || !run(QStringLiteral("udevadm"), { QStringLiteral("settle") }))
+        return false;
+
+    return format(partitionNode(loop, 1), *tool(QStringLiteral("ext4"))) &&
+           format(partitionNode(loop, 2), *tool(QStringLiteral("fat32"))) &&
+           format(partitionNode(loop, 5), *tool(QStringLiteral("linuxswap"))) &&
+           format(partitionNode(loop, 6), *tool(QStringLiteral("xfs")));
+}
+
+// A GPT disk with an open LUKS2 container
+bool LoopFarm::createLuks()
+{
+    const QString loop = attach(QStringLiteral("luks.img"), 130);
+    if (loop.isEmpty())
+        return false;
+
+    if (!run(QStringLiteral("sfdisk"), { QStringLiteral("--quiet"), loop }, nullptr, "label: gpt\n,\n") || !run(QStringLiteral("udevadm"), { QStringLiteral("settle") }))
+        return false;
+
+    // The benchmark is about scanning, keep key derivation cheap
+    const QString partition = partitionNode(loop, 1);
+    const QByteArray passphrase = "kpmbench";
+    if (!run(QStringLiteral("cryptsetup"), { QStringLiteral("luksFormat"), QStringLiteral("--batch-mode"), QStringLiteral("--type"), QStringLiteral("luks2"),
+                                             QStringLiteral("--pbkdf"), QStringLiteral("pbkdf2"), QStringLiteral("--pbkdf-force-iterations"), QStringLiteral("1000"),
+                                             QStringLiteral("--key-file"), QStringLiteral("-"), partition }, nullptr, passphrase))
+        return false;
+
+    if (!run(QStringLiteral("cryptsetup"), { QStringLiteral("open"), QStringLiteral("--key-file"), QStringLiteral("-"), partition, luksName }, nullptr, passphrase))
+        return false;
+    m_Luks = true;
+
+    return format(QStringLiteral("/dev/mapper/") + luksName, *tool(QStringLiteral("ext4")));
+}
+
+// A volume group with many logical volumes
+bool LoopFarm::createVolumeGroup(int logicalVolumes)
+{
+    const QString loop = attach(QStringLiteral("lvm.img"), logicalVolumes * logicalVolumeSize + 16);
+    if (loop.isEmpty())
+        return false;
+
+    if (!run(QStringLiteral("lvm"), { QStringLiteral("pvcreate"), QStringLiteral("--force"), QStringLiteral("--yes"), loop }) ||
+        !run(QStringLiteral("lvm"), { QStringLiteral("vgcreate"), QStringLiteral("--physicalextentsize"), QStringLiteral("4M"), volumeGroup, loop }))
+        return false;
+    m_VolumeGroup = true;
+
+    for (int i = 0; i < logicalVolumes; ++i) {
+        const QString name = QStringLiteral("lv%1").arg(i);
+        if (!run(QStringLiteral("lvm"), { QStringLiteral("lvcreate"), QStringLiteral("--yes"), QStringLiteral("--size"), QStringLiteral("%1M").arg(logicalVolumeSize), QStringLiteral("--name"), name, volumeGroup }))
+            return false;
+        if (!format(QStringLiteral("/dev/%1/%2").arg(volumeGroup, name), *tool(QStringLiteral("ext4"))))
+            return false;
+    }
+
+    return true;
+}
+
+// A RAID 1 array on two loop devices
+bool LoopFarm::createRaid()
+{
+    const QString first = attach(QStringLiteral("raid0.img"), 130);
+    const QString second = attach(QStringLiteral("raid1.img"), 130);
+    if (first.isEmpty() || second.isEmpty())
+        return false;
+
+    if (!run(QStringLiteral("mdadm"), { QStringLiteral("--create"), mdArray, QStringLiteral("--run"), QStringLiteral("--assume-clean"), QStringLiteral("--level=1"),
+                                        QStringLiteral("--raid-devices=2"), QStringLiteral("--metadata=1.2"), first, second }))
+        return false;
+    m_Raid = true;
+
+    return format(mdArray, *tool(QStringLiteral("ext4")));
+}
+
+struct Measurement
+{
+    qint64 total = 0;
+    qint64 enumerate = 0;
+    qint64 devices = 0;
+    qint64 volumeManagers = 0;
+    qint64 farm = 0;
+    int scannedDevices = 0;
+    quint64 processes = 0;
+    quint64 helperCalls = 0;
+};
+
+static qint64 median(std::vector<qint64> values)
+{
+    std::sort(values.begin(), values.end());
+    return values.empty() ? 0 : values[values.size() / 2];
+}
+
+int main( int argc, char **argv )
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral("Benchmarks device scanning on a farm of loop devices."));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("backend"), QStringLiteral("Backend plugin to use."));
+    const QCommandLineOption partitionsOption(QStringLiteral("partitions"), QStringLiteral("Partitions on the GPT loop device."), QStringLiteral("count"), QStringLiteral("32"));
+    const QCommandLineOption volumesOption(QStringLiteral("logical-volumes"), QStringLiteral("Logical volumes in the volume group."), QStringLiteral("count"), QStringLiteral("32"));
+    const QCommandLineOption iterationsOption(QStringLiteral("iterations"), QStringLiteral("Number of scans to measure."), QStringLiteral("count"), QStringLiteral("5"));
+    const QCommandLineOption maxOption(QStringLiteral("max-seconds"), QStringLiteral("Fail if the median full scan takes longer."), QStringLiteral("seconds"), QStringLiteral("0"));
+    parser.addOptions({ partitionsOption, volumesOption, iterationsOption, maxOption });
+    parser.process(app);
+
+    if (geteuid() != 0) {
+        qInfo() << "Setting up loop devices needs root, skipping.";
+        return skipReturnCode;
+    }
+    if (findTool(QStringLiteral("losetup")).isEmpty() || findTool(QStringLiteral("sfdisk")).isEmpty()) {
+        qInfo() << "losetup and sfdisk are needed, skipping.";
+        return skipReturnCode;
+    }
+
+    std::unique_ptr<KPMCoreInitializer> i;
+    if (parser.positionalArguments().isEmpty())
+        i = std::make_unique<KPMCoreInitializer>();
+    else
+        i = std::make_unique<KPMCoreInitializer>(parser.positionalArguments().first());
+    if (!i->isValid())
+        return 1;
+
+    QTemporaryDir directory;
+    LoopFarm farm(directory.path());
+
+    QElapsedTimer setupTimer;
+    setupTimer.start();
+    if (!farm.create(parser.value(partitionsOption).toInt(), parser.value(volumesOption).toInt())) {
+        qInfo() << "Could not set up the loop devices, skipping.";
+        return skipReturnCode;
+    }
+    qInfo().noquote() << QStringLiteral("Set up %1 loop devices in %2 ms").arg(farm.deviceNodes().size()).arg(setupTimer.elapsed());
+
+    OperationStack operationStack;
+    DeviceScanner scanner(nullptr, operationStack);
+
+    // The backend reports each device before scanning it, which splits a scan into listing
+    // the devices, scanning them and scanning the volume managers after the last one
+    QElapsedTimer timer;
+    qint64 firstDevice = -1;
+    qint64 lastDevice = -1;
+    int scannedDevices = 0;
+    QObject::connect(CoreBackendManager::self()->backend(), &CoreBackend::scanProgress, [&] (const QString&, int) {
+        lastDevice = timer.elapsed();
+        if (firstDevice < 0)
+            firstDevice = lastDevice;
+        ++scannedDevices;
+    });
+
+    std::vector<Measurement> measurements;
+    const int iterations = parser.value(iterationsOption).toInt();
+    for (int iteration = 0; iteration < iterations; ++iteration) {
+        Measurement m;
+        firstDevice = lastDevice = -1;
+        scannedDevices = 0;
+
+        const quint64 processes = processesStarted();
+        const quint64 helperCalls = ExternalCommand::helperCalls();
+
+        timer.start();
+        scanner.scan();
+        m.total = timer.elapsed();
+
+        m.processes = processesStarted() - processes;
+        m.helperCalls = ExternalCommand::helperCalls() - helperCalls;
+        m.scannedDevices = scannedDevices;
+        if (firstDevice >= 0) {
+            m.enumerate = firstDevice;
+            m.devices = lastDevice - firstDevice;
+            m.volumeManagers = m.total - lastDevice;
+        }
+
+        timer.start();
+        scanner.scan(farm.deviceNodes());
+        m.farm = timer.elapsed();
+
+        qInfo().noquote() << QStringLiteral("Scan %1: %2 ms total, %3 ms listing, %4 ms for %5 devices, %6 ms last device and volume managers, "
+                                            "%7 ms loop devices only, %8 processes, %9 helper calls")
+                             .arg(iteration + 1).arg(m.total).arg(m.enumerate).arg(m.devices).arg(m.scannedDevices)
+                             .arg(m.volumeManagers).arg(m.farm).arg(m.processes).arg(m.helperCalls);
+        measurements.push_back(m);
+    }
+
+    if (measurements.empty())
+        return 0;
+
+    auto collect = [&measurements] (auto field) {
+        std::vector<qint64> values;
+        for (const auto &m : measurements)
+            values.push_back(static_cast<qint64>(m.*field));
+        return median(values);
+    };
+
+    const qint64 total = collect(&Measurement::total);
+    qInfo().noquote() << QStringLiteral("Median: %1 ms total, %2 ms listing, %3 ms devices, %4 ms last device and volume managers, "
+                                        "%5 ms loop devices only, %6 processes, %7 helper calls")
+                         .arg(total).arg(collect(&Measurement::enumerate)).arg(collect(&Measurement::devices))
+                         .arg(collect(&Measurement::volumeManagers)).arg(collect(&Measurement::farm))
+                         .arg(collect(&Measurement::processes)).arg(collect(&Measurement::helperCalls));
+
+    const qint64 maxSeconds = parser.value(maxOption).toLongLong();
+    if (maxSeconds > 0 && total > maxSeconds * 1000) {
+        qWarning() << "Scanning took longer than" << maxSeconds << "seconds.";
+        return 1;
+    }
+
+    return 0;
+}